@@ -0,0 +1,1043 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// RuntimeBench.cpp
+//
+
+//
+//  Micro-benchmarks of the runtime helpers that compiled code calls most, linked against the runtime static
+//  library the same way the bootstrapper is, so that helper changes can be measured without any managed code.
+//  runtimebench is linked against Runtime and runtimebench_portable against PortableRuntime.
+//
+//  usage: runtimebench [<benchmark>...] [-count <n>] [-runs <n>] [-threads <n>] [-csv]
+//
+//  Without any benchmark name every benchmark is run. Each benchmark is run once to warm up and then -runs
+//  times (5 by default), -count operations at a time (each benchmark has its own default). The benchmarks are:
+//
+//  newfast             RhpNewFast of an object without references
+//  newbatch            RhpNewFastBatch of 64 objects at a time into an object array, per object
+//  newarray            RhpNewArray of a byte[32]
+//  newarray-refs       RhpNewArray of an object[8]
+//  assignref           RhpAssignRef storing a gen0 object into a gen0 object
+//  assignref-gen2      RhpAssignRef storing a gen0 object into a gen2 object, which marks a card
+//  checkedassignref    RhpCheckedAssignRef storing a gen0 object into a gen0 object
+//  checkedassignref-stack  RhpCheckedAssignRef storing into a location outside of the GC heap
+//  dispatch-<n>        Interface dispatch cache lookup (RhpSearchDispatchCellCache) for a call site that has
+//                      seen n types, going round the n types. The dispatch stubs aren't callable from C++, this
+//                      is the search they do.
+//  handlealloc         RhpHandleAlloc of a strong handle followed by RhHandleFree
+//  arraycopy           RhpArrayCopy of 256 elements of a byte[]
+//  arraycopy-refs      RhpArrayCopy of 256 elements of an object[], including the bulk write barrier
+//  arraycopy-refs-scalar  The copy and bulk write barrier RhpArrayCopy does for arraycopy-refs, with the copy
+//                      done by the pointer sized loops the GC-safe copy used before it moved large spans with
+//                      vector instructions (the argument checks of RhpArrayCopy are left out)
+//  gcsafecopy          InlineForwardGCSafeCopy of 2KB between two object[] whose data share the same alignment
+//  gcsafecopy-scalar   The same with the pointer sized loops
+//  gcsafefill          InlineGCSafeFillMemory of 2KB of an object[] with zeros
+//  gcsafefill-scalar   The same with the pointer sized loops
+//  reversepinvoke      RhpReversePInvoke2 followed by RhpReversePInvokeReturn
+//  gcsuspend           A gen0 GC of an empty gen0 (RhpCollect) while -threads - 1 other threads go in and out of
+//                      cooperative mode through reverse p/invokes, so that it's mostly the cost of suspending
+//                      and restarting them.
+//  spinlock            SpinLock acquire and release, on each of -threads threads (1 by default)
+//  spinlock-queued     The same with the queued (MCS) flavor of SpinLock
+//
+//  Results are in nanoseconds per operation: the fastest and the median run. On Linux the number of last
+//  level cache misses and L1 data cache read misses per operation over all the runs are reported as well, if
+//  perf_event_open is allowed to count them. -csv prints comma separated values, leaving out the counters that
+//  aren't available, for tracking regressions. When both a benchmark and its -scalar variant are run, the two
+//  are reported side by side at the end.
+//
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "CommonTypes.h"
+#include "CommonMacros.h"
+#include "daccess.h"
+#include "PalRedhawkCommon.h"
+#include "PalRedhawk.h"
+#include "rhassert.h"
+#include "Volatile.h"
+#include "SpinLock.h"
+#include "rhbinder.h"
+#include "eetype.h"
+#include "ObjectLayout.h"
+#include "gcrhinterface.h"
+#include "CommonMacros.inl"
+#include "GCMemoryHelpers.h"
+#include "GCMemoryHelpers.inl"
+
+//
+// The runtime helpers being measured, and the ones needed to set things up
+//
+
+struct ReversePInvokeFrame
+{
+    void*   m_savedPInvokeTransitionFrame;
+    void*   m_savedThread;
+};
+
+EXTERN_C UInt32_BOOL WINAPI RtuDllMain(HANDLE hPalInstance, UInt32 dwReason, void* pvReserved);
+EXTERN_C UInt32_BOOL REDHAWK_CALLCONV RhpEnableConservativeStackReporting();
+
+EXTERN_C void REDHAWK_CALLCONV RhpReversePInvoke2(ReversePInvokeFrame* pFrame);
+EXTERN_C void REDHAWK_CALLCONV RhpReversePInvokeReturn(ReversePInvokeFrame* pFrame);
+
+EXTERN_C Object * REDHAWK_CALLCONV RhpNewFast(EEType* pEEType);
+EXTERN_C UInt32 REDHAWK_CALLCONV RhpNewFastBatch(EEType* pEEType, UInt32 count, Object ** pOut);
+EXTERN_C Array * REDHAWK_CALLCONV RhpNewArray(EEType * pArrayEEType, int numElements);
+
+EXTERN_C void REDHAWK_CALLCONV RhpAssignRef(Object ** dst, Object * ref);
+EXTERN_C void REDHAWK_CALLCONV RhpCheckedAssignRef(Object ** dst, Object * ref);
+
+EXTERN_C void * RhpInitialDynamicInterfaceDispatch;
+EXTERN_C PTR_Code REDHAWK_CALLCONV RhpUpdateDispatchCellCache(InterfaceDispatchCell * pCell, PTR_Code pTargetCode, EEType* pInstanceType);
+EXTERN_C PTR_Code REDHAWK_CALLCONV RhpSearchDispatchCellCache(InterfaceDispatchCell * pCell, EEType* pInstanceType);
+
+EXTERN_C void * REDHAWK_CALLCONV RhpHandleAlloc(Object *pObject, int type);
+EXTERN_C void REDHAWK_CALLCONV RhHandleFree(void * handle);
+EXTERN_C Object * REDHAWK_CALLCONV RhHandleGet(void * handle);
+
+EXTERN_C Boolean REDHAWK_CALLCONV RhpArrayCopy(Array * pSourceArray, Int32 sourceIndex, Array * pDestinationArray, Int32 destinationIndex, Int32 length);
+
+EXTERN_C REDHAWK_API void __cdecl RhpCollect(UInt32 uGeneration, UInt32 uMode);
+EXTERN_C Int32 REDHAWK_CALLCONV RhGetGeneration(Object * obj);
+
+#define HNDTYPE_STRONG          2       // see objecthandle.h
+#define COLLECTION_BLOCKING     2       // see collection_mode in gc.h
+
+//
+// The runtime expects these from the class library, which is not there. None of them is reached by the
+// benchmarks.
+//
+
+static void Unsupported(const char * pszName)
+{
+    fprintf(stderr, "runtimebench: %s is not supported without a class library\n", pszName);
+    abort();
+}
+
+#define UNSUPPORTED_EXPORT(_name) EXTERN_C void _name() { Unsupported(#_name); }
+
+#if !defined(_WIN32) || defined(USE_PORTABLE_HELPERS)
+UNSUPPORTED_EXPORT(RhpThrowEx)
+UNSUPPORTED_EXPORT(RhpThrowHwEx)
+UNSUPPORTED_EXPORT(RhpCallCatchFunclet)
+UNSUPPORTED_EXPORT(RhpCallFilterFunclet)
+UNSUPPORTED_EXPORT(RhpCallFinallyFunclet)
+#endif // !_WIN32 || USE_PORTABLE_HELPERS
+UNSUPPORTED_EXPORT(RhGetCurrentThreadStackTrace)
+UNSUPPORTED_EXPORT(RhpUniversalTransition)
+UNSUPPORTED_EXPORT(RhpFailFastForPInvokeExceptionPreemp)
+UNSUPPORTED_EXPORT(RhpFailFastForPInvokeExceptionCoop)
+UNSUPPORTED_EXPORT(RhpEtwExceptionThrown)
+UNSUPPORTED_EXPORT(RhpReversePInvokeBadTransition)
+UNSUPPORTED_EXPORT(RhpSetHaveNewClasslibs)
+UNSUPPORTED_EXPORT(RhpCidResolve)
+UNSUPPORTED_EXPORT(RhTypeCast_IsInstanceOfClass)
+UNSUPPORTED_EXPORT(RhTypeCast_CheckCastClass)
+UNSUPPORTED_EXPORT(RhTypeCast_IsInstanceOfArray)
+UNSUPPORTED_EXPORT(RhTypeCast_CheckCastArray)
+UNSUPPORTED_EXPORT(RhTypeCast_IsInstanceOfInterface)
+UNSUPPORTED_EXPORT(RhTypeCast_CheckCastInterface)
+UNSUPPORTED_EXPORT(RhTypeCast_CheckVectorElemAddr)
+
+EXTERN_C void * g_pSystemArrayEETypeTemporaryWorkaround = NULL;
+
+//
+// Types. There is no binder to lay out EETypes, so the few the benchmarks need are laid out by hand: the fields
+// of EEType (see inc/eetype.h) preceded by a GCDesc with at most one series of references (see gcdesc.h).
+//
+
+#define EETYPE_VALUE_TYPE       0x0008  // EEType::ValueTypeFlag
+#define EETYPE_HAS_POINTERS     0x0020  // EEType::HasPointersFlag
+#define EETYPE_IS_INTERFACE     0x0200  // EEType::IsInterfaceFlag
+
+struct BenchEEType
+{
+    // GCDesc, read backwards from the EEType by the GC
+    IntNative       m_seriesSize;       // length of the series in bytes minus the base size
+    UIntNative      m_seriesOffset;
+    UIntNative      m_numSeries;
+
+    // EEType
+    UInt16          m_usComponentSize;
+    UInt16          m_usFlags;
+    UInt32          m_uBaseSize;
+    EEType *        m_pRelatedType;     // base type, or element type of an array
+    UInt16          m_usNumVtableSlots;
+    UInt16          m_usNumInterfaces;
+    UInt32          m_uHashCode;
+#if defined(CORERT)
+    void *          m_ppModuleManager;
+#endif
+
+    EEType * AsEEType()
+    {
+        return (EEType *)&m_usComponentSize;
+    }
+};
+
+// The base size of every object includes the ObjHeader in front of it.
+#define OBJECT_BASE_SIZE(_cbFields) max((UInt32)(SYNC_BLOCK_SKEW + sizeof(Object) + (_cbFields)), (UInt32)(3 * sizeof(void*)))
+#define ARRAY_BASE_SIZE             ((UInt32)(SYNC_BLOCK_SKEW + sizeof(Array)))
+
+// An object with two references, at offset sizeof(Object)
+static BenchEEType s_nodeType;
+// An object without references
+static BenchEEType s_objectType;
+static BenchEEType s_byteArrayType;
+static BenchEEType s_objectArrayType;
+static BenchEEType s_interfaceType;
+
+// Distinct types for the interface dispatch benchmarks
+#define MAX_DISPATCH_TYPES 16
+static BenchEEType s_dispatchTypes[MAX_DISPATCH_TYPES];
+
+static void InitializeCanonicalType(BenchEEType * pType, UInt32 cbFields, UInt32 cReferences)
+{
+    memset(pType, 0, sizeof(*pType));
+    pType->m_uBaseSize = OBJECT_BASE_SIZE(cbFields);
+    pType->m_uHashCode = (UInt32)(UIntNative)pType;
+    if (cReferences != 0)
+    {
+        pType->m_usFlags = EETYPE_HAS_POINTERS;
+        pType->m_numSeries = 1;
+        pType->m_seriesOffset = sizeof(Object);
+        pType->m_seriesSize = (IntNative)(cReferences * sizeof(Object *)) - (IntNative)pType->m_uBaseSize;
+    }
+}
+
+static void InitializeArrayType(BenchEEType * pType, BenchEEType * pElementType, UInt16 cbElement, bool fReferences)
+{
+    memset(pType, 0, sizeof(*pType));
+    pType->m_usComponentSize = cbElement;
+    pType->m_usFlags = EEType::ParameterizedEEType;
+    pType->m_uBaseSize = ARRAY_BASE_SIZE;
+    pType->m_pRelatedType = pElementType->AsEEType();
+    pType->m_uHashCode = (UInt32)(UIntNative)pType;
+    if (fReferences)
+    {
+        // A single series covering the whole data portion of the array
+        pType->m_usFlags |= EETYPE_HAS_POINTERS;
+        pType->m_numSeries = 1;
+        pType->m_seriesOffset = sizeof(Array);
+        pType->m_seriesSize = -(IntNative)pType->m_uBaseSize;
+    }
+}
+
+static void InitializeTypes()
+{
+    // Only System.Object may have no base type (see EEType::Validate), the other types derive from it.
+    InitializeCanonicalType(&s_objectType, 0, 0);
+    InitializeCanonicalType(&s_nodeType, 2 * sizeof(Object *), 2);
+    s_nodeType.m_pRelatedType = s_objectType.AsEEType();
+
+    // The element type of byte[] is only there for the sake of completeness.
+    static BenchEEType s_byteType;
+    InitializeCanonicalType(&s_byteType, 1, 0);
+    s_byteType.m_usFlags |= EETYPE_VALUE_TYPE;
+    s_byteType.m_pRelatedType = s_objectType.AsEEType();
+    InitializeArrayType(&s_byteArrayType, &s_byteType, 1, false);
+    InitializeArrayType(&s_objectArrayType, &s_objectType, sizeof(Object *), true);
+
+    InitializeCanonicalType(&s_interfaceType, 0, 0);
+    s_interfaceType.m_usFlags = EETYPE_IS_INTERFACE;
+
+    for (int i = 0; i < MAX_DISPATCH_TYPES; i++)
+        InitializeCanonicalType(&s_dispatchTypes[i], 0, 0);
+}
+
+static Object ** GetNodeReferences(Object * pNode)
+{
+    return (Object **)((UInt8 *)pNode + sizeof(Object));
+}
+
+//
+// Benchmark state. Objects live on the stack of the benchmark thread, which is reported conservatively just
+// like for code generated by CppCodeGen, or in strong handles when they need to live across runs.
+//
+
+struct BenchOptions
+{
+    UInt64  m_count;
+    UInt32  m_cRuns;
+    UInt32  m_cThreads;
+    bool    m_fCsv;
+};
+
+static BenchOptions s_options;
+
+// Keeps the compiler from optimizing away the results of the helpers
+static void * volatile s_pSink;
+
+// An object promoted to gen2 by the setup of assignref-gen2
+static void * s_hGen2Node;
+
+static UInt64 BenchNewFast(UInt64 count)
+{
+    EEType * pType = s_objectType.AsEEType();
+    for (UInt64 i = 0; i < count; i++)
+        s_pSink = RhpNewFast(pType);
+    return count;
+}
+
+#define BATCH_SIZE 64
+
+static UInt64 BenchNewBatch(UInt64 count)
+{
+    EEType * pType = s_objectType.AsEEType();
+    Array * pBatch = RhpNewArray(s_objectArrayType.AsEEType(), BATCH_SIZE);
+    Object ** pObjects = (Object **)pBatch->GetArrayData();
+
+    UInt64 cBatches = (count + BATCH_SIZE - 1) / BATCH_SIZE;
+    for (UInt64 i = 0; i < cBatches; i++)
+    {
+        UInt32 cAllocated = RhpNewFastBatch(pType, BATCH_SIZE, pObjects);
+        while (cAllocated < BATCH_SIZE)
+        {
+            // The alloc context is exhausted, refill it the way RhpNewFastBatch expects.
+            RhpAssignRef(&pObjects[cAllocated], RhpNewFast(pType));
+            cAllocated++;
+            cAllocated += RhpNewFastBatch(pType, BATCH_SIZE - cAllocated, &pObjects[cAllocated]);
+        }
+    }
+
+    s_pSink = pBatch;
+    return cBatches * BATCH_SIZE;
+}
+
+static UInt64 BenchNewArray(UInt64 count)
+{
+    EEType * pType = s_byteArrayType.AsEEType();
+    for (UInt64 i = 0; i < count; i++)
+        s_pSink = RhpNewArray(pType, 32);
+    return count;
+}
+
+static UInt64 BenchNewArrayRefs(UInt64 count)
+{
+    EEType * pType = s_objectArrayType.AsEEType();
+    for (UInt64 i = 0; i < count; i++)
+        s_pSink = RhpNewArray(pType, 8);
+    return count;
+}
+
+static UInt64 BenchAssignRef(UInt64 count)
+{
+    Object * pNode = RhpNewFast(s_nodeType.AsEEType());
+    Object * pTarget = RhpNewFast(s_objectType.AsEEType());
+    Object ** ppField = GetNodeReferences(pNode);
+    for (UInt64 i = 0; i < count; i++)
+        RhpAssignRef(ppField, pTarget);
+    s_pSink = pNode;
+    return count;
+}
+
+static void SetupAssignRefGen2()
+{
+    if (s_hGen2Node != NULL)
+        return;
+
+    ReversePInvokeFrame frame;
+    RhpReversePInvoke2(&frame);
+    s_hGen2Node = RhpHandleAlloc(RhpNewFast(s_nodeType.AsEEType()), HNDTYPE_STRONG);
+    RhpReversePInvokeReturn(&frame);
+
+    // A blocking gen2 GC promotes gen0 survivors to gen1 only, it takes two to get to gen2.
+    for (int i = 0; i < 3; i++)
+    {
+        RhpCollect(2, COLLECTION_BLOCKING);
+
+        RhpReversePInvoke2(&frame);
+        Int32 generation = RhGetGeneration(RhHandleGet(s_hGen2Node));
+        RhpReversePInvokeReturn(&frame);
+        if (generation == 2)
+            break;
+    }
+}
+
+static UInt64 BenchAssignRefGen2(UInt64 count)
+{
+    Object * pNode = RhHandleGet(s_hGen2Node);
+    Object * pTarget = RhpNewFast(s_objectType.AsEEType());
+    Object ** ppField = GetNodeReferences(pNode);
+    for (UInt64 i = 0; i < count; i++)
+        RhpAssignRef(ppField, pTarget);
+    return count;
+}
+
+static UInt64 BenchCheckedAssignRef(UInt64 count)
+{
+    Object * pNode = RhpNewFast(s_nodeType.AsEEType());
+    Object * pTarget = RhpNewFast(s_objectType.AsEEType());
+    Object ** ppField = GetNodeReferences(pNode);
+    for (UInt64 i = 0; i < count; i++)
+        RhpCheckedAssignRef(ppField, pTarget);
+    s_pSink = pNode;
+    return count;
+}
+
+static UInt64 BenchCheckedAssignRefStack(UInt64 count)
+{
+    Object * volatile pLocal = NULL;
+    Object * pTarget = RhpNewFast(s_objectType.AsEEType());
+    for (UInt64 i = 0; i < count; i++)
+        RhpCheckedAssignRef((Object **)&pLocal, pTarget);
+    s_pSink = pLocal;
+    return count;
+}
+
+static void DispatchTarget()
+{
+}
+
+// A call site for each of the dispatch benchmarks, each followed by the cell terminating the run, which holds
+// the slot number. They are only filled once so that the caches don't keep on growing.
+static InterfaceDispatchCell s_dispatchCells[3][2];
+
+static UInt64 BenchDispatch(UInt64 count, UInt32 cTypes, InterfaceDispatchCell * pCell)
+{
+    if (pCell->m_pStub == 0)
+    {
+        pCell->m_pStub = (UIntTarget)&RhpInitialDynamicInterfaceDispatch;
+        pCell->m_pCache = (UIntTarget)s_interfaceType.AsEEType() | InterfaceDispatchCell::IDC_CachePointerIsInterfacePointer;
+
+        for (UInt32 i = 0; i < cTypes; i++)
+            RhpUpdateDispatchCellCache(pCell, (PTR_Code)&DispatchTarget, s_dispatchTypes[i].AsEEType());
+    }
+
+    EEType * pTypes[MAX_DISPATCH_TYPES];
+    for (UInt32 i = 0; i < cTypes; i++)
+        pTypes[i] = s_dispatchTypes[i].AsEEType();
+
+    UInt32 iType = 0;
+    for (UInt64 i = 0; i < count; i++)
+    {
+        s_pSink = RhpSearchDispatchCellCache(pCell, pTypes[iType]);
+        if (++iType == cTypes)
+            iType = 0;
+    }
+
+    return count;
+}
+
+static UInt64 BenchDispatch1(UInt64 count) { return BenchDispatch(count, 1, s_dispatchCells[0]); }
+static UInt64 BenchDispatch4(UInt64 count) { return BenchDispatch(count, 4, s_dispatchCells[1]); }
+static UInt64 BenchDispatch16(UInt64 count) { return BenchDispatch(count, 16, s_dispatchCells[2]); }
+
+static UInt64 BenchHandleAlloc(UInt64 count)
+{
+    Object * pObject = RhpNewFast(s_objectType.AsEEType());
+    for (UInt64 i = 0; i < count; i++)
+        RhHandleFree(RhpHandleAlloc(pObject, HNDTYPE_STRONG));
+    return count;
+}
+
+#define ARRAY_COPY_LENGTH 256
+
+static UInt64 BenchArrayCopy(BenchEEType * pArrayType, UInt64 count)
+{
+    Array * pSource = RhpNewArray(pArrayType->AsEEType(), ARRAY_COPY_LENGTH);
+    Array * pDestination = RhpNewArray(pArrayType->AsEEType(), ARRAY_COPY_LENGTH);
+
+    if (pArrayType == &s_objectArrayType)
+    {
+        Object ** pElements = (Object **)pSource->GetArrayData();
+        for (int i = 0; i < ARRAY_COPY_LENGTH; i++)
+            RhpAssignRef(&pElements[i], RhpNewFast(s_objectType.AsEEType()));
+    }
+
+    for (UInt64 i = 0; i < count; i++)
+        RhpArrayCopy(pSource, 0, pDestination, 0, ARRAY_COPY_LENGTH);
+
+    s_pSink = pSource;
+    s_pSink = pDestination;
+    return count;
+}
+
+static UInt64 BenchArrayCopyBytes(UInt64 count) { return BenchArrayCopy(&s_byteArrayType, count); }
+static UInt64 BenchArrayCopyRefs(UInt64 count) { return BenchArrayCopy(&s_objectArrayType, count); }
+
+// The pointer sized loops of InlineForwardGCSafeCopy and InlineGCSafeFillMemory (GCMemoryHelpers.inl) from
+// before they moved large spans with vector instructions, to compare against.
+FORCEINLINE void ScalarForwardGCSafeCopy(void * dest, const void *src, size_t len)
+{
+    size_t size = len;
+    UInt8 * dmem = (UInt8 *)dest;
+    UInt8 * smem = (UInt8 *)src;
+
+    while (size >= 4 * sizeof(size_t))
+    {
+        size -= 4 * sizeof(size_t);
+        ((size_t *)dmem)[0] = ((size_t *)smem)[0];
+        ((size_t *)dmem)[1] = ((size_t *)smem)[1];
+        ((size_t *)dmem)[2] = ((size_t *)smem)[2];
+        ((size_t *)dmem)[3] = ((size_t *)smem)[3];
+        smem += 4 * sizeof(size_t);
+        dmem += 4 * sizeof(size_t);
+    }
+
+    if ((size & (2 * sizeof(size_t))) != 0)
+    {
+        ((size_t *)dmem)[0] = ((size_t *)smem)[0];
+        ((size_t *)dmem)[1] = ((size_t *)smem)[1];
+        smem += 2 * sizeof(size_t);
+        dmem += 2 * sizeof(size_t);
+    }
+
+    if ((size & sizeof(size_t)) != 0)
+    {
+        ((size_t *)dmem)[0] = ((size_t *)smem)[0];
+    }
+}
+
+FORCEINLINE void ScalarGCSafeFillMemory(void * mem, size_t size, size_t pv)
+{
+    UInt8 * memBytes = (UInt8 *)mem;
+    UInt8 * endBytes = &memBytes[size];
+
+    while (!IS_ALIGNED(memBytes, sizeof(void *)) && (memBytes < endBytes))
+        *memBytes++ = (UInt8)pv;
+
+    size_t nPtrs = (endBytes - memBytes) / sizeof(void *);
+    UIntNative* memPtr = (UIntNative*)memBytes;
+    for (size_t i = 0; i < nPtrs; i++)
+        *memPtr++ = pv;
+
+    memBytes = (UInt8*)memPtr;
+    while (memBytes < endBytes)
+        *memBytes++ = (UInt8)pv;
+}
+
+static Array * NewFilledObjectArray(int length)
+{
+    Array * pArray = RhpNewArray(s_objectArrayType.AsEEType(), length);
+    Object ** pElements = (Object **)pArray->GetArrayData();
+    for (int i = 0; i < length; i++)
+        RhpAssignRef(&pElements[i], RhpNewFast(s_objectType.AsEEType()));
+    return pArray;
+}
+
+static UInt64 BenchArrayCopyRefsScalar(UInt64 count)
+{
+    Array * pSource = NewFilledObjectArray(ARRAY_COPY_LENGTH);
+    Array * pDestination = RhpNewArray(s_objectArrayType.AsEEType(), ARRAY_COPY_LENGTH);
+
+    for (UInt64 i = 0; i < count; i++)
+    {
+        ScalarForwardGCSafeCopy(pDestination->GetArrayData(), pSource->GetArrayData(), ARRAY_COPY_LENGTH * sizeof(Object *));
+        InlinedBulkWriteBarrier(pDestination->GetArrayData(), ARRAY_COPY_LENGTH * sizeof(Object *));
+    }
+
+    s_pSink = pSource;
+    s_pSink = pDestination;
+    return count;
+}
+
+#define GC_SAFE_COPY_SIZE (ARRAY_COPY_LENGTH * sizeof(Object *))
+
+// On AMD64 the vector copy is only used when the source and the destination share the same alignment within
+// 16 bytes, the destination array has a spare element to start one element in when they don't.
+template <bool fScalar>
+static UInt64 BenchGCSafeCopy(UInt64 count)
+{
+    Array * pSource = NewFilledObjectArray(ARRAY_COPY_LENGTH);
+    Array * pDestination = RhpNewArray(s_objectArrayType.AsEEType(), ARRAY_COPY_LENGTH + 1);
+
+    UInt8 * pbSource = pSource->GetArrayData();
+    UInt8 * pbDestination = pDestination->GetArrayData();
+    if ((((size_t)pbSource ^ (size_t)pbDestination) & 15) != 0)
+        pbDestination += sizeof(Object *);
+
+    for (UInt64 i = 0; i < count; i++)
+    {
+        if (fScalar)
+            ScalarForwardGCSafeCopy(pbDestination, pbSource, GC_SAFE_COPY_SIZE);
+        else
+            InlineForwardGCSafeCopy(pbDestination, pbSource, GC_SAFE_COPY_SIZE);
+    }
+
+    s_pSink = pSource;
+    s_pSink = pDestination;
+    return count;
+}
+
+template <bool fScalar>
+static UInt64 BenchGCSafeFill(UInt64 count)
+{
+    Array * pArray = RhpNewArray(s_objectArrayType.AsEEType(), ARRAY_COPY_LENGTH);
+
+    for (UInt64 i = 0; i < count; i++)
+    {
+        if (fScalar)
+            ScalarGCSafeFillMemory(pArray->GetArrayData(), GC_SAFE_COPY_SIZE, 0);
+        else
+            InlineGCSafeFillMemory(pArray->GetArrayData(), GC_SAFE_COPY_SIZE, 0);
+    }
+
+    s_pSink = pArray;
+    return count;
+}
+
+static UInt64 BenchReversePInvoke(UInt64 count)
+{
+    ReversePInvokeFrame frame;
+    for (UInt64 i = 0; i < count; i++)
+    {
+        RhpReversePInvoke2(&frame);
+        RhpReversePInvokeReturn(&frame);
+    }
+    return count;
+}
+
+static Int32 s_fStopMutators;
+static Int32 s_cMutatorsStarted;
+static std::vector<std::thread> s_mutators;
+
+static void MutatorThread()
+{
+    ReversePInvokeFrame frame;
+    RhpReversePInvoke2(&frame);
+    RhpReversePInvokeReturn(&frame);
+    PalInterlockedIncrement(&s_cMutatorsStarted);
+
+    while (VolatileLoad(&s_fStopMutators) == 0)
+    {
+        RhpReversePInvoke2(&frame);
+        s_pSink = RhpNewFast(s_objectType.AsEEType());
+        RhpReversePInvokeReturn(&frame);
+    }
+}
+
+// The mutators are started before and stopped after the timed runs, so that gcsuspend doesn't measure thread
+// creation. Setup waits until all of them are attached to the runtime.
+static void StartMutators()
+{
+    s_fStopMutators = 0;
+    s_cMutatorsStarted = 0;
+    for (UInt32 i = 1; i < s_options.m_cThreads; i++)
+        s_mutators.push_back(std::thread(MutatorThread));
+
+    while (VolatileLoad(&s_cMutatorsStarted) != (Int32)s_mutators.size())
+        std::this_thread::yield();
+}
+
+static void StopMutators()
+{
+    VolatileStore(&s_fStopMutators, (Int32)1);
+    for (size_t i = 0; i < s_mutators.size(); i++)
+        s_mutators[i].join();
+    s_mutators.clear();
+}
+
+static UInt64 BenchGCSuspend(UInt64 count)
+{
+    for (UInt64 i = 0; i < count; i++)
+        RhpCollect(0, COLLECTION_BLOCKING);
+
+    return count;
+}
+
+static SpinLock s_lock;
+static SpinLock s_queuedLock(SpinLock::Queued);
+static UInt64 s_cLockAcquisitions;
+
+static void SpinLockThread(SpinLock * pLock, UInt64 count)
+{
+    for (UInt64 i = 0; i < count; i++)
+    {
+        SpinLock::Holder holder(*pLock);
+        s_cLockAcquisitions++;
+    }
+}
+
+static UInt64 BenchSpinLock(SpinLock * pLock, UInt64 count)
+{
+    std::vector<std::thread> threads;
+    for (UInt32 i = 1; i < s_options.m_cThreads; i++)
+        threads.push_back(std::thread(SpinLockThread, pLock, count));
+
+    SpinLockThread(pLock, count);
+
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    return count * s_options.m_cThreads;
+}
+
+static UInt64 BenchSpinLockTestAndTestAndSet(UInt64 count) { return BenchSpinLock(&s_lock, count); }
+static UInt64 BenchSpinLockQueued(UInt64 count) { return BenchSpinLock(&s_queuedLock, count); }
+
+struct Benchmark
+{
+    const char *    m_name;
+    UInt64       (* m_pfnRun)(UInt64 count);     // returns the number of operations done
+    UInt64          m_defaultCount;
+    bool            m_fCooperative;             // called in cooperative mode, like the helper from managed code
+    void         (* m_pfnSetup)();               // called once before the runs, in preemptive mode
+    void         (* m_pfnCleanup)();             // called once after the runs, in preemptive mode
+};
+
+static const Benchmark s_benchmarks[] =
+{
+    { "newfast",                BenchNewFast,                   10000000,   true,   NULL,               NULL },
+    { "newbatch",               BenchNewBatch,                  10000000,   true,   NULL,               NULL },
+    { "newarray",               BenchNewArray,                  10000000,   true,   NULL,               NULL },
+    { "newarray-refs",          BenchNewArrayRefs,              10000000,   true,   NULL,               NULL },
+    { "assignref",              BenchAssignRef,                 50000000,   true,   NULL,               NULL },
+    { "assignref-gen2",         BenchAssignRefGen2,             50000000,   true,   SetupAssignRefGen2, NULL },
+    { "checkedassignref",       BenchCheckedAssignRef,          50000000,   true,   NULL,               NULL },
+    { "checkedassignref-stack", BenchCheckedAssignRefStack,     50000000,   true,   NULL,               NULL },
+    { "dispatch-1",             BenchDispatch1,                 50000000,   true,   NULL,               NULL },
+    { "dispatch-4",             BenchDispatch4,                 50000000,   true,   NULL,               NULL },
+    { "dispatch-16",            BenchDispatch16,                50000000,   true,   NULL,               NULL },
+    { "handlealloc",            BenchHandleAlloc,               5000000,    true,   NULL,               NULL },
+    { "arraycopy",              BenchArrayCopyBytes,            5000000,    true,   NULL,               NULL },
+    { "arraycopy-refs",         BenchArrayCopyRefs,             2000000,    true,   NULL,               NULL },
+    { "arraycopy-refs-scalar",  BenchArrayCopyRefsScalar,       2000000,    true,   NULL,               NULL },
+    { "gcsafecopy",             BenchGCSafeCopy<false>,         5000000,    true,   NULL,               NULL },
+    { "gcsafecopy-scalar",      BenchGCSafeCopy<true>,          5000000,    true,   NULL,               NULL },
+    { "gcsafefill",             BenchGCSafeFill<false>,         5000000,    true,   NULL,               NULL },
+    { "gcsafefill-scalar",      BenchGCSafeFill<true>,          5000000,    true,   NULL,               NULL },
+    { "reversepinvoke",         BenchReversePInvoke,            20000000,   false,  NULL,               NULL },
+    { "gcsuspend",              BenchGCSuspend,                 2000,       false,  StartMutators,      StopMutators },
+    { "spinlock",               BenchSpinLockTestAndTestAndSet, 20000000,   false,  NULL,               NULL },
+    { "spinlock-queued",        BenchSpinLockQueued,            20000000,   false,  NULL,               NULL },
+};
+
+//
+// Hardware counters
+//
+
+enum
+{
+    COUNTER_CACHE_MISSES,       // last level cache
+    COUNTER_L1D_READ_MISSES,
+    COUNTER_COUNT
+};
+
+class PerfCounters
+{
+#ifdef __linux__
+    int m_fds[COUNTER_COUNT];
+
+    static int Open(UInt32 type, UInt64 config)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;           // count the threads started by the benchmark too
+        attr.exclude_kernel = 1;    // allowed with the default perf_event_paranoid setting
+        attr.exclude_hv = 1;
+        return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif // __linux__
+
+public:
+    PerfCounters()
+    {
+#ifdef __linux__
+        m_fds[COUNTER_CACHE_MISSES] = Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        m_fds[COUNTER_L1D_READ_MISSES] = Open(PERF_TYPE_HW_CACHE,
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+#endif // __linux__
+    }
+
+    ~PerfCounters()
+    {
+#ifdef __linux__
+        for (int i = 0; i < COUNTER_COUNT; i++)
+        {
+            if (m_fds[i] >= 0)
+                close(m_fds[i]);
+        }
+#endif // __linux__
+    }
+
+    bool IsAvailable(int counter)
+    {
+#ifdef __linux__
+        return m_fds[counter] >= 0;
+#else
+        return false;
+#endif
+    }
+
+    void Start()
+    {
+#ifdef __linux__
+        for (int i = 0; i < COUNTER_COUNT; i++)
+        {
+            if (m_fds[i] >= 0)
+            {
+                ioctl(m_fds[i], PERF_EVENT_IOC_RESET, 0);
+                ioctl(m_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif // __linux__
+    }
+
+    // Adds the counts since Start to pTotals
+    void Stop(UInt64 * pTotals)
+    {
+#ifdef __linux__
+        for (int i = 0; i < COUNTER_COUNT; i++)
+        {
+            if (m_fds[i] >= 0)
+            {
+                ioctl(m_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+                UInt64 value;
+                if (read(m_fds[i], &value, sizeof(value)) == sizeof(value))
+                    pTotals[i] += value;
+            }
+        }
+#endif // __linux__
+    }
+};
+
+//
+// Running and reporting
+//
+
+static UInt64 GetTimestamp()
+{
+    LARGE_INTEGER timestamp;
+    PalQueryPerformanceCounter(&timestamp);
+    return (UInt64)timestamp.QuadPart;
+}
+
+static UInt64 RunOnce(const Benchmark * pBenchmark, UInt64 count, UInt64 * pOps)
+{
+    ReversePInvokeFrame frame;
+    if (pBenchmark->m_fCooperative)
+        RhpReversePInvoke2(&frame);
+
+    UInt64 start = GetTimestamp();
+    *pOps = pBenchmark->m_pfnRun(count);
+    UInt64 end = GetTimestamp();
+
+    if (pBenchmark->m_fCooperative)
+        RhpReversePInvokeReturn(&frame);
+
+    return end - start;
+}
+
+static void PrintHeader()
+{
+    if (s_options.m_fCsv)
+    {
+        printf("benchmark,runtime,threads,count,runs,min_ns_per_op,median_ns_per_op,cache_misses_per_op,l1d_read_misses_per_op\n");
+    }
+    else
+    {
+        printf("%-24s %7s %10s %12s %12s %14s %14s\n",
+            "benchmark", "threads", "count", "min ns/op", "median ns/op", "cache miss/op", "L1D miss/op");
+    }
+}
+
+// Returns the fastest run, in nanoseconds per operation
+static double RunBenchmark(const Benchmark * pBenchmark, PerfCounters * pCounters)
+{
+    UInt64 count = (s_options.m_count != 0) ? s_options.m_count : pBenchmark->m_defaultCount;
+
+    if (pBenchmark->m_pfnSetup != NULL)
+        pBenchmark->m_pfnSetup();
+
+    UInt64 ops;
+    RunOnce(pBenchmark, (count + 9) / 10, &ops);
+
+    LARGE_INTEGER frequency;
+    PalQueryPerformanceFrequency(&frequency);
+
+    std::vector<double> nsPerOp;
+    UInt64 totalOps = 0;
+    UInt64 counters[COUNTER_COUNT] = { 0 };
+    for (UInt32 i = 0; i < s_options.m_cRuns; i++)
+    {
+        pCounters->Start();
+        UInt64 ticks = RunOnce(pBenchmark, count, &ops);
+        pCounters->Stop(counters);
+
+        nsPerOp.push_back((double)ticks * 1e9 / (double)frequency.QuadPart / (double)ops);
+        totalOps += ops;
+    }
+
+    if (pBenchmark->m_pfnCleanup != NULL)
+        pBenchmark->m_pfnCleanup();
+
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+    double minimum = nsPerOp[0];
+    double median = nsPerOp[nsPerOp.size() / 2];
+
+    char perOp[COUNTER_COUNT][32];
+    for (int i = 0; i < COUNTER_COUNT; i++)
+    {
+        if (pCounters->IsAvailable(i))
+            sprintf(perOp[i], "%.4f", (double)counters[i] / (double)totalOps);
+        else
+            strcpy(perOp[i], s_options.m_fCsv ? "" : "-");
+    }
+
+    if (s_options.m_fCsv)
+    {
+#ifdef USE_PORTABLE_HELPERS
+        const char * pszRuntime = "portable";
+#else
+        const char * pszRuntime = "full";
+#endif
+        printf("%s,%s,%u,%llu,%u,%.3f,%.3f,%s,%s\n",
+            pBenchmark->m_name, pszRuntime, s_options.m_cThreads, (unsigned long long)count, s_options.m_cRuns,
+            minimum, median, perOp[COUNTER_CACHE_MISSES], perOp[COUNTER_L1D_READ_MISSES]);
+    }
+    else
+    {
+        printf("%-24s %7u %10llu %12.2f %12.2f %14s %14s\n",
+            pBenchmark->m_name, s_options.m_cThreads, (unsigned long long)count,
+            minimum, median, perOp[COUNTER_CACHE_MISSES], perOp[COUNTER_L1D_READ_MISSES]);
+    }
+    fflush(stdout);
+
+    return minimum;
+}
+
+// Reports the fastest runs of each benchmark next to its -scalar variant, when both were run.
+static void PrintScalarComparison(const std::vector<const Benchmark *> & benchmarks, const std::vector<double> & minimums)
+{
+    static const char c_szScalarSuffix[] = "-scalar";
+    const size_t cchSuffix = sizeof(c_szScalarSuffix) - 1;
+
+    bool fHeader = false;
+    for (size_t i = 0; i < benchmarks.size(); i++)
+    {
+        const char * pszScalar = benchmarks[i]->m_name;
+        size_t cchScalar = strlen(pszScalar);
+        if ((cchScalar <= cchSuffix) || (strcmp(pszScalar + cchScalar - cchSuffix, c_szScalarSuffix) != 0))
+            continue;
+
+        for (size_t j = 0; j < benchmarks.size(); j++)
+        {
+            const char * pszName = benchmarks[j]->m_name;
+            if ((strlen(pszName) != cchScalar - cchSuffix) || (strncmp(pszName, pszScalar, cchScalar - cchSuffix) != 0))
+                continue;
+
+            if (!fHeader)
+            {
+                printf("\n%-24s %12s %12s %8s\n", "benchmark", "min ns/op", "scalar", "speedup");
+                fHeader = true;
+            }
+            printf("%-24s %12.2f %12.2f %7.2fx\n", pszName, minimums[j], minimums[i], minimums[i] / minimums[j]);
+            break;
+        }
+    }
+}
+
+static int Usage()
+{
+    fprintf(stderr, "usage: runtimebench [<benchmark>...] [-count <n>] [-runs <n>] [-threads <n>] [-csv]\n");
+    fprintf(stderr, "benchmarks:");
+    for (size_t i = 0; i < sizeof(s_benchmarks) / sizeof(s_benchmarks[0]); i++)
+        fprintf(stderr, " %s", s_benchmarks[i].m_name);
+    fprintf(stderr, "\n");
+    return 1;
+}
+
+int __cdecl main(int argc, char* argv[])
+{
+    s_options.m_count = 0;
+    s_options.m_cRuns = 5;
+    s_options.m_cThreads = 1;
+    s_options.m_fCsv = false;
+
+    std::vector<const Benchmark *> selected;
+    for (int i = 1; i < argc; i++)
+    {
+        if (argv[i][0] != '-')
+        {
+            const Benchmark * pBenchmark = NULL;
+            for (size_t j = 0; j < sizeof(s_benchmarks) / sizeof(s_benchmarks[0]); j++)
+            {
+                if (strcmp(argv[i], s_benchmarks[j].m_name) == 0)
+                    pBenchmark = &s_benchmarks[j];
+            }
+            if (pBenchmark == NULL)
+                return Usage();
+            selected.push_back(pBenchmark);
+            continue;
+        }
+
+        if (strcmp(argv[i], "-csv") == 0)
+        {
+            s_options.m_fCsv = true;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+            return Usage();
+
+        unsigned long long value = strtoull(argv[i + 1], NULL, 0);
+        if (strcmp(argv[i], "-count") == 0 && value > 0)
+            s_options.m_count = value;
+        else if (strcmp(argv[i], "-runs") == 0 && value > 0)
+            s_options.m_cRuns = (UInt32)value;
+        else if (strcmp(argv[i], "-threads") == 0 && value > 0)
+            s_options.m_cThreads = (UInt32)value;
+        else
+            return Usage();
+        i++;
+    }
+
+    if (selected.empty())
+    {
+        for (size_t i = 0; i < sizeof(s_benchmarks) / sizeof(s_benchmarks[0]); i++)
+            selected.push_back(&s_benchmarks[i]);
+    }
+
+    //
+    // Initialize the runtime the same way the bootstrapper does
+    //
+    if (!PalInit())
+        return -1;
+
+    if (!RtuDllMain(NULL, DLL_PROCESS_ATTACH, NULL))
+        return -1;
+
+    if (!RhpEnableConservativeStackReporting())
+        return -1;
+
+    InitializeTypes();
+
+    // Attach the main thread to the runtime, the benchmarks that call helpers in preemptive mode expect it to be.
+    ReversePInvokeFrame frame;
+    RhpReversePInvoke2(&frame);
+    RhpReversePInvokeReturn(&frame);
+
+    PerfCounters counters;
+
+    PrintHeader();
+    std::vector<double> minimums;
+    for (size_t i = 0; i < selected.size(); i++)
+        minimums.push_back(RunBenchmark(selected[i], &counters));
+
+    if (!s_options.m_fCsv)
+        PrintScalarComparison(selected, minimums);
+
+    return 0;
+}
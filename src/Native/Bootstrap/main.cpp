@@ -147,8 +147,18 @@ extern "C" BOOL WINAPI RtuDllMain(HANDLE hPalInstance, DWORD dwReason, void* pvR
 
 REDHAWK_PALIMPORT bool REDHAWK_PALAPI PalInit();
 
+// Points of the startup timeline recorded by the bootstrapper, keep in sync with STARTUP_TIMELINE_EVENT_ID in
+// src/Native/Runtime/CommonMacros.h.
+#define STARTUP_TIMELINE_PAL_INIT_BEGIN                 0
+#define STARTUP_TIMELINE_INITIALIZE_MODULES_BEGIN       6
+#define STARTUP_TIMELINE_INITIALIZE_MODULES_COMPLETE    8
+extern "C" void RhpRecordStartupTimelineEvent(uint32_t eventId);
+extern "C" void RhpCompleteStartupTimeline();
+
 int __initialize_runtime()
 {
+    RhpRecordStartupTimelineEvent(STARTUP_TIMELINE_PAL_INIT_BEGIN);
+
     if (!PalInit())
         return -1;
 
@@ -350,11 +360,18 @@ int main(int argc, char* argv[])
 #endif
 
     ReversePInvokeFrame frame; __reverse_pinvoke(&frame);
+    RhpRecordStartupTimelineEvent(STARTUP_TIMELINE_INITIALIZE_MODULES_BEGIN);
 #if defined (__APPLE__)
     InitializeModules(&__registeredModules[0], __registeredModules.size());
 #else
     InitializeModules(__modules_a, (int)((__modules_z - __modules_a))); 
 #endif
+    RhpRecordStartupTimelineEvent(STARTUP_TIMELINE_INITIALIZE_MODULES_COMPLETE);
+
+    // Completing the startup timeline may write its report to a file, leave cooperative mode around it.
+    __reverse_pinvoke_return(&frame);
+    RhpCompleteStartupTimeline();
+    __reverse_pinvoke(&frame);
 
     int retval;
     try
@@ -0,0 +1,195 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Sampling allocation profiler, see AllocationSampler.h.
+//
+
+#include "common.h"
+#include "gcenv.h"
+#include "gc.h"
+
+#include "gcrhinterface.h"
+
+#include "PalRedhawkCommon.h"
+#include "slist.h"
+#include "varint.h"
+#include "regdisplay.h"
+#include "StackFrameIterator.h"
+
+#include "thread.h"
+#include "RWLock.h"
+#include "threadstore.h"
+#include "RhConfig.h"
+#include "AllocationSampler.h"
+
+#ifndef DACCESS_COMPILE
+
+UIntNative AllocationSampler::s_cbMeanInterval = 0;
+
+void AllocationSampler::Initialize()
+{
+    s_cbMeanInterval = g_pRhConfig->GetAllocationSamplingInterval();
+}
+
+// Pick the number of bytes to allocate before the next sample, uniformly distributed between 1 and twice
+// the configured mean so that periodic allocation patterns can't hide from the sampler.
+UIntNative AllocationSampler::NextInterval(AllocSamplerThreadState * pState)
+{
+    // xorshift32
+    UInt32 x = pState->m_uRandom;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    pState->m_uRandom = x;
+
+    return 1 + (UIntNative)(((UInt64)x * (2 * (UInt64)s_cbMeanInterval)) >> 32);
+}
+
+bool AllocationSampler::OnSlowPathEnter(Thread * pThread, alloc_context * pAllocContext, UIntNative cbSize)
+{
+    AllocSamplerThreadState * pState = pThread->GetAllocSamplerState();
+    if (pState == NULL)
+    {
+        // Without any state this thread simply doesn't get sampled.
+        pState = new (nothrow) AllocSamplerThreadState();
+        if (pState == NULL)
+            return false;
+
+        pState->m_uRandom = ((UInt32)pThread->GetPalThreadIdForLogging() ^ PalGetTickCount()) | 1;
+        pState->m_cbUntilSample = NextInterval(pState);
+        pThread->SetAllocSamplerState(pState);
+    }
+
+    DisarmThread(pThread, pAllocContext);
+
+    if (cbSize >= pState->m_cbUntilSample)
+    {
+        pState->m_cbUntilSample = NextInterval(pState);
+        return true;
+    }
+
+    pState->m_cbUntilSample -= cbSize;
+    return false;
+}
+
+void AllocationSampler::OnSlowPathExit(Thread * pThread, alloc_context * pAllocContext, void * pObject, EEType * pEEType, UIntNative cbSize, bool fSample, void * pCallerIP)
+{
+    AllocSamplerThreadState * pState = pThread->GetAllocSamplerState();
+    if (pState == NULL)
+        return;
+
+    if (fSample && (pObject != NULL))
+        RecordSample(pThread, pState, pEEType, cbSize, pCallerIP);
+
+    // Arm the next sample point. If it lies within the current allocation context lower the limit to it so
+    // that the allocation crossing it comes back here, otherwise the bytes allocated from this context are
+    // accounted for when the thread next takes the slow path.
+    UInt8 * pAllocPtr = pAllocContext->alloc_ptr;
+    if (pAllocPtr == NULL)
+        return;
+
+    pState->m_pArmedAllocPtr = pAllocPtr;
+    if ((UIntNative)(pAllocContext->alloc_limit - pAllocPtr) > pState->m_cbUntilSample)
+    {
+        pState->m_pSavedAllocLimit = pAllocContext->alloc_limit;
+        pAllocContext->alloc_limit = pAllocPtr + pState->m_cbUntilSample;
+    }
+}
+
+void AllocationSampler::DisarmThread(Thread * pThread, alloc_context * pAllocContext)
+{
+    AllocSamplerThreadState * pState = pThread->GetAllocSamplerState();
+    if ((pState == NULL) || (pState->m_pArmedAllocPtr == NULL))
+        return;
+
+    UIntNative cbAllocated = (UIntNative)(pAllocContext->alloc_ptr - pState->m_pArmedAllocPtr);
+    pState->m_cbUntilSample -= min(cbAllocated, pState->m_cbUntilSample);
+    pState->m_pArmedAllocPtr = NULL;
+
+    if (pState->m_pSavedAllocLimit != NULL)
+    {
+        pAllocContext->alloc_limit = pState->m_pSavedAllocLimit;
+        pState->m_pSavedAllocLimit = NULL;
+    }
+}
+
+void AllocationSampler::ReleaseThread(Thread * pThread)
+{
+    AllocSamplerThreadState * pState = pThread->GetAllocSamplerState();
+    if (pState == NULL)
+        return;
+
+    DisarmThread(pThread, pThread->GetAllocContext());
+
+    // Any samples still in the ring are lost. We hold the thread store lock so nobody can be draining them.
+    pThread->SetAllocSamplerState(NULL);
+    delete pState;
+}
+
+void AllocationSampler::RecordSample(Thread * pThread, AllocSamplerThreadState * pState, EEType * pEEType, UIntNative cbSize, void * pCallerIP)
+{
+    UInt32 iWrite = pState->m_iWrite;
+    if (iWrite - VolatileLoad(&pState->m_iRead) >= ALLOC_SAMPLE_RING_SIZE)
+        return;
+
+    AllocationSample * pSample = &pState->m_rgSamples[iWrite & (ALLOC_SAMPLE_RING_SIZE - 1)];
+    pSample->m_pEEType = pEEType;
+    pSample->m_cbSize = cbSize;
+    pSample->m_uThreadId = pThread->GetPalThreadIdForLogging();
+
+    // The assembly allocation helpers record their transition frame before calling into the allocator (a GC
+    // triggered from the slow path walks the stack from the same frame), so this starts at the allocating
+    // method. The C++ ones don't have a frame to start from (m_pHackPInvokeTunnel is left over from some
+    // earlier transition) and pass their return address instead, so their samples carry just the callsite.
+    UInt32 cFrames = 0;
+    if (pCallerIP != NULL)
+    {
+        pSample->m_rgpFrames[cFrames++] = pCallerIP;
+    }
+    else
+    {
+        StackFrameIterator frameIterator(pThread, pThread->GetTransitionFrameForStackTrace());
+        while (frameIterator.IsValid() && (cFrames < ALLOC_SAMPLE_MAX_FRAMES))
+        {
+            pSample->m_rgpFrames[cFrames++] = (void *)frameIterator.GetRegisterSet()->GetIP();
+            frameIterator.Next();
+        }
+    }
+    pSample->m_cFrames = cFrames;
+
+    // Publish the sample to readers.
+    VolatileStore(&pState->m_iWrite, iWrite + 1);
+}
+
+// Copy up to cMaxSamples allocation samples taken by all threads into pBuffer, removing them from the
+// per-thread rings, and return how many were copied.
+EXTERN_C REDHAWK_API UInt32 __cdecl RhpGetAllocationSamples(AllocationSample * pBuffer, UInt32 cMaxSamples)
+{
+    // This must be called via p/invoke rather than RuntimeImport since it takes the thread store lock.
+
+    UInt32 cSamples = 0;
+
+    FOREACH_THREAD(pThread)
+    {
+        AllocSamplerThreadState * pState = pThread->GetAllocSamplerState();
+        while ((pState != NULL) && (cSamples < cMaxSamples))
+        {
+            UInt32 iRead = VolatileLoad(&pState->m_iRead);
+            if (iRead == VolatileLoad(&pState->m_iWrite))
+                break;
+
+            // The owning thread won't reuse the entry until m_iRead moves past it, but other callers may be
+            // draining the same ring, so only the one which manages to advance m_iRead gets to keep it.
+            pBuffer[cSamples] = pState->m_rgSamples[iRead & (ALLOC_SAMPLE_RING_SIZE - 1)];
+            if (PalInterlockedCompareExchange((Int32 volatile *)&pState->m_iRead, (Int32)(iRead + 1), (Int32)iRead) == (Int32)iRead)
+                cSamples++;
+        }
+    }
+    END_FOREACH_THREAD
+
+    return cSamples;
+}
+
+#endif // !DACCESS_COMPILE
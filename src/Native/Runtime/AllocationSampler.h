@@ -0,0 +1,88 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// A low overhead sampling allocation profiler.
+//
+// Each thread picks a random number of bytes to allocate before its next sample and lowers the limit of its
+// allocation context so that the allocation which crosses that point takes the allocation slow path. There
+// the type, size and the return addresses of the managed stack are recorded into a per-thread ring of samples
+// which can be drained from any thread with RhpGetAllocationSamples. Allocations which don't cross a sample point
+// never see any of this.
+//
+// Only the assembly allocation helpers (Windows builds without USE_PORTABLE_HELPERS) set up a transition frame
+// to walk the stack from. The C++ helpers in portable.cpp, which all Unix builds use, record just the return
+// address into the allocating method.
+//
+// Sampling is enabled by setting the AllocationSamplingInterval config value to the mean number of bytes
+// between samples.
+//
+
+#ifndef __AllocationSampler_h__
+#define __AllocationSampler_h__
+
+// Maximum number of return addresses recorded with each sample.
+#define ALLOC_SAMPLE_MAX_FRAMES 16
+
+// Number of samples each thread can buffer before new samples are dropped. Must be a power of 2.
+#define ALLOC_SAMPLE_RING_SIZE  32
+
+// A single allocation sample as returned by RhpGetAllocationSamples.
+struct AllocationSample
+{
+    EEType *    m_pEEType;                              // Type of the sampled object
+    UIntNative  m_cbSize;                               // Size of the sampled object in bytes
+    UInt64      m_uThreadId;                            // OS thread id of the allocating thread
+    UInt32      m_cFrames;                              // Number of valid entries in m_rgpFrames
+    void *      m_rgpFrames[ALLOC_SAMPLE_MAX_FRAMES];   // Managed return addresses, innermost first
+};
+
+// Sampling state of a single thread, allocated the first time the thread takes the allocation slow path.
+struct AllocSamplerThreadState
+{
+    UInt8 *             m_pArmedAllocPtr;       // alloc_ptr when the sample point was armed, NULL if not armed
+    UInt8 *             m_pSavedAllocLimit;     // Real alloc_limit while it's lowered to the sample point
+    UIntNative          m_cbUntilSample;        // Bytes left to allocate (as of m_pArmedAllocPtr) until the next sample
+    UInt32              m_uRandom;              // State of the interval random number generator
+
+    // Ring of samples, written only by the owning thread and drained by any thread. Samples taken while the
+    // ring is full are dropped.
+    UInt32              m_iWrite;
+    UInt32              m_iRead;
+    AllocationSample    m_rgSamples[ALLOC_SAMPLE_RING_SIZE];
+};
+
+class AllocationSampler
+{
+public:
+    static void Initialize();
+
+    static bool IsEnabled()
+    {
+        return s_cbMeanInterval != 0;
+    }
+
+    // Called on entry to the allocation slow path. Puts the allocation context back into its real state and
+    // returns whether the allocation about to be made should be sampled.
+    static bool OnSlowPathEnter(Thread * pThread, alloc_context * pAllocContext, UIntNative cbSize);
+
+    // Called once the slow path has allocated pObject (which may be NULL on failure). Records a sample if
+    // requested and arms the next sample point. pCallerIP is the return address of an allocation helper that
+    // didn't set up a transition frame, which is then recorded in place of the stack.
+    static void OnSlowPathExit(Thread * pThread, alloc_context * pAllocContext, void * pObject, EEType * pEEType, UIntNative cbSize, bool fSample, void * pCallerIP);
+
+    // Restore the real limit of the thread's allocation context before the GC looks at it.
+    static void DisarmThread(Thread * pThread, alloc_context * pAllocContext);
+
+    // Called when the thread is destroyed (with the thread store lock held).
+    static void ReleaseThread(Thread * pThread);
+
+private:
+    static UIntNative NextInterval(AllocSamplerThreadState * pState);
+    static void RecordSample(Thread * pThread, AllocSamplerThreadState * pState, EEType * pEEType, UIntNative cbSize, void * pCallerIP);
+
+    static UIntNative s_cbMeanInterval;
+};
+
+#endif // __AllocationSampler_h__
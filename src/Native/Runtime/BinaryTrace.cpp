@@ -0,0 +1,300 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Portable in-process event tracing, see BinaryTrace.h.
+//
+
+#include "common.h"
+#include "CommonTypes.h"
+#include "CommonMacros.h"
+#include "daccess.h"
+#include "PalRedhawkCommon.h"
+#include "PalRedhawk.h"
+#include "CommonMacros.inl"
+#include "rhassert.h"
+#include "holder.h"
+#include "Crst.h"
+#include "Volatile.h"
+#include "RhConfig.h"
+#include "BinaryTrace.h"
+
+#if !defined(DACCESS_COMPILE) && defined(FEATURE_BINARY_TRACE)
+
+// A single thread's ring of records. Only the owning thread advances m_iWrite and only the writer thread
+// (holding s_BinaryTraceLock) advances m_iRead, both are byte counts that are allowed to wrap around.
+struct BinaryTraceBuffer
+{
+    BinaryTraceBuffer * m_pNext;            // Next buffer in the list of all buffers
+    UInt32              m_fInUse;           // Whether a live thread owns this buffer
+    UInt32              m_iWrite;
+    UInt32              m_iRead;
+    UInt32              m_cLostEvents;      // Events dropped since the last LostEvents record
+    UInt8               m_rgbData[BINARY_TRACE_BUFFER_SIZE];
+};
+
+volatile UInt32 BinaryTrace::s_enabledKeywords = 0;
+volatile UInt32 BinaryTrace::s_level = 0;
+
+// All buffers ever created. Buffers are never freed, a buffer released by an exiting thread is picked up by
+// the next thread which needs one.
+static BinaryTraceBuffer * volatile s_pBinaryTraceBuffers = NULL;
+
+DECLSPEC_THREAD
+static BinaryTraceBuffer * t_pBinaryTraceBuffer = NULL;
+
+// Protects the session state below and serializes draining the buffers.
+static CrstStatic s_BinaryTraceLock;
+static HANDLE s_hBinaryTraceFile = NULL;
+static bool s_fBinaryTraceWriterStarted = false;
+
+static BinaryTraceBuffer * AcquireBinaryTraceBuffer()
+{
+    for (BinaryTraceBuffer * pBuffer = s_pBinaryTraceBuffers; pBuffer != NULL; pBuffer = pBuffer->m_pNext)
+    {
+        if ((VolatileLoad(&pBuffer->m_fInUse) == 0) &&
+            (PalInterlockedCompareExchange((Int32 volatile *)&pBuffer->m_fInUse, 1, 0) == 0))
+        {
+            return pBuffer;
+        }
+    }
+
+    BinaryTraceBuffer * pBuffer = new (nothrow) BinaryTraceBuffer();
+    if (pBuffer == NULL)
+        return NULL;
+
+    pBuffer->m_fInUse = 1;
+    pBuffer->m_iWrite = 0;
+    pBuffer->m_iRead = 0;
+    pBuffer->m_cLostEvents = 0;
+
+    BinaryTraceBuffer * pHead;
+    do
+    {
+        pHead = s_pBinaryTraceBuffers;
+        pBuffer->m_pNext = pHead;
+    }
+    while (PalInterlockedCompareExchangePointer((void * volatile *)&s_pBinaryTraceBuffers, pBuffer, pHead) != pHead);
+
+    return pBuffer;
+}
+
+// Append a record to the buffer, returns false if there's no room for it.
+static bool TryWriteBinaryTraceRecord(BinaryTraceBuffer * pBuffer, BinaryTraceEventId eventId, const void * pvPayload, UInt32 cbPayload)
+{
+    UInt32 cbRecord = (UInt32)ALIGN_UP(sizeof(BinaryTraceRecordHeader) + cbPayload, BINARY_TRACE_RECORD_ALIGNMENT);
+
+    UInt32 iWrite = pBuffer->m_iWrite;
+    UInt32 iRead = VolatileLoad(&pBuffer->m_iRead);
+
+    // Records never wrap around the end of the ring, what's left at the end is filled with a padding record
+    // instead. Since every record is aligned there's always room for at least the padding record's header.
+    UInt32 offset = iWrite & (BINARY_TRACE_BUFFER_SIZE - 1);
+    UInt32 cbPadding = ((BINARY_TRACE_BUFFER_SIZE - offset) < cbRecord) ? (BINARY_TRACE_BUFFER_SIZE - offset) : 0;
+
+    if ((iWrite - iRead) + cbPadding + cbRecord > BINARY_TRACE_BUFFER_SIZE)
+        return false;
+
+    LARGE_INTEGER timestamp;
+    PalQueryPerformanceCounter(&timestamp);
+    UInt32 threadId = (UInt32)PalGetCurrentThreadIdForLogging();
+
+    if (cbPadding != 0)
+    {
+        BinaryTraceRecordHeader * pPadding = (BinaryTraceRecordHeader *)&pBuffer->m_rgbData[offset];
+        pPadding->m_eventId = BinaryTraceEvent_Padding;
+        pPadding->m_cbPayload = (UInt16)(cbPadding - sizeof(BinaryTraceRecordHeader));
+        pPadding->m_threadId = threadId;
+        pPadding->m_timestamp = timestamp.QuadPart;
+        offset = 0;
+    }
+
+    BinaryTraceRecordHeader * pHeader = (BinaryTraceRecordHeader *)&pBuffer->m_rgbData[offset];
+    pHeader->m_eventId = (UInt16)eventId;
+    pHeader->m_cbPayload = (UInt16)cbPayload;
+    pHeader->m_threadId = threadId;
+    pHeader->m_timestamp = timestamp.QuadPart;
+    memcpy(pHeader + 1, pvPayload, cbPayload);
+
+    // Publish the record to the writer thread.
+    VolatileStore(&pBuffer->m_iWrite, iWrite + cbPadding + cbRecord);
+    return true;
+}
+
+void BinaryTrace::WriteEvent(BinaryTraceEventId eventId, const void * pvPayload, UInt32 cbPayload)
+{
+    ASSERT(cbPayload <= BINARY_TRACE_BUFFER_SIZE / 16);
+
+    BinaryTraceBuffer * pBuffer = t_pBinaryTraceBuffer;
+    if (pBuffer == NULL)
+    {
+        pBuffer = AcquireBinaryTraceBuffer();
+        if (pBuffer == NULL)
+            return;
+        t_pBinaryTraceBuffer = pBuffer;
+    }
+
+    if (pBuffer->m_cLostEvents != 0)
+    {
+        if (!TryWriteBinaryTraceRecord(pBuffer, BinaryTraceEvent_LostEvents, &pBuffer->m_cLostEvents, sizeof(UInt32)))
+        {
+            pBuffer->m_cLostEvents++;
+            return;
+        }
+        pBuffer->m_cLostEvents = 0;
+    }
+
+    if (!TryWriteBinaryTraceRecord(pBuffer, eventId, pvPayload, cbPayload))
+        pBuffer->m_cLostEvents++;
+}
+
+void BinaryTrace::ReleaseCurrentThreadBuffer()
+{
+    BinaryTraceBuffer * pBuffer = t_pBinaryTraceBuffer;
+    if (pBuffer == NULL)
+        return;
+
+    t_pBinaryTraceBuffer = NULL;
+    VolatileStore(&pBuffer->m_fInUse, (UInt32)0);
+}
+
+// Write everything buffered so far to the trace file. Called with s_BinaryTraceLock held.
+void BinaryTrace::DrainBuffers()
+{
+    for (BinaryTraceBuffer * pBuffer = s_pBinaryTraceBuffers; pBuffer != NULL; pBuffer = pBuffer->m_pNext)
+    {
+        UInt32 iWrite = VolatileLoad(&pBuffer->m_iWrite);
+        UInt32 iRead = pBuffer->m_iRead;
+
+        while (iRead != iWrite)
+        {
+            UInt32 offset = iRead & (BINARY_TRACE_BUFFER_SIZE - 1);
+            UInt32 cbChunk = min(iWrite - iRead, BINARY_TRACE_BUFFER_SIZE - offset);
+            PalWriteOutputFile(s_hBinaryTraceFile, &pBuffer->m_rgbData[offset], cbChunk);
+            iRead += cbChunk;
+        }
+
+        // Let the owning thread reuse the space.
+        VolatileStore(&pBuffer->m_iRead, iRead);
+    }
+}
+
+UInt32 __stdcall BinaryTrace::WriterThreadStart(void * pContext)
+{
+    UNREFERENCED_PARAMETER(pContext);
+
+    for (;;)
+    {
+        PalSleep(BINARY_TRACE_FLUSH_INTERVAL_MS);
+
+        s_BinaryTraceLock.Enter();
+        if (s_hBinaryTraceFile != NULL)
+            DrainBuffers();
+        s_BinaryTraceLock.Leave();
+    }
+}
+
+void BinaryTrace::Initialize()
+{
+    s_BinaryTraceLock.Init(CrstBinaryTrace);
+
+    UInt32 keywords = g_pRhConfig->GetBinaryTraceKeywords();
+    if (keywords == 0)
+        return;
+
+    UInt32 level = g_pRhConfig->GetBinaryTraceLevel();
+    if (level == 0)
+        level = BINARY_TRACE_LEVEL_INFORMATIONAL;
+
+    char szFileName[PAL_MAX_OUTPUT_FILE_NAME];
+    if (!PalGetOutputFileName("rhtrace", ".bin", szFileName, sizeof(szFileName)))
+        return;
+
+    StartSession(szFileName, keywords, level);
+}
+
+bool BinaryTrace::StartSession(const char * pszFileName, UInt32 keywords, UInt32 level)
+{
+    bool fStarted = false;
+
+    s_BinaryTraceLock.Enter();
+
+    if (s_hBinaryTraceFile == NULL)
+    {
+        if (!s_fBinaryTraceWriterStarted)
+            s_fBinaryTraceWriterStarted = PalStartDiagnosticsThread(WriterThreadStart, NULL);
+
+        HANDLE hFile = s_fBinaryTraceWriterStarted ? PalCreateOutputFile(pszFileName) : INVALID_HANDLE_VALUE;
+        if (hFile != INVALID_HANDLE_VALUE)
+        {
+            LARGE_INTEGER frequency;
+            LARGE_INTEGER timestamp;
+            PalQueryPerformanceFrequency(&frequency);
+            PalQueryPerformanceCounter(&timestamp);
+
+            BinaryTraceFileHeader header;
+            header.m_magic = BINARY_TRACE_MAGIC;
+            header.m_version = BINARY_TRACE_VERSION;
+            header.m_cbPointer = sizeof(void *);
+            header.m_timestampFrequency = frequency.QuadPart;
+            header.m_startTimestamp = timestamp.QuadPart;
+            header.m_processId = PalGetCurrentProcessId();
+            header.m_reserved = 0;
+
+            if (PalWriteOutputFile(hFile, &header, sizeof(header)))
+            {
+                // Whatever is left in the rings from a previous session doesn't belong in this one.
+                for (BinaryTraceBuffer * pBuffer = s_pBinaryTraceBuffers; pBuffer != NULL; pBuffer = pBuffer->m_pNext)
+                    VolatileStore(&pBuffer->m_iRead, VolatileLoad(&pBuffer->m_iWrite));
+
+                s_hBinaryTraceFile = hFile;
+                s_level = level;
+                s_enabledKeywords = keywords;
+                fStarted = true;
+            }
+            else
+            {
+                PalCloseHandle(hFile);
+            }
+        }
+    }
+
+    s_BinaryTraceLock.Leave();
+
+    return fStarted;
+}
+
+void BinaryTrace::StopSession()
+{
+    s_BinaryTraceLock.Enter();
+
+    if (s_hBinaryTraceFile != NULL)
+    {
+        s_enabledKeywords = 0;
+
+        // Threads which saw the session enabled just before this may still add a last event or two, those
+        // are discarded when the next session starts.
+        DrainBuffers();
+
+        PalCloseHandle(s_hBinaryTraceFile);
+        s_hBinaryTraceFile = NULL;
+    }
+
+    s_BinaryTraceLock.Leave();
+}
+
+// Start writing events matching the given keywords (BINARY_TRACE_KEYWORD_*) and level to the given file.
+// Returns false if a session is already active or the file couldn't be created.
+EXTERN_C REDHAWK_API UInt32_BOOL __cdecl RhpStartBinaryTrace(const char * pszFileName, UInt32 keywords, UInt32 level)
+{
+    return BinaryTrace::StartSession(pszFileName, keywords, level) ? UInt32_TRUE : UInt32_FALSE;
+}
+
+// Stop the current session, if any, making sure all events written so far are in the file.
+EXTERN_C REDHAWK_API void __cdecl RhpStopBinaryTrace()
+{
+    BinaryTrace::StopSession();
+}
+
+#endif // !DACCESS_COMPILE && FEATURE_BINARY_TRACE
@@ -0,0 +1,116 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// A portable, in-process event tracing backend for platforms without ETW.
+//
+// Events are written by the thread raising them into a per-thread ring buffer without taking any locks. A
+// writer thread periodically drains all rings into the trace file of the current session. Events raised while
+// a ring is full are dropped and the number of dropped events is recorded in the ring as soon as there's room
+// again. A session is started with RhpStartBinaryTrace (or at startup when the BinaryTraceKeywords config value
+// is set, in which case the trace is written to /tmp/rhtrace-<pid>.bin) and stopped with RhpStopBinaryTrace.
+//
+// File format (all values little endian):
+//
+//   BinaryTraceFileHeader
+//   a sequence of records, each made of
+//     BinaryTraceRecordHeader
+//     m_cbPayload bytes of event specific payload (see BinaryTraceEvents.h)
+//     padding up to the next multiple of BINARY_TRACE_RECORD_ALIGNMENT bytes
+//
+// Records from different threads are interleaved in the order the rings were drained, consumers have to sort
+// them by timestamp. Records with the BinaryTraceEvent_Padding id carry no information and are to be skipped.
+// src/Native/Runtime/tools/rhtrace.py decodes trace files.
+//
+
+#ifndef __BinaryTrace_h__
+#define __BinaryTrace_h__
+
+#define BINARY_TRACE_MAGIC              0x45434152544852ull     // "RHTRACE"
+#define BINARY_TRACE_VERSION            1
+
+#define BINARY_TRACE_RECORD_ALIGNMENT   16
+
+// Size of each per-thread ring, must be a power of 2.
+#define BINARY_TRACE_BUFFER_SIZE        (64 * 1024)
+
+// Interval at which the writer thread drains the rings.
+#define BINARY_TRACE_FLUSH_INTERVAL_MS  100
+
+// Keywords select groups of events.
+#define BINARY_TRACE_KEYWORD_GC         0x1     // GC start/end, triggers, suspension and allocation ticks
+#define BINARY_TRACE_KEYWORD_GC_HEAP    0x2     // Segment creation/deletion and per GC heap history
+
+// Levels, as with ETW an event is written if its level is no higher than the level of the session.
+#define BINARY_TRACE_LEVEL_CRITICAL     1
+#define BINARY_TRACE_LEVEL_ERROR        2
+#define BINARY_TRACE_LEVEL_WARNING      3
+#define BINARY_TRACE_LEVEL_INFORMATIONAL 4
+#define BINARY_TRACE_LEVEL_VERBOSE      5
+
+enum BinaryTraceEventId
+{
+    BinaryTraceEvent_Padding            = 0,    // fills the end of a ring, no payload
+    BinaryTraceEvent_LostEvents         = 1,    // UInt32 number of events dropped by this thread
+
+    BinaryTraceEvent_GCStart            = 10,
+    BinaryTraceEvent_GCEnd              = 11,
+    BinaryTraceEvent_GCTriggered        = 12,
+    BinaryTraceEvent_GCSuspendEEBegin   = 13,
+    BinaryTraceEvent_GCSuspendEEEnd     = 14,
+    BinaryTraceEvent_GCRestartEEBegin   = 15,
+    BinaryTraceEvent_GCRestartEEEnd     = 16,
+    BinaryTraceEvent_GCAllocationTick   = 17,
+    BinaryTraceEvent_GCCreateSegment    = 18,
+    BinaryTraceEvent_GCFreeSegment      = 19,
+    BinaryTraceEvent_GCGlobalHeapHistory = 20,
+    BinaryTraceEvent_GCPerHeapHistory   = 21,
+};
+
+struct BinaryTraceFileHeader
+{
+    UInt64      m_magic;                // BINARY_TRACE_MAGIC
+    UInt32      m_version;              // BINARY_TRACE_VERSION
+    UInt32      m_cbPointer;            // size of a pointer (and of size_t) in the traced process
+    UInt64      m_timestampFrequency;   // timestamp ticks per second
+    UInt64      m_startTimestamp;       // timestamp of the start of the session
+    UInt32      m_processId;
+    UInt32      m_reserved;
+};
+
+struct BinaryTraceRecordHeader
+{
+    UInt16      m_eventId;              // BinaryTraceEventId
+    UInt16      m_cbPayload;            // payload size, excluding the header and padding
+    UInt32      m_threadId;             // OS id of the thread that raised the event
+    UInt64      m_timestamp;            // performance counter value when the event was raised
+};
+
+class BinaryTrace
+{
+public:
+    static void Initialize();
+
+    static bool IsEnabled(UInt32 keyword, UInt32 level)
+    {
+        return ((s_enabledKeywords & keyword) != 0) && (level <= s_level);
+    }
+
+    static void WriteEvent(BinaryTraceEventId eventId, const void * pvPayload, UInt32 cbPayload);
+
+    // Called on a thread that's about to go away so that its ring can be reused by another thread.
+    static void ReleaseCurrentThreadBuffer();
+
+    static bool StartSession(const char * pszFileName, UInt32 keywords, UInt32 level);
+    static void StopSession();
+
+private:
+    static UInt32 __stdcall WriterThreadStart(void * pContext);
+    static void DrainBuffers();
+
+    static volatile UInt32 s_enabledKeywords;
+    static volatile UInt32 s_level;
+};
+
+#endif // __BinaryTrace_h__
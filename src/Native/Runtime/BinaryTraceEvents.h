@@ -0,0 +1,244 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Payloads of the events written to binary traces (see BinaryTrace.h) and the FireEtw* macros routing the
+// GC's events to them on platforms without ETW. Included after etmdummy.h, whose definitions for these events
+// are replaced here. Arguments only meaningful to ETW (instance ids, ETW specific enums) are dropped.
+//
+// Payload layouts are part of the trace file format, keep tools/rhtrace.py in sync when changing them.
+//
+
+#ifndef __BinaryTraceEvents_h__
+#define __BinaryTraceEvents_h__
+
+#include "BinaryTrace.h"
+
+struct BinaryTraceGCStartPayload
+{
+    UInt32      m_count;
+    UInt32      m_depth;
+};
+
+struct BinaryTraceGCEndPayload
+{
+    UInt32      m_count;
+    UInt32      m_depth;
+};
+
+struct BinaryTraceGCTriggeredPayload
+{
+    UInt32      m_reason;
+};
+
+struct BinaryTraceGCSuspendEEBeginPayload
+{
+    UInt32      m_reason;
+    UInt32      m_count;
+};
+
+struct BinaryTraceGCAllocationTickPayload
+{
+    UInt32      m_amount;
+};
+
+struct BinaryTraceGCSegmentPayload
+{
+    UInt64      m_address;
+    UInt64      m_size;                 // 0 for GCFreeSegment
+};
+
+struct BinaryTraceGCGlobalHeapHistoryPayload
+{
+    UInt64      m_finalYoungestDesired;
+    UInt32      m_numHeaps;
+    UInt32      m_condemnedGeneration;
+    UInt32      m_gen0ReductionCount;
+    UInt32      m_reason;
+    UInt32      m_globalMechanisms;
+    UInt32      m_pauseMode;
+    UInt32      m_memoryPressure;
+    UInt32      m_reserved;
+};
+
+// Followed by m_cGenerations records of m_cbGenerationData bytes each (the GC's gc_generation_data, made of
+// pointer sized fields).
+struct BinaryTraceGCPerHeapHistoryPayload
+{
+    UInt64      m_freeListAllocated;
+    UInt64      m_freeListRejected;
+    UInt64      m_endOfSegAllocated;
+    UInt64      m_condemnedAllocated;
+    UInt64      m_pinnedAllocated;
+    UInt64      m_pinnedAllocatedAdvance;
+    UInt64      m_extraGen0Commit;
+    UInt32      m_runningFreeListEfficiency;
+    UInt32      m_condemnReasons0;
+    UInt32      m_condemnReasons1;
+    UInt32      m_compactMechanisms;
+    UInt32      m_expandMechanisms;
+    UInt32      m_heapIndex;
+    UInt32      m_cGenerations;
+    UInt32      m_cbGenerationData;
+};
+
+#define BINARY_TRACE_MAX_GENERATION_DATA 256
+
+inline UInt32 BinaryTraceGCStart(UInt32 count, UInt32 depth)
+{
+    BinaryTraceGCStartPayload payload = { count, depth };
+    BinaryTrace::WriteEvent(BinaryTraceEvent_GCStart, &payload, sizeof(payload));
+    return 0;
+}
+
+inline UInt32 BinaryTraceGCEnd(UInt32 count, UInt32 depth)
+{
+    BinaryTraceGCEndPayload payload = { count, depth };
+    BinaryTrace::WriteEvent(BinaryTraceEvent_GCEnd, &payload, sizeof(payload));
+    return 0;
+}
+
+inline UInt32 BinaryTraceGCTriggered(UInt32 reason)
+{
+    BinaryTraceGCTriggeredPayload payload = { reason };
+    BinaryTrace::WriteEvent(BinaryTraceEvent_GCTriggered, &payload, sizeof(payload));
+    return 0;
+}
+
+inline UInt32 BinaryTraceGCSuspendEEBegin(UInt32 reason, UInt32 count)
+{
+    BinaryTraceGCSuspendEEBeginPayload payload = { reason, count };
+    BinaryTrace::WriteEvent(BinaryTraceEvent_GCSuspendEEBegin, &payload, sizeof(payload));
+    return 0;
+}
+
+inline UInt32 BinaryTraceNoPayload(BinaryTraceEventId eventId)
+{
+    BinaryTrace::WriteEvent(eventId, NULL, 0);
+    return 0;
+}
+
+inline UInt32 BinaryTraceGCAllocationTick(UInt32 amount)
+{
+    BinaryTraceGCAllocationTickPayload payload = { amount };
+    BinaryTrace::WriteEvent(BinaryTraceEvent_GCAllocationTick, &payload, sizeof(payload));
+    return 0;
+}
+
+inline UInt32 BinaryTraceGCSegment(BinaryTraceEventId eventId, UInt64 address, UInt64 size)
+{
+    BinaryTraceGCSegmentPayload payload = { address, size };
+    BinaryTrace::WriteEvent(eventId, &payload, sizeof(payload));
+    return 0;
+}
+
+inline UInt32 BinaryTraceGCGlobalHeapHistory(UInt64 finalYoungestDesired, UInt32 numHeaps, UInt32 condemnedGeneration,
+                                             UInt32 gen0ReductionCount, UInt32 reason, UInt32 globalMechanisms,
+                                             UInt32 pauseMode, UInt32 memoryPressure)
+{
+    BinaryTraceGCGlobalHeapHistoryPayload payload;
+    payload.m_finalYoungestDesired = finalYoungestDesired;
+    payload.m_numHeaps = numHeaps;
+    payload.m_condemnedGeneration = condemnedGeneration;
+    payload.m_gen0ReductionCount = gen0ReductionCount;
+    payload.m_reason = reason;
+    payload.m_globalMechanisms = globalMechanisms;
+    payload.m_pauseMode = pauseMode;
+    payload.m_memoryPressure = memoryPressure;
+    payload.m_reserved = 0;
+    BinaryTrace::WriteEvent(BinaryTraceEvent_GCGlobalHeapHistory, &payload, sizeof(payload));
+    return 0;
+}
+
+inline UInt32 BinaryTraceGCPerHeapHistory(UInt64 freeListAllocated, UInt64 freeListRejected, UInt64 endOfSegAllocated,
+                                          UInt64 condemnedAllocated, UInt64 pinnedAllocated, UInt64 pinnedAllocatedAdvance,
+                                          UInt32 runningFreeListEfficiency, UInt32 condemnReasons0, UInt32 condemnReasons1,
+                                          UInt32 compactMechanisms, UInt32 expandMechanisms, UInt32 heapIndex,
+                                          UInt64 extraGen0Commit, UInt32 cGenerations, UInt32 cbGenerationData,
+                                          const void * pvGenerationData)
+{
+    UInt8 rgbPayload[sizeof(BinaryTraceGCPerHeapHistoryPayload) + BINARY_TRACE_MAX_GENERATION_DATA * sizeof(UInt64)];
+    BinaryTraceGCPerHeapHistoryPayload * pPayload = (BinaryTraceGCPerHeapHistoryPayload *)rgbPayload;
+
+    // Drop the generation data rather than overflow the payload if the GC's history ever grows this big.
+    UInt32 cbData = cGenerations * cbGenerationData;
+    if (cbData > BINARY_TRACE_MAX_GENERATION_DATA * sizeof(UInt64))
+    {
+        cGenerations = 0;
+        cbData = 0;
+    }
+
+    pPayload->m_freeListAllocated = freeListAllocated;
+    pPayload->m_freeListRejected = freeListRejected;
+    pPayload->m_endOfSegAllocated = endOfSegAllocated;
+    pPayload->m_condemnedAllocated = condemnedAllocated;
+    pPayload->m_pinnedAllocated = pinnedAllocated;
+    pPayload->m_pinnedAllocatedAdvance = pinnedAllocatedAdvance;
+    pPayload->m_extraGen0Commit = extraGen0Commit;
+    pPayload->m_runningFreeListEfficiency = runningFreeListEfficiency;
+    pPayload->m_condemnReasons0 = condemnReasons0;
+    pPayload->m_condemnReasons1 = condemnReasons1;
+    pPayload->m_compactMechanisms = compactMechanisms;
+    pPayload->m_expandMechanisms = expandMechanisms;
+    pPayload->m_heapIndex = heapIndex;
+    pPayload->m_cGenerations = cGenerations;
+    pPayload->m_cbGenerationData = cbGenerationData;
+    memcpy(pPayload + 1, pvGenerationData, cbData);
+
+    BinaryTrace::WriteEvent(BinaryTraceEvent_GCPerHeapHistory, rgbPayload, sizeof(BinaryTraceGCPerHeapHistoryPayload) + cbData);
+    return 0;
+}
+
+#define BINARY_TRACE_GC_EVENT_ENABLED(keyword, level) BinaryTrace::IsEnabled(BINARY_TRACE_KEYWORD_##keyword, BINARY_TRACE_LEVEL_##level)
+
+#undef FireEtwGCTriggered
+#define FireEtwGCTriggered(Reason, ClrInstanceID) \
+    (BINARY_TRACE_GC_EVENT_ENABLED(GC, INFORMATIONAL) ? BinaryTraceGCTriggered((UInt32)(Reason)) : 0)
+
+#undef FireEtwGCSuspendEEBegin_V1
+#define FireEtwGCSuspendEEBegin_V1(Reason, Count, ClrInstanceID) \
+    (BINARY_TRACE_GC_EVENT_ENABLED(GC, INFORMATIONAL) ? BinaryTraceGCSuspendEEBegin((UInt32)(Reason), (UInt32)(Count)) : 0)
+
+#undef FireEtwGCSuspendEEEnd_V1
+#define FireEtwGCSuspendEEEnd_V1(ClrInstanceID) \
+    (BINARY_TRACE_GC_EVENT_ENABLED(GC, INFORMATIONAL) ? BinaryTraceNoPayload(BinaryTraceEvent_GCSuspendEEEnd) : 0)
+
+#undef FireEtwGCRestartEEBegin_V1
+#define FireEtwGCRestartEEBegin_V1(ClrInstanceID) \
+    (BINARY_TRACE_GC_EVENT_ENABLED(GC, INFORMATIONAL) ? BinaryTraceNoPayload(BinaryTraceEvent_GCRestartEEBegin) : 0)
+
+#undef FireEtwGCRestartEEEnd_V1
+#define FireEtwGCRestartEEEnd_V1(ClrInstanceID) \
+    (BINARY_TRACE_GC_EVENT_ENABLED(GC, INFORMATIONAL) ? BinaryTraceNoPayload(BinaryTraceEvent_GCRestartEEEnd) : 0)
+
+#undef FireEtwGCAllocationTick_V1
+#define FireEtwGCAllocationTick_V1(AllocationAmount, AllocationKind, ClrInstanceID) \
+    (BINARY_TRACE_GC_EVENT_ENABLED(GC, VERBOSE) ? BinaryTraceGCAllocationTick((UInt32)(AllocationAmount)) : 0)
+
+#undef FireEtwGCCreateSegment_V1
+#define FireEtwGCCreateSegment_V1(Address, Size, Type, ClrInstanceID) \
+    (BINARY_TRACE_GC_EVENT_ENABLED(GC_HEAP, INFORMATIONAL) ? BinaryTraceGCSegment(BinaryTraceEvent_GCCreateSegment, (UInt64)(Address), (UInt64)(Size)) : 0)
+
+#undef FireEtwGCFreeSegment_V1
+#define FireEtwGCFreeSegment_V1(Address, ClrInstanceID) \
+    (BINARY_TRACE_GC_EVENT_ENABLED(GC_HEAP, INFORMATIONAL) ? BinaryTraceGCSegment(BinaryTraceEvent_GCFreeSegment, (UInt64)(Address), 0) : 0)
+
+#undef FireEtwGCGlobalHeapHistory_V2
+#define FireEtwGCGlobalHeapHistory_V2(FinalYoungestDesired, NumHeaps, CondemnedGeneration, Gen0ReductionCount, Reason, GlobalMechanisms, ClrInstanceID, PauseMode, MemoryPressure) \
+    (BINARY_TRACE_GC_EVENT_ENABLED(GC_HEAP, INFORMATIONAL) ? \
+        BinaryTraceGCGlobalHeapHistory((UInt64)(FinalYoungestDesired), (UInt32)(NumHeaps), (UInt32)(CondemnedGeneration), \
+                                       (UInt32)(Gen0ReductionCount), (UInt32)(Reason), (UInt32)(GlobalMechanisms), \
+                                       (UInt32)(PauseMode), (UInt32)(MemoryPressure)) : 0)
+
+#undef FireEtwGCPerHeapHistory_V3
+#define FireEtwGCPerHeapHistory_V3(ClrInstanceID, FreeListAllocated, FreeListRejected, EndOfSegAllocated, CondemnedAllocated, PinnedAllocated, PinnedAllocatedAdvance, RunningFreeListEfficiency, CondemnReasons0, CondemnReasons1, CompactMechanisms, ExpandMechanisms, HeapIndex, ExtraGen0Commit, Count, Values_Len_, Values) \
+    (BINARY_TRACE_GC_EVENT_ENABLED(GC_HEAP, INFORMATIONAL) ? \
+        BinaryTraceGCPerHeapHistory((UInt64)(size_t)(FreeListAllocated), (UInt64)(size_t)(FreeListRejected), \
+                                    (UInt64)(size_t)(EndOfSegAllocated), (UInt64)(size_t)(CondemnedAllocated), \
+                                    (UInt64)(size_t)(PinnedAllocated), (UInt64)(size_t)(PinnedAllocatedAdvance), \
+                                    (UInt32)(RunningFreeListEfficiency), (UInt32)(CondemnReasons0), (UInt32)(CondemnReasons1), \
+                                    (UInt32)(CompactMechanisms), (UInt32)(ExpandMechanisms), (UInt32)(HeapIndex), \
+                                    (UInt64)(size_t)(ExtraGen0Commit), (UInt32)(Count), (UInt32)(Values_Len_), (Values)) : 0)
+
+#endif // __BinaryTraceEvents_h__
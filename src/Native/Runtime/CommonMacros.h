@@ -23,12 +23,18 @@
 #define MSVC_DISABLE_WARNING(warn_num) __pragma(warning(disable: warn_num))
 #define MSVC_RESTORE_WARNING_STATE() __pragma(warning(pop))
 
+EXTERN_C void * _ReturnAddress(void);
+#pragma intrinsic(_ReturnAddress)
+#define RETURN_ADDRESS() _ReturnAddress()
+
 #else
 
 #define MSVC_SAVE_WARNING_STATE()
 #define MSVC_DISABLE_WARNING(warn_num)
 #define MSVC_RESTORE_WARNING_STATE()
 
+#define RETURN_ADDRESS() __builtin_return_address(0)
+
 #endif // _MSC_VER
 
 #ifndef COUNTOF
@@ -174,22 +180,27 @@ EXTERN_C int __cdecl memcmp(const void *,const void *,size_t);
 
 #define INLINE inline
 
+// Points of the startup timeline, see StartupTimeline.h. The ones marked as such are recorded outside of the
+// runtime through RhpRecordStartupTimelineEvent, keep their values in sync with the bootstrapper
+// (src/Native/Bootstrap/main.cpp) and StartupCodeHelpers.
 enum STARTUP_TIMELINE_EVENT_ID
 {
-    PROCESS_ATTACH_BEGIN = 0,
-    NONGC_INIT_COMPLETE,
-    GC_INIT_COMPLETE,
-    PROCESS_ATTACH_COMPLETE,
+    PAL_INIT_BEGIN = 0,                 // bootstrapper
+    PROCESS_ATTACH_BEGIN = 1,
+    NONGC_INIT_COMPLETE = 2,
+    GC_HEAP_INIT_COMPLETE = 3,
+    GC_INIT_COMPLETE = 4,
+    PROCESS_ATTACH_COMPLETE = 5,
+    INITIALIZE_MODULES_BEGIN = 6,       // bootstrapper
+    EAGER_CCTORS_BEGIN = 7,             // StartupCodeHelpers
+    INITIALIZE_MODULES_COMPLETE = 8,    // bootstrapper
+    MANAGED_MAIN_BEGIN = 9,             // bootstrapper, through RhpCompleteStartupTimeline
 
     NUM_STARTUP_TIMELINE_EVENTS
 };
 
-#ifdef PROFILE_STARTUP
 extern unsigned __int64 g_startupTimelineEvents[NUM_STARTUP_TIMELINE_EVENTS];
 #define STARTUP_TIMELINE_EVENT(eventid) PalQueryPerformanceCounter((LARGE_INTEGER*)&g_startupTimelineEvents[eventid]);
-#else // PROFILE_STARTUP
-#define STARTUP_TIMELINE_EVENT(eventid)
-#endif // PROFILE_STARTUP
 
 bool inline FitsInI4(__int64 val)
 {
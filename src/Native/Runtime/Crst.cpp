@@ -6,9 +6,22 @@
 #include "CommonMacros.h"
 #include "PalRedhawkCommon.h"
 #include "PalRedhawk.h"
+#include "rhassert.h"
 #include "holder.h"
 #include "Crst.h"
 
+#include "RhConfig.h"
+
+#ifndef DACCESS_COMPILE
+// Some counters used for profiling lock contention, indexed by CrstType.
+extern "C"
+{
+    CrstContentionStats g_rgCrstContentionStats[CrstTypeCount];
+};
+
+bool CrstStatic::s_fContentionStats = false;
+#endif // !DACCESS_COMPILE
+
 void CrstStatic::Init(CrstType eType, CrstFlags eFlags)
 {
     UNREFERENCED_PARAMETER(eType);
@@ -17,6 +30,8 @@ void CrstStatic::Init(CrstType eType, CrstFlags eFlags)
 #if defined(_DEBUG)
     m_uiOwnerId.Clear();
 #endif // _DEBUG
+    ASSERT(eType < CrstTypeCount);
+    m_eType = eType;
     PalInitializeCriticalSectionEx(&m_sCritSec, 0, 0);
 #endif // !DACCESS_COMPILE
 }
@@ -32,7 +47,26 @@ void CrstStatic::Destroy()
 void CrstStatic::Enter(CrstStatic *pCrst)
 {
 #ifndef DACCESS_COMPILE
-    PalEnterCriticalSection(&pCrst->m_sCritSec);
+    if (s_fContentionStats)
+    {
+        // The counters are updated while holding the lock, so only Crsts of the same type sharing a counter can
+        // race with each other. That's acceptable for a profiling aid.
+        if (!PalTryEnterCriticalSection(&pCrst->m_sCritSec))
+        {
+            LARGE_INTEGER waitStart, waitEnd;
+            PalQueryPerformanceCounter(&waitStart);
+            PalEnterCriticalSection(&pCrst->m_sCritSec);
+            PalQueryPerformanceCounter(&waitEnd);
+
+            g_rgCrstContentionStats[pCrst->m_eType].m_cContendedAcquires++;
+            g_rgCrstContentionStats[pCrst->m_eType].m_WaitTime += waitEnd.QuadPart - waitStart.QuadPart;
+        }
+        g_rgCrstContentionStats[pCrst->m_eType].m_cAcquires++;
+    }
+    else
+    {
+        PalEnterCriticalSection(&pCrst->m_sCritSec);
+    }
 #if defined(_DEBUG)
     pCrst->m_uiOwnerId.SetToCurrentThread();
 #endif // _DEBUG
@@ -54,6 +88,25 @@ void CrstStatic::Leave(CrstStatic *pCrst)
 #endif // !DACCESS_COMPILE
 }
 
+#ifndef DACCESS_COMPILE
+// static
+void CrstStatic::InitializeContentionStats()
+{
+    s_fContentionStats = g_pRhConfig->GetCrstContentionStats() != 0;
+}
+
+// Copy the contention counters (an array of CrstContentionStats indexed by CrstType, see Crst.h) to pBuffer if
+// cbBuffer is large enough. Returns the size of the counters, which stay zero unless the CrstContentionStats
+// config value is set. The counters are read without taking the locks, they may be slightly out of date.
+COOP_PINVOKE_HELPER(UInt32, RhGetCrstContentionStats, (void * pBuffer, UInt32 cbBuffer))
+{
+    if (cbBuffer >= sizeof(g_rgCrstContentionStats))
+        memcpy(pBuffer, g_rgCrstContentionStats, sizeof(g_rgCrstContentionStats));
+
+    return sizeof(g_rgCrstContentionStats);
+}
+#endif // !DACCESS_COMPILE
+
 #if defined(_DEBUG)
 bool CrstStatic::OwnedByCurrentThread()
 {
@@ -21,6 +21,19 @@ enum CrstType
     CrstRestrictedCallouts,
     CrstGcStressControl,
     CrstSuspendEE,
+    CrstPerfMap,
+    CrstBinaryTrace,
+
+    CrstTypeCount
+};
+
+// Contention counters kept for each CrstType when the CrstContentionStats config value is set, see
+// RhGetCrstContentionStats.
+struct CrstContentionStats
+{
+    unsigned __int64    m_cAcquires;            // total number of Enter calls
+    unsigned __int64    m_cContendedAcquires;   // Enter calls which found the lock already held
+    unsigned __int64    m_WaitTime;             // total time spent waiting in contended Enter calls (performance counter ticks)
 };
 
 enum CrstFlags
@@ -48,11 +61,18 @@ public:
     EEThreadId GetHolderThreadId();
 #endif // _DEBUG
 
+    // Start counting contention if the CrstContentionStats config value is set. Crsts entered before this
+    // aren't counted.
+    static void InitializeContentionStats();
+
 private:
     CRITICAL_SECTION    m_sCritSec;
+    CrstType            m_eType;
 #if defined(_DEBUG)
     EEThreadId          m_uiOwnerId;
 #endif // _DEBUG
+
+    static bool         s_fContentionStats;
 };
 
 // Non-static version that will initialize itself during construction.
@@ -15,7 +15,11 @@
 #include "RuntimeInstance.h"
 #include "shash.h"
 #include "module.h"
+#include "GCMemoryHelpers.h"
 
+// Number of finalizer threads currently between RhpWaitForFinalizerRequest and RhpSignalFinalizationComplete.
+// The finalization pass is complete once the last of them is done.
+static volatile Int32 g_cActiveFinalizerThreads = 0;
 
 // Block the current thread until at least one object needs to be finalized (returns true) or memory is low
 // (returns false and the finalizer thread should initiate a garbage collection).
@@ -30,6 +34,18 @@ EXTERN_C REDHAWK_API UInt32_BOOL __cdecl RhpWaitForFinalizerRequest()
     // request.
     static bool fLastEventWasLowMemory = false;
 
+    // Additional finalizer threads are woken up by the others once there is more than a batch of objects to
+    // finalize. They leave low memory notifications to the primary finalizer thread.
+    if (!FinalizerThread::IsCurrentThreadPrimaryFinalizer())
+    {
+        UInt32 uResult = PalWaitForSingleObjectEx(FinalizerThread::GetFinalizerHelperEvent(), INFINITE, FALSE);
+        ASSERT(uResult == WAIT_OBJECT_0);
+        UNREFERENCED_PARAMETER(uResult);
+
+        PalInterlockedIncrement(&g_cActiveFinalizerThreads);
+        return TRUE;
+    }
+
     GCHeap * pHeap = GCHeap::GetGCHeap();
 
     // Wait in a loop because we may have to retry if we decide to only wait for finalization events but the
@@ -49,6 +65,7 @@ EXTERN_C REDHAWK_API UInt32_BOOL __cdecl RhpWaitForFinalizerRequest()
         {
         case WAIT_OBJECT_0:
             // At least one object is ready for finalization.
+            PalInterlockedIncrement(&g_cActiveFinalizerThreads);
             return TRUE;
 
         case WAIT_OBJECT_0 + 1:
@@ -74,7 +91,8 @@ EXTERN_C REDHAWK_API UInt32_BOOL __cdecl RhpWaitForFinalizerRequest()
 // Indicate that the current round of finalizations is complete.
 EXTERN_C REDHAWK_API void __cdecl RhpSignalFinalizationComplete()
 {
-    FinalizerThread::SignalFinalizationDone(TRUE);
+    if (PalInterlockedDecrement(&g_cActiveFinalizerThreads) == 0)
+        FinalizerThread::SignalFinalizationDone(TRUE);
 }
 
 //
@@ -106,6 +124,58 @@ COOP_PINVOKE_HELPER(OBJECTREF, RhpGetNextFinalizableObject, ())
     }
 }
 
+// Fetch up to a buffer's worth of objects which need finalization, taking the finalization queue lock only
+// once. Returns the number of objects stored at the start of the buffer, zero if the queue is empty.
+COOP_PINVOKE_HELPER(UInt32, RhpGetNextFinalizableObjects, (ArrayBase * pBuffer))
+{
+    // The elements of an object array immediately follow the array header.
+    OBJECTREF * rgObjects = (OBJECTREF *)(pBuffer + 1);
+    UInt32 cCapacity = pBuffer->GetNumComponents();
+
+    UInt32 cObjects = 0;
+    size_t cFetched = 0;
+    while (cObjects == 0)
+    {
+        cFetched = GCHeap::GetGCHeap()->GetNextFinalizables(rgObjects, cCapacity);
+        if (cFetched == 0)
+            break;
+
+        for (size_t i = 0; i < cFetched; i++)
+        {
+            OBJECTREF refNext = rgObjects[i];
+
+            // Skip objects which have been marked as finalized already, see RhpGetNextFinalizableObject.
+            if (refNext->GetHeader()->GetBits() & BIT_SBLK_FINALIZER_RUN)
+            {
+                refNext->GetHeader()->ClrBit(BIT_SBLK_FINALIZER_RUN);
+                continue;
+            }
+
+            rgObjects[cObjects++] = refNext;
+        }
+
+        // Don't leave the skipped objects behind in the buffer.
+        for (size_t i = cObjects; i < cFetched; i++)
+            rgObjects[i] = NULL;
+    }
+
+    // The buffer may live in any generation, so the references stored into it need a write barrier.
+    if (cObjects != 0)
+        RhpBulkWriteBarrier(rgObjects, cObjects * sizeof(OBJECTREF));
+
+    // A full batch means there's likely more to do, so let any additional finalizer threads join in. Once the
+    // queue is drained they can go back to waiting.
+    FinalizerThread::EnableFinalizerHelpers(cFetched == cCapacity);
+
+    return cObjects;
+}
+
+// Only the primary finalizer thread makes the finalizer init callbacks, see __Finalizer.ProcessFinalizers.
+COOP_PINVOKE_HELPER(UInt32_BOOL, RhpIsCurrentThreadPrimaryFinalizer, ())
+{
+    return FinalizerThread::IsCurrentThreadPrimaryFinalizer();
+}
+
 // This function walks the list of modules looking for any module that is a class library and has not yet 
 // had its finalizer init callback invoked.  It gets invoked in a loop, so it's technically O(n*m), but the
 // number of classlibs subscribing to this callback is almost certainly going to be 1.
@@ -149,3 +149,25 @@ COOP_PINVOKE_HELPER(Int64, RhGetLastGCDuration, (Int32 generation))
 {
     return GCHeap::GetGCHeap()->GetLastGCDuration(generation);
 }
+
+// Copy the GC's pause and phase statistics (a gc_pause_stats structure, see gc.h) to pBuffer if cbBuffer is
+// large enough. Returns the size of the statistics. Being a cooperative mode helper this never observes the
+// statistics in the middle of an update by a blocking GC.
+COOP_PINVOKE_HELPER(UInt32, RhGetGcPauseStats, (void * pBuffer, UInt32 cbBuffer))
+{
+    if (cbBuffer >= sizeof(gc_pause_stats))
+        GCHeap::GetGCHeap()->GetPauseStats((gc_pause_stats *)pBuffer);
+
+    return sizeof(gc_pause_stats);
+}
+
+// Copy up to cMaxEntries of the types owning the most bytes after the last blocking gen2 GC (an array of
+// gc_type_histogram_entry, see gc.h) to pBuffer, sorted by size, and the index of that GC to pGcIndex. Returns
+// the number of entries copied, which is zero unless the GCTypeHistogram config value is set.
+COOP_PINVOKE_HELPER(UInt32, RhGetTypeHistogram, (void * pBuffer, UInt32 cMaxEntries, UInt64 * pGcIndex))
+{
+    size_t gcIndex;
+    size_t cEntries = GCHeap::GetGCHeap()->GetTypeHistogram((gc_type_histogram_entry *)pBuffer, cMaxEntries, &gcIndex);
+    *pGcIndex = gcIndex;
+    return (UInt32)cEntries;
+}
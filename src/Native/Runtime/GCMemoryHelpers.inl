@@ -6,6 +6,54 @@
 // Unmanaged GC memory helpers
 //
 
+// On 64-bit targets where 128-bit vector loads and stores are part of the baseline instruction set the bulk of
+// large copies and fills is done with vector instructions. This preserves the per-pointer atomicity that the GC
+// relies on: an aligned vector access is performed as (at least) naturally aligned pointer sized pieces, so no
+// pointer sized slot is ever observed half written.
+//
+// On AMD64 this holds for aligned SSE2 loads and stores, so both the source and the destination must share the
+// same alignment within a vector. On ARM64 each element of an LD1/ST1 of 64-bit elements is single-copy atomic
+// as long as it is naturally aligned, so pointer alignment (which the callers already guarantee) is enough.
+#if defined(_AMD64_)
+
+#include <emmintrin.h>
+
+#define GCSAFE_VECTOR_SIZE 16
+
+typedef __m128i GCSafeVector;
+
+FORCEINLINE GCSafeVector GCSafeVectorLoad(const UInt8 * p) { return _mm_load_si128((const __m128i *)p); }
+FORCEINLINE void GCSafeVectorStore(UInt8 * p, GCSafeVector v) { _mm_store_si128((__m128i *)p, v); }
+FORCEINLINE GCSafeVector GCSafeVectorFromPointer(size_t pv) { return _mm_set1_epi64x((long long)pv); }
+
+FORCEINLINE bool GCSafeVectorCanCopy(const UInt8 * dmem, const UInt8 * smem)
+{
+    return (((size_t)dmem ^ (size_t)smem) & (GCSAFE_VECTOR_SIZE - 1)) == 0;
+}
+
+#elif defined(_ARM64_)
+
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+
+#define GCSAFE_VECTOR_SIZE 16
+
+typedef uint64x2_t GCSafeVector;
+
+FORCEINLINE GCSafeVector GCSafeVectorLoad(const UInt8 * p) { return vld1q_u64((const uint64_t *)p); }
+FORCEINLINE void GCSafeVectorStore(UInt8 * p, GCSafeVector v) { vst1q_u64((uint64_t *)p, v); }
+FORCEINLINE GCSafeVector GCSafeVectorFromPointer(size_t pv) { return vdupq_n_u64((uint64_t)pv); }
+
+FORCEINLINE bool GCSafeVectorCanCopy(const UInt8 * dmem, const UInt8 * smem)
+{
+    return true;
+}
+
+#endif // _AMD64_
+
 // This function fills a piece of memory in a GC safe way.  It makes the guarantee
 // that it will fill memory in at least pointer sized chunks whenever possible.
 // Unaligned memory at the beginning and remaining bytes at the end are written bytewise.
@@ -21,6 +69,35 @@ FORCEINLINE void InlineGCSafeFillMemory(void * mem, size_t size, size_t pv)
     while (!IS_ALIGNED(memBytes, sizeof(void *)) && (memBytes < endBytes))
         *memBytes++ = (UInt8)pv;
 
+#ifdef GCSAFE_VECTOR_SIZE
+    // write vector sized pieces once the destination is vector aligned
+    if ((size_t)(endBytes - memBytes) >= 4 * GCSAFE_VECTOR_SIZE)
+    {
+        while (!IS_ALIGNED(memBytes, GCSAFE_VECTOR_SIZE))
+        {
+            *(UIntNative *)memBytes = pv;
+            memBytes += sizeof(void *);
+        }
+
+        // write 4 vectors at a time, then single vectors
+        GCSafeVector v = GCSafeVectorFromPointer(pv);
+        while ((size_t)(endBytes - memBytes) >= 4 * GCSAFE_VECTOR_SIZE)
+        {
+            GCSafeVectorStore(memBytes, v);
+            GCSafeVectorStore(memBytes + GCSAFE_VECTOR_SIZE, v);
+            GCSafeVectorStore(memBytes + 2 * GCSAFE_VECTOR_SIZE, v);
+            GCSafeVectorStore(memBytes + 3 * GCSAFE_VECTOR_SIZE, v);
+            memBytes += 4 * GCSAFE_VECTOR_SIZE;
+        }
+
+        while ((size_t)(endBytes - memBytes) >= GCSAFE_VECTOR_SIZE)
+        {
+            GCSafeVectorStore(memBytes, v);
+            memBytes += GCSAFE_VECTOR_SIZE;
+        }
+    }
+#endif // GCSAFE_VECTOR_SIZE
+
     // now write pointer sized pieces 
     size_t nPtrs = (endBytes - memBytes) / sizeof(void *);
     UIntNative* memPtr = (UIntNative*)memBytes;
@@ -50,6 +127,37 @@ FORCEINLINE void InlineForwardGCSafeCopy(void * dest, const void *src, size_t le
     // regions must be non-overlapping
     ASSERT(dmem <= smem || smem + size <= dmem);
 
+#ifdef GCSAFE_VECTOR_SIZE
+    if (size >= 4 * GCSAFE_VECTOR_SIZE && GCSafeVectorCanCopy(dmem, smem))
+    {
+        // copy single pointers until the destination is vector aligned
+        while (!IS_ALIGNED(dmem, GCSAFE_VECTOR_SIZE))
+        {
+            size -= sizeof(size_t);
+            ((size_t *)dmem)[0] = ((size_t *)smem)[0];
+            smem += sizeof(size_t);
+            dmem += sizeof(size_t);
+        }
+
+        // copy 4 vectors at a time, loading all of them before storing any so that overlapping
+        // regions (with the destination below the source) are handled correctly
+        while (size >= 4 * GCSAFE_VECTOR_SIZE)
+        {
+            size -= 4 * GCSAFE_VECTOR_SIZE;
+            GCSafeVector v0 = GCSafeVectorLoad(smem);
+            GCSafeVector v1 = GCSafeVectorLoad(smem + GCSAFE_VECTOR_SIZE);
+            GCSafeVector v2 = GCSafeVectorLoad(smem + 2 * GCSAFE_VECTOR_SIZE);
+            GCSafeVector v3 = GCSafeVectorLoad(smem + 3 * GCSAFE_VECTOR_SIZE);
+            GCSafeVectorStore(dmem, v0);
+            GCSafeVectorStore(dmem + GCSAFE_VECTOR_SIZE, v1);
+            GCSafeVectorStore(dmem + 2 * GCSAFE_VECTOR_SIZE, v2);
+            GCSafeVectorStore(dmem + 3 * GCSAFE_VECTOR_SIZE, v3);
+            smem += 4 * GCSAFE_VECTOR_SIZE;
+            dmem += 4 * GCSAFE_VECTOR_SIZE;
+        }
+    }
+#endif // GCSAFE_VECTOR_SIZE
+
     // copy 4 pointers at a time 
     while (size >= 4 * sizeof(size_t))
     {
@@ -92,6 +200,37 @@ FORCEINLINE void InlineBackwardGCSafeCopy(void * dest, const void *src, size_t l
     // regions must be non-overlapping
     ASSERT(smem <= dmem || dmem + size <= smem);
 
+#ifdef GCSAFE_VECTOR_SIZE
+    if (size >= 4 * GCSAFE_VECTOR_SIZE && GCSafeVectorCanCopy(dmem, smem))
+    {
+        // copy single pointers until the end of the destination is vector aligned
+        while (!IS_ALIGNED(dmem, GCSAFE_VECTOR_SIZE))
+        {
+            size -= sizeof(size_t);
+            smem -= sizeof(size_t);
+            dmem -= sizeof(size_t);
+            ((size_t *)dmem)[0] = ((size_t *)smem)[0];
+        }
+
+        // copy 4 vectors at a time, loading all of them before storing any so that overlapping
+        // regions (with the destination above the source) are handled correctly
+        while (size >= 4 * GCSAFE_VECTOR_SIZE)
+        {
+            size -= 4 * GCSAFE_VECTOR_SIZE;
+            smem -= 4 * GCSAFE_VECTOR_SIZE;
+            dmem -= 4 * GCSAFE_VECTOR_SIZE;
+            GCSafeVector v3 = GCSafeVectorLoad(smem + 3 * GCSAFE_VECTOR_SIZE);
+            GCSafeVector v2 = GCSafeVectorLoad(smem + 2 * GCSAFE_VECTOR_SIZE);
+            GCSafeVector v1 = GCSafeVectorLoad(smem + GCSAFE_VECTOR_SIZE);
+            GCSafeVector v0 = GCSafeVectorLoad(smem);
+            GCSafeVectorStore(dmem + 3 * GCSAFE_VECTOR_SIZE, v3);
+            GCSafeVectorStore(dmem + 2 * GCSAFE_VECTOR_SIZE, v2);
+            GCSafeVectorStore(dmem + GCSAFE_VECTOR_SIZE, v1);
+            GCSafeVectorStore(dmem, v0);
+        }
+    }
+#endif // GCSAFE_VECTOR_SIZE
+
     // copy 4 pointers at a time 
     while (size >= 4 * sizeof(size_t))
     {
@@ -218,36 +357,40 @@ FORCEINLINE void InlinedBulkWriteBarrier(void* pMemStart, UInt32 cbMemSize)
 
 #endif // WRITE_BARRIER_CHECK
 
-    // Compute the starting card address and the number of bytes to write (groups of 8 cards). We could try
-    // for further optimization here using aligned 32-bit writes but there's some overhead in setup required
-    // and additional complexity. It's not clear this is warranted given that a single byte of card table
-    // update already covers 1K of object space (2K on 64-bit platforms). It's also not worth probing that
-    // 1K/2K range to see if any of the pointers appear to be non-ephemeral GC references. Given the size of
-    // the area the chances are high that at least one interesting GC refenence is present.
-
-    size_t startAddress = (size_t)pMemStart;
-    size_t endAddress = startAddress + cbMemSize;
-    size_t startingClump = startAddress >> LOG2_CLUMP_SIZE;
-    size_t endingClump = (endAddress + CLUMP_SIZE - 1) >> LOG2_CLUMP_SIZE;
+    // Rather than marking every card covering the range, examine each pointer sized slot that was written and
+    // only mark the cards for slots that now refer into the ephemeral range (this is the same test the single
+    // reference write barrier uses). Large copies of references to older objects would otherwise mark many
+    // cards that the next ephemeral GC has to scan for nothing. Slots holding non-reference data can at worst
+    // cause a card to be marked unnecessarily, which is always safe.
+    //
+    // Card bundles don't need to be updated here: the GC derives them from write watch over the card table
+    // itself.
 
-    // calculate the number of clumps to mark (round_up(end) - start)
-    size_t clumpCount = endingClump - startingClump;
     // VolatileLoadWithoutBarrier() is used here to prevent fetch of g_card_table from being reordered 
     // with g_lowest/highest_address check at the beginning of this function. 
-    uint8_t* card = ((uint8_t*)VolatileLoadWithoutBarrier(&g_card_table)) + startingClump;
+    uint8_t* cardTable = (uint8_t*)VolatileLoadWithoutBarrier(&g_card_table);
+    uint8_t* ephemeralLow = g_ephemeral_low;
+    uint8_t* ephemeralHigh = g_ephemeral_high;
+
+    UIntNative* slot = ALIGN_UP((UIntNative*)pMemStart, sizeof(UIntNative));
+    UIntNative* endSlot = ALIGN_DOWN((UIntNative*)((uint8_t*)pMemStart + cbMemSize), sizeof(UIntNative));
 
-    // Fill the cards. To avoid cache line thrashing we check whether the cards have already been set before
-    // writing.
-    do
+    while (slot < endSlot)
     {
-        if (*card != 0xff)
+        uint8_t* ref = (uint8_t*)*slot;
+        if ((ref >= ephemeralLow) && (ref < ephemeralHigh))
         {
-            *card = 0xff;
+            // To avoid cache line thrashing we check whether the card has already been set before writing.
+            uint8_t* pCardByte = cardTable + ((size_t)slot >> LOG2_CLUMP_SIZE);
+            if (*pCardByte != 0xFF)
+                *pCardByte = 0xFF;
+
+            // No need to look at the remaining slots covered by the same card.
+            slot = (UIntNative*)(((size_t)slot + CLUMP_SIZE) & ~((size_t)CLUMP_SIZE - 1));
+            continue;
         }
 
-        card++;
-        clumpCount--;
+        slot++;
     }
-    while (clumpCount != 0);
 }
 #endif // DACCESS_COMPILE
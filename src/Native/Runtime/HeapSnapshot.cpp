@@ -0,0 +1,383 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Heap snapshot writer, see HeapSnapshot.h.
+//
+
+#include "common.h"
+#include "gcenv.h"
+#include "gc.h"
+
+#include "gcrhinterface.h"
+
+#include "PalRedhawkCommon.h"
+#include "slist.h"
+#include "varint.h"
+#include "regdisplay.h"
+#include "StackFrameIterator.h"
+
+#include "thread.h"
+#include "RWLock.h"
+#include "threadstore.h"
+#include "shash.h"
+#include "module.h"
+#include "RuntimeInstance.h"
+#include "objecthandle.h"
+#include "HeapSnapshot.h"
+
+#ifndef DACCESS_COMPILE
+
+HeapSnapshotWriter * HeapSnapshot::s_pPendingWriter = NULL;
+
+// Streams the records described in HeapSnapshot.h to the file through a fixed size buffer. Allocated by the
+// thread requesting the snapshot so that nothing needs to be allocated while the EE is suspended.
+class HeapSnapshotWriter
+{
+public:
+    bool Open(const char * pszFileName)
+    {
+        m_hFile = PalCreateOutputFile(pszFileName);
+        if (m_hFile == INVALID_HANDLE_VALUE)
+            return false;
+
+        m_pbCur = m_rgbBuffer;
+        m_fFailed = false;
+        m_fComplete = false;
+        memset(m_rgTypeCache, 0, sizeof(m_rgTypeCache));
+        m_lastRoot = 0;
+        m_lastObjectEnd = 0;
+        m_lastReference = 0;
+        m_cObjects = 0;
+        m_cReferences = 0;
+        m_cRoots = 0;
+        return true;
+    }
+
+    // Returns true if the snapshot was written in full.
+    bool Close()
+    {
+        PalCloseHandle(m_hFile);
+        return m_fComplete && !m_fFailed;
+    }
+
+    void WriteSnapshot(size_t gcIndex);
+
+private:
+    static void RootCallback(PTR_PTR_Object ppObject, ScanContext * pSC, UInt32 flags);
+    static BOOL ObjectCallback(Object * pObject, void * pvContext);
+    static BOOL CountReferenceCallback(Object * pTarget, void * pvContext);
+    static BOOL WriteReferenceCallback(Object * pTarget, void * pvContext);
+
+    void WriteRoots();
+    void WriteObject(Object * pObject);
+
+    // Flush the buffer unless there's room for cb more bytes.
+    void Reserve(UInt32 cb)
+    {
+        if ((UInt32)(m_rgbBuffer + HEAP_SNAPSHOT_BUFFER_SIZE - m_pbCur) < cb)
+            Flush();
+    }
+
+    void Flush()
+    {
+        if (!m_fFailed && (m_pbCur != m_rgbBuffer))
+        {
+            if (!PalWriteOutputFile(m_hFile, m_rgbBuffer, (UInt32)(m_pbCur - m_rgbBuffer)))
+                m_fFailed = true;
+        }
+        m_pbCur = m_rgbBuffer;
+    }
+
+    void WriteByte(UInt8 b)
+    {
+        Reserve(1);
+        *m_pbCur++ = b;
+    }
+
+    void WriteUnsigned(UInt64 value)
+    {
+        Reserve(10);
+        while (value >= 0x80)
+        {
+            *m_pbCur++ = (UInt8)(value | 0x80);
+            value >>= 7;
+        }
+        *m_pbCur++ = (UInt8)value;
+    }
+
+    void WriteSigned(Int64 value)
+    {
+        WriteUnsigned(((UInt64)value << 1) ^ (UInt64)(value >> 63));
+    }
+
+    void WriteType(EEType * pEEType)
+    {
+        UInt64 typeAddress = (UInt64)(UIntNative)pEEType;
+        UInt32 slot = HeapSnapshotTypeCacheSlot(typeAddress);
+        if (m_rgTypeCache[slot] == typeAddress)
+        {
+            WriteUnsigned((UInt64)slot << 1);
+        }
+        else
+        {
+            m_rgTypeCache[slot] = typeAddress;
+            WriteUnsigned(((UInt64)slot << 1) | 1);
+            WriteUnsigned(typeAddress);
+        }
+    }
+
+    HANDLE      m_hFile;
+    UInt8 *     m_pbCur;
+    bool        m_fFailed;
+    bool        m_fComplete;
+
+    UInt64      m_lastRoot;
+    UInt64      m_lastObjectEnd;
+    UInt64      m_lastReference;
+    UInt64      m_cObjects;
+    UInt64      m_cReferences;
+    UInt64      m_cRoots;
+
+    UInt64      m_rgTypeCache[HEAP_SNAPSHOT_TYPE_CACHE_SIZE];
+    UInt8       m_rgbBuffer[HEAP_SNAPSHOT_BUFFER_SIZE];
+};
+
+struct HeapSnapshotScanContext : ScanContext
+{
+    HeapSnapshotWriter *    m_pWriter;
+    UInt32                  m_rootKind;
+    UInt32                  m_rootFlags;
+};
+
+void HeapSnapshotWriter::RootCallback(PTR_PTR_Object ppObject, ScanContext * pSC, UInt32 flags)
+{
+    Object * pObject = *ppObject;
+    if (pObject == NULL)
+        return;
+
+    HeapSnapshotScanContext * pContext = (HeapSnapshotScanContext *)pSC;
+    HeapSnapshotWriter * pWriter = pContext->m_pWriter;
+
+    UInt32 rootFlags = pContext->m_rootFlags;
+    if (flags & GC_CALL_INTERIOR)
+        rootFlags |= HEAP_SNAPSHOT_ROOT_FLAG_INTERIOR;
+    if (flags & GC_CALL_PINNED)
+        rootFlags |= HEAP_SNAPSHOT_ROOT_FLAG_PINNED;
+
+    UInt64 address = (UInt64)(UIntNative)pObject;
+    pWriter->WriteByte((UInt8)(HEAP_SNAPSHOT_TAG_ROOT + pContext->m_rootKind));
+    pWriter->WriteUnsigned(rootFlags);
+    pWriter->WriteSigned((Int64)(address - pWriter->m_lastRoot));
+    pWriter->m_lastRoot = address;
+    pWriter->m_cRoots++;
+}
+
+void HeapSnapshotWriter::WriteRoots()
+{
+    HeapSnapshotScanContext sc;
+    sc.promotion = FALSE;
+    sc.m_pWriter = this;
+    sc.m_rootFlags = 0;
+
+    sc.m_rootKind = HEAP_SNAPSHOT_ROOT_STACK;
+    FOREACH_THREAD(pThread)
+    {
+        // Skip "GC Special" threads which are really background workers that will never have any roots.
+        if (pThread->IsGCSpecial())
+            continue;
+
+        WriteByte(HEAP_SNAPSHOT_TAG_THREAD);
+        WriteUnsigned(pThread->GetPalThreadIdForLogging());
+
+        sc.thread_under_crawl = pThread;
+        pThread->GcScanRoots(reinterpret_cast<void*>(RootCallback), &sc);
+    }
+    END_FOREACH_THREAD
+    sc.thread_under_crawl = NULL;
+
+    sc.m_rootKind = HEAP_SNAPSHOT_ROOT_STATIC;
+    GetRuntimeInstance()->EnumAllStaticGCRefs(reinterpret_cast<void*>(RootCallback), &sc);
+
+    // Weak handles don't keep their targets alive, they're included so that readers can tell why an object
+    // they expected to be collected wasn't (or was).
+    static const UInt32 s_rgHandleTypes[] =
+    {
+        HNDTYPE_STRONG,
+        HNDTYPE_PINNED,
+        HNDTYPE_REFCOUNTED,
+        HNDTYPE_ASYNCPINNED,
+        HNDTYPE_SIZEDREF,
+        HNDTYPE_WEAK_SHORT,
+        HNDTYPE_WEAK_LONG,
+    };
+
+    sc.m_rootKind = HEAP_SNAPSHOT_ROOT_HANDLE;
+    for (UInt32 i = 0; i < _countof(s_rgHandleTypes); i++)
+    {
+        UInt32 type = s_rgHandleTypes[i];
+        sc.m_rootFlags = type << HEAP_SNAPSHOT_ROOT_HANDLE_TYPE_SHIFT;
+        if ((type == HNDTYPE_PINNED) || (type == HNDTYPE_ASYNCPINNED))
+            sc.m_rootFlags |= HEAP_SNAPSHOT_ROOT_FLAG_PINNED;
+
+        Ref_ScanHandlesOfType(type, &sc, RootCallback);
+    }
+}
+
+BOOL HeapSnapshotWriter::CountReferenceCallback(Object * pTarget, void * pvContext)
+{
+    UNREFERENCED_PARAMETER(pTarget);
+    (*(UInt32 *)pvContext)++;
+    return TRUE;
+}
+
+BOOL HeapSnapshotWriter::WriteReferenceCallback(Object * pTarget, void * pvContext)
+{
+    HeapSnapshotWriter * pWriter = (HeapSnapshotWriter *)pvContext;
+
+    UInt64 address = (UInt64)(UIntNative)pTarget;
+    pWriter->WriteSigned((Int64)(address - pWriter->m_lastReference));
+    pWriter->m_lastReference = address;
+    return TRUE;
+}
+
+void HeapSnapshotWriter::WriteObject(Object * pObject)
+{
+    GCHeap * pHeap = GCHeap::GetGCHeap();
+
+    UInt32 gen = pHeap->WhichGeneration(pObject);
+    if ((gen >= GCHeap::GetMaxGeneration()) && !pHeap->IsHeapPointer(pObject, TRUE))
+        gen = HEAP_SNAPSHOT_LARGE_OBJECT_GEN;
+
+    UInt64 address = (UInt64)(UIntNative)pObject;
+    UInt64 cbObject = pObject->GetSize();
+
+    WriteByte((UInt8)(HEAP_SNAPSHOT_TAG_OBJECT + gen));
+    WriteSigned((Int64)(address - m_lastObjectEnd));
+    WriteType(pObject->get_SafeEEType());
+    WriteUnsigned(cbObject);
+
+    // Walk the references twice rather than buffering them, arrays of references can be arbitrarily large.
+    UInt32 cReferences = 0;
+    if (pObject->get_SafeEEType()->HasReferenceFields())
+        pHeap->WalkObject(pObject, CountReferenceCallback, &cReferences);
+
+    WriteUnsigned(cReferences);
+    if (cReferences != 0)
+    {
+        m_lastReference = address;
+        pHeap->WalkObject(pObject, WriteReferenceCallback, this);
+    }
+
+    m_lastObjectEnd = address + cbObject;
+    m_cObjects++;
+    m_cReferences += cReferences;
+}
+
+BOOL HeapSnapshotWriter::ObjectCallback(Object * pObject, void * pvContext)
+{
+    HeapSnapshotWriter * pWriter = (HeapSnapshotWriter *)pvContext;
+    pWriter->WriteObject(pObject);
+
+    // Stop walking if the file can't be written to anymore.
+    return !pWriter->m_fFailed;
+}
+
+void HeapSnapshotWriter::WriteSnapshot(size_t gcIndex)
+{
+    HeapSnapshotFileHeader header;
+    header.m_magic = HEAP_SNAPSHOT_MAGIC;
+    header.m_version = HEAP_SNAPSHOT_VERSION;
+    header.m_cbPointer = sizeof(void *);
+    header.m_gcIndex = gcIndex;
+    header.m_processId = PalGetCurrentProcessId();
+    header.m_reserved = 0;
+
+    Reserve(sizeof(header));
+    memcpy(m_pbCur, &header, sizeof(header));
+    m_pbCur += sizeof(header);
+
+    WriteRoots();
+
+    GCHeap::GetGCHeap()->DiagWalkHeap(ObjectCallback, this, GCHeap::GetMaxGeneration(), TRUE);
+
+    WriteByte(HEAP_SNAPSHOT_TAG_END);
+    WriteUnsigned(m_cObjects);
+    WriteUnsigned(m_cReferences);
+    WriteUnsigned(m_cRoots);
+    Flush();
+
+    m_fComplete = true;
+}
+
+// Schedule a snapshot, trigger a blocking full GC to write it and wait for that to complete.
+bool HeapSnapshot::Write(const char * pszFileName)
+{
+    // The writer is large, keep it off the stack.
+    HeapSnapshotWriter * pWriter = new (nothrow) HeapSnapshotWriter();
+    if (pWriter == NULL)
+        return false;
+
+    if (!pWriter->Open(pszFileName))
+    {
+        delete pWriter;
+        return false;
+    }
+
+    Thread * pCurThread = GetThread();
+
+    pCurThread->SetupHackPInvokeTunnel();
+    pCurThread->DisablePreemptiveMode();
+
+    ASSERT(!pCurThread->IsDoNotTriggerGcSet());
+
+    // Only one snapshot can be scheduled at a time, wait for the GC writing any other one to complete first.
+    while (PalInterlockedCompareExchangePointer((void * volatile *)&s_pPendingWriter, pWriter, NULL) != NULL)
+    {
+        pCurThread->EnablePreemptiveMode();
+
+        if (PalSwitchToThread() == 0)
+            PalSleep(1);
+        RedhawkGCInterface::WaitForGCCompletion();
+
+        pCurThread->DisablePreemptiveMode();
+    }
+
+    GCHeap::GetGCHeap()->GarbageCollect(GCHeap::GetMaxGeneration(), FALSE, collection_blocking);
+
+    // The GC writing the snapshot takes it off s_pPendingWriter. If the GC didn't happen (because the
+    // application is in a no GC region for instance) the snapshot is abandoned.
+    PalInterlockedCompareExchangePointer((void * volatile *)&s_pPendingWriter, NULL, pWriter);
+
+    pCurThread->EnablePreemptiveMode();
+
+    bool fSuccess = pWriter->Close();
+    delete pWriter;
+    return fSuccess;
+}
+
+void HeapSnapshot::OnGCEnd(size_t gcIndex, int condemned, bool fConcurrent)
+{
+    // The heap can only be walked at the end of a blocking GC, and only a full one leaves no dead objects
+    // behind.
+    if (fConcurrent || (condemned != (int)GCHeap::GetMaxGeneration()))
+        return;
+
+    HeapSnapshotWriter * pWriter = VolatileLoad(&s_pPendingWriter);
+    if (pWriter == NULL)
+        return;
+
+    VolatileStore(&s_pPendingWriter, (HeapSnapshotWriter *)NULL);
+    pWriter->WriteSnapshot(gcIndex);
+}
+
+// Write a snapshot of the heap to the given file, returns false if the file couldn't be written in full.
+EXTERN_C REDHAWK_API UInt32_BOOL __cdecl RhpWriteHeapSnapshot(const char * pszFileName)
+{
+    // This must be called via p/invoke rather than RuntimeImport to make the stack crawlable.
+
+    return HeapSnapshot::Write(pszFileName) ? UInt32_TRUE : UInt32_FALSE;
+}
+
+#endif // !DACCESS_COMPILE
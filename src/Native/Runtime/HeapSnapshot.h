@@ -0,0 +1,96 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// On demand heap snapshots, for finding leaks without taking a full dump of the process.
+//
+// RhpWriteHeapSnapshot schedules a snapshot and triggers a blocking full GC. At the end of that GC, while the
+// EE is still suspended, the roots and every object on the heap along with its outgoing references are
+// streamed to the file through a fixed size buffer, so the memory used doesn't depend on the size of the heap.
+//
+// File format: a HeapSnapshotFileHeader followed by records which each start with a tag byte. Integers are
+// LEB128 varints (uvar below), signed integers are zigzag encoded first (svar below). Addresses are delta
+// encoded so that the typical object takes a handful of bytes.
+//
+//   HEAP_SNAPSHOT_TAG_THREAD           uvar OS thread id, the stack roots that follow belong to this thread
+//   HEAP_SNAPSHOT_TAG_ROOT + kind      uvar flags (HEAP_SNAPSHOT_ROOT_FLAG_*, plus the handle type shifted left
+//                                      by HEAP_SNAPSHOT_ROOT_HANDLE_TYPE_SHIFT for handle roots)
+//                                      svar address minus the address of the previous root, roots reported
+//                                      conservatively or as interior pointers may not point at an object start
+//   HEAP_SNAPSHOT_TAG_OBJECT + gen     svar address minus the end of the previous object
+//                                      type reference, see below
+//                                      uvar size in bytes
+//                                      uvar number of references
+//                                      svar for each reference, its target minus the previous target (the first
+//                                      one relative to the address of the object itself)
+//   HEAP_SNAPSHOT_TAG_END              uvar number of objects, uvar number of references, uvar number of roots
+//
+// Roots come before objects. Objects come in heap order, gen is 0 to 2 or HEAP_SNAPSHOT_LARGE_OBJECT_GEN for
+// objects on the large object heap. A file without the end record is incomplete.
+//
+// Type references: writer and reader each keep a direct mapped cache of HEAP_SNAPSHOT_TYPE_CACHE_SIZE EETypes,
+// indexed by HeapSnapshotTypeCacheSlot. A type reference is a uvar of the slot shifted left by one. If the low
+// bit is set the slot is being replaced and the uvar EEType address follows.
+//
+// src/Native/Runtime/tools/heapsnapshot.py decodes snapshots.
+//
+
+#ifndef __HeapSnapshot_h__
+#define __HeapSnapshot_h__
+
+#define HEAP_SNAPSHOT_MAGIC                     0x50414e5350414548ull   // "HEAPSNAP"
+#define HEAP_SNAPSHOT_VERSION                   1
+
+#define HEAP_SNAPSHOT_TAG_THREAD                0x01
+#define HEAP_SNAPSHOT_TAG_ROOT                  0x10
+#define HEAP_SNAPSHOT_TAG_OBJECT                0x20
+#define HEAP_SNAPSHOT_TAG_END                   0x7F
+
+// Root kinds
+#define HEAP_SNAPSHOT_ROOT_STACK                0
+#define HEAP_SNAPSHOT_ROOT_STATIC               1
+#define HEAP_SNAPSHOT_ROOT_HANDLE               2
+
+#define HEAP_SNAPSHOT_ROOT_FLAG_INTERIOR        0x1
+#define HEAP_SNAPSHOT_ROOT_FLAG_PINNED          0x2
+#define HEAP_SNAPSHOT_ROOT_HANDLE_TYPE_SHIFT    2
+
+#define HEAP_SNAPSHOT_LARGE_OBJECT_GEN          3
+
+#define HEAP_SNAPSHOT_TYPE_CACHE_BITS           12
+#define HEAP_SNAPSHOT_TYPE_CACHE_SIZE           (1 << HEAP_SNAPSHOT_TYPE_CACHE_BITS)
+
+#define HEAP_SNAPSHOT_BUFFER_SIZE               (256 * 1024)
+
+struct HeapSnapshotFileHeader
+{
+    UInt64      m_magic;                // HEAP_SNAPSHOT_MAGIC
+    UInt32      m_version;              // HEAP_SNAPSHOT_VERSION
+    UInt32      m_cbPointer;            // size of a pointer in the process
+    UInt64      m_gcIndex;              // index of the GC at the end of which the snapshot was taken
+    UInt32      m_processId;
+    UInt32      m_reserved;
+};
+
+inline UInt32 HeapSnapshotTypeCacheSlot(UInt64 typeAddress)
+{
+    return (UInt32)(((typeAddress >> 3) * 0x9E3779B97F4A7C15ull) >> (64 - HEAP_SNAPSHOT_TYPE_CACHE_BITS));
+}
+
+class HeapSnapshotWriter;
+
+class HeapSnapshot
+{
+public:
+    static bool Write(const char * pszFileName);
+
+    // Called at the end of every GC, writes the scheduled snapshot if there is one and the GC was a blocking
+    // full one.
+    static void OnGCEnd(size_t gcIndex, int condemned, bool fConcurrent);
+
+private:
+    static HeapSnapshotWriter * s_pPendingWriter;
+};
+
+#endif // __HeapSnapshot_h__
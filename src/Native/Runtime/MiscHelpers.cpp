@@ -38,6 +38,7 @@
 #include "Volatile.h"
 #include "GCMemoryHelpers.h"
 #include "GCMemoryHelpers.inl"
+#include "StartupTimeline.h"
 
 // Busy spin for the given number of iterations.
 COOP_PINVOKE_HELPER(void, RhSpinWait, (Int32 iterations))
@@ -627,7 +628,18 @@ COOP_PINVOKE_HELPER(Boolean, RhpArrayClear, (Array * pArray, Int32 index, Int32
     if (length == 0)
         return true;
 
-    InlineGCSafeFillMemory((UInt8 *)pArray->GetArrayData() + index * componentSize, length * componentSize, 0);
+    UInt8 * pData = (UInt8 *)pArray->GetArrayData() + index * componentSize;
+    size_t size = length * componentSize;
+
+    if (pArrayType->HasReferenceFields())
+    {
+        InlineGCSafeFillMemory(pData, size, 0);
+    }
+    else
+    {
+        // No object references can be torn, so the CRT's (typically non-temporal for large spans) memset is fine.
+        memset(pData, 0, size);
+    }
 
     return true;
 }
@@ -652,6 +664,11 @@ COOP_PINVOKE_HELPER(void*, RhpGetModuleSection, (ModuleManager* pModule, Int32 h
 
 COOP_PINVOKE_HELPER(void*, RhpCreateModuleManager, (void* pModuleHeader))
 {
-    return ModuleManager::Create(pModuleHeader);
+    UInt64 registrationBegin = StartupTimeline::BeginModuleRegistration();
+
+    ModuleManager * pModuleManager = ModuleManager::Create(pModuleHeader);
+
+    StartupTimeline::EndModuleRegistration(registrationBegin);
+    return pModuleManager;
 }
 #endif
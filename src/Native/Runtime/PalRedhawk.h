@@ -769,14 +769,33 @@ EXTERN_C void * __cdecl _alloca(size_t);
 
 REDHAWK_PALIMPORT _Ret_maybenull_ _Post_writable_byte_size_(size) void* REDHAWK_PALAPI PalVirtualAlloc(_In_opt_ void* pAddress, UIntNative size, UInt32 allocationType, UInt32 protect);
 REDHAWK_PALIMPORT UInt32_BOOL REDHAWK_PALAPI PalVirtualFree(_In_ void* pAddress, UIntNative size, UInt32 freeType);
+// pOldProtect may be NULL when the caller already knows the previous protection, which saves looking it up on
+// platforms that can't report it cheaply.
+REDHAWK_PALIMPORT UInt32_BOOL REDHAWK_PALAPI PalVirtualProtect(_In_ void* pAddress, UIntNative size, UInt32 protect, _Out_opt_ UInt32* pOldProtect);
 REDHAWK_PALIMPORT void REDHAWK_PALAPI PalSleep(UInt32 milliseconds);
 REDHAWK_PALIMPORT UInt32_BOOL REDHAWK_PALAPI PalSwitchToThread();
 REDHAWK_PALIMPORT HANDLE REDHAWK_PALAPI PalCreateEventW(_In_opt_ LPSECURITY_ATTRIBUTES pEventAttributes, UInt32_BOOL manualReset, UInt32_BOOL initialState, _In_opt_z_ LPCWSTR pName);
 REDHAWK_PALIMPORT UInt32 REDHAWK_PALAPI PalGetTickCount();
 REDHAWK_PALIMPORT HANDLE REDHAWK_PALAPI PalCreateFileW(_In_z_ LPCWSTR pFileName, uint32_t desiredAccess, uint32_t shareMode, _In_opt_ void* pSecurityAttributes, uint32_t creationDisposition, uint32_t flagsAndAttributes, HANDLE hTemplateFile);
 REDHAWK_PALIMPORT HANDLE REDHAWK_PALAPI PalCreateLowMemoryNotification();
+
+// Format the name of a diagnostic output file of the current process, <temporary directory>/<prefix>-<pid><ext>
+// (e.g. /tmp/perf-1234.map). The temporary directory is /tmp on Unix, where tools such as perf look for these
+// files, and the one GetTempPath returns on Windows. Returns false if the name doesn't fit in cchFileName
+// characters, PAL_MAX_OUTPUT_FILE_NAME is always enough.
+#define PAL_MAX_OUTPUT_FILE_NAME 320
+REDHAWK_PALIMPORT bool REDHAWK_PALAPI PalGetOutputFileName(_In_z_ const char* pPrefix, _In_z_ const char* pExtension, _Out_writes_z_(cchFileName) char* pFileName, UInt32 cchFileName);
+// Create (or truncate) a file that diagnostic output is written to sequentially. Returns INVALID_HANDLE_VALUE
+// on failure, the handle is closed with PalCloseHandle.
+REDHAWK_PALIMPORT HANDLE REDHAWK_PALAPI PalCreateOutputFile(_In_z_ const char* pFileName);
+REDHAWK_PALIMPORT UInt32_BOOL REDHAWK_PALAPI PalWriteOutputFile(HANDLE hFile, _In_reads_bytes_(cbBuffer) const void* pBuffer, UInt32 cbBuffer);
+// Create (or truncate) a file of cbSize zero bytes and map all of it read/write, shared with other processes
+// reading the file. Returns NULL on failure. The mapping lasts for the life of the process.
+REDHAWK_PALIMPORT void* REDHAWK_PALAPI PalMapOutputFile(_In_z_ const char* pFileName, UIntNative cbSize);
 REDHAWK_PALIMPORT void REDHAWK_PALAPI PalTerminateCurrentProcess(UInt32 exitCode);
 REDHAWK_PALIMPORT HANDLE REDHAWK_PALAPI PalGetModuleHandleFromPointer(_In_ void* pointer);
+// Return the name of the exported symbol of a loaded image that contains pointer, or NULL if there is none.
+REDHAWK_PALIMPORT const char* REDHAWK_PALAPI PalGetSymbolName(_In_ void* pointer);
 
 #ifndef APP_LOCAL_RUNTIME
 REDHAWK_PALIMPORT void* REDHAWK_PALAPI PalAddVectoredExceptionHandler(UInt32 firstHandler, _In_ PVECTORED_EXCEPTION_HANDLER vectoredHandler);
@@ -785,6 +804,7 @@ REDHAWK_PALIMPORT void* REDHAWK_PALAPI PalAddVectoredExceptionHandler(UInt32 fir
 typedef UInt32 (__stdcall *BackgroundCallback)(_In_opt_ void* pCallbackContext);
 REDHAWK_PALIMPORT bool REDHAWK_PALAPI PalStartBackgroundGCThread(_In_ BackgroundCallback callback, _In_opt_ void* pCallbackContext);
 REDHAWK_PALIMPORT bool REDHAWK_PALAPI PalStartFinalizerThread(_In_ BackgroundCallback callback, _In_opt_ void* pCallbackContext);
+REDHAWK_PALIMPORT bool REDHAWK_PALAPI PalStartDiagnosticsThread(_In_ BackgroundCallback callback, _In_opt_ void* pCallbackContext);
 
 typedef UInt32 (__stdcall *PalHijackCallback)(HANDLE hThread, _In_ PAL_LIMITED_CONTEXT* pThreadContext, _In_opt_ void* pCallbackContext);
 REDHAWK_PALIMPORT UInt32 REDHAWK_PALAPI PalHijack(HANDLE hThread, _In_ PalHijackCallback callback, _In_opt_ void* pCallbackContext);
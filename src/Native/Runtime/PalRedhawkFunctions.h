@@ -203,6 +203,12 @@ inline void PalTerminateProcess(HANDLE arg1, UInt32 arg2)
     TerminateProcess(arg1, arg2);
 }
 
+extern "C" UInt32_BOOL __stdcall TryEnterCriticalSection(CRITICAL_SECTION *);
+inline UInt32_BOOL PalTryEnterCriticalSection(CRITICAL_SECTION * arg1)
+{
+    return TryEnterCriticalSection(arg1);
+}
+
 extern "C" UInt32 __stdcall WaitForMultipleObjectsEx(UInt32, HANDLE *, UInt32_BOOL, UInt32, UInt32_BOOL);
 inline UInt32 PalWaitForMultipleObjectsEx(UInt32 arg1, HANDLE * arg2, UInt32_BOOL arg3, UInt32 arg4, UInt32_BOOL arg5)
 {
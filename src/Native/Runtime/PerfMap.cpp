@@ -0,0 +1,152 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Writer for /tmp/perf-<pid>.map, see PerfMap.h.
+//
+
+#include "common.h"
+#include "CommonTypes.h"
+#include "CommonMacros.h"
+#include "daccess.h"
+#include "PalRedhawkCommon.h"
+#include "PalRedhawk.h"
+#include "rhassert.h"
+#include "slist.h"
+#include "holder.h"
+#include "Crst.h"
+#include "RhConfig.h"
+#include "PerfMap.h"
+
+#ifndef DACCESS_COMPILE
+
+#ifdef FEATURE_PERFMAP
+
+HANDLE PerfMap::s_hFile = NULL;
+
+// Serializes writers so that lines logged from different threads don't interleave.
+static CrstStatic s_PerfMapLock;
+
+#define PERFMAP_LINE_SIZE   512
+
+// Append the hex representation of value to the buffer at pch, returning the new end of the buffer.
+static char * AppendHex(char * pch, UInt64 value)
+{
+    char rgch[16];
+    int cch = 0;
+    do
+    {
+        rgch[cch++] = "0123456789abcdef"[value & 0xF];
+        value >>= 4;
+    }
+    while (value != 0);
+
+    while (cch > 0)
+        *pch++ = rgch[--cch];
+
+    return pch;
+}
+
+// Append at most pchLimit - pch characters of the string.
+static char * AppendString(char * pch, char * pchLimit, const char * psz)
+{
+    while ((*psz != '\0') && (pch < pchLimit))
+        *pch++ = *psz++;
+
+    return pch;
+}
+
+void PerfMap::Initialize()
+{
+    if (g_pRhConfig->GetPerfMapEnabled() == 0)
+        return;
+
+    char szFileName[PAL_MAX_OUTPUT_FILE_NAME];
+    if (!PalGetOutputFileName("perf", ".map", szFileName, sizeof(szFileName)))
+        return;
+
+    HANDLE hFile = PalCreateOutputFile(szFileName);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return;
+
+    s_PerfMapLock.Init(CrstPerfMap);
+    s_hFile = hFile;
+}
+
+// Write a single "<start> <size> <prefix><name>" line.
+void PerfMap::WriteLine(void * pvStart, UIntNative cbRange, const char * pszPrefix, const char * pszName)
+{
+    char szLine[PERFMAP_LINE_SIZE];
+    // Leave room for the newline.
+    char * pchLimit = szLine + PERFMAP_LINE_SIZE - 1;
+
+    char * pch = AppendHex(szLine, (UInt64)(UIntNative)pvStart);
+    *pch++ = ' ';
+    pch = AppendHex(pch, (UInt64)cbRange);
+    *pch++ = ' ';
+    if (pszPrefix != NULL)
+        pch = AppendString(pch, pchLimit, pszPrefix);
+    pch = AppendString(pch, pchLimit, pszName);
+    *pch++ = '\n';
+
+    s_PerfMapLock.Enter();
+    PalWriteOutputFile(s_hFile, szLine, (UInt32)(pch - szLine));
+    s_PerfMapLock.Leave();
+}
+
+// Profilers name code inside images from the images' own symbols and ignore map entries for it, so only code
+// in anonymous memory is logged.
+static bool IsInImage(void * pvAddress)
+{
+    return PalGetModuleHandleFromPointer(pvAddress) != NULL;
+}
+
+void PerfMap::LogCodeRange(void * pvStart, UIntNative cbRange, const char * pszName)
+{
+    if (!IsEnabled() || IsInImage(pvStart))
+        return;
+
+    WriteLine(pvStart, cbRange, NULL, pszName);
+}
+
+// A thunk mapping alternates pages of thunk code with pages of thunk data (see ThunkPool.cs), only the code
+// pages are logged. They're named after the symbol of the template they were copied from when it has one.
+void PerfMap::LogThunks(void * pvThunks, UIntNative cbThunks, void * pvTemplate)
+{
+    if (!IsEnabled() || IsInImage(pvThunks))
+        return;
+
+    const char * pszTemplateName = PalGetSymbolName(pvTemplate);
+    for (UIntNative offset = 0; offset < cbThunks; offset += 2 * OS_PAGE_SIZE)
+    {
+        if (pszTemplateName != NULL)
+            WriteLine((UInt8 *)pvThunks + offset, OS_PAGE_SIZE, "[thunks] ", pszTemplateName);
+        else
+            WriteLine((UInt8 *)pvThunks + offset, OS_PAGE_SIZE, NULL, "[thunks]");
+    }
+}
+
+#else // FEATURE_PERFMAP
+
+void PerfMap::Initialize()
+{
+}
+
+void PerfMap::LogCodeRange(void * pvStart, UIntNative cbRange, const char * pszName)
+{
+    UNREFERENCED_PARAMETER(pvStart);
+    UNREFERENCED_PARAMETER(cbRange);
+    UNREFERENCED_PARAMETER(pszName);
+}
+
+void PerfMap::LogThunks(void * pvThunks, UIntNative cbThunks, void * pvTemplate)
+{
+    UNREFERENCED_PARAMETER(pvThunks);
+    UNREFERENCED_PARAMETER(cbThunks);
+    UNREFERENCED_PARAMETER(pvTemplate);
+}
+
+#endif // FEATURE_PERFMAP
+
+#endif // !DACCESS_COMPILE
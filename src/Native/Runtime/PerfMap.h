@@ -0,0 +1,44 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Support for the perf map convention used by Linux perf and other sampling profilers: when the PerfMapEnabled
+// config value is set the runtime writes /tmp/perf-<pid>.map, one "<start> <size> <name>" line (start and size
+// in hex) per code range, so that samples in managed code and runtime generated stubs can be attributed.
+//
+// Profilers only consult the map for code in anonymous memory, code inside an image (including the methods and
+// stubs of modules compiled into it, which is where all of the AOT compiled code lives) is named from the
+// image's symbols. Ranges outside of any image are logged as they become known: code managers registered for
+// dynamic code and the thunk pages RhAllocateThunksFromTemplate copies from a thunk template.
+//
+
+#ifndef __PerfMap_h__
+#define __PerfMap_h__
+
+class PerfMap
+{
+public:
+    static void Initialize();
+
+    static bool IsEnabled()
+    {
+#ifdef FEATURE_PERFMAP
+        return s_hFile != NULL;
+#else
+        return false;
+#endif
+    }
+
+    static void LogCodeRange(void * pvStart, UIntNative cbRange, const char * pszName);
+    static void LogThunks(void * pvThunks, UIntNative cbThunks, void * pvTemplate);
+
+#ifdef FEATURE_PERFMAP
+private:
+    static void WriteLine(void * pvStart, UIntNative cbRange, const char * pszPrefix, const char * pszName);
+
+    static HANDLE s_hFile;
+#endif // FEATURE_PERFMAP
+};
+
+#endif // __PerfMap_h__
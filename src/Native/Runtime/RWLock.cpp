@@ -10,6 +10,7 @@
 #include "CommonMacros.h"
 #include "daccess.h"
 #include "PalRedhawkCommon.h"
+#include "CommonMacros.inl"
 #include "PalRedhawk.h"
 #include "rhassert.h"
 #include "slist.h"
@@ -36,18 +37,43 @@ struct SpinConstants
     UInt32 uRepetitions;
 } g_SpinConstants = { 
     50,        // dwInitialDuration 
-    40000,     // dwMaximumDuration - ideally (20000 * max(2, numProc))
+    40000,     // dwMaximumDuration - ideally (20000 * max(2, numProc)), see InitializeSpinConstants
     3,         // dwBackoffFactor
     10         // dwRepetitions
 };
 
+// Upper bound on the maximum spin duration, however many processors the machine has.
+#define SPIN_MAXIMUM_DURATION_LIMIT 1000000
+
+// After revoking the read bias a writer keeps readers on the shared lock word for this many times as long as
+// the revocation took (and at least 1ms).
+#define READ_BIAS_INHIBIT_MULTIPLIER 9
+
+#ifndef DACCESS_COMPILE
+
+void InitializeSpinConstants()
+{
+    UInt32 cCpus = PalGetLogicalCpuCount();
+    UInt32 uMaximumDuration = 20000 * max(2u, min(cCpus, SPIN_MAXIMUM_DURATION_LIMIT / 20000u));
+    g_SpinConstants.uMaximumDuration = uMaximumDuration;
+}
+
+// Index (plus one) of the reader indicator used by the current thread, zero until it is first needed. Threads
+// are assigned indicators round-robin; each lock maps the index onto its own set of indicators.
+DECLSPEC_THREAD
+static UInt32 t_uReaderIndicatorIndex;
+
+static Int32 g_uNextReaderIndicatorIndex;
+
+#endif // !DACCESS_COMPILE
+
 ReaderWriterLock::ReadHolder::ReadHolder(ReaderWriterLock * pLock, bool fAcquireLock) :
-    m_pLock(pLock)
+    m_pLock(pLock), m_pIndicator(NULL)
 {
 #ifndef DACCESS_COMPILE
     m_fLockAcquired = fAcquireLock;
     if (fAcquireLock)
-        m_pLock->AcquireReadLock();
+        m_pIndicator = m_pLock->AcquireReadLock();
 #else
     UNREFERENCED_PARAMETER(fAcquireLock);
 #endif // !DACCESS_COMPILE
@@ -57,7 +83,7 @@ ReaderWriterLock::ReadHolder::~ReadHolder()
 {
 #ifndef DACCESS_COMPILE
     if (m_fLockAcquired)
-        m_pLock->ReleaseReadLock();
+        m_pLock->ReleaseReadLock(m_pIndicator);
 #endif // !DACCESS_COMPILE
 }
 
@@ -82,7 +108,13 @@ ReaderWriterLock::WriteHolder::~WriteHolder()
 }
 
 ReaderWriterLock::ReaderWriterLock() : 
-    m_RWLock(0)
+    m_RWLock(0),
+    m_fReadBiased(false),
+    m_cReaderIndicators(0),
+    m_pReaderIndicators(NULL),
+    m_pReaderIndicatorsAlloc(NULL),
+    m_inhibitBiasUntil(0),
+    m_fWriterPending(0)
 #if 0
     , m_WriterWaiting(false)
 #endif
@@ -92,6 +124,37 @@ ReaderWriterLock::ReaderWriterLock() :
         (PalGetProcessCpuCount() == 1) ? 0 : 
 #endif
         4000);
+
+#ifndef DACCESS_COMPILE
+    // Readers can't contend with each other on a single processor, so there is nothing to gain from the bias.
+    UInt32 cCpus = PalGetLogicalCpuCount();
+    if (cCpus <= 1)
+        return;
+
+    UInt32 cReaderIndicators = 1;
+    while ((cReaderIndicators < cCpus) && (cReaderIndicators < RWLOCK_MAX_READER_INDICATORS))
+        cReaderIndicators *= 2;
+
+    // Over-allocate by a cache line so the indicators can be aligned. If the allocation fails the lock simply
+    // never becomes read biased.
+    UInt8 * pAlloc = new (nothrow) UInt8[(cReaderIndicators + 1) * sizeof(ReaderIndicator)];
+    if (pAlloc == NULL)
+        return;
+
+    memset(pAlloc, 0, (cReaderIndicators + 1) * sizeof(ReaderIndicator));
+    m_pReaderIndicatorsAlloc = pAlloc;
+    m_pReaderIndicators = (ReaderIndicator *)ALIGN_UP((UIntNative)pAlloc, sizeof(ReaderIndicator));
+    m_cReaderIndicators = cReaderIndicators;
+    m_fReadBiased = true;
+#endif // !DACCESS_COMPILE
+}
+
+ReaderWriterLock::~ReaderWriterLock()
+{
+#ifndef DACCESS_COMPILE
+    ASSERT(m_RWLock == 0);
+    delete[] (UInt8 *)m_pReaderIndicatorsAlloc;
+#endif // !DACCESS_COMPILE
 }
 
 
@@ -106,16 +169,33 @@ ReaderWriterLock::ReaderWriterLock() :
 // only used to detect if a suspended thread owns the write lock to prevent
 // deadlock with the Hijack logic during GC suspension.
 //
+// The pulse only looks at the shared lock word (which is where a writer is recorded) and so never needs the
+// calling thread's reader indicator. That keeps it safe to call from the hijack callback.
+//
 bool ReaderWriterLock::DangerousTryPulseReadLock()
 {
     if (TryAcquireReadLock())
     {
-        ReleaseReadLock();
+        ReleaseReadLock(NULL);
         return true;
     }
     return false;
 }
 
+ReaderWriterLock::ReaderIndicator * ReaderWriterLock::GetReaderIndicator()
+{
+    ASSERT(m_cReaderIndicators != 0);
+
+    UInt32 uIndex = t_uReaderIndicatorIndex;
+    if (uIndex == 0)
+    {
+        uIndex = (UInt32)PalInterlockedIncrement(&g_uNextReaderIndicatorIndex);
+        t_uReaderIndicatorIndex = uIndex;
+    }
+
+    return &m_pReaderIndicators[(uIndex - 1) & (m_cReaderIndicators - 1)];
+}
+
 bool ReaderWriterLock::TryAcquireReadLock()
 {
     Int32 RWLock;
@@ -132,12 +212,33 @@ bool ReaderWriterLock::TryAcquireReadLock()
     return true;
 }
 
-void ReaderWriterLock::AcquireReadLock()
+ReaderWriterLock::ReaderIndicator * ReaderWriterLock::AcquireReadLock()
 {
-    if (TryAcquireReadLock())
-        return;
+    if (m_fReadBiased)
+    {
+        // The interlocked increment is a full barrier, so either a revoking writer will see our indicator or we
+        // will see that the bias has been revoked.
+        ReaderIndicator * pIndicator = GetReaderIndicator();
+        PalInterlockedIncrement(&pIndicator->m_cReaders);
+        if (m_fReadBiased)
+            return pIndicator;
+
+        PalInterlockedDecrement(&pIndicator->m_cReaders);
+    }
+
+    if (!TryAcquireReadLock())
+        AcquireReadLockWorker();
+
+    // No writer can hold the write lock while we hold the read lock, so this is a safe point to restore the read
+    // bias once the inhibit period following the last revocation has passed. A writer which is still revoking
+    // the bias re-checks it once it has the write lock (see AcquireWriteLock).
+    if (!m_fReadBiased && (m_cReaderIndicators != 0) && !m_fWriterPending &&
+        ((Int32)(PalGetTickCount() - m_inhibitBiasUntil) >= 0))
+    {
+        m_fReadBiased = true;
+    }
 
-    AcquireReadLockWorker();
+    return NULL;
 }
 
 void ReaderWriterLock::AcquireReadLockWorker()
@@ -203,8 +304,16 @@ void ReaderWriterLock::AcquireReadLockWorker()
     }
 }
 
-void ReaderWriterLock::ReleaseReadLock()
+void ReaderWriterLock::ReleaseReadLock(ReaderIndicator * pIndicator)
 {
+    if (pIndicator != NULL)
+    {
+        Int32 cReaders = PalInterlockedDecrement(&pIndicator->m_cReaders);
+        ASSERT(cReaders >= 0);
+        UNREFERENCED_PARAMETER(cReaders);
+        return;
+    }
+
     Int32 RWLock;
     RWLock = PalInterlockedDecrement(&m_RWLock);
     ASSERT(RWLock >= 0);
@@ -227,24 +336,53 @@ bool ReaderWriterLock::TryAcquireWriteLock()
     return true;
 }
 
-void ReaderWriterLock::AcquireWriteLock()
+// Called by the pending writer before it acquires the shared lock word. Stops new readers from using the reader
+// indicators and waits for the readers which already have to leave. Since the shared lock word is still free,
+// a reader which holds the lock through its indicator can meanwhile re-enter it through the shared lock word,
+// e.g. the GC thread enumerating the thread store while it has the thread store locked.
+void ReaderWriterLock::RevokeReadBias()
+{
+    UInt32 startTicks = PalGetTickCount();
+
+    m_fReadBiased = false;
+    PalMemoryBarrier();
+
+    UInt32 uSwitchCount = 0;
+    for (UInt32 i = 0; i < m_cReaderIndicators; i++)
+    {
+        Int32 spinCount = m_spinCount;
+        while (m_pReaderIndicators[i].m_cReaders != 0)
+        {
+            if (spinCount > 0)
+            {
+                spinCount--;
+                PalYieldProcessor();
+            }
+            else
+            {
+                __SwitchToThread(0, ++uSwitchCount);
+            }
+        }
+    }
+
+    UInt32 elapsedTicks = PalGetTickCount() - startTicks;
+    m_inhibitBiasUntil = PalGetTickCount() + max(1u, elapsedTicks * READ_BIAS_INHIBIT_MULTIPLIER);
+}
+
+// Spins, backing off exponentially, until pfnTryAcquire succeeds.
+void ReaderWriterLock::SpinToAcquire(bool (ReaderWriterLock::*pfnTryAcquire)())
 {
     UInt32 uSwitchCount = 0;
 
     for (;;)
     {
-        if (TryAcquireWriteLock())
+        if ((this->*pfnTryAcquire)())
             return;
 
-#if 0
-        // Set the writer waiting word, if not already set, to notify potential readers to wait.
-        m_WriterWaiting = true;
-#endif
-
         UInt32 uDelay = g_SpinConstants.uInitialDuration;
         do
         {
-            if (TryAcquireWriteLock())
+            if ((this->*pfnTryAcquire)())
                 return;
 
             if (g_SystemInfo.dwNumberOfProcessors <= 1)
@@ -278,10 +416,37 @@ void ReaderWriterLock::AcquireWriteLock()
     }
 }
 
+bool ReaderWriterLock::TryBecomePendingWriter()
+{
+    return PalInterlockedCompareExchange(&m_fWriterPending, 1, 0) == 0;
+}
+
+void ReaderWriterLock::AcquireWriteLock()
+{
+    SpinToAcquire(&ReaderWriterLock::TryBecomePendingWriter);
+
+    for (;;)
+    {
+        if (m_fReadBiased)
+            RevokeReadBias();
+
+        SpinToAcquire(&ReaderWriterLock::TryAcquireWriteLock);
+
+        // The bias can only have been restored by a reader which checked m_fWriterPending before we set it. It
+        // may have let more readers in through their indicators, so give the lock word back and revoke again.
+        if (!m_fReadBiased)
+            return;
+
+        PalInterlockedExchange(&m_RWLock, 0);
+    }
+}
+
 void ReaderWriterLock::ReleaseWriteLock()
 {
     Int32 RWLock;
     RWLock = PalInterlockedExchange(&m_RWLock, 0);
     ASSERT(RWLock == -1);
+
+    m_fWriterPending = 0;
 }
 #endif // DACCESS_COMPILE
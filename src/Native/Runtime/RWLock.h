@@ -2,10 +2,42 @@
 // The .NET Foundation licenses this file to you under the MIT license.
 // See the LICENSE file in the project root for more information.
 
+// Maximum number of per-thread reader indicators a lock will use.
+#define RWLOCK_MAX_READER_INDICATORS 64
+
+// Initialize the spin constants shared by the runtime's spin locks based on the number of processors.
+void InitializeSpinConstants();
+
+//
+// ReaderWriterLock is heavily biased towards readers. While the lock is "read biased" readers don't touch the
+// shared lock word at all: each reader instead increments one of a set of reader indicators (selected per thread
+// and each on its own cache line), so readers on different processors don't contend with each other. A writer
+// first revokes the bias and waits for all the reader indicators to drain, and only then acquires the shared lock
+// word. Until it does, readers which find the bias revoked (including a thread re-entering a read lock it already
+// holds through its indicator) go through the shared lock word rather than waiting for the writer. Writers are
+// serialized by m_fWriterPending so that only one of them revokes the bias at a time. After a revocation readers use the shared lock word for a while (in proportion to how long the revocation
+// took) before the bias is restored, so that locks which do see frequent writes aren't penalized by repeated
+// revocations.
+//
 class ReaderWriterLock
 {
-    volatile Int32  m_RWLock;       // lock used for R/W synchronization
-    Int32           m_spinCount;    // spin count for a reader waiting for a writer to release the lock
+public:
+    struct ReaderIndicator
+    {
+        volatile Int32  m_cReaders;
+        UInt8           m_padding[64 - sizeof(Int32)];
+    };
+
+private:
+    volatile Int32      m_RWLock;       // lock used for R/W synchronization
+    Int32               m_spinCount;    // spin count for a reader waiting for a writer to release the lock
+
+    volatile bool       m_fReadBiased;              // readers may use the reader indicators
+    UInt32              m_cReaderIndicators;        // power of 2, or 0 if the lock can never be read biased
+    ReaderIndicator *   m_pReaderIndicators;        // cache line aligned
+    void *              m_pReaderIndicatorsAlloc;   // allocation backing m_pReaderIndicators
+    volatile UInt32     m_inhibitBiasUntil;         // tick count before which the read bias will not be restored
+    volatile Int32      m_fWriterPending;           // a writer is revoking the bias or holds the write lock
 
 #if 0
     // used to prevent writers from being starved by readers
@@ -16,12 +48,18 @@ class ReaderWriterLock
 
     bool TryAcquireReadLock();
     bool TryAcquireWriteLock();
+    bool TryBecomePendingWriter();
+    void SpinToAcquire(bool (ReaderWriterLock::*pfnTryAcquire)());
+
+    ReaderIndicator * GetReaderIndicator();
+    void RevokeReadBias();
 
 public:
     class ReadHolder
     {
         ReaderWriterLock * m_pLock;
         bool               m_fLockAcquired;
+        ReaderIndicator *  m_pIndicator;
     public:
         ReadHolder(ReaderWriterLock * pLock, bool fAcquireLock = true);
         ~ReadHolder();
@@ -37,9 +75,12 @@ public:
     };
 
     ReaderWriterLock();
+    ~ReaderWriterLock();
 
-    void AcquireReadLock();
-    void ReleaseReadLock();
+    // Returns the reader indicator the lock was acquired through, or NULL if it was acquired through the shared
+    // lock word. The result must be passed to the matching ReleaseReadLock, which may run on another thread.
+    ReaderIndicator * AcquireReadLock();
+    void ReleaseReadLock(ReaderIndicator * pIndicator);
 
     bool DangerousTryPulseReadLock();
 
@@ -15,9 +15,20 @@
 DEBUG_CONFIG_VALUE_WITH_DEFAULT(BreakOnAssert, 1) 
 
 RETAIL_CONFIG_VALUE(HeapVerify)
+RETAIL_CONFIG_VALUE(HeapVerifyThreads)      // Number of threads verifying the heap in parallel (HeapVerify), the GC thread only when left unspecified
+RETAIL_CONFIG_VALUE(HeapVerifySamplePercent) // Percentage of the segments verified at each GC (HeapVerify), all of them when left unspecified
 RETAIL_CONFIG_VALUE(StressLogLevel)
 RETAIL_CONFIG_VALUE(TotalStressLogSize)
+RETAIL_CONFIG_VALUE(StressLogToFile)        // Keep the stress log in rhstresslog-<pid>.log in the temp directory so it can be read live or after a crash
 RETAIL_CONFIG_VALUE(DisableBGC)
+RETAIL_CONFIG_VALUE(GCTypeHistogram)        // Count live objects and bytes by type during blocking gen2 GCs, see RhGetTypeHistogram
+RETAIL_CONFIG_VALUE(FinalizerThreadCount)   // Number of threads running finalizers, a single thread when left unspecified
+RETAIL_CONFIG_VALUE(AllocationSamplingInterval) // Mean number of bytes allocated between allocation samples, sampling is disabled when left unspecified
+RETAIL_CONFIG_VALUE(PerfMapEnabled)         // Write /tmp/perf-<pid>.map describing managed code and stubs for perf (Unix only)
+RETAIL_CONFIG_VALUE(BinaryTraceKeywords)    // Start a binary trace session writing /tmp/rhtrace-<pid>.bin at startup for the given keywords (Unix only)
+RETAIL_CONFIG_VALUE(BinaryTraceLevel)       // Level of the startup binary trace session, defaults to informational (4)
+RETAIL_CONFIG_VALUE(CrstContentionStats)    // Count acquires, contended acquires and wait time of each kind of Crst, see RhGetCrstContentionStats
+RETAIL_CONFIG_VALUE(StartupTimeline)        // Write the startup timeline to rhstartup-<pid>.json in the temp directory before calling Main, see StartupTimeline.h
 DEBUG_CONFIG_VALUE(DisallowRuntimeServicesFallback)
 DEBUG_CONFIG_VALUE(GcStressThrottleMode)    // gcstm_TriggerAlways / gcstm_TriggerOnFirstHit / gcstm_TriggerRandom
 DEBUG_CONFIG_VALUE(GcStressFreqCallsite)    // Number of times to force GC out of GcStressFreqDenom (for GCSTM_RANDOM)
@@ -26,6 +26,9 @@
 #include "StackFrameIterator.h"
 #include "thread.h"
 #include "DebugEventSource.h"
+#include "PerfMap.h"
+#include "StartupTimeline.h"
+#include "Volatile.h"
 
 #include "CommonMacros.inl"
 #include "slist.inl"
@@ -296,6 +299,18 @@ struct GenericTypeTraits : public DefaultSHashTraits<PTR_GenericInstanceDesc>
 
 class GenericTypeHashTable : public SHash< NoRemoveSHashTraits < GenericTypeTraits > >
 {
+public:
+    GenericTypeHashTable() : m_pNextRetired(NULL) {}
+
+    // Link for RuntimeInstance::m_pRetiredGenericTypeHashTables
+    GenericTypeHashTable * m_pNextRetired;
+
+    // Returns true if an element can be added without the underlying table being reallocated (and therefore
+    // without disturbing concurrent lookups). Elements are never removed so every occupied slot is counted.
+    bool CanAddWithoutGrowing()
+    {
+        return GetCount() < GetCapacity();
+    }
 };
 
 #ifndef DACCESS_COMPILE
@@ -349,6 +364,78 @@ bool RuntimeInstance::BuildGenericTypeHashTable()
     return true;
 }
 
+// Add a GenericInstanceDesc to the generic type hash table in a manner that is safe in the presence of
+// concurrent lock-free lookups. The caller must hold m_GenericHashTableLock for write and the GID must be
+// fully initialized.
+bool RuntimeInstance::AddToGenericTypeHashTable(GenericInstanceDesc * pGid)
+{
+    GenericTypeHashTable * pTable = m_pGenericTypeHashTable;
+    ASSERT(pTable != NULL);
+
+    // Make sure the contents of the GID are visible to other threads before the GID itself is.
+    PalMemoryBarrier();
+
+    if (pTable->CanAddWithoutGrowing())
+    {
+        // Lookups will observe either an empty slot or the fully initialized GID.
+        return pTable->Add(pGid);
+    }
+
+    // Copy the existing entries into a larger table, add the new entry and publish the result. The old table
+    // may still be in use by lookups on other threads so it can't be deleted until the next GC.
+    GenericTypeHashTable * pNewTable = new (nothrow) GenericTypeHashTable();
+    if (pNewTable == NULL)
+        return false;
+
+    if (!pNewTable->CheckGrowth(pTable->GetCount() * 2 + 1))
+    {
+        delete pNewTable;
+        return false;
+    }
+
+    for (GenericTypeHashTable::Iterator it = pTable->Begin(), end = pTable->End(); it != end; it++)
+    {
+        if (!pNewTable->Add(*it))
+        {
+            delete pNewTable;
+            return false;
+        }
+    }
+
+    if (!pNewTable->Add(pGid))
+    {
+        delete pNewTable;
+        return false;
+    }
+
+    PalInterlockedExchangePointer((void**)&m_pGenericTypeHashTable, pNewTable);
+    RetireGenericTypeHashTable(pTable);
+
+    return true;
+}
+
+// Queue a generic type hash table that is no longer published for deletion at the next GC. The caller must
+// hold m_GenericHashTableLock for write.
+void RuntimeInstance::RetireGenericTypeHashTable(GenericTypeHashTable * pTable)
+{
+    pTable->m_pNextRetired = m_pRetiredGenericTypeHashTables;
+    m_pRetiredGenericTypeHashTables = pTable;
+}
+
+void RuntimeInstance::ReclaimRetiredGenericTypeHashTables()
+{
+    // No need for any locks, we're not racing with any other threads any more.
+    GenericTypeHashTable * pTable = m_pRetiredGenericTypeHashTables;
+    m_pRetiredGenericTypeHashTables = NULL;
+
+    while (pTable != NULL)
+    {
+        GenericTypeHashTable * pNext = pTable->m_pNextRetired;
+        delete pTable;
+        pTable = pNext;
+    }
+}
+
 Module * RuntimeInstance::FindModuleByOsHandle(HANDLE hOsHandle)
 {
     FOREACH_MODULE(pModule)
@@ -366,6 +453,7 @@ RuntimeInstance::RuntimeInstance() :
     m_fStandaloneExeMode(false),
     m_pStandaloneExeModule(NULL),
     m_pGenericTypeHashTable(NULL),
+    m_pRetiredGenericTypeHashTables(NULL),
     m_conservativeStackReportingEnabled(false)
 {
 }
@@ -378,6 +466,8 @@ RuntimeInstance::~RuntimeInstance()
         m_pGenericTypeHashTable = NULL;
     }
 
+    ReclaimRetiredGenericTypeHashTables();
+
     if (NULL != m_pThreadStore)
     {
         delete m_pThreadStore;
@@ -435,11 +525,13 @@ bool RuntimeInstance::RegisterModule(ModuleHeader *pModuleHeader)
         // @TODO: This is obviously not ideal, we would be better of by incrementally adding
         //        types in the new module to the existing hashtable. Unfortunately today implementation
         //        doesn't expect the table to be growable.
+        // The table may still be in use by lookups on other threads, so it is retired rather than deleted.
         ReaderWriterLock::WriteHolder write(&m_GenericHashTableLock);
-        if (m_pGenericTypeHashTable != nullptr)
+        GenericTypeHashTable * pTable = m_pGenericTypeHashTable;
+        if (pTable != nullptr)
         {
-            delete m_pGenericTypeHashTable;
-            m_pGenericTypeHashTable = nullptr;
+            PalInterlockedExchangePointer((void**)&m_pGenericTypeHashTable, nullptr);
+            RetireGenericTypeHashTable(pTable);
         }
     }
 
@@ -483,6 +575,8 @@ bool RuntimeInstance::RegisterCodeManager(ICodeManager * pCodeManager, PTR_VOID
         m_CodeManagerList.PushHead(pEntry);
     }
 
+    PerfMap::LogCodeRange(pvStartRange, cbRange, "[dynamic code]");
+
     return true;
 }
 
@@ -511,7 +605,13 @@ void RuntimeInstance::UnregisterCodeManager(ICodeManager * pCodeManager)
 
 extern "C" bool __stdcall RegisterCodeManager(ICodeManager * pCodeManager, PTR_VOID pvStartRange, UInt32 cbRange)
 {
-    return GetRuntimeInstance()->RegisterCodeManager(pCodeManager, pvStartRange, cbRange);
+    UInt64 registrationBegin = StartupTimeline::BeginModuleRegistration();
+
+    if (!GetRuntimeInstance()->RegisterCodeManager(pCodeManager, pvStartRange, cbRange))
+        return false;
+
+    StartupTimeline::EndModuleRegistration(registrationBegin);
+    return true;
 }
 
 extern "C" void __stdcall UnregisterCodeManager(ICodeManager * pCodeManager)
@@ -593,6 +693,10 @@ void RuntimeInstance::UnsychronizedResetHijackedLoops()
     END_FOREACH_MODULE;
 }
 
+// Number of times LookupGenericInstance builds the generic type hash table before it gives up and scans the
+// modules instead.
+#define MAX_GENERIC_TYPE_HASH_TABLE_BUILDS 4
+
 // Given the EEType* for an instantiated generic type retrieve the GenericInstanceDesc associated with that
 // type. This is legal only for types that are guaranteed to have this metadata at runtime; generic types
 // which have variance over one or more of their type parameters and generic interfaces on array).
@@ -603,34 +707,40 @@ GenericInstanceDesc * RuntimeInstance::LookupGenericInstance(EEType * pEEType)
     if (pEEType->IsCloned())
         pEEType = pEEType->get_CanonicalEEType();
 
-    if (m_pGenericTypeHashTable == NULL)
+    // No lock is required here: the table is never reallocated in place and any table we observe remains
+    // valid until the next GC (and we're in cooperative mode, so that can't happen during the lookup). A module
+    // registration can retire the table right after we build it though, so rebuild it a bounded number of times.
+    GenericTypeHashTable * pTable = NULL;
+    for (int iAttempt = 0; iAttempt < MAX_GENERIC_TYPE_HASH_TABLE_BUILDS; iAttempt++)
     {
-        if (!BuildGenericTypeHashTable())
-        {
-            // We failed the allocation but we don't want to fail the call (because we build this table lazily
-            // we're doing the allocation at a point the caller doesn't expect can fail). So fall back to the
-            // slow linear scan of all variant GIDs in this case.
+        pTable = VolatileLoad(&m_pGenericTypeHashTable);
+        if ((pTable != NULL) || !BuildGenericTypeHashTable())
+            break;
+    }
 
-            FOREACH_MODULE(pModule)
+    if (pTable == NULL)
+    {
+        // We failed the allocation (or kept losing the table to module registrations) but we don't want to
+        // fail the call (because we build this table lazily we're doing the allocation at a point the caller
+        // doesn't expect can fail). So fall back to the slow linear scan of all variant GIDs in this case.
+
+        FOREACH_MODULE(pModule)
+        {
+            Module::GenericInstanceDescEnumerator gidEnumerator(pModule, Module::GenericInstanceDescKind::VariantGenericInstances);
+            GenericInstanceDesc * pGid;
+            while ((pGid = gidEnumerator.Next()) != NULL)
             {
-                Module::GenericInstanceDescEnumerator gidEnumerator(pModule, Module::GenericInstanceDescKind::VariantGenericInstances);
-                GenericInstanceDesc * pGid;
-                while ((pGid = gidEnumerator.Next()) != NULL)
-                {
-                    if (pGid->GetEEType() == pEEType)
-                        return pGid;
-                }
+                if (pGid->GetEEType() == pEEType)
+                    return pGid;
             }
-            END_FOREACH_MODULE;
-
-            // It is not legal to call this API unless you know there is a matching GenericInstanceDesc.
-            UNREACHABLE();
         }
-    }
+        END_FOREACH_MODULE;
 
-    ReaderWriterLock::ReadHolder read(&m_GenericHashTableLock);
+        // It is not legal to call this API unless you know there is a matching GenericInstanceDesc.
+        UNREACHABLE();
+    }
 
-    const PTR_GenericInstanceDesc * ppGid = m_pGenericTypeHashTable->LookupPtr(pEEType);
+    const PTR_GenericInstanceDesc * ppGid = pTable->LookupPtr(pEEType);
     if (ppGid != NULL)
         return *ppGid;
 
@@ -753,7 +863,14 @@ bool RuntimeInstance::CreateGenericInstanceDesc(EEType *             pEEType,
 
     ReaderWriterLock::WriteHolder write(&m_GenericHashTableLock);
 
-    if (!m_pGenericTypeHashTable->Add(pGid))
+    // The table may have been retired by a module registration since we checked above.
+    if (m_pGenericTypeHashTable == NULL)
+    {
+        if (!BuildGenericTypeHashTable())
+            return false;
+    }
+
+    if (!AddToGenericTypeHashTable(pGid))
         return false;
 
     if (gcStaticDataSize > 0 || pGid->HasThreadStaticFields())
@@ -1027,6 +1144,8 @@ COOP_PINVOKE_HELPER(void *, RhAllocateThunksFromTemplate, (PTR_UInt8 moduleBase,
     if (PalAllocateThunksFromTemplate((HANDLE)moduleBase, templateRva, templateSize, &pThunkMap) == FALSE)
         return NULL;
 
+    PerfMap::LogThunks(pThunkMap, templateSize, moduleBase + templateRva);
+
     return pThunkMap;
 }
 
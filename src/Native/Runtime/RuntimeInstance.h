@@ -65,10 +65,16 @@ class RuntimeInstance
     // mode we report the GenericInstanceDescs directly from the module itself.
     PTR_GenericInstanceDesc     m_genericInstReportList;
 
+    // Serializes updates to m_pGenericTypeHashTable. Lookups never take this lock: entries are only ever added
+    // in place while the table has spare capacity and otherwise the table is copied into a larger one which is
+    // then published atomically. Tables replaced in this way may still be in use by concurrent lookups so they
+    // are queued on m_pRetiredGenericTypeHashTables and deleted during the next GC (when no lookups can be in
+    // progress since all callers run in cooperative mode).
     ReaderWriterLock            m_GenericHashTableLock;
 
     // This is used (in standalone mode only) to build an on-demand hash tables of all generic instantiations
     PTR_GenericTypeHashTable            m_pGenericTypeHashTable;
+    PTR_GenericTypeHashTable            m_pRetiredGenericTypeHashTables;
 
     bool                        m_conservativeStackReportingEnabled;
 
@@ -77,6 +83,8 @@ class RuntimeInstance
     SList<Module>* GetModuleList();
 
     bool BuildGenericTypeHashTable();
+    bool AddToGenericTypeHashTable(GenericInstanceDesc * pGid);
+    void RetireGenericTypeHashTable(GenericTypeHashTable * pTable);
 
 public:
     class ModuleIterator
@@ -128,6 +136,10 @@ public:
     void EnableGcPollStress();
     void UnsychronizedResetHijackedLoops();
 
+    // Called during a GC (when no lookups can be in progress) to free generic type hash tables that have been
+    // replaced since the last GC.
+    void ReclaimRetiredGenericTypeHashTables();
+
     // Given the EEType* for an instantiated generic type retrieve the GenericInstanceDesc associated with
     // that type. This is legal only for types that are guaranteed to have this metadata at runtime; generic
     // types which have variance over one or more of their type parameters and generic interfaces on array).
@@ -41,8 +41,33 @@
         }                                                               \
     }
 
+// Number of iterations after which a spinning waiter starts yielding its processor with __SwitchToThread.
+#define SPINLOCK_SPINS_BEFORE_YIELD     1024
+
+// Upper bound on the number of PalYieldProcessor calls between two looks at a contended lock.
+#define SPINLOCK_MAX_BACKOFF            256
+
+//
+// SpinLock comes in two flavors, selected when the lock is constructed:
+//
+//  - Test-and-test-and-set (the default): waiters spin reading the lock word, which stays in their own
+//    caches until the owner releases the lock, and only then attempt the interlocked exchange. Failed attempts
+//    back off exponentially so that a release doesn't trigger a storm of exchanges. Cheapest when the lock is
+//    rarely contended.
+//
+//  - Queued (MCS): each waiter links a node, which lives in its Holder, onto a queue and spins on a flag in
+//    that node. The owner hands the lock directly to its successor, so waiters are served in FIFO order and
+//    each spins on its own cache line. Use this for locks known to be contended by many threads.
+//
 class SpinLock
 {
+public:
+    enum LockKind
+    {
+        TestAndTestAndSet,
+        Queued
+    };
+
 private:
     enum LOCK_STATE
     {
@@ -50,23 +75,119 @@ private:
         LOCKED = 1
     };
 
-    volatile Int32 m_lock;
+    struct QueueNode
+    {
+        QueueNode * m_pNext;
+        Int32       m_fWaiting;
+    };
+
+    volatile Int32  m_lock;         // used by TestAndTestAndSet locks
+    QueueNode *     m_pQueueTail;   // used by Queued locks, NULL when the lock is free
+    LockKind        m_kind;
+
+    static void Backoff(UInt32 * puBackoff, UInt32 * puSpinCount, UInt32 * puSwitchCount)
+    {
+        if (++(*puSpinCount) < SPINLOCK_SPINS_BEFORE_YIELD)
+        {
+            for (UInt32 i = 0; i < *puBackoff; i++)
+                PalYieldProcessor();
 
-    static void Lock(SpinLock& lock)
-        { YIELD_WHILE (PalInterlockedExchange(&lock.m_lock, LOCKED) == LOCKED); }
+            if (*puBackoff < SPINLOCK_MAX_BACKOFF)
+                *puBackoff *= 2;
+        }
+        else
+        {
+            // See #SwitchToThreadSpinning
+            __SwitchToThread(0, ++(*puSwitchCount));
+        }
+    }
+
+    void AcquireTestAndTestAndSet()
+    {
+        UInt32 uBackoff = 1;
+        UInt32 uSpinCount = 0;
+        UInt32 uSwitchCount = 0;
 
-    static void Unlock(SpinLock& lock)
-        { PalInterlockedExchange(&lock.m_lock, UNLOCKED); }
+        for (;;)
+        {
+            if ((m_lock == UNLOCKED) && (PalInterlockedExchange(&m_lock, LOCKED) == UNLOCKED))
+                return;
+
+            Backoff(&uBackoff, &uSpinCount, &uSwitchCount);
+        }
+    }
+
+    void ReleaseTestAndTestAndSet()
+    {
+        PalInterlockedExchange(&m_lock, UNLOCKED);
+    }
+
+    void AcquireQueued(QueueNode * pNode)
+    {
+        pNode->m_pNext = NULL;
+        pNode->m_fWaiting = 1;
+
+        QueueNode * pPredecessor = (QueueNode *)PalInterlockedExchangePointer(&m_pQueueTail, pNode);
+        if (pPredecessor == NULL)
+            return;
+
+        VolatileStore(&pPredecessor->m_pNext, pNode);
+
+        // No backoff needed here since nobody else is spinning on our node.
+        UInt32 uSpinCount = 0;
+        UInt32 uSwitchCount = 0;
+        while (VolatileLoad(&pNode->m_fWaiting))
+        {
+            if (++uSpinCount < SPINLOCK_SPINS_BEFORE_YIELD)
+                PalYieldProcessor();
+            else
+                __SwitchToThread(0, ++uSwitchCount);
+        }
+    }
+
+    void ReleaseQueued(QueueNode * pNode)
+    {
+        QueueNode * pSuccessor = VolatileLoad(&pNode->m_pNext);
+        if (pSuccessor == NULL)
+        {
+            if (PalInterlockedCompareExchangePointer(&m_pQueueTail, NULL, pNode) == pNode)
+                return;
+
+            // A new waiter has swapped itself into the tail but not linked itself to us yet.
+            while ((pSuccessor = VolatileLoad(&pNode->m_pNext)) == NULL)
+                PalYieldProcessor();
+        }
+
+        VolatileStore(&pSuccessor->m_fWaiting, (Int32)0);
+    }
 
 public:
-    SpinLock()
-        : m_lock(UNLOCKED) { }
+    SpinLock(LockKind kind = TestAndTestAndSet)
+        : m_lock(UNLOCKED), m_pQueueTail(NULL), m_kind(kind) { }
 
-    typedef HolderNoDefaultValue<SpinLock&,
-                                 SpinLock::Lock,
-                                 SpinLock::Unlock>
-        Holder;
+    class Holder
+    {
+        SpinLock &  m_lock;
+        QueueNode   m_node;     // this thread's place in the queue of a Queued lock
+
+    public:
+        Holder(SpinLock & lock)
+            : m_lock(lock)
+        {
+            if (m_lock.m_kind == Queued)
+                m_lock.AcquireQueued(&m_node);
+            else
+                m_lock.AcquireTestAndTestAndSet();
+        }
+
+        ~Holder()
+        {
+            if (m_lock.m_kind == Queued)
+                m_lock.ReleaseQueued(&m_node);
+            else
+                m_lock.ReleaseTestAndTestAndSet();
+        }
+    };
 };
 
 #endif
-
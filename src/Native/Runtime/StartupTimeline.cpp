@@ -0,0 +1,226 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Startup timeline recording and report, see StartupTimeline.h.
+//
+
+#include "common.h"
+#include "CommonTypes.h"
+#include "CommonMacros.h"
+#include "daccess.h"
+#include "PalRedhawkCommon.h"
+#include "PalRedhawk.h"
+#include "rhassert.h"
+#include "RhConfig.h"
+#include "StartupTimeline.h"
+
+#ifndef DACCESS_COMPILE
+
+unsigned __int64 g_startupTimelineEvents[NUM_STARTUP_TIMELINE_EVENTS] = { 0 };
+
+UInt32 StartupTimeline::s_cModulesRegistered = 0;
+UInt64 StartupTimeline::s_moduleRegistrationTicks = 0;
+bool StartupTimeline::s_fComplete = false;
+
+static const char * const c_eventNames[NUM_STARTUP_TIMELINE_EVENTS] =
+{
+    "pal_init_begin",
+    "process_attach_begin",
+    "nongc_init_complete",
+    "gc_heap_init_complete",
+    "gc_init_complete",
+    "process_attach_complete",
+    "initialize_modules_begin",
+    "eager_cctors_begin",
+    "initialize_modules_complete",
+    "managed_main_begin",
+};
+
+struct StartupTimelinePhase
+{
+    const char *                pszName;
+    STARTUP_TIMELINE_EVENT_ID   beginEvent;
+    STARTUP_TIMELINE_EVENT_ID   endEvent;
+};
+
+static const StartupTimelinePhase c_phases[] =
+{
+    { "pal_init",               PAL_INIT_BEGIN,             PROCESS_ATTACH_BEGIN },
+    { "init_dll",               PROCESS_ATTACH_BEGIN,       PROCESS_ATTACH_COMPLETE },
+    { "runtime_instance_init",  PROCESS_ATTACH_BEGIN,       NONGC_INIT_COMPLETE },       // includes interface dispatch
+    { "gc_heap_init",           NONGC_INIT_COMPLETE,        GC_HEAP_INIT_COMPLETE },     // includes the finalizer thread
+    { "handle_table_init",      GC_HEAP_INIT_COMPLETE,      GC_INIT_COMPLETE },
+    { "attach_to_managed",      PROCESS_ATTACH_COMPLETE,    INITIALIZE_MODULES_BEGIN },  // module registration and thread attach
+    { "initialize_modules",     INITIALIZE_MODULES_BEGIN,   INITIALIZE_MODULES_COMPLETE },
+    { "global_tables",          INITIALIZE_MODULES_BEGIN,   EAGER_CCTORS_BEGIN },        // module managers, strings and statics
+    { "eager_cctors",           EAGER_CCTORS_BEGIN,         INITIALIZE_MODULES_COMPLETE },
+    { "total",                  PAL_INIT_BEGIN,             MANAGED_MAIN_BEGIN },
+};
+
+#define STARTUP_TIMELINE_REPORT_SIZE 2048
+
+static UInt64 QueryTicks()
+{
+    LARGE_INTEGER ticks;
+    PalQueryPerformanceCounter(&ticks);
+    return (UInt64)ticks.QuadPart;
+}
+
+// Append at most pchLimit - pch characters of the string.
+static char * AppendString(char * pch, char * pchLimit, const char * psz)
+{
+    while ((*psz != '\0') && (pch < pchLimit))
+        *pch++ = *psz++;
+
+    return pch;
+}
+
+static char * AppendDecimal(char * pch, char * pchLimit, UInt64 value)
+{
+    char rgch[20];
+    int cch = 0;
+    do
+    {
+        rgch[cch++] = (char)('0' + (value % 10));
+        value /= 10;
+    }
+    while (value != 0);
+
+    while ((cch > 0) && (pch < pchLimit))
+        *pch++ = rgch[--cch];
+
+    return pch;
+}
+
+// Append the duration of the given number of ticks in microseconds, with three decimals.
+static char * AppendMicroseconds(char * pch, char * pchLimit, UInt64 ticks, UInt64 frequency)
+{
+    UInt64 ns = (ticks / frequency) * 1000000000 + ((ticks % frequency) * 1000000000) / frequency;
+
+    pch = AppendDecimal(pch, pchLimit, ns / 1000);
+    pch = AppendString(pch, pchLimit, ".");
+    UInt32 fraction = (UInt32)(ns % 1000);
+    if (fraction < 100)
+        pch = AppendString(pch, pchLimit, (fraction < 10) ? "00" : "0");
+    return AppendDecimal(pch, pchLimit, fraction);
+}
+
+void StartupTimeline::RecordEvent(STARTUP_TIMELINE_EVENT_ID eventId)
+{
+    g_startupTimelineEvents[eventId] = QueryTicks();
+}
+
+void StartupTimeline::Complete()
+{
+    RecordEvent(MANAGED_MAIN_BEGIN);
+    s_fComplete = true;
+
+    if (g_pRhConfig->GetStartupTimeline() != 0)
+        WriteReport();
+}
+
+UInt64 StartupTimeline::BeginModuleRegistration()
+{
+    return s_fComplete ? 0 : QueryTicks();
+}
+
+void StartupTimeline::EndModuleRegistration(UInt64 beginTicks)
+{
+    if (s_fComplete || (beginTicks == 0))
+        return;
+
+    s_cModulesRegistered++;
+    s_moduleRegistrationTicks += QueryTicks() - beginTicks;
+}
+
+void StartupTimeline::WriteReport()
+{
+    LARGE_INTEGER frequency;
+    PalQueryPerformanceFrequency(&frequency);
+    UInt64 ticksPerSecond = (UInt64)frequency.QuadPart;
+
+    // The clock isn't guaranteed to be monotonic everywhere, take the earliest event as the start.
+    UInt64 startTicks = 0;
+    for (int i = 0; i < NUM_STARTUP_TIMELINE_EVENTS; i++)
+    {
+        UInt64 ticks = g_startupTimelineEvents[i];
+        if ((ticks != 0) && ((startTicks == 0) || (ticks < startTicks)))
+            startTicks = ticks;
+    }
+
+    char szReport[STARTUP_TIMELINE_REPORT_SIZE];
+    char * pchLimit = szReport + sizeof(szReport);
+
+    char * pch = AppendString(szReport, pchLimit, "{\n  \"pid\": ");
+    pch = AppendDecimal(pch, pchLimit, PalGetCurrentProcessId());
+    pch = AppendString(pch, pchLimit, ",\n  \"frequency\": ");
+    pch = AppendDecimal(pch, pchLimit, ticksPerSecond);
+    pch = AppendString(pch, pchLimit, ",\n  \"start\": ");
+    pch = AppendDecimal(pch, pchLimit, startTicks);
+
+    pch = AppendString(pch, pchLimit, ",\n  \"events\": {");
+    const char * pszSeparator = "\n    ";
+    for (int i = 0; i < NUM_STARTUP_TIMELINE_EVENTS; i++)
+    {
+        UInt64 ticks = g_startupTimelineEvents[i];
+        if (ticks == 0)
+            continue;
+
+        pch = AppendString(pch, pchLimit, pszSeparator);
+        pch = AppendString(pch, pchLimit, "\"");
+        pch = AppendString(pch, pchLimit, c_eventNames[i]);
+        pch = AppendString(pch, pchLimit, "\": ");
+        pch = AppendMicroseconds(pch, pchLimit, ticks - startTicks, ticksPerSecond);
+        pszSeparator = ",\n    ";
+    }
+
+    pch = AppendString(pch, pchLimit, "\n  },\n  \"phases\": {");
+    pszSeparator = "\n    ";
+    for (size_t i = 0; i < COUNTOF(c_phases); i++)
+    {
+        UInt64 beginTicks = g_startupTimelineEvents[c_phases[i].beginEvent];
+        UInt64 endTicks = g_startupTimelineEvents[c_phases[i].endEvent];
+        if ((beginTicks == 0) || (endTicks == 0))
+            continue;
+
+        pch = AppendString(pch, pchLimit, pszSeparator);
+        pch = AppendString(pch, pchLimit, "\"");
+        pch = AppendString(pch, pchLimit, c_phases[i].pszName);
+        pch = AppendString(pch, pchLimit, "\": ");
+        pch = AppendMicroseconds(pch, pchLimit, (endTicks > beginTicks) ? (endTicks - beginTicks) : 0, ticksPerSecond);
+        pszSeparator = ",\n    ";
+    }
+
+    pch = AppendString(pch, pchLimit, "\n  },\n  \"module_registration\": { \"count\": ");
+    pch = AppendDecimal(pch, pchLimit, s_cModulesRegistered);
+    pch = AppendString(pch, pchLimit, ", \"us\": ");
+    pch = AppendMicroseconds(pch, pchLimit, s_moduleRegistrationTicks, ticksPerSecond);
+    pch = AppendString(pch, pchLimit, " }\n}\n");
+
+    char szFileName[PAL_MAX_OUTPUT_FILE_NAME];
+    if (!PalGetOutputFileName("rhstartup", ".json", szFileName, sizeof(szFileName)))
+        return;
+
+    HANDLE hFile = PalCreateOutputFile(szFileName);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return;
+
+    PalWriteOutputFile(hFile, szReport, (UInt32)(pch - szReport));
+    PalCloseHandle(hFile);
+}
+
+COOP_PINVOKE_HELPER(void, RhpRecordStartupTimelineEvent, (UInt32 eventId))
+{
+    if (eventId < NUM_STARTUP_TIMELINE_EVENTS)
+        StartupTimeline::RecordEvent((STARTUP_TIMELINE_EVENT_ID)eventId);
+}
+
+// Called by the bootstrapper right before Main, in preemptive mode since the report is written to a file.
+EXTERN_C REDHAWK_API void __cdecl RhpCompleteStartupTimeline()
+{
+    StartupTimeline::Complete();
+}
+
+#endif // !DACCESS_COMPILE
@@ -0,0 +1,53 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Startup timeline: where the time goes between the bootstrapper starting to initialize the runtime and the
+// first call to managed Main.
+//
+// The runtime, the bootstrapper and StartupCodeHelpers record the STARTUP_TIMELINE_EVENT_IDs (CommonMacros.h)
+// as startup goes through them, and the runtime keeps the time spent registering modules. Recording is always
+// on, it's a handful of performance counter reads. The bootstrapper completes the timeline through
+// RhpCompleteStartupTimeline just before Main is called and, when the StartupTimeline config value is set, the
+// timeline is then written to rhstartup-<pid>.json in the temp directory (see PalGetOutputFileName):
+//
+//   {
+//     "pid": 1234,
+//     "frequency": 1000000,                        performance counter ticks per second
+//     "start": 5678901234,                         performance counter at the first event
+//     "events": { "pal_init_begin": 0.000, ... },  microseconds since the first event, in startup order
+//     "phases": { "pal_init": 152.000, ... },      microseconds, see c_phases in StartupTimeline.cpp
+//     "module_registration": { "count": 1, "us": 35.000 }
+//   }
+//
+// Events that weren't recorded, e.g. the bootstrapper ones when the runtime is hosted some other way, are left
+// out along with the phases they bound.
+//
+
+#ifndef __StartupTimeline_h__
+#define __StartupTimeline_h__
+
+class StartupTimeline
+{
+public:
+    static void RecordEvent(STARTUP_TIMELINE_EVENT_ID eventId);
+
+    // Record MANAGED_MAIN_BEGIN and write the report if it's enabled. The report is written to a file, this must
+    // not be called in cooperative mode.
+    static void Complete();
+
+    // Bracket the registration of a module, the time in between is accounted to module registration until the
+    // timeline is complete.
+    static UInt64 BeginModuleRegistration();
+    static void EndModuleRegistration(UInt64 beginTicks);
+
+private:
+    static void WriteReport();
+
+    static UInt32 s_cModulesRegistered;
+    static UInt64 s_moduleRegistrationTicks;
+    static bool s_fComplete;
+};
+
+#endif // __StartupTimeline_h__
@@ -10,9 +10,13 @@
 #include "rhassert.h"
 #include "slist.h"
 #include "holder.h"
+#include "Volatile.h"
 #include "SpinLock.h"
+#include "RWLock.h"
+#include "RuntimeInstance.h"
 #include "rhbinder.h"
 #include "CachedInterfaceDispatch.h"
+#include "TypeCastCache.h"
 
 #include "SyncClean.hpp"
 
@@ -27,4 +31,10 @@ void SyncClean::CleanUp ()
     // Update any interface dispatch caches that were unsafe to modify outside of this GC.
     ReclaimUnusedInterfaceDispatchCaches();
 #endif
+
+    // Reset the type cast cache if it filled up since the last GC.
+    FlushTypeCastCacheIfSaturated();
+
+    // Free any generic type hash tables that were replaced since the last GC.
+    GetRuntimeInstance()->ReclaimRetiredGenericTypeHashTables();
 }
@@ -0,0 +1,172 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+// ==--==
+//
+// A fixed size, lock-free, open addressed cache of type cast results keyed by (source EEType, target EEType).
+//
+// The managed type cast helpers (RhTypeCast_IsInstanceOfClass, RhTypeCast_IsInstanceOfArray,
+// RhTypeCast_CheckCastInterface etc.) probe this cache before walking parent chains, interface maps and
+// generic variance information. The cache records only the relationship between the two types: results which
+// depend on the object instance (ICastable) are never cached.
+//
+// Entries are write-once between garbage collections: a writer claims an empty entry by atomically swapping
+// in the source type and then publishes the target type (with the result encoded in its low bit). Readers
+// therefore never observe a torn entry; an entry which has been claimed but not yet published simply looks
+// like a mismatch. Both the probe and update helpers run in cooperative mode, so during a GC no reader or
+// writer can be active and the cache can be reset wholesale if it has filled up.
+//
+// ============================================================================
+#include "common.h"
+#include "CommonTypes.h"
+#include "CommonMacros.h"
+#include "daccess.h"
+#include "PalRedhawkCommon.h"
+#include "PalRedhawk.h"
+#include "rhassert.h"
+#include "TargetPtrs.h"
+#include "eetype.h"
+#include "Volatile.h"
+#include "TypeCastCache.h"
+
+#ifndef DACCESS_COMPILE
+
+// The cache always has a power of 2 number of entries.
+#define CAST_CACHE_SIZE_LOG2    12
+#define CAST_CACHE_SIZE         (1 << CAST_CACHE_SIZE_LOG2)
+
+// Maximum number of consecutive entries examined for a single (source, target) pair before giving up.
+#define CAST_CACHE_MAX_PROBES   8
+
+// EETypes are always pointer aligned, so the low bit of the target type is free to hold the cast result.
+#define CAST_CACHE_RESULT_MASK  ((UIntNative)1)
+
+//#define FEATURE_CAST_CACHE_STATS 1
+
+#ifdef FEATURE_CAST_CACHE_STATS
+
+// Some counters used for debugging and profiling the cache.
+extern "C"
+{
+    UInt32 CCC_g_cHits = 0;
+    UInt32 CCC_g_cMisses = 0;
+    UInt32 CCC_g_cInserts = 0;
+    UInt32 CCC_g_cInsertFailures = 0;
+    UInt32 CCC_g_cFlushes = 0;
+};
+
+#define CCC_COUNTER_INC(_counter_name) CCC_g_c##_counter_name++
+
+#else
+
+#define CCC_COUNTER_INC(_counter_name)
+
+#endif // FEATURE_CAST_CACHE_STATS
+
+struct TypeCastCacheEntry
+{
+    EEType *    m_pSourceType;          // Type of the object being cast, NULL for an unused entry
+    UIntNative  m_targetTypeAndResult;  // Target type of the cast ORed with the result (1 == castable)
+};
+
+static TypeCastCacheEntry g_rgCastCache[CAST_CACHE_SIZE];
+
+// Set when an insertion failed because all of the candidate entries were in use. The cache is reset at the
+// next GC in that case, since entries can't safely be replaced while other threads may be reading them.
+static bool g_fCastCacheSaturated = false;
+
+// Compute the index of the first entry to probe for the given type pair. The target type is rotated before
+// being combined so that (A, B) and (B, A) do not collide.
+static inline UInt32 CastCacheHash(EEType * pSourceType, EEType * pTargetType)
+{
+    UIntNative key = (UIntNative)pSourceType ^ (((UIntNative)pTargetType << 16) | ((UIntNative)pTargetType >> (sizeof(UIntNative) * 8 - 16)));
+#ifdef BIT64
+    return (UInt32)((key * 0x9E3779B97F4A7C15ull) >> (64 - CAST_CACHE_SIZE_LOG2));
+#else
+    return (UInt32)((key * 0x9E3779B9u) >> (32 - CAST_CACHE_SIZE_LOG2));
+#endif
+}
+
+// Look up the cached result of casting an object of type pSourceType to pTargetType. Returns one of the
+// CastCacheResult values.
+COOP_PINVOKE_HELPER(UInt32, RhpCheckCastCache, (EEType * pSourceType, EEType * pTargetType))
+{
+    UInt32 idx = CastCacheHash(pSourceType, pTargetType);
+
+    for (UInt32 i = 0; i < CAST_CACHE_MAX_PROBES; i++)
+    {
+        TypeCastCacheEntry * pEntry = &g_rgCastCache[(idx + i) & (CAST_CACHE_SIZE - 1)];
+
+        EEType * pEntrySourceType = VolatileLoad(&pEntry->m_pSourceType);
+
+        // Entries are claimed in probe order and never released outside of a GC, so an empty entry means
+        // the pair can't be further along the probe sequence.
+        if (pEntrySourceType == NULL)
+            break;
+
+        if (pEntrySourceType == pSourceType)
+        {
+            UIntNative targetTypeAndResult = VolatileLoad(&pEntry->m_targetTypeAndResult);
+            if ((targetTypeAndResult & ~CAST_CACHE_RESULT_MASK) == (UIntNative)pTargetType)
+            {
+                CCC_COUNTER_INC(Hits);
+                return (UInt32)(targetTypeAndResult & CAST_CACHE_RESULT_MASK);
+            }
+        }
+    }
+
+    CCC_COUNTER_INC(Misses);
+    return CastCacheResult_Miss;
+}
+
+// Record the result of casting an object of type pSourceType to pTargetType. If the cache has no room for
+// the pair the result is simply dropped (and the cache will be reset at the next GC).
+COOP_PINVOKE_HELPER(void, RhpAddToCastCache, (EEType * pSourceType, EEType * pTargetType, Boolean fCastable))
+{
+    ASSERT(((UIntNative)pTargetType & CAST_CACHE_RESULT_MASK) == 0);
+
+    UIntNative targetTypeAndResult = (UIntNative)pTargetType | (fCastable ? CAST_CACHE_RESULT_MASK : 0);
+    UInt32 idx = CastCacheHash(pSourceType, pTargetType);
+
+    for (UInt32 i = 0; i < CAST_CACHE_MAX_PROBES; i++)
+    {
+        TypeCastCacheEntry * pEntry = &g_rgCastCache[(idx + i) & (CAST_CACHE_SIZE - 1)];
+
+        EEType * pEntrySourceType = VolatileLoad(&pEntry->m_pSourceType);
+        if (pEntrySourceType == NULL)
+        {
+            pEntrySourceType = (EEType *)PalInterlockedCompareExchangePointer(&pEntry->m_pSourceType, pSourceType, NULL);
+            if (pEntrySourceType == NULL)
+            {
+                // We own this entry now. Publishing the target type makes it visible to readers.
+                VolatileStore(&pEntry->m_targetTypeAndResult, targetTypeAndResult);
+                CCC_COUNTER_INC(Inserts);
+                return;
+            }
+        }
+
+        // Another thread may have raced with us to cache the same result.
+        if ((pEntrySourceType == pSourceType) &&
+            ((VolatileLoad(&pEntry->m_targetTypeAndResult) & ~CAST_CACHE_RESULT_MASK) == (UIntNative)pTargetType))
+        {
+            return;
+        }
+    }
+
+    CCC_COUNTER_INC(InsertFailures);
+    g_fCastCacheSaturated = true;
+}
+
+void FlushTypeCastCacheIfSaturated()
+{
+    // No need for any locks, we're not racing with any other threads any more.
+    if (!g_fCastCacheSaturated)
+        return;
+
+    memset(g_rgCastCache, 0, sizeof(g_rgCastCache));
+    g_fCastCacheSaturated = false;
+
+    CCC_COUNTER_INC(Flushes);
+}
+
+#endif // !DACCESS_COMPILE
@@ -0,0 +1,22 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+// ==--==
+//
+// A global cache of type cast results keyed by (source EEType, target EEType). The managed type cast helpers
+// in Runtime.Base probe this cache before falling back on the full (and potentially expensive) computation
+// involving parent chains, interface maps and generic variance.
+//
+// ============================================================================
+
+// The result of a cast cache probe. Keep this synchronized with CastCacheResult in TypeCast.cs.
+enum CastCacheResult
+{
+    CastCacheResult_NotCastable = 0,
+    CastCacheResult_Castable    = 1,
+    CastCacheResult_Miss        = 2,
+};
+
+// Called during a GC (when no cache readers or writers can be running) to reset the cache if it has become
+// saturated since the last GC.
+void FlushTypeCastCacheIfSaturated();
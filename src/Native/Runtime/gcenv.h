@@ -57,6 +57,10 @@
     #include "etmdummy.h"
     #define ETW_EVENT_ENABLED(e,f) false
 
+    #ifdef FEATURE_BINARY_TRACE
+    #include "BinaryTraceEvents.h"
+    #endif // FEATURE_BINARY_TRACE
+
 #endif // FEATURE_ETW
 
 #define MAX_LONGPATH 1024
@@ -163,6 +167,8 @@ public:
     uint32_t ShouldInjectFault(uint32_t faultType) const { UNREFERENCED_PARAMETER(faultType); return FALSE; }
    
     int     GetHeapVerifyLevel();
+    int     GetHeapVerifyThreads();
+    int     GetHeapVerifySamplePercent();
     bool    IsHeapVerifyEnabled()                 { return GetHeapVerifyLevel() != 0; }
 
     GCStressFlags GetGCStressLevel()        const { return (GCStressFlags) m_gcStressMode; }
@@ -191,6 +197,7 @@ public:
     int     GetGCRetainVM ()                const { return 0; }
     int     GetGCTrimCommit()               const { return 0; }
     int     GetGCLOHCompactionMode()        const { return 0; }
+    int     GetGCTypeHistogram();
 
     bool    GetGCAllowVeryLargeObjects ()   const { return false; }
 
@@ -33,6 +33,8 @@
 #include "RhConfig.h"
 
 #include "threadstore.h"
+#include "AllocationSampler.h"
+#include "HeapSnapshot.h"
 
 #include "gcdesc.h"
 #include "SyncClean.hpp"
@@ -79,11 +81,26 @@ int EEConfig::GetHeapVerifyLevel()
     return g_pRhConfig->GetHeapVerify();
 }
 
+int EEConfig::GetHeapVerifyThreads()
+{
+    return g_pRhConfig->GetHeapVerifyThreads();
+}
+
+int EEConfig::GetHeapVerifySamplePercent()
+{
+    return g_pRhConfig->GetHeapVerifySamplePercent();
+}
+
 int EEConfig::GetGCconcurrent()
 {
     return !g_pRhConfig->GetDisableBGC();
 }
 
+int EEConfig::GetGCTypeHistogram()
+{
+    return g_pRhConfig->GetGCTypeHistogram();
+}
+
 // A few settings are now backed by the cut-down version of Redhawk configuration values.
 static RhConfig g_sRhConfig;
 RhConfig * g_pRhConfig = &g_sRhConfig;
@@ -185,6 +202,8 @@ bool RedhawkGCInterface::InitializeSubsystems(GCType gcType)
     if (!g_SuspendEELock.InitNoThrow(CrstSuspendEE))
         return false;
 
+    AllocationSampler::Initialize();
+
     // Set the GC heap type.
     bool fUseServerGC = (gcType == GCType_Server);
     GCHeap::InitializeHeapType(fUseServerGC);
@@ -201,6 +220,7 @@ bool RedhawkGCInterface::InitializeSubsystems(GCType gcType)
 
     if (!FinalizerThread::Initialize())
         return false;
+    STARTUP_TIMELINE_EVENT(GC_HEAP_INIT_COMPLETE);
 
     // Initialize HandleTable.
     if (!Ref_Initialize())
@@ -219,6 +239,16 @@ bool RedhawkGCInterface::InitializeSubsystems(GCType gcType)
 
 // static
 void* RedhawkGCInterface::Alloc(Thread *pThread, UIntNative cbSize, UInt32 uFlags, EEType *pEEType)
+{
+    // The assembly allocation helpers link a transition frame before calling here.
+    return Alloc(pThread, cbSize, uFlags, pEEType, NULL);
+}
+
+// Allocate an object on behalf of an allocation helper which hasn't set up a transition frame.
+//  pCallerIP       -  return address of the allocation helper, or NULL if it did set up a transition frame
+
+// static
+void* RedhawkGCInterface::Alloc(Thread *pThread, UIntNative cbSize, UInt32 uFlags, EEType *pEEType, void * pCallerIP)
 {
     ASSERT(GCHeap::UseAllocationContexts());
     ASSERT(!pThread->IsDoNotTriggerGcSet());
@@ -226,6 +256,12 @@ void* RedhawkGCInterface::Alloc(Thread *pThread, UIntNative cbSize, UInt32 uFlag
     // Save the EEType for instrumentation purposes.
     SetLastAllocEEType(pEEType);
 
+    // The allocation sampler may have lowered the limit of the allocation context, the GC must only ever see
+    // the real one.
+    bool fSample = false;
+    if (AllocationSampler::IsEnabled())
+        fSample = AllocationSampler::OnSlowPathEnter(pThread, pThread->GetAllocContext(), cbSize);
+
     Object * pObject;
 #ifdef FEATURE_64BIT_ALIGNMENT
     if (uFlags & GC_ALLOC_ALIGN8)
@@ -234,6 +270,9 @@ void* RedhawkGCInterface::Alloc(Thread *pThread, UIntNative cbSize, UInt32 uFlag
 #endif // FEATURE_64BIT_ALIGNMENT
         pObject = GCHeap::GetGCHeap()->Alloc(pThread->GetAllocContext(), cbSize, uFlags);
 
+    if (AllocationSampler::IsEnabled())
+        AllocationSampler::OnSlowPathExit(pThread, pThread->GetAllocContext(), pObject, pEEType, cbSize, fSample, pCallerIP);
+
     // NOTE: we cannot call PublishObject here because the object isn't initialized!
 
     return pObject;
@@ -283,6 +322,129 @@ void RedhawkGCInterface::ReleaseAllocContext(alloc_context * pAllocContext)
     GCHeap::GetGCHeap()->FixAllocContext(pAllocContext, FALSE, NULL, NULL);
 }
 
+#ifdef FEATURE_PREMORTEM_FINALIZATION
+// Number of finalizable objects a thread can allocate before they have to be registered with the GC.
+#define PENDING_FINALIZABLES_CAPACITY 16
+
+// Finalizable objects a thread has allocated since the last GC without registering them with the GC, along
+// with the room reserved for them on the finalization queue. Allocated on the thread's first use of the
+// RhpNewFinalizable fast path and handed over to the next GC when the thread is destroyed.
+struct PendingFinalizables
+{
+    PendingFinalizables *   m_pNext;            // list of orphaned blocks, see OrphanPendingFinalizables
+    UInt32                  m_cObjects;
+    UInt32                  m_cReserved;        // reserved slots on the finalization queue, at least m_cObjects
+    Object *                m_rgpObjects[PENDING_FINALIZABLES_CAPACITY];
+};
+
+// Pending finalizable objects of threads which were destroyed since the last GC.
+static PendingFinalizables * g_pOrphanedFinalizables = NULL;
+
+// The room was reserved when the objects were recorded, so registering them can't fail.
+static void RegisterPendingFinalizables(PendingFinalizables * pPending)
+{
+    for (UInt32 i = 0; i < pPending->m_cObjects; i++)
+        GCHeap::GetGCHeap()->RegisterReservedForFinalization(pPending->m_rgpObjects[i]);
+
+    pPending->m_cReserved -= pPending->m_cObjects;
+    pPending->m_cObjects = 0;
+}
+
+// Make sure the next finalizable object this thread allocates (in cooperative mode) can be recorded with
+// AddPendingFinalizable. Once the reserved room is used up the pending objects are registered with the GC and
+// room for a new batch is reserved. Returns false if that fails (the finalization queue or the block can't be
+// allocated), in which case the object must be allocated through the slow path.
+bool Thread::ReservePendingFinalizable()
+{
+    ASSERT(IsCurrentThread());
+
+    PendingFinalizables * pPending = m_pPendingFinalizables;
+    if (pPending == NULL)
+    {
+        pPending = new (nothrow) PendingFinalizables();
+        if (pPending == NULL)
+            return false;
+
+        m_pPendingFinalizables = pPending;
+    }
+
+    if (pPending->m_cObjects < pPending->m_cReserved)
+        return true;
+
+    RegisterPendingFinalizables(pPending);
+
+    if (!GCHeap::GetGCHeap()->ReserveForFinalization(PENDING_FINALIZABLES_CAPACITY))
+        return false;
+
+    pPending->m_cReserved = PENDING_FINALIZABLES_CAPACITY;
+    return true;
+}
+
+void Thread::AddPendingFinalizable(Object * pObject)
+{
+    PendingFinalizables * pPending = m_pPendingFinalizables;
+    ASSERT(pPending->m_cObjects < pPending->m_cReserved);
+
+    pPending->m_rgpObjects[pPending->m_cObjects++] = pObject;
+}
+
+// Register the finalizable objects this thread has allocated since the last GC with the GC. Called on the
+// thread performing a GC (while this thread is suspended) before the GC looks at the finalization queue.
+void Thread::FlushPendingFinalizables()
+{
+    if (m_pPendingFinalizables != NULL)
+        RegisterPendingFinalizables(m_pPendingFinalizables);
+}
+
+// Called when the thread is destroyed, which happens in preemptive mode and so can't register the objects
+// itself. The block is handed over to the next GC instead, which registers the objects and gives back the
+// unused reservation. We hold the thread store lock so no GC can be in progress and the objects can't move
+// until that GC has registered them.
+void Thread::OrphanPendingFinalizables()
+{
+    PendingFinalizables * pOrphans = m_pPendingFinalizables;
+    if (pOrphans == NULL)
+        return;
+
+    m_pPendingFinalizables = NULL;
+
+    if (pOrphans->m_cReserved == 0)
+    {
+        delete pOrphans;
+        return;
+    }
+
+    PendingFinalizables * pHead;
+    do
+    {
+        pHead = VolatileLoad(&g_pOrphanedFinalizables);
+        pOrphans->m_pNext = pHead;
+    }
+    while (PalInterlockedCompareExchangePointer((void * volatile *)&g_pOrphanedFinalizables, pOrphans, pHead) != pHead);
+}
+
+static void FlushAllPendingFinalizables()
+{
+    PendingFinalizables * pOrphans = (PendingFinalizables *)PalInterlockedExchangePointer((void * volatile *)&g_pOrphanedFinalizables, NULL);
+    while (pOrphans != NULL)
+    {
+        RegisterPendingFinalizables(pOrphans);
+        if (pOrphans->m_cReserved != 0)
+            GCHeap::GetGCHeap()->ReleaseFinalizationReservation(pOrphans->m_cReserved);
+
+        PendingFinalizables * pNext = pOrphans->m_pNext;
+        delete pOrphans;
+        pOrphans = pNext;
+    }
+
+    FOREACH_THREAD(pThread)
+    {
+        pThread->FlushPendingFinalizables();
+    }
+    END_FOREACH_THREAD
+}
+#endif // FEATURE_PREMORTEM_FINALIZATION
+
 // static 
 void RedhawkGCInterface::WaitForGCCompletion()
 {
@@ -949,14 +1111,11 @@ void RedhawkGCInterface::SetLastAllocEEType(EEType * pEEType)
 
 void GCToEEInterface::SuspendEE(GCToEEInterface::SUSPEND_REASON reason)
 {
-#ifdef FEATURE_EVENT_TRACE
-    ETW::GCLog::ETW_GC_INFO Info;
-    Info.SuspendEE.Reason = reason;
-    Info.SuspendEE.GcCount = (((reason == SUSPEND_FOR_GC) || (reason == SUSPEND_FOR_GC_PREP)) ?
+    UInt32 gcCount = (((reason == SUSPEND_FOR_GC) || (reason == SUSPEND_FOR_GC_PREP)) ?
         (UInt32)GCHeap::GetGCHeap()->GetGcCount() : (UInt32)-1);
-#endif // FEATURE_EVENT_TRACE
+    UNREFERENCED_PARAMETER(gcCount);
 
-    FireEtwGCSuspendEEBegin_V1(Info.SuspendEE.Reason, Info.SuspendEE.GcCount, GetClrInstanceId());
+    FireEtwGCSuspendEEBegin_V1(reason, gcCount, GetClrInstanceId());
 
     g_SuspendEELock.Enter();
 
@@ -991,6 +1150,17 @@ void GCToEEInterface::RestartEE(bool /*bFinishedGC*/)
 
 void GCToEEInterface::GcStartWork(int condemned, int /*max_gen*/)
 {
+#ifdef FEATURE_BINARY_TRACE
+    if (BinaryTrace::IsEnabled(BINARY_TRACE_KEYWORD_GC, BINARY_TRACE_LEVEL_INFORMATIONAL))
+        BinaryTraceGCStart((UInt32)GCHeap::GetGCHeap()->GetGcCount(), (UInt32)condemned);
+#endif // FEATURE_BINARY_TRACE
+
+#ifdef FEATURE_PREMORTEM_FINALIZATION
+    // Finalizable objects allocated through the fast path must be on the finalization queue before the GC
+    // decides which objects are ready for finalization.
+    FlushAllPendingFinalizables();
+#endif // FEATURE_PREMORTEM_FINALIZATION
+
     // Invoke any registered callouts for the start of the collection.
     RestrictedCallouts::InvokeGcCallouts(GCRC_StartCollection, condemned);
 }
@@ -1010,6 +1180,16 @@ void GCToEEInterface::GcDone(int condemned)
 {
     // Invoke any registered callouts for the end of the collection.
     RestrictedCallouts::InvokeGcCallouts(GCRC_EndCollection, condemned);
+
+#ifdef FEATURE_BINARY_TRACE
+    if (BinaryTrace::IsEnabled(BINARY_TRACE_KEYWORD_GC, BINARY_TRACE_LEVEL_INFORMATIONAL))
+        BinaryTraceGCEnd((UInt32)GCHeap::GetGCHeap()->GetGcCount(), (UInt32)condemned);
+#endif // FEATURE_BINARY_TRACE
+}
+
+void GCToEEInterface::DiagGCEnd(size_t index, int condemned, bool fConcurrent)
+{
+    HeapSnapshot::OnGCEnd(index, condemned, fConcurrent);
 }
 
 bool GCToEEInterface::RefCountedHandleCallbacks(Object * pObject)
@@ -1095,6 +1275,14 @@ CLREventStatic* hEventFinalizer = nullptr;
 CLREventStatic* hEventFinalizerDone = nullptr;
 
 #ifndef DACCESS_COMPILE
+// When more than one finalizer thread is configured the threads other than g_pFinalizerThread (the helpers)
+// wait on this manual reset event. It's set while finalizer threads are finding full batches of finalizable
+// objects and reset once the queue has been drained.
+CLREventStatic* hEventFinalizerHelpers = nullptr;
+
+DECLSPEC_THREAD
+static bool t_fIsFinalizerThread;
+
 // Finalizer method implemented by redhawkm.
 extern "C" void __cdecl ProcessFinalizers();
 
@@ -1106,6 +1294,7 @@ extern "C" void __cdecl ProcessFinalizers();
 UInt32 WINAPI FinalizerStart(void* pContext)
 {
     HANDLE hFinalizerEvent = (HANDLE)pContext;
+    bool fHelper = (hFinalizerEvent != FinalizerThread::GetFinalizerEvent());
 
     ThreadStore::AttachCurrentThread();
     Thread * pThread = GetThread();
@@ -1114,16 +1303,22 @@ UInt32 WINAPI FinalizerStart(void* pContext)
     // get into an infinite loop if performed on the finalizer thread.
     pThread->SetSuppressGcStress();
 
-    FinalizerThread::SetFinalizerThread(pThread);
+    t_fIsFinalizerThread = true;
+    if (!fHelper)
+        FinalizerThread::SetFinalizerThread(pThread);
 
-    // Wait for a finalization request.
+    // Wait for a finalization request. Helper threads are only woken once the primary finalizer thread has
+    // started draining the queue, so the managed code is known to be initialized by then too.
     UInt32 uResult = PalWaitForSingleObjectEx(hFinalizerEvent, INFINITE, FALSE);
     ASSERT(uResult == WAIT_OBJECT_0);
 
-    // Since we just consumed the request (and the event is auto-reset) we must set the event again so the
-    // managed finalizer code will immediately start processing the queue when we run it.
-    UInt32_BOOL fResult = PalSetEvent(hFinalizerEvent);
-    ASSERT(fResult);
+    if (!fHelper)
+    {
+        // Since we just consumed the request (and the event is auto-reset) we must set the event again so the
+        // managed finalizer code will immediately start processing the queue when we run it.
+        UInt32_BOOL fResult = PalSetEvent(hFinalizerEvent);
+        ASSERT(fResult);
+    }
 
     // Run the managed portion of the finalizer. Until we implement (non-process) shutdown this call will
     // never return.
@@ -1190,6 +1385,22 @@ bool FinalizerThread::Initialize()
     if (!StartFinalizerThread())
         return false;
 
+    // Create any additional finalizer threads. These are optional, so failing to create them isn't fatal.
+    UInt32 cFinalizerThreads = g_pRhConfig->GetFinalizerThreadCount();
+    if (cFinalizerThreads > 1)
+    {
+        hEventFinalizerHelpers = new (nothrow) CLREventStatic();
+        if (hEventFinalizerHelpers != NULL)
+        {
+            hEventFinalizerHelpers->CreateManualEvent(FALSE);
+            for (UInt32 i = 1; i < cFinalizerThreads; i++)
+            {
+                if (!PalStartFinalizerThread(FinalizerStart, (void*)hEventFinalizerHelpers->GetOSEvent()))
+                    break;
+            }
+        }
+    }
+
     return true;
 }
 
@@ -1215,6 +1426,11 @@ bool FinalizerThread::HaveExtraWorkForFinalizer()
 }
 
 bool FinalizerThread::IsCurrentThreadFinalizer()
+{
+    return t_fIsFinalizerThread;
+}
+
+bool FinalizerThread::IsCurrentThreadPrimaryFinalizer()
 {
     return GetThread() == g_pFinalizerThread;
 }
@@ -1224,6 +1440,22 @@ HANDLE FinalizerThread::GetFinalizerEvent()
     return hEventFinalizer->GetOSEvent();
 }
 
+HANDLE FinalizerThread::GetFinalizerHelperEvent()
+{
+    return (hEventFinalizerHelpers != NULL) ? hEventFinalizerHelpers->GetOSEvent() : NULL;
+}
+
+void FinalizerThread::EnableFinalizerHelpers(bool fEnable)
+{
+    if (hEventFinalizerHelpers == NULL)
+        return;
+
+    if (fEnable)
+        hEventFinalizerHelpers->Set();
+    else
+        hEventFinalizerHelpers->Reset();
+}
+
 void FinalizerThread::Wait(DWORD timeout, bool allowReentrantWait)
 {
     // Can't call this from the finalizer thread itself.
@@ -1269,6 +1501,207 @@ void DestroyThread(Thread * /*pThread*/)
 {
     // TODO: Implement
 }
+#if defined(_AMD64_) && defined(PLATFORM_UNIX) && !defined(USE_PORTABLE_HELPERS) && !defined(DACCESS_COMPILE)
+
+// The write barrier helpers in amd64/WriteBarriers.S embed the bounds of the ephemeral range and the address of
+// the card table as 64-bit immediates. Each of the labels below marks a load of one of those values into r11,
+// which is turned into a "movabs r11, imm64" at initialization and whose immediate then has to be rewritten
+// whenever the GC changes the corresponding value.
+EXTERN_C void * RhpAssignRef_PatchEphemeralLow_RSI;
+EXTERN_C void * RhpAssignRef_PatchEphemeralHigh_RSI;
+EXTERN_C void * RhpAssignRef_PatchCardTable_RSI;
+EXTERN_C void * RhpCheckedAssignRef_PatchEphemeralLow_RSI;
+EXTERN_C void * RhpCheckedAssignRef_PatchEphemeralHigh_RSI;
+EXTERN_C void * RhpCheckedAssignRef_PatchCardTable_RSI;
+EXTERN_C void * RhpCheckedLockCmpXchg_PatchEphemeralLow_RSI;
+EXTERN_C void * RhpCheckedLockCmpXchg_PatchEphemeralHigh_RSI;
+EXTERN_C void * RhpCheckedLockCmpXchg_PatchCardTable_RSI;
+EXTERN_C void * RhpCheckedXchg_PatchEphemeralLow_RSI;
+EXTERN_C void * RhpCheckedXchg_PatchEphemeralHigh_RSI;
+EXTERN_C void * RhpCheckedXchg_PatchCardTable_RSI;
+EXTERN_C void * RhpByRefAssignRef_PatchEphemeralLow;
+EXTERN_C void * RhpByRefAssignRef_PatchEphemeralHigh;
+EXTERN_C void * RhpByRefAssignRef_PatchCardTable;
+
+static UInt8 * const s_rgEphemeralLowPatchSites[] =
+{
+    (UInt8 *)&RhpAssignRef_PatchEphemeralLow_RSI,
+    (UInt8 *)&RhpCheckedAssignRef_PatchEphemeralLow_RSI,
+    (UInt8 *)&RhpCheckedLockCmpXchg_PatchEphemeralLow_RSI,
+    (UInt8 *)&RhpCheckedXchg_PatchEphemeralLow_RSI,
+    (UInt8 *)&RhpByRefAssignRef_PatchEphemeralLow,
+};
+
+static UInt8 * const s_rgEphemeralHighPatchSites[] =
+{
+    (UInt8 *)&RhpAssignRef_PatchEphemeralHigh_RSI,
+    (UInt8 *)&RhpCheckedAssignRef_PatchEphemeralHigh_RSI,
+    (UInt8 *)&RhpCheckedLockCmpXchg_PatchEphemeralHigh_RSI,
+    (UInt8 *)&RhpCheckedXchg_PatchEphemeralHigh_RSI,
+    (UInt8 *)&RhpByRefAssignRef_PatchEphemeralHigh,
+};
+
+static UInt8 * const s_rgCardTablePatchSites[] =
+{
+    (UInt8 *)&RhpAssignRef_PatchCardTable_RSI,
+    (UInt8 *)&RhpCheckedAssignRef_PatchCardTable_RSI,
+    (UInt8 *)&RhpCheckedLockCmpXchg_PatchCardTable_RSI,
+    (UInt8 *)&RhpCheckedXchg_PatchCardTable_RSI,
+    (UInt8 *)&RhpByRefAssignRef_PatchCardTable,
+};
+
+// The immediate operand follows the REX prefix and opcode of "movabs r11, imm64" (49 BB).
+#define WRITE_BARRIER_PATCH_IMMEDIATE_OFFSET 2
+
+// Set once the first StompWriteBarrierResize (during GC initialization, when no write barriers can be executing)
+// has tried to patch the barriers.
+static bool s_fWriteBarrierInitialized = false;
+
+// Set if that succeeded. Otherwise the patch sites keep the loads from memory they were assembled with and the
+// barriers don't need to be updated at all.
+static bool s_fWriteBarrierPatched = false;
+
+static void PatchWriteBarrierSites(UInt8 * const * rgSites, size_t cSites, void * value)
+{
+    for (size_t i = 0; i < cSites; i++)
+    {
+        UInt8 * pSite = rgSites[i];
+
+        // The first time around the site still holds "mov r11, [rip + disp32]" (4C 8B 1D) padded with a nop to
+        // the size of the movabs that replaces it.
+        ASSERT(s_fWriteBarrierPatched ? ((pSite[0] == 0x49) && (pSite[1] == 0xBB))
+                                      : ((pSite[0] == 0x4C) && (pSite[1] == 0x8B) && (pSite[2] == 0x1D)));
+
+        pSite[0] = 0x49;
+        pSite[1] = 0xBB;
+        memcpy(pSite + WRITE_BARRIER_PATCH_IMMEDIATE_OFFSET, &value, sizeof(value));
+    }
+}
+
+// The range of code covering all of the patch sites and its protection outside of updates, captured by the first
+// update so that later ones (which run inside GC pauses) don't have to look them up again.
+static UInt8 * s_pWriteBarrierPatchLow = NULL;
+static UInt8 * s_pWriteBarrierPatchHigh = NULL;
+static UInt32 s_writeBarrierCodeProtect = 0;
+
+// The values last written to the patch sites. The GC restamps the barriers at every GC that may have moved the
+// ephemeral range, most of which don't actually change it.
+static void * s_pPatchedEphemeralLow = NULL;
+static void * s_pPatchedEphemeralHigh = NULL;
+static void * s_pPatchedCardTable = NULL;
+
+// Rewrite the write barrier patch sites with the current GC values. Must be called either before any write
+// barrier can run or while all other threads are suspended, since the sites are not updated atomically. Returns
+// false, without touching the code, if it can't be made writable.
+static bool UpdateWriteBarrierPatchSites(bool fUpdateEphemeralBounds, bool fUpdateCardTable)
+{
+    fUpdateEphemeralBounds = fUpdateEphemeralBounds &&
+        ((s_pPatchedEphemeralLow != g_ephemeral_low) || (s_pPatchedEphemeralHigh != g_ephemeral_high));
+    fUpdateCardTable = fUpdateCardTable && (s_pPatchedCardTable != g_card_table);
+
+    if (!s_fWriteBarrierInitialized)
+    {
+        // All of the patch sites live in the write barrier helpers, which are contiguous in the image.
+        UInt8 * pLow = (UInt8 *)UINTPTR_MAX;
+        UInt8 * pHigh = NULL;
+        for (size_t i = 0; i < COUNTOF(s_rgEphemeralLowPatchSites); i++)
+        {
+            UInt8 * rgSites[] = { s_rgEphemeralLowPatchSites[i], s_rgEphemeralHighPatchSites[i], s_rgCardTablePatchSites[i] };
+            for (size_t j = 0; j < COUNTOF(rgSites); j++)
+            {
+                pLow = min(pLow, rgSites[j]);
+                pHigh = max(pHigh, rgSites[j] + WRITE_BARRIER_PATCH_IMMEDIATE_OFFSET + sizeof(void *));
+            }
+        }
+
+        if (!PalVirtualProtect(pLow, pHigh - pLow, PAGE_EXECUTE_READWRITE, &s_writeBarrierCodeProtect))
+            return false;
+
+        s_pWriteBarrierPatchLow = pLow;
+        s_pWriteBarrierPatchHigh = pHigh;
+
+        // The sites still load the values from memory, they all have to be rewritten.
+        fUpdateEphemeralBounds = true;
+        fUpdateCardTable = true;
+    }
+    else
+    {
+        if (!fUpdateEphemeralBounds && !fUpdateCardTable)
+            return true;
+
+        if (!PalVirtualProtect(s_pWriteBarrierPatchLow, s_pWriteBarrierPatchHigh - s_pWriteBarrierPatchLow, PAGE_EXECUTE_READWRITE, NULL))
+            return false;
+    }
+
+    if (fUpdateEphemeralBounds)
+    {
+        PatchWriteBarrierSites(s_rgEphemeralLowPatchSites, COUNTOF(s_rgEphemeralLowPatchSites), g_ephemeral_low);
+        PatchWriteBarrierSites(s_rgEphemeralHighPatchSites, COUNTOF(s_rgEphemeralHighPatchSites), g_ephemeral_high);
+        s_pPatchedEphemeralLow = g_ephemeral_low;
+        s_pPatchedEphemeralHigh = g_ephemeral_high;
+    }
+
+    if (fUpdateCardTable)
+    {
+        PatchWriteBarrierSites(s_rgCardTablePatchSites, COUNTOF(s_rgCardTablePatchSites), g_card_table);
+        s_pPatchedCardTable = g_card_table;
+    }
+
+    PalVirtualProtect(s_pWriteBarrierPatchLow, s_pWriteBarrierPatchHigh - s_pWriteBarrierPatchLow, s_writeBarrierCodeProtect, NULL);
+    return true;
+}
+
+// Update the immediates of barriers that were patched at initialization. They can't be switched back to loading
+// the values from memory without writing to the code either, and stale values would make them miss card table
+// updates.
+static void UpdatePatchedWriteBarrier(bool fUpdateEphemeralBounds, bool fUpdateCardTable)
+{
+    if (!UpdateWriteBarrierPatchSites(fUpdateEphemeralBounds, fUpdateCardTable))
+    {
+        ASSERT_UNCONDITIONALLY("Failed to make the write barrier code writable");
+        RhFailFast();
+    }
+}
+
+void StompWriteBarrierEphemeral()
+{
+    // The GC only moves the ephemeral range while the runtime is suspended. Before the first
+    // StompWriteBarrierResize there's nothing to update, it writes the ephemeral bounds too.
+    ASSERT(!s_fWriteBarrierInitialized || GCHeap::IsGCInProgress());
+
+    if (s_fWriteBarrierPatched)
+        UpdatePatchedWriteBarrier(true, false);
+}
+
+void StompWriteBarrierResize(bool /*bReqUpperBoundsCheck*/)
+{
+    // The first call happens during GC initialization, before any managed code can run. If the code can't be
+    // made writable (e.g. because the system doesn't allow writable code) the barriers keep loading the values
+    // from memory.
+    if (!s_fWriteBarrierInitialized)
+    {
+        s_fWriteBarrierPatched = UpdateWriteBarrierPatchSites(true, true);
+        s_fWriteBarrierInitialized = true;
+        return;
+    }
+
+    if (!s_fWriteBarrierPatched || (s_pPatchedCardTable == g_card_table))
+        return;
+
+    // After that the card table can be grown by an allocating thread while other threads are running write
+    // barriers, in which case those threads must be suspended for the duration of the update.
+    bool fSuspend = !GCHeap::IsGCInProgress();
+    if (fSuspend)
+        GCToEEInterface::SuspendEE(GCToEEInterface::SUSPEND_FOR_GC_PREP);
+
+    UpdatePatchedWriteBarrier(false, true);
+
+    if (fSuspend)
+        GCToEEInterface::RestartEE(false);
+}
+
+#else // _AMD64_ && PLATFORM_UNIX && !USE_PORTABLE_HELPERS && !DACCESS_COMPILE
+
 void StompWriteBarrierEphemeral()
 {
 }
@@ -1277,6 +1710,8 @@ void StompWriteBarrierResize(bool /*bReqUpperBoundsCheck*/)
 {
 }
 
+#endif // _AMD64_ && PLATFORM_UNIX && !USE_PORTABLE_HELPERS && !DACCESS_COMPILE
+
 void LogSpewAlways(const char * /*fmt*/, ...)
 {
 }
@@ -129,6 +129,12 @@ public:
     // Returns a pointer to the object allocated or NULL on failure.
     static void* Alloc(Thread *pThread, UIntNative cbSize, UInt32 uFlags, EEType *pEEType);
 
+    // Same as above, for the allocation helpers which call in without setting up a transition frame first
+    // (the C++ ones in portable.cpp), so that nothing tries to walk the stack from m_pHackPInvokeTunnel.
+    //  pCallerIP       -  return address of the allocation helper, recorded by the allocation sampler as the
+    //                     allocating callsite in place of a stack
+    static void* Alloc(Thread *pThread, UIntNative cbSize, UInt32 uFlags, EEType *pEEType, void * pCallerIP);
+
     // Allocate an object on the large GC heap. Used when you want to force an allocation on the large heap
     // that wouldn't normally go there (e.g. objects containing double fields).
     //  cbSize          -  size in bytes of the final object
@@ -24,6 +24,7 @@
 #include "module.h"
 #include "RuntimeInstance.h"
 #include "threadstore.h"
+#include "AllocationSampler.h"
 
 
 #ifndef DACCESS_COMPILE
@@ -92,6 +93,9 @@ void GCToEEInterface::GcEnumAllocContexts (enum_alloc_context_func* fn, void* pa
     {
         FOREACH_THREAD(thread)
         {
+            if (AllocationSampler::IsEnabled())
+                AllocationSampler::DisarmThread(thread, thread->GetAllocContext());
+
             (*fn) (thread->GetAllocContext(), param);
         }
         END_FOREACH_THREAD
@@ -277,6 +277,7 @@ class ThreadStressLog;
 typedef DPTR(ThreadStressLog) PTR_ThreadStressLog;
 struct StressLogChunk;
 typedef DPTR(StressLogChunk) PTR_StressLogChunk;
+struct StressLogFileHeader;
 struct DacpStressLogEnumCBArgs;
 
 
@@ -302,7 +303,7 @@ public:
 #ifndef DACCESS_COMPILE
 public:
     static void Initialize(unsigned facilities, unsigned level, unsigned maxBytesPerThread, 
-                    unsigned maxBytesTotal, HANDLE hMod);
+                    unsigned maxBytesTotal, HANDLE hMod, bool fFileBacked);
     // Called at DllMain THREAD_DETACH to recycle thread's logs
     static void ThreadDetach(ThreadStressLog *msgs);
     static long NewChunk ()     { return PalInterlockedIncrement (&theLog.totalChunk); }
@@ -322,6 +323,14 @@ public:
     static ThreadStressLog* CreateThreadStressLog(Thread * pThread);
     static ThreadStressLog* CreateThreadStressLogHelper(Thread * pThread);
 
+    // File backed log support, see StressLogFileHeader
+    static StressLogFileHeader* s_pFileHeader;  // NULL unless the log lives in a file mapping
+
+    static bool InitializeFile(unsigned maxBytesTotal);
+    static void* AllocateFileChunk();
+    static void* AllocateFileThreadLog();
+    static bool IsInFile(void * pv);
+
 #else // DACCESS_COMPILE
 public:
     bool Initialize();
@@ -496,8 +505,12 @@ struct StressLogChunk
 #ifndef DACCESS_COMPILE
     static HANDLE s_LogChunkHeap; 
 
-    void * operator new (size_t)
+    // noexcept, so that new returns NULL rather than running the constructor on it when the allocation fails
+    void * operator new (size_t) noexcept
     {
+        if (StressLog::s_pFileHeader != NULL)
+            return StressLog::AllocateFileChunk();
+
         _ASSERTE (s_LogChunkHeap != NULL);
         //no need to zero memory because we could handle garbage contents
         return PalHeapAlloc (s_LogChunkHeap, 0, sizeof (StressLogChunk));
@@ -505,6 +518,11 @@ struct StressLogChunk
 
     void operator delete (void * chunk)
     {
+        // chunks in the file are never reused, they are only ever freed when a new ThreadStressLog fails to
+        // initialize
+        if (StressLog::IsInFile (chunk))
+            return;
+
         _ASSERTE (s_LogChunkHeap != NULL);
         PalHeapFree (s_LogChunkHeap, 0, chunk);
     }
@@ -569,6 +587,26 @@ public:
     inline ThreadStressLog ();
     inline ~ThreadStressLog ();
 
+    void * operator new (size_t size, const std::nothrow_t&) noexcept
+    {
+        if (StressLog::s_pFileHeader != NULL)
+            return StressLog::AllocateFileThreadLog();
+
+        return ::operator new (size, nothrow);
+    }
+
+    void operator delete (void * threadLog)
+    {
+        // Clearing the slot tells readers of the file it isn't in use.
+        if (StressLog::IsInFile (threadLog))
+        {
+            memset (threadLog, 0, sizeof (ThreadStressLog));
+            return;
+        }
+
+        ::operator delete (threadLog);
+    }
+
     void LogMsg ( UInt32 facility, int cArgs, const char* format, ... )
     {
         va_list Args;
@@ -632,6 +670,66 @@ public:
 };
 
 
+//==========================================================================================
+// StressLogFileHeader
+//
+// When the StressLogToFile config value is set the log is kept in a shared mapping of the file
+// rhstresslog-<pid>.log in the temporary directory (see PalGetOutputFileName) rather than on the heap, so that
+// it can be read while the process is running and survives the process crashing or being killed. The file
+// holds this header, an array of ThreadStressLog slots starting at threadLogsOffset and an array of
+// StressLogChunks starting at chunksOffset. Pointers in the file are addresses in the logging process, readers
+// translate them using mappingBase. Format strings are stored as offsets from moduleOffset, the base address of
+// the module modulePath.
+//
+// Logging costs the same as with the log on the heap: the writes land in the page cache and are written back
+// by the OS in the background. The file is sized up front to a page for the header, a slot for each chunk and
+// TotalStressLogSize bytes (plus a little slack, see StressLog::InitializeFile) of chunks, it never grows.
+// Once all the chunks are handed out new threads reuse the log of the oldest dead thread, or go without a log
+// when there is none. If the file can't be created the log is kept on the heap instead.
+//
+// src/Native/Runtime/tools/stresslog.py decodes these files.
+//
+#define STRESSLOG_FILE_MAGIC        0x474F4C53534852ull     // "RHSSLOG"
+#define STRESSLOG_FILE_VERSION      1
+#define STRESSLOG_FILE_MAX_PATH     512
+
+struct StressLogFileHeader
+{
+    UInt64 magic;                   // STRESSLOG_FILE_MAGIC, written last so that readers never see a partial header
+    UInt32 version;                 // STRESSLOG_FILE_VERSION
+    UInt32 cbPointer;               // size of a pointer in the logging process
+    UInt64 mappingBase;             // address at which the file is mapped in the logging process
+    UInt64 cbMapping;               // size of the file
+    UInt64 tickFrequency;           // StressLog::tickFrequency
+    UInt64 startTimeStamp;          // StressLog::startTimeStamp
+    UInt64 moduleOffset;            // StressLog::moduleOffset
+
+    UInt32 threadLogsOffset;        // file offset of the ThreadStressLog slots
+    UInt32 cbThreadLogSlot;         // distance between two slots
+    UInt32 cMaxThreadLogs;
+    Int32  cThreadLogs;             // number of slots handed out so far
+
+    UInt64 chunksOffset;            // file offset of the StressLogChunks
+    UInt32 cbChunk;                 // sizeof(StressLogChunk)
+    UInt32 cMaxChunks;
+    Int32  cChunks;                 // number of chunks handed out so far
+
+    // Layout of the structures the readers walk
+    UInt32 cbChunkBuffer;           // STRESSLOG_CHUNK_SIZE
+    UInt32 offsetOfChunkNext;
+    UInt32 offsetOfChunkBuf;
+    UInt32 offsetOfThreadId;
+    UInt32 offsetOfIsDead;
+    UInt32 offsetOfWriteHasWrapped;
+    UInt32 offsetOfCurPtr;
+    UInt32 offsetOfChunkListHead;
+    UInt32 offsetOfChunkListTail;
+    UInt32 offsetOfCurWriteChunk;
+    UInt32 reserved;
+
+    char   modulePath[STRESSLOG_FILE_MAX_PATH];
+};
+
 //==========================================================================================
 // Inline implementations:
 //
@@ -53,6 +53,9 @@ struct alloc_context
     SVR::GCHeap*   home_heap;
 #endif // defined(FEATURE_SVR_GC)
     int            alloc_count;
+    UInt8          alloc_quantum_units;
+    UInt8          alloc_refills;
+    UInt16         alloc_uncleared_bytes;
 };
 
 //
@@ -97,7 +100,7 @@ COOP_PINVOKE_HELPER(Object *, RhpNewFast, (EEType* pEEType))
         return pObject;
     }
 
-    pObject = (Object *)RedhawkGCInterface::Alloc(pCurThread, size, 0, pEEType);
+    pObject = (Object *)RedhawkGCInterface::Alloc(pCurThread, size, 0, pEEType, RETURN_ADDRESS());
     if (pObject == nullptr)
     {
         ASSERT_UNCONDITIONALLY("NYI");  // TODO: Throw OOM
@@ -118,11 +121,29 @@ COOP_PINVOKE_HELPER(Object *, RhpNewFinalizable, (EEType* pEEType))
     ASSERT(pEEType->HasFinalizer());
 
     Thread * pCurThread = ThreadStore::GetCurrentThread();
+    alloc_context * acontext = pCurThread->GetAllocContext();
     Object * pObject;
 
     size_t size = pEEType->get_BaseSize();
 
-    pObject = (Object *)RedhawkGCInterface::Alloc(pCurThread, size, GC_ALLOC_FINALIZE, pEEType);
+    // Bump allocate like RhpNewFast. Rather than being registered with the GC right away the object is
+    // recorded in the thread's list of pending finalizable objects, which is flushed to the GC when it fills
+    // up or at the start of the next GC. If no room can be reserved for it on the finalization queue the
+    // object goes through the slow path, which reports the failure.
+    UInt8* result = acontext->alloc_ptr;
+    UInt8* advance = result + size;
+    if ((advance <= acontext->alloc_limit) && pCurThread->ReservePendingFinalizable())
+    {
+        acontext->alloc_ptr = advance;
+        pObject = (Object *)result;
+        pObject->set_EEType(pEEType);
+
+        pCurThread->AddPendingFinalizable(pObject);
+
+        return pObject;
+    }
+
+    pObject = (Object *)RedhawkGCInterface::Alloc(pCurThread, size, GC_ALLOC_FINALIZE, pEEType, RETURN_ADDRESS());
     if (pObject == nullptr)
     {
         ASSERT_UNCONDITIONALLY("NYI");  // TODO: Throw OOM
@@ -135,6 +156,45 @@ COOP_PINVOKE_HELPER(Object *, RhpNewFinalizable, (EEType* pEEType))
     return pObject;
 }
 
+// Allocate up to count objects of the same type from the current thread's alloc context in one go, storing
+// them in consecutive elements of pOut and returning how many were allocated. This never falls back on the
+// GC allocator (and so never triggers a GC): once the alloc context is exhausted the caller is expected to
+// allocate a single object through RhpNewFast, which refills the context, and then call back in for the
+// rest. That keeps every allocated object reachable from a GC-reported location at all times, so pOut must
+// point at the elements of a managed object array that the caller keeps alive.
+COOP_PINVOKE_HELPER(UInt32, RhpNewFastBatch, (EEType* pEEType, UInt32 count, Object ** pOut))
+{
+    ASSERT(!pEEType->RequiresAlign8());
+    ASSERT(!pEEType->HasFinalizer());
+
+    Thread * pCurThread = ThreadStore::GetCurrentThread();
+    alloc_context * acontext = pCurThread->GetAllocContext();
+
+    size_t size = pEEType->get_BaseSize();
+
+    UInt8* result = acontext->alloc_ptr;
+    size_t cFit = (size_t)(acontext->alloc_limit - result) / size;
+    if (cFit == 0)
+        return 0;
+
+    UInt32 cAllocated = (cFit < count) ? (UInt32)cFit : count;
+    acontext->alloc_ptr = result + (cAllocated * size);
+
+    // The alloc context has been cleared already, so all that's left to do is to stamp the type.
+    for (UInt32 i = 0; i < cAllocated; i++)
+    {
+        Object * pObject = (Object *)result;
+        pObject->set_EEType(pEEType);
+        pOut[i] = pObject;
+        result += size;
+    }
+
+    // The destination array may live in any generation.
+    RhpBulkWriteBarrier(pOut, cAllocated * sizeof(Object *));
+
+    return cAllocated;
+}
+
 COOP_PINVOKE_HELPER(Array *, RhpNewArray, (EEType * pArrayEEType, int numElements))
 {
     ASSERT_MSG(!pArrayEEType->RequiresAlign8(), "NYI");
@@ -182,7 +242,7 @@ COOP_PINVOKE_HELPER(Array *, RhpNewArray, (EEType * pArrayEEType, int numElement
         return pObject;
     }
 
-    pObject = (Array *)RedhawkGCInterface::Alloc(pCurThread, size, 0, pArrayEEType);
+    pObject = (Array *)RedhawkGCInterface::Alloc(pCurThread, size, 0, pArrayEEType, RETURN_ADDRESS());
     if (pObject == nullptr)
     {
         ASSERT_UNCONDITIONALLY("NYI");  // TODO: Throw OOM
@@ -231,7 +291,7 @@ COOP_PINVOKE_HELPER(MDArray *, RhNewMDArray, (EEType * pArrayEEType, UInt32 rank
     else
     {
         needsPublish = true;
-        pObject = (MDArray *)RedhawkGCInterface::Alloc(pCurThread, size, 0, pArrayEEType);
+        pObject = (MDArray *)RedhawkGCInterface::Alloc(pCurThread, size, 0, pArrayEEType, RETURN_ADDRESS());
         if (pObject == nullptr)
         {
             ASSERT_UNCONDITIONALLY("NYI");  // TODO: Throw OOM
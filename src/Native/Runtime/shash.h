@@ -125,10 +125,11 @@ class SHash : public TRAITS
 
     class KeyIndex;
     friend class KeyIndex;
+
+  public:
     class Iterator;
     class KeyIterator;
 
-  public:
     // explicitly declare local typedefs for these traits types, otherwise 
     // the compiler may get confused
     typedef typename TRAITS::element_t element_t;
@@ -374,6 +375,7 @@ private:
         }
     };
 
+public:
     class Iterator : public Index, public Enumerator<Iterator>
     {
         friend class SHash;
@@ -385,6 +387,8 @@ private:
         }
     };
 
+private:
+
     //
     // Index for iterating elements with a given key.  
     // Note that the m_index field is artificially bumped to m_tableSize when the end
@@ -451,6 +455,7 @@ private:
         }
     };
 
+public:
     class KeyIterator : public KeyIndex, public Enumerator<KeyIterator>
     {
         friend class SHash;
@@ -473,6 +478,8 @@ private:
         }
     };
 
+private:
+
     // Test for prime number.
     static bool IsPrime(count_t number);
 
@@ -25,13 +25,12 @@
 #include "RhConfig.h"
 #include "stressLog.h"
 #include "RestrictedCallouts.h"
+#include "PerfMap.h"
+#include "BinaryTrace.h"
+#include "StartupTimeline.h"
 
 #ifndef DACCESS_COMPILE
 
-#ifdef PROFILE_STARTUP
-unsigned __int64 g_startupTimelineEvents[NUM_STARTUP_TIMELINE_EVENTS] = { 0 };
-#endif // PROFILE_STARTUP
-
 HANDLE RtuCreateRuntimeInstance(HANDLE hPalInstance);
 
 
@@ -47,6 +46,16 @@ bool InitDLL(HANDLE hPalInstance)
 {
     CheckForPalFallback();
 
+    InitializeSpinConstants();
+
+    CrstStatic::InitializeContentionStats();
+
+    PerfMap::Initialize();
+
+#ifdef FEATURE_BINARY_TRACE
+    BinaryTrace::Initialize();
+#endif
+
 #ifdef FEATURE_CACHED_INTERFACE_DISPATCH
     //
     // Initialize interface dispatch.
@@ -82,20 +91,24 @@ bool InitDLL(HANDLE hPalInstance)
 #ifdef STRESS_LOG
     UInt32 dwTotalStressLogSize = g_pRhConfig->GetTotalStressLogSize();
     UInt32 dwStressLogLevel = g_pRhConfig->GetStressLogLevel();
+    bool fStressLogToFile = g_pRhConfig->GetStressLogToFile() != 0;
 
     unsigned facility = (unsigned)LF_ALL;
-#ifdef _DEBUG
-    if (dwTotalStressLogSize == 0)
-        dwTotalStressLogSize = 1024 * STRESSLOG_CHUNK_SIZE;
-    if (dwStressLogLevel == 0)
-        dwStressLogLevel = LL_INFO1000;
+#ifndef _DEBUG
+    if (fStressLogToFile)
 #endif
+    {
+        if (dwTotalStressLogSize == 0)
+            dwTotalStressLogSize = 1024 * STRESSLOG_CHUNK_SIZE;
+        if (dwStressLogLevel == 0)
+            dwStressLogLevel = LL_INFO1000;
+    }
     unsigned dwPerThreadChunks = (dwTotalStressLogSize / 24) / STRESSLOG_CHUNK_SIZE;
     if (dwTotalStressLogSize != 0)
     {
         StressLog::Initialize(facility, dwStressLogLevel, 
                               dwPerThreadChunks * STRESSLOG_CHUNK_SIZE, 
-                              (unsigned)dwTotalStressLogSize, hPalInstance);
+                              (unsigned)dwTotalStressLogSize, hPalInstance, fStressLogToFile);
     }
 #endif // STRESS_LOG
 
@@ -157,63 +170,8 @@ void DetectCPUFeatures()
 #endif // !CORERT
 }
 
-#ifdef PROFILE_STARTUP
-#define STD_OUTPUT_HANDLE ((UInt32)-11)
-
-struct RegisterModuleTrace
-{
-    LARGE_INTEGER Begin;
-    LARGE_INTEGER End;
-};
-
-const int NUM_REGISTER_MODULE_TRACES = 16;
-int g_registerModuleCount = 0;
-
-RegisterModuleTrace g_registerModuleTraces[NUM_REGISTER_MODULE_TRACES] = { 0 };
-
-void AppendInt64(char * pBuffer, UInt32* pLen, UInt64 value)
-{
-    char localBuffer[20];
-    int cch = 0;
-
-    do
-    {
-        localBuffer[cch++] = '0' + (value % 10);
-        value = value / 10;
-    } while (value);
-
-    for (int i = 0; i < cch; i++)
-    {
-        pBuffer[(*pLen)++] = localBuffer[cch - i - 1];
-    }
-
-    pBuffer[(*pLen)++] = ',';
-    pBuffer[(*pLen)++] = ' ';
-}
-#endif // PROFILE_STARTUP
-
 bool UninitDLL(HANDLE /*hModDLL*/)
 {
-#ifdef PROFILE_STARTUP
-    char buffer[1024];
-
-    UInt32 len = 0;
-
-    AppendInt64(buffer, &len, g_startupTimelineEvents[PROCESS_ATTACH_BEGIN]);
-    AppendInt64(buffer, &len, g_startupTimelineEvents[NONGC_INIT_COMPLETE]);
-    AppendInt64(buffer, &len, g_startupTimelineEvents[GC_INIT_COMPLETE]);
-    AppendInt64(buffer, &len, g_startupTimelineEvents[PROCESS_ATTACH_COMPLETE]);
-
-    for (int i = 0; i < g_registerModuleCount; i++)
-    {
-        AppendInt64(buffer, &len, g_registerModuleTraces[i].Begin.QuadPart);
-        AppendInt64(buffer, &len, g_registerModuleTraces[i].End.QuadPart);
-    }
-
-    buffer[len++] = '\n';
-
-    fwrite(buffer, len, 1, stdout);
-#endif // PROFILE_STARTUP
     return true;
 }
 
@@ -261,25 +219,14 @@ void __stdcall RuntimeThreadShutdown(void* thread)
 
 COOP_PINVOKE_HELPER(UInt32_BOOL, RhpRegisterModule, (ModuleHeader *pModuleHeader))
 {
-#ifdef PROFILE_STARTUP
-    if (g_registerModuleCount < NUM_REGISTER_MODULE_TRACES)
-    {
-        PalQueryPerformanceCounter(&g_registerModuleTraces[g_registerModuleCount].Begin);
-    }
-#endif // PROFILE_STARTUP
+    UInt64 registrationBegin = StartupTimeline::BeginModuleRegistration();
 
     RuntimeInstance * pInstance = GetRuntimeInstance();
 
     if (!pInstance->RegisterModule(pModuleHeader))
         return UInt32_FALSE;
 
-#ifdef PROFILE_STARTUP
-    if (g_registerModuleCount < NUM_REGISTER_MODULE_TRACES)
-    {
-        PalQueryPerformanceCounter(&g_registerModuleTraces[g_registerModuleCount].End);
-        g_registerModuleCount++;
-    }
-#endif // PROFILE_STARTUP
+    StartupTimeline::EndModuleRegistration(registrationBegin);
 
     return UInt32_TRUE;
 }
@@ -16,6 +16,7 @@
 #include "CommonMacros.h"
 #include "PalRedhawkCommon.h"
 #include "PalRedhawk.h"
+#include "CommonMacros.inl"
 #include "daccess.h"
 #include "stressLog.h"
 #include "holder.h"
@@ -42,6 +43,7 @@ GPTR_IMPL(StressLog, g_pStressLog /*, &StressLog::theLog*/);
 #ifndef DACCESS_COMPILE
 
 HANDLE StressLogChunk::s_LogChunkHeap = NULL;
+StressLogFileHeader* StressLog::s_pFileHeader = NULL;
 
 /*********************************************************************************/
 #if defined(_X86_)
@@ -93,15 +95,34 @@ const static unsigned __int64 RECYCLE_AGE = 0x40000000L;        // after a billi
 #ifndef DACCESS_COMPILE
 
 void StressLog::Initialize(unsigned facilities,  unsigned level, unsigned maxBytesPerThread, 
-            unsigned maxBytesTotal, HANDLE hMod) 
+            unsigned maxBytesTotal, HANDLE hMod, bool fFileBacked) 
 {
-#if !defined(CORERT) // @TODO: CORERT: disabled because of assumption that hMod is a module base address in stress log code
+#if defined(CORERT)
+    // @TODO: CORERT: the log is only enabled with StressLogToFile. hMod isn't a module base address as the
+    // stress log code assumes, so the module holding the format strings is looked up instead. That also makes
+    // the heap usable for the log when the file can't be created.
+    if (!fFileBacked)
+        return;
+    hMod = PalGetModuleHandleFromPointer((void *)ThreadStressLog::gcStartMsg());
+#endif // CORERT
+
     if (theLog.MaxSizePerThread != 0)
     {
         // guard ourself against multiple initialization. First init wins.
         return;
     }
 
+    if (maxBytesTotal < STRESSLOG_CHUNK_SIZE * 256)
+    {
+        maxBytesTotal = STRESSLOG_CHUNK_SIZE * 256;
+    }
+
+    // If the file can't be created the log is kept on the heap, as it is without StressLogToFile.
+    if (fFileBacked)
+    {
+        InitializeFile(maxBytesTotal);
+    }
+
     g_pStressLog = &theLog;
 
     theLog.pLock = new (nothrow) CrstStatic();
@@ -111,11 +132,6 @@ void StressLog::Initialize(unsigned facilities,  unsigned level, unsigned maxByt
         maxBytesPerThread = STRESSLOG_CHUNK_SIZE;
     }
     theLog.MaxSizePerThread = maxBytesPerThread;
-
-    if (maxBytesTotal < STRESSLOG_CHUNK_SIZE * 256)
-    {
-        maxBytesTotal = STRESSLOG_CHUNK_SIZE * 256;
-    }
     theLog.MaxSizeTotal = maxBytesTotal;
     theLog.totalChunk = 0;
     theLog.facilitiesToLog = facilities | LF_ALWAYS;
@@ -129,7 +145,7 @@ void StressLog::Initialize(unsigned facilities,  unsigned level, unsigned maxByt
 
     theLog.moduleOffset = (size_t)hMod; // HMODULES are base addresses.
 
-#ifndef APP_LOCAL_RUNTIME
+#if !defined(APP_LOCAL_RUNTIME) && !defined(CORERT)
     StressLogChunk::s_LogChunkHeap = PalHeapCreate (0, STRESSLOG_CHUNK_SIZE * 128, 0);
     if (StressLogChunk::s_LogChunkHeap == NULL)
 #endif
@@ -137,7 +153,105 @@ void StressLog::Initialize(unsigned facilities,  unsigned level, unsigned maxByt
         StressLogChunk::s_LogChunkHeap = PalGetProcessHeap ();
     }
     _ASSERTE (StressLogChunk::s_LogChunkHeap);
-#endif // !defined(CORERT)
+
+    if (s_pFileHeader != NULL)
+    {
+        s_pFileHeader->tickFrequency = theLog.tickFrequency;
+        s_pFileHeader->startTimeStamp = theLog.startTimeStamp;
+        s_pFileHeader->moduleOffset = theLog.moduleOffset;
+
+        const TCHAR * pszModulePath;
+        if ((PalGetModuleFileName(&pszModulePath, hMod) != 0) && (pszModulePath != NULL))
+        {
+            for (int i = 0; (i < STRESSLOG_FILE_MAX_PATH - 1) && (pszModulePath[i] != 0); i++)
+                s_pFileHeader->modulePath[i] = (char)pszModulePath[i];
+        }
+
+        // Let readers know the header is complete.
+        VolatileStore(&s_pFileHeader->magic, (UInt64)STRESSLOG_FILE_MAGIC);
+    }
+}
+
+/*********************************************************************************/
+/* map the file backing the log, see StressLogFileHeader                         */
+
+bool StressLog::InitializeFile(unsigned maxBytesTotal)
+{
+    // AllowNewChunk doesn't strictly enforce the total size, leave some room for threads racing past it. Every
+    // ThreadStressLog owns at least one chunk, so there can't be more of them than there are chunks.
+    UInt32 cMaxChunks = (maxBytesTotal / STRESSLOG_CHUNK_SIZE) + 16;
+    UInt32 cbThreadLogSlot = (UInt32)ALIGN_UP(sizeof(ThreadStressLog), sizeof(UInt64));
+    UInt32 threadLogsOffset = (UInt32)ALIGN_UP(sizeof(StressLogFileHeader), OS_PAGE_SIZE);
+    UInt64 chunksOffset = ALIGN_UP((UInt64)threadLogsOffset + (UInt64)cMaxChunks * cbThreadLogSlot, OS_PAGE_SIZE);
+    UInt64 cbMapping = chunksOffset + (UInt64)cMaxChunks * sizeof(StressLogChunk);
+
+    char szFileName[PAL_MAX_OUTPUT_FILE_NAME];
+    if (!PalGetOutputFileName("rhstresslog", ".log", szFileName, sizeof(szFileName)))
+        return false;
+
+    // The mapping is zero filled, so all counts and the module path start out empty.
+    StressLogFileHeader * pHeader = (StressLogFileHeader *)PalMapOutputFile(szFileName, (UIntNative)cbMapping);
+    if (pHeader == NULL)
+        return false;
+
+    pHeader->version = STRESSLOG_FILE_VERSION;
+    pHeader->cbPointer = sizeof(void *);
+    pHeader->mappingBase = (UInt64)(UIntNative)pHeader;
+    pHeader->cbMapping = cbMapping;
+    pHeader->threadLogsOffset = threadLogsOffset;
+    pHeader->cbThreadLogSlot = cbThreadLogSlot;
+    pHeader->cMaxThreadLogs = cMaxChunks;
+    pHeader->chunksOffset = chunksOffset;
+    pHeader->cbChunk = sizeof(StressLogChunk);
+    pHeader->cMaxChunks = cMaxChunks;
+    pHeader->cbChunkBuffer = STRESSLOG_CHUNK_SIZE;
+    pHeader->offsetOfChunkNext = offsetof(StressLogChunk, next);
+    pHeader->offsetOfChunkBuf = offsetof(StressLogChunk, buf);
+    pHeader->offsetOfThreadId = offsetof(ThreadStressLog, threadId);
+    pHeader->offsetOfIsDead = offsetof(ThreadStressLog, isDead);
+    pHeader->offsetOfWriteHasWrapped = offsetof(ThreadStressLog, writeHasWrapped);
+    pHeader->offsetOfCurPtr = offsetof(ThreadStressLog, curPtr);
+    pHeader->offsetOfChunkListHead = offsetof(ThreadStressLog, chunkListHead);
+    pHeader->offsetOfChunkListTail = offsetof(ThreadStressLog, chunkListTail);
+    pHeader->offsetOfCurWriteChunk = offsetof(ThreadStressLog, curWriteChunk);
+
+    s_pFileHeader = pHeader;
+    return true;
+}
+
+// Chunks are allocated by the logging threads themselves without taking any locks.
+void* StressLog::AllocateFileChunk()
+{
+    StressLogFileHeader * pHeader = s_pFileHeader;
+    Int32 iChunk = PalInterlockedIncrement(&pHeader->cChunks) - 1;
+    if ((UInt32)iChunk >= pHeader->cMaxChunks)
+    {
+        // Keep the count from wrapping around should threads keep trying.
+        PalInterlockedDecrement(&pHeader->cChunks);
+        return NULL;
+    }
+
+    return (UInt8 *)pHeader + pHeader->chunksOffset + (UIntNative)iChunk * pHeader->cbChunk;
+}
+
+void* StressLog::AllocateFileThreadLog()
+{
+    StressLogFileHeader * pHeader = s_pFileHeader;
+    Int32 iThreadLog = PalInterlockedIncrement(&pHeader->cThreadLogs) - 1;
+    if ((UInt32)iThreadLog >= pHeader->cMaxThreadLogs)
+    {
+        PalInterlockedDecrement(&pHeader->cThreadLogs);
+        return NULL;
+    }
+
+    return (UInt8 *)pHeader + pHeader->threadLogsOffset + (UIntNative)iThreadLog * pHeader->cbThreadLogSlot;
+}
+
+bool StressLog::IsInFile(void * pv)
+{
+    StressLogFileHeader * pHeader = s_pFileHeader;
+    return (pHeader != NULL) &&
+           ((UIntNative)pv - (UIntNative)pHeader < (UIntNative)pHeader->cbMapping);
 }
 
 /*********************************************************************************/
@@ -157,7 +271,8 @@ ThreadStressLog* StressLog::CreateThreadStressLog(Thread * pThread) {
         return msgs;
     }
 
-    // if it looks like we won't be allowed to allocate a new chunk, exit early
+    // if it looks like we won't be allowed to allocate a new chunk, exit early (with the log in a file, once
+    // all of its chunks are handed out)
     if (VolatileLoad(&theLog.deadCount) == 0 && !AllowNewChunk (0))
     {
         return NULL;
@@ -209,8 +324,8 @@ ThreadStressLog* StressLog::CreateThreadStressLogHelper(Thread * pThread) {
             msgs = msgs->next;
         }
 
-        //if the total stress log size limit is already passed and we can't add new chunk,
-        //always reuse the oldest dead msg
+        //if the total stress log size limit is already passed (or the file holding the log is full) and we
+        //can't add new chunk, always reuse the oldest dead msg
         if (!AllowNewChunk (0) && !msgs)
         {
             msgs = oldestDeadMsg;
@@ -272,6 +387,11 @@ bool StressLog::AllowNewChunk (long numChunksInCurThread)
     _ASSERTE (numChunksInCurThread <= VolatileLoad(&theLog.totalChunk));
     UInt32 perThreadLimit = theLog.MaxSizePerThread;
 
+    // The file holding the log has a fixed number of chunks, not even the first chunk of a thread can be
+    // allocated once they are all handed out.
+    if (s_pFileHeader != NULL && (UInt32)VolatileLoad(&s_pFileHeader->cChunks) >= s_pFileHeader->cMaxChunks)
+        return FALSE;
+
     if (numChunksInCurThread == 0 /*&& IsSuspendEEThread()*/)
         return TRUE;
 
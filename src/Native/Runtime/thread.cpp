@@ -19,6 +19,8 @@
 #include "event.h"
 #include "RWLock.h"
 #include "threadstore.h"
+#include "AllocationSampler.h"
+#include "BinaryTrace.h"
 #include "RuntimeInstance.h"
 #include "shash.h"
 #include "module.h"
@@ -77,6 +79,7 @@ void Thread::LeaveRendezVous(void * pTransitionFrame)
     if (ThreadStore::IsTrapThreadsRequested())
     {
         Unhijack();
+        GetThreadStore()->SignalSafePointReached();
         GetThreadStore()->WaitForSuspendComplete();
     }
 }
@@ -375,6 +378,14 @@ void Thread::Destroy()
         delete[] m_pDynamicTypesTlsCells;
     }
 
+    OrphanPendingFinalizables();
+
+    AllocationSampler::ReleaseThread(this);
+
+#ifdef FEATURE_BINARY_TRACE
+    BinaryTrace::ReleaseCurrentThreadBuffer();
+#endif
+
     RedhawkGCInterface::ReleaseAllocContext(GetAllocContext());
 
     // Thread::Destroy is called when the thread's "home" fiber dies.  We mark the thread as "detached" here
@@ -383,6 +394,16 @@ void Thread::Destroy()
     SetDetached();
 }
 
+AllocSamplerThreadState * Thread::GetAllocSamplerState()
+{
+    return m_pAllocSamplerState;
+}
+
+void Thread::SetAllocSamplerState(AllocSamplerThreadState * pState)
+{
+    m_pAllocSamplerState = pState;
+}
+
 void Thread::GcScanRoots(void * pfnEnumCallback, void * pvCallbackData)
 {
     StackFrameIterator  frameIterator(this, GetTransitionFrame());
@@ -872,6 +893,7 @@ EXTERN_C void FASTCALL RhpPInvokeWaitEx(Thread * pThread)
 #endif // _DEBUG
 
     pThread->Unhijack();
+    GetThreadStore()->SignalSafePointReached();
     GetThreadStore()->WaitForSuspendComplete();
 
     ASSERT_MSG(uLastErrorOnEntry == PalGetLastError(), "Unexpectedly trashed last error on PInvoke path!");
@@ -890,6 +912,8 @@ EXTERN_C void FASTCALL RhpPInvokeReturnWaitEx(Thread * pThread)
     pThread->Unhijack();
     if (!pThread->IsDoNotTriggerGcSet())
     {
+        // Threads arriving here from a hijack have just reached a safe point.
+        GetThreadStore()->SignalSafePointReached();
         RedhawkGCInterface::WaitForGCCompletion();
     }
 
@@ -8,6 +8,8 @@ class RuntimeInstance;
 class ThreadStore;
 class CLREventStatic;
 class Thread;
+struct AllocSamplerThreadState;
+struct PendingFinalizables;
 
 // The offsets of some fields in the thread (in particular, m_pTransitionFrame) are known to the compiler and get 
 // inlined into the code.  Let's make sure they don't change just because we enable/disable server GC in a particular
@@ -91,6 +93,10 @@ struct ThreadBuffer
     // Thread Statics Storage for dynamic types
     UInt32          m_numDynamicTypesTlsCells;
     PTR_UInt8*      m_pDynamicTypesTlsCells;
+
+    PendingFinalizables *       m_pPendingFinalizables;         // see Thread::FlushPendingFinalizables
+
+    AllocSamplerThreadState *   m_pAllocSamplerState;           // see AllocationSampler
 };
 
 struct ReversePInvokeFrame
@@ -189,6 +195,16 @@ public:
 
     PTR_UInt8           AllocateThreadLocalStorageForDynamicType(UInt32 uTlsTypeOffset, UInt32 tlsStorageSize, UInt32 numTlsCells);
     PTR_UInt8           GetThreadLocalStorageForDynamicType(UInt32 uTlsTypeOffset);
+
+#ifndef DACCESS_COMPILE
+    bool                ReservePendingFinalizable();
+    void                AddPendingFinalizable(Object * pObject);
+    void                FlushPendingFinalizables();
+    void                OrphanPendingFinalizables();
+
+    AllocSamplerThreadState *   GetAllocSamplerState();
+    void                SetAllocSamplerState(AllocSamplerThreadState * pState);
+#endif // !DACCESS_COMPILE
     PTR_UInt8           GetThreadLocalStorage(UInt32 uTlsIndex, UInt32 uTlsStartOffset);
     PTR_UInt8           GetTEB();
 
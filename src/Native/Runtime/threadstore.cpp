@@ -26,6 +26,7 @@
 
 #include "slist.inl"
 #include "GCMemoryHelpers.h"
+#include "stressLog.h"
 
 EXTERN_C volatile UInt32 RhpTrapThreads = 0;
 
@@ -60,7 +61,8 @@ PTR_Thread ThreadStore::Iterator::GetNext()
 
 ThreadStore::ThreadStore() : 
     m_ThreadList(),
-    m_Lock()
+    m_Lock(),
+    m_pLockReaderIndicator(NULL)
 {
 }
 
@@ -83,6 +85,7 @@ ThreadStore * ThreadStore::Create(RuntimeInstance * pRuntimeInstance)
         return NULL;
 
     pNewThreadStore->m_SuspendCompleteEvent.CreateManualEvent(TRUE);
+    pNewThreadStore->m_SafePointReachedEvent.CreateAutoEvent(FALSE);
 
     pNewThreadStore->m_pRuntimeInstance = pRuntimeInstance;
 
@@ -200,11 +203,74 @@ void ThreadStore::DetachCurrentThread()
 // effect of being a memory barrier.
 void ThreadStore::LockThreadStore()
 {
-    m_Lock.AcquireReadLock();
+    m_pLockReaderIndicator = m_Lock.AcquireReadLock();
 }
 void ThreadStore::UnlockThreadStore()
 { 
-    m_Lock.ReleaseReadLock();
+    m_Lock.ReleaseReadLock(m_pLockReaderIndicator);
+}
+
+// Suspension tuning. The suspending thread spins (with exponentially increasing spin counts, up to a limit) for
+// the first few passes over the thread list since most threads reach a safe point very quickly. After that it
+// blocks on m_SafePointReachedEvent, which is signalled whenever a thread arrives at a safe point, with a short
+// timeout so that threads that need to be hijacked again are still revisited. Only hijacked threads signal the
+// event though: threads which leave managed code through an inlined p/invoke transition don't, and neither do
+// those which couldn't be hijacked (on Unix none can be). As long as any such thread is pending the suspending
+// thread keeps spinning instead, since every wait would run to its timeout.
+#define SUSPEND_SPIN_PASSES             8
+#define SUSPEND_INITIAL_SPIN_COUNT      64
+#define SUSPEND_MAX_SPIN_COUNT          (SUSPEND_INITIAL_SPIN_COUNT << SUSPEND_SPIN_PASSES)
+#define SUSPEND_WAIT_TIMEOUT_MS         1
+
+// Kept in a global so that it can also be inspected from a debugger when diagnosing long GC pauses.
+EXTERN_C SuspendStats g_SuspendStats = {};
+
+static UInt64 GetSuspendTimestampUsec()
+{
+    static UInt64 s_ticksPerSecond = 0;
+    if (s_ticksPerSecond == 0)
+    {
+        LARGE_INTEGER frequency;
+        PalQueryPerformanceFrequency(&frequency);
+        s_ticksPerSecond = frequency.QuadPart;
+    }
+
+    LARGE_INTEGER ticks;
+    PalQueryPerformanceCounter(&ticks);
+    // Split the conversion so that it doesn't overflow: on Unix the counter is in microseconds since the epoch.
+    UInt64 t = (UInt64)ticks.QuadPart;
+    return (t / s_ticksPerSecond) * 1000000 + ((t % s_ticksPerSecond) * 1000000) / s_ticksPerSecond;
+}
+
+// pSlowestThread is one of the cSlowestThreads threads which were still running on the last pass that had to
+// wait, i.e. which reached a safe point last.
+static void RecordSuspendTime(UInt64 elapsedUsec, UInt32 cPasses, Thread * pSlowestThread, UInt32 cSlowestThreads)
+{
+    UInt32 bucket = 0;
+    while ((bucket < SUSPEND_TIME_HISTOGRAM_BUCKETS - 1) && ((elapsedUsec >> (bucket + 1)) != 0))
+        bucket++;
+    g_SuspendStats.m_rgTimeHistogram[bucket]++;
+
+    UInt64 slowestThreadId = (pSlowestThread != NULL) ? pSlowestThread->GetPalThreadIdForLogging() : 0;
+    if (elapsedUsec > g_SuspendStats.m_MaxTimeUsec)
+    {
+        g_SuspendStats.m_MaxTimeUsec = elapsedUsec;
+        g_SuspendStats.m_SlowestThreadId = slowestThreadId;
+    }
+
+    STRESS_LOG4(LF_GC, LL_INFO10, "SuspendAllThreads: %d us, %d passes, %d threads on the last pass including %llx\n",
+        (UInt32)elapsedUsec, cPasses, cSlowestThreads, slowestThreadId);
+}
+
+// Copy the runtime suspension statistics (a SuspendStats structure, see threadstore.h) to pBuffer if cbBuffer is
+// large enough. Returns the size of the statistics. Being a cooperative mode helper this never observes the
+// statistics in the middle of an update by a suspension.
+COOP_PINVOKE_HELPER(UInt32, RhGetSuspendStats, (void * pBuffer, UInt32 cbBuffer))
+{
+    if (cbBuffer >= sizeof(SuspendStats))
+        memcpy(pBuffer, &g_SuspendStats, sizeof(SuspendStats));
+
+    return sizeof(SuspendStats);
 }
 
 void ThreadStore::SuspendAllThreads(CLREventStatic* pCompletionEvent)
@@ -213,10 +279,13 @@ void ThreadStore::SuspendAllThreads(CLREventStatic* pCompletionEvent)
 
     LockThreadStore();
 
+    UInt64 startUsec = GetSuspendTimestampUsec();
+
     RhpSuspendingThread = pThisThread;
 
     pCompletionEvent->Reset();
     m_SuspendCompleteEvent.Reset();
+    m_SafePointReachedEvent.Reset();
 
     // set the global trap for pinvoke leave and return
     RhpTrapThreads = 1;
@@ -226,20 +295,35 @@ void ThreadStore::SuspendAllThreads(CLREventStatic* pCompletionEvent)
     PalFlushProcessWriteBuffers();
 
     bool keepWaiting;
+    UInt32 cPasses = 0;
+    UInt32 spinCount = SUSPEND_INITIAL_SPIN_COUNT;
+    Thread * pSlowestThread = NULL;
+    UInt32 cSlowestThreads = 0;
     do
     {
         keepWaiting = false;
+        bool fAllPendingSignal = true;
+        Thread * pPendingThread = NULL;
+        UInt32 cPendingThreads = 0;
         FOREACH_THREAD(pTargetThread)
         {
             if (pTargetThread == pThisThread)
                 continue;
 
+            // Threads that have reached preemptive mode stay there until the suspension is over, so this
+            // is cheap for every thread which has already been dealt with on a previous pass.
             if (!pTargetThread->CacheTransitionFrameForSuspend())
             {
                 // We drive all threads to preemptive mode by hijacking them with both a
-                // return-address hijack and loop hijacks.
+                // return-address hijack and loop hijacks. The thread may have returned past the hijack of an
+                // earlier pass, so it's hijacked again on every pass. A thread with a return address hijack
+                // signals when it reaches the hijack, other ways of reaching a safe point from cooperative mode
+                // don't.
                 keepWaiting = true;
-                pTargetThread->Hijack();
+                pPendingThread = pTargetThread;
+                cPendingThreads++;
+                if (!pTargetThread->Hijack())
+                    fAllPendingSignal = false;
             }
             else if (pTargetThread->DangerousCrossThreadIsHijacked())
             {
@@ -248,29 +332,47 @@ void ThreadStore::SuspendAllThreads(CLREventStatic* pCompletionEvent)
                 // stackwalk and find the hijack still on the stack, which will cause the 
                 // stackwalking code to crash.
                 keepWaiting = true;
+                pPendingThread = pTargetThread;
+                cPendingThreads++;
             }
         }
         END_FOREACH_THREAD
 
         if (keepWaiting)
         {
-            if (PalSwitchToThread() == 0 && g_SystemInfo.dwNumberOfProcessors > 1)
+            pSlowestThread = pPendingThread;
+            cSlowestThreads = cPendingThreads;
+            cPasses++;
+
+            if ((cPasses <= SUSPEND_SPIN_PASSES) || !fAllPendingSignal)
             {
-                // No threads are scheduled on this processor.  Perhaps we're waiting for a thread
-                // that's scheduled on another processor.  If so, let's give it a little time
-                // to make forward progress.  
-                // Note that we do not call Sleep, because the minimum granularity of Sleep is much
-                // too long (we probably don't need a 15ms wait here).  Instead, we'll just burn some
-                // cycles.
-    	        // @TODO: need tuning for spin
-                for (int i = 0; i < 10000; i++)
-                    PalYieldProcessor();
+                if (PalSwitchToThread() == 0 && g_SystemInfo.dwNumberOfProcessors > 1)
+                {
+                    // No threads are scheduled on this processor.  Perhaps we're waiting for a thread
+                    // that's scheduled on another processor.  If so, let's give it a little time
+                    // to make forward progress.  
+                    // Note that we do not call Sleep, because the minimum granularity of Sleep is much
+                    // too long (we probably don't need a 15ms wait here).  Instead, we'll just burn some
+                    // cycles, backing off exponentially.
+                    for (UInt32 i = 0; i < spinCount; i++)
+                        PalYieldProcessor();
+
+                    spinCount = min(spinCount * 2, SUSPEND_MAX_SPIN_COUNT);
+                }
+            }
+            else
+            {
+                // The remaining threads are taking a while. Block until one of them reaches a safe point
+                // (or the timeout expires so that we can hijack again).
+                m_SafePointReachedEvent.Wait(SUSPEND_WAIT_TIMEOUT_MS, false);
             }
         }
 
     } while (keepWaiting);
 
     m_SuspendCompleteEvent.Set();
+
+    RecordSuspendTime(GetSuspendTimestampUsec() - startUsec, cPasses, pSlowestThread, cSlowestThreads);
 }
 
 void ThreadStore::ResumeAllThreads(CLREventStatic* pCompletionEvent)
@@ -295,6 +397,13 @@ bool ThreadStore::IsTrapThreadsRequested()
     return (RhpTrapThreads != 0);
 }
 
+// Called by a thread that has just reached a safe point (i.e. switched to preemptive mode) while a suspension is
+// in progress, to let the suspending thread know it might not have to wait any longer.
+void ThreadStore::SignalSafePointReached()
+{
+    m_SafePointReachedEvent.Set();
+}
+
 void ThreadStore::WaitForSuspendComplete()
 {
     UInt32 waitResult = m_SuspendCompleteEvent.Wait(INFINITE, false);
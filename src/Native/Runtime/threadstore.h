@@ -7,12 +7,26 @@ class RuntimeInstance;
 class Array;
 typedef DPTR(RuntimeInstance) PTR_RuntimeInstance;
 
+// Statistics on how long it takes to suspend the runtime, see RhGetSuspendStats. Bucket i of the histogram counts
+// suspensions that took [2^i, 2^(i+1)) microseconds (bucket 0 also counts those that took less than a
+// microsecond, the last bucket counts everything longer).
+#define SUSPEND_TIME_HISTOGRAM_BUCKETS  20
+
+struct SuspendStats
+{
+    UInt32  m_rgTimeHistogram[SUSPEND_TIME_HISTOGRAM_BUCKETS];
+    UInt64  m_MaxTimeUsec;
+    UInt64  m_SlowestThreadId;      // OS id of a thread still running on the last pass of the slowest suspension
+};
+
 class ThreadStore
 {
     SList<Thread>       m_ThreadList;
     PTR_RuntimeInstance m_pRuntimeInstance;
     CLREventStatic      m_SuspendCompleteEvent;
+    CLREventStatic      m_SafePointReachedEvent;
     ReaderWriterLock    m_Lock;
+    ReaderWriterLock::ReaderIndicator * m_pLockReaderIndicator;    // how LockThreadStore acquired m_Lock, NULL if through the lock word
 
 private:
     ThreadStore();
@@ -51,6 +65,7 @@ public:
 
     static bool IsTrapThreadsRequested();
     void        WaitForSuspendComplete();
+    void        SignalSafePointReached();
 };
 typedef DPTR(ThreadStore) PTR_ThreadStore;
 
@@ -0,0 +1,253 @@
+# Licensed to the .NET Foundation under one or more agreements.
+# The .NET Foundation licenses this file to you under the MIT license.
+# See the LICENSE file in the project root for more information.
+
+"""
+Decoder for the heap snapshots written by RhpWriteHeapSnapshot (see src/Native/Runtime/HeapSnapshot.h for
+the format).
+
+usage: heapsnapshot.py <snapshot> [--top <n>] [--path <object address>] [--dump]
+
+By default prints the number of objects, references and roots and the <n> (default 20) types owning the
+most bytes, by EEType address. --path prints the shortest chain of references from a root to the given object,
+which is usually what's keeping a leaked object alive. --dump prints every root and object.
+"""
+import struct
+import sys
+from collections import deque
+
+MAGIC = 0x50414e5350414548
+VERSION = 1
+
+FILE_HEADER = struct.Struct('<QIIQII')
+
+TAG_THREAD = 0x01
+TAG_ROOT = 0x10
+TAG_OBJECT = 0x20
+TAG_END = 0x7F
+
+ROOT_KINDS = {0: 'stack', 1: 'static', 2: 'handle'}
+ROOT_FLAG_INTERIOR = 0x1
+ROOT_FLAG_PINNED = 0x2
+ROOT_HANDLE_TYPE_SHIFT = 2
+HANDLE_TYPES = {0: 'weak-short', 1: 'weak-long', 2: 'strong', 3: 'pinned', 4: 'variable', 5: 'refcounted',
+                6: 'dependent', 7: 'async-pinned', 8: 'sizedref'}
+WEAK_HANDLE_TYPES = (0, 1)
+GENERATIONS = {0: 'gen0', 1: 'gen1', 2: 'gen2', 3: 'loh'}
+
+TYPE_CACHE_BITS = 12
+MASK64 = (1 << 64) - 1
+
+
+def type_cache_slot(address):
+    return (((address >> 3) * 0x9E3779B97F4A7C15) & MASK64) >> (64 - TYPE_CACHE_BITS)
+
+
+class Reader(object):
+    def __init__(self, data, offset):
+        self.data = data
+        self.offset = offset
+
+    def byte(self):
+        b = self.data[self.offset]
+        self.offset += 1
+        return b if isinstance(b, int) else ord(b)
+
+    def unsigned(self):
+        result = 0
+        shift = 0
+        while True:
+            b = self.byte()
+            result |= (b & 0x7F) << shift
+            if b < 0x80:
+                return result
+            shift += 7
+
+    def signed(self):
+        value = self.unsigned()
+        return (value >> 1) ^ -(value & 1)
+
+
+def read_snapshot(path, on_root, on_object):
+    """Calls on_root(kind, flags, address, thread_id) and on_object(address, gen, type, size, refs) for each
+    record, returns the header and the counts from the end record (None if the snapshot is incomplete)."""
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    if len(data) < FILE_HEADER.size:
+        raise ValueError('%s: truncated header' % path)
+    magic, version, cb_pointer, gc_index, pid, _ = FILE_HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise ValueError('%s: not a heap snapshot' % path)
+    if version != VERSION:
+        raise ValueError('%s: unsupported version %d' % (path, version))
+    header = {'pointer_size': cb_pointer, 'gc_index': gc_index, 'pid': pid}
+
+    r = Reader(data, FILE_HEADER.size)
+    type_cache = [0] * (1 << TYPE_CACHE_BITS)
+    last_root = 0
+    last_object_end = 0
+    thread_id = None
+    try:
+        while r.offset < len(data):
+            tag = r.byte()
+            if tag == TAG_THREAD:
+                thread_id = r.unsigned()
+            elif TAG_ROOT <= tag < TAG_ROOT + len(ROOT_KINDS):
+                flags = r.unsigned()
+                last_root = (last_root + r.signed()) & MASK64
+                on_root(tag - TAG_ROOT, flags, last_root, thread_id if tag == TAG_ROOT else None)
+            elif TAG_OBJECT <= tag < TAG_OBJECT + len(GENERATIONS):
+                address = (last_object_end + r.signed()) & MASK64
+                type_ref = r.unsigned()
+                slot = type_ref >> 1
+                if type_ref & 1:
+                    type_cache[slot] = r.unsigned()
+                size = r.unsigned()
+                refs = []
+                last_ref = address
+                for _ in range(r.unsigned()):
+                    last_ref = (last_ref + r.signed()) & MASK64
+                    refs.append(last_ref)
+                on_object(address, tag - TAG_OBJECT, type_cache[slot], size, refs)
+                last_object_end = address + size
+            elif tag == TAG_END:
+                return header, (r.unsigned(), r.unsigned(), r.unsigned())
+            else:
+                raise ValueError('%s: unknown record 0x%x at offset %d' % (path, tag, r.offset - 1))
+    except IndexError:
+        pass
+    return header, None
+
+
+def describe_root(kind, flags):
+    text = ROOT_KINDS.get(kind, 'root%d' % kind)
+    if kind == 2:
+        text += '(%s)' % HANDLE_TYPES.get(flags >> ROOT_HANDLE_TYPE_SHIFT, '?')
+    if flags & ROOT_FLAG_PINNED:
+        text += ' pinned'
+    if flags & ROOT_FLAG_INTERIOR:
+        text += ' interior'
+    return text
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write(__doc__)
+        return 1
+
+    top = 20
+    target = None
+    dump = False
+    i = 2
+    while i < len(argv):
+        if argv[i] == '--top' and i + 1 < len(argv):
+            top = int(argv[i + 1])
+            i += 2
+        elif argv[i] == '--path' and i + 1 < len(argv):
+            target = int(argv[i + 1], 16)
+            i += 2
+        elif argv[i] == '--dump':
+            dump = True
+            i += 1
+        else:
+            sys.stderr.write(__doc__)
+            return 1
+
+    roots = []
+    types = {}
+    generations = {}
+    objects = {}
+
+    def on_root(kind, flags, address, thread_id):
+        if dump:
+            print('root   %016x %s%s' % (address, describe_root(kind, flags),
+                                         ' thread %d' % thread_id if thread_id is not None else ''))
+        if target is not None:
+            # Weak handles don't keep anything alive.
+            if not (kind == 2 and (flags >> ROOT_HANDLE_TYPE_SHIFT) in WEAK_HANDLE_TYPES):
+                roots.append((address, describe_root(kind, flags), thread_id))
+
+    def on_object(address, gen, type_address, size, refs):
+        if dump:
+            print('object %016x %-4s type %016x size %d refs %s' % (
+                address, GENERATIONS[gen], type_address, size, ' '.join('%x' % ref for ref in refs)))
+        count, total = types.get(type_address, (0, 0))
+        types[type_address] = (count + 1, total + size)
+        count, total = generations.get(gen, (0, 0))
+        generations[gen] = (count + 1, total + size)
+        if target is not None:
+            objects[address] = (type_address, size, refs)
+
+    header, counts = read_snapshot(argv[1], on_root, on_object)
+
+    if target is not None:
+        return print_path(objects, roots, target)
+
+    if counts is None:
+        print('warning: the snapshot is incomplete')
+        counts = (sum(c for c, _ in generations.values()), 0, 0)
+    print('pid %d, gc %d, %d objects, %d references, %d roots' % (header['pid'], header['gc_index'],
+                                                                 counts[0], counts[1], counts[2]))
+    for gen in sorted(generations):
+        print('  %-4s %10d objects %14d bytes' % (GENERATIONS[gen], generations[gen][0], generations[gen][1]))
+    print('')
+    print('%16s %10s %14s' % ('EEType', 'count', 'bytes'))
+    for type_address, (count, total) in sorted(types.items(), key=lambda t: -t[1][1])[:top]:
+        print('%016x %10d %14d' % (type_address, count, total))
+    return 0
+
+
+def print_path(objects, roots, target):
+    # Roots reported as interior pointers or conservatively may point inside an object, map them to the object
+    # containing them.
+    starts = sorted(objects)
+
+    def containing_object(address):
+        lo, hi = 0, len(starts)
+        while lo < hi:
+            mid = (lo + hi) // 2
+            if starts[mid] <= address:
+                lo = mid + 1
+            else:
+                hi = mid
+        if lo > 0:
+            start = starts[lo - 1]
+            if address < start + objects[start][1]:
+                return start
+        return None
+
+    parent = {}
+    queue = deque()
+    for address, description, thread_id in roots:
+        start = containing_object(address)
+        if start is not None and start not in parent:
+            parent[start] = (None, description, thread_id)
+            queue.append(start)
+
+    while queue and target not in parent:
+        address = queue.popleft()
+        for ref in objects[address][2]:
+            if ref in objects and ref not in parent:
+                parent[ref] = (address, None, None)
+                queue.append(ref)
+
+    if target not in parent:
+        print('%x is not reachable from any root' % target)
+        return 1
+
+    chain = []
+    address = target
+    while address is not None:
+        chain.append(address)
+        previous, description, thread_id = parent[address]
+        if previous is None:
+            print('root: %s%s' % (description, ' thread %d' % thread_id if thread_id is not None else ''))
+        address = previous
+    for address in reversed(chain):
+        print('  %016x type %016x size %d' % (address, objects[address][0], objects[address][1]))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
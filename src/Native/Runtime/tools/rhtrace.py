@@ -0,0 +1,146 @@
+# Licensed to the .NET Foundation under one or more agreements.
+# The .NET Foundation licenses this file to you under the MIT license.
+# See the LICENSE file in the project root for more information.
+
+"""
+Decoder for the binary traces written by the runtime on platforms without ETW (see
+src/Native/Runtime/BinaryTrace.h and BinaryTraceEvents.h for the format).
+
+usage: rhtrace.py <trace file> [--csv]
+
+Prints one line per event, sorted by timestamp, with the time in milliseconds since the start
+of the session. With --csv the events are printed as comma separated values instead.
+"""
+import struct
+import sys
+
+MAGIC = 0x45434152544852
+VERSION = 1
+RECORD_ALIGNMENT = 16
+
+FILE_HEADER = struct.Struct('<QIIQQII')
+RECORD_HEADER = struct.Struct('<HHIQ')
+
+GENERATION_DATA_FIELDS = [
+    'size_before', 'free_list_space_before', 'free_obj_space_before',
+    'size_after', 'free_list_space_after', 'free_obj_space_after',
+    'in', 'pinned_surv', 'npinned_surv', 'new_allocation',
+]
+
+def fixed(fmt, names):
+    s = struct.Struct('<' + fmt)
+    def decode(payload, header):
+        return list(zip(names, s.unpack_from(payload)))
+    return decode
+
+def no_payload(payload, header):
+    return []
+
+def segment(payload, header):
+    address, size = struct.unpack_from('<QQ', payload)
+    return [('address', '0x%x' % address), ('size', size)]
+
+def free_segment(payload, header):
+    address, size = struct.unpack_from('<QQ', payload)
+    return [('address', '0x%x' % address)]
+
+PER_HEAP_HISTORY = struct.Struct('<7Q8I')
+PER_HEAP_HISTORY_NAMES = [
+    'free_list_allocated', 'free_list_rejected', 'end_of_seg_allocated', 'condemned_allocated',
+    'pinned_allocated', 'pinned_allocated_advance', 'extra_gen0_commit',
+    'running_free_list_efficiency', 'condemn_reasons0', 'condemn_reasons1',
+    'compact_mechanisms', 'expand_mechanisms', 'heap_index',
+]
+
+def per_heap_history(payload, header):
+    values = PER_HEAP_HISTORY.unpack_from(payload)
+    fields = list(zip(PER_HEAP_HISTORY_NAMES, values[:13]))
+    generations, cb_generation_data = values[13], values[14]
+    pointer_format = 'Q' if header['pointer_size'] == 8 else 'I'
+    count = cb_generation_data // header['pointer_size']
+    for gen in range(generations):
+        offset = PER_HEAP_HISTORY.size + gen * cb_generation_data
+        data = struct.unpack_from('<%d%s' % (count, pointer_format), payload, offset)
+        for name, value in zip(GENERATION_DATA_FIELDS, data):
+            fields.append(('gen%d.%s' % (gen, name), value))
+    return fields
+
+EVENTS = {
+    1:  ('LostEvents', fixed('I', ['count'])),
+    10: ('GCStart', fixed('II', ['count', 'depth'])),
+    11: ('GCEnd', fixed('II', ['count', 'depth'])),
+    12: ('GCTriggered', fixed('I', ['reason'])),
+    13: ('GCSuspendEEBegin', fixed('II', ['reason', 'count'])),
+    14: ('GCSuspendEEEnd', no_payload),
+    15: ('GCRestartEEBegin', no_payload),
+    16: ('GCRestartEEEnd', no_payload),
+    17: ('GCAllocationTick', fixed('I', ['amount'])),
+    18: ('GCCreateSegment', segment),
+    19: ('GCFreeSegment', free_segment),
+    20: ('GCGlobalHeapHistory', fixed('Q8I', ['final_youngest_desired', 'num_heaps', 'condemned_generation',
+                                             'gen0_reduction_count', 'reason', 'global_mechanisms',
+                                             'pause_mode', 'memory_pressure'])),
+    21: ('GCPerHeapHistory', per_heap_history),
+}
+
+def read_trace(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    if len(data) < FILE_HEADER.size:
+        raise ValueError('%s: truncated file header' % path)
+
+    magic, version, pointer_size, frequency, start, pid, _ = FILE_HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise ValueError('%s: not a runtime binary trace' % path)
+    if version != VERSION:
+        raise ValueError('%s: unsupported version %d' % (path, version))
+
+    header = {'pointer_size': pointer_size, 'frequency': frequency, 'start': start, 'pid': pid}
+
+    events = []
+    offset = FILE_HEADER.size
+    while offset + RECORD_HEADER.size <= len(data):
+        event_id, cb_payload, thread_id, timestamp = RECORD_HEADER.unpack_from(data, offset)
+        payload_offset = offset + RECORD_HEADER.size
+        offset += (RECORD_HEADER.size + cb_payload + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1)
+        if event_id == 0:
+            continue
+        # A session stopped while a thread was writing may end with a partial record.
+        if payload_offset + cb_payload > len(data):
+            break
+        events.append((timestamp, thread_id, event_id, data[payload_offset:payload_offset + cb_payload]))
+
+    # Records are grouped by thread in the file.
+    events.sort(key=lambda e: e[0])
+    return header, events
+
+def decode(header, event_id, payload):
+    name, decoder = EVENTS.get(event_id, ('Event%d' % event_id, None))
+    if decoder is None:
+        return name, [('payload', payload.hex() if hasattr(payload, 'hex') else payload.encode('hex'))]
+    return name, decoder(payload, header)
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write(__doc__)
+        return 1
+
+    csv = '--csv' in argv[2:]
+    header, events = read_trace(argv[1])
+
+    if not csv:
+        print('pid %d, %d-bit, %d events' % (header['pid'], header['pointer_size'] * 8, len(events)))
+
+    for timestamp, thread_id, event_id, payload in events:
+        ms = (timestamp - header['start']) * 1000.0 / header['frequency']
+        name, fields = decode(header, event_id, payload)
+        if csv:
+            print(','.join(['%.3f' % ms, str(thread_id), name] + ['%s=%s' % f for f in fields]))
+        else:
+            print('%12.3f %8d %-20s %s' % (ms, thread_id, name, ' '.join('%s=%s' % f for f in fields)))
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,335 @@
+# Licensed to the .NET Foundation under one or more agreements.
+# The .NET Foundation licenses this file to you under the MIT license.
+# See the LICENSE file in the project root for more information.
+
+"""
+Decoder for the stress logs kept in rhstresslog-<pid>.log in the temporary directory (/tmp on Unix) when the
+StressLogToFile config value is set (see StressLogFileHeader in src/Native/Runtime/inc/stressLog.h for the
+format).
+
+usage: stresslog.py <log file> [--module <path>] [--thread <id>]
+
+Prints the messages of all threads, oldest first, with the time in seconds since the log was created. The
+format strings are read from the module the log names in its header, --module overrides that path (for
+instance when decoding a log copied from another machine). Only ELF modules are supported.
+
+The file can be decoded while the process is still running, messages written while it's being read may be
+garbled or missing.
+"""
+import struct
+import sys
+
+MAGIC = 0x474F4C53534852
+VERSION = 1
+
+FILE_HEADER = struct.Struct('<QII5QIIIiQIIi11I512s')
+FILE_HEADER_FIELDS = [
+    'magic', 'version', 'cbPointer', 'mappingBase', 'cbMapping', 'tickFrequency', 'startTimeStamp',
+    'moduleOffset', 'threadLogsOffset', 'cbThreadLogSlot', 'cMaxThreadLogs', 'cThreadLogs',
+    'chunksOffset', 'cbChunk', 'cMaxChunks', 'cChunks', 'cbChunkBuffer', 'offsetOfChunkNext',
+    'offsetOfChunkBuf', 'offsetOfThreadId', 'offsetOfIsDead', 'offsetOfWriteHasWrapped', 'offsetOfCurPtr',
+    'offsetOfChunkListHead', 'offsetOfChunkListTail', 'offsetOfCurWriteChunk', 'reserved', 'modulePath',
+]
+
+# StressMsg: UInt32 numberOfArgs:3 / formatOffset:29, UInt32 facility, UInt64 timeStamp, void* args[]
+MSG_HEADER = struct.Struct('<IIQ')
+MAX_ARGS = 7
+
+
+class StressLogFile(object):
+    def __init__(self, data):
+        self.data = data
+        if len(data) < FILE_HEADER.size:
+            raise ValueError('truncated header')
+        self.header = dict(zip(FILE_HEADER_FIELDS, FILE_HEADER.unpack_from(data)))
+        if self.header['magic'] != MAGIC:
+            raise ValueError('not a stress log file, or the log is not initialized yet')
+        if self.header['version'] != VERSION:
+            raise ValueError('unsupported version %d' % self.header['version'])
+        self.pointer_format = '<Q' if self.header['cbPointer'] == 8 else '<I'
+        self.cb_pointer = self.header['cbPointer']
+        self.module_path = self.header['modulePath'].split(b'\0', 1)[0].decode('utf-8', 'replace')
+
+    # Pointers in the file are addresses in the logging process.
+    def to_offset(self, address):
+        offset = address - self.header['mappingBase']
+        if offset < 0 or offset >= len(self.data):
+            return None
+        return offset
+
+    def read(self, fmt, offset):
+        if offset is None or offset + struct.calcsize(fmt) > len(self.data):
+            return None
+        return struct.unpack_from(fmt, self.data, offset)[0]
+
+    def pointer(self, offset):
+        return self.read(self.pointer_format, offset)
+
+    def thread_logs(self):
+        h = self.header
+        for i in range(min(max(h['cThreadLogs'], 0), h['cMaxThreadLogs'])):
+            offset = h['threadLogsOffset'] + i * h['cbThreadLogSlot']
+            # Slots of logs that failed to initialize are cleared.
+            if self.pointer(offset + h['offsetOfChunkListHead']):
+                yield ThreadLog(self, offset)
+
+
+class ThreadLog(object):
+    def __init__(self, log, offset):
+        h = log.header
+        self.log = log
+        self.thread_id = log.read('<Q', offset + h['offsetOfThreadId'])
+        self.is_dead = log.read('<B', offset + h['offsetOfIsDead'])
+        self.write_has_wrapped = log.read('<B', offset + h['offsetOfWriteHasWrapped'])
+        self.cur_ptr = log.pointer(offset + h['offsetOfCurPtr'])
+        self.chunk_list_tail = log.pointer(offset + h['offsetOfChunkListTail'])
+        self.cur_write_chunk = log.pointer(offset + h['offsetOfCurWriteChunk'])
+
+    def chunk_start(self, chunk):
+        return chunk + self.log.header['offsetOfChunkBuf']
+
+    def chunk_end(self, chunk):
+        return self.chunk_start(chunk) + self.log.header['cbChunkBuffer']
+
+    def message(self, address):
+        offset = self.log.to_offset(address)
+        if offset is None or offset + MSG_HEADER.size > len(self.log.data):
+            return None
+        fmt_offs_cargs, facility, timestamp = MSG_HEADER.unpack_from(self.log.data, offset)
+        cargs = fmt_offs_cargs & 7
+        args = []
+        for i in range(cargs):
+            arg = self.log.pointer(offset + MSG_HEADER.size + i * self.log.cb_pointer)
+            if arg is None:
+                return None
+            args.append(arg)
+        return (fmt_offs_cargs >> 3, facility, timestamp, args)
+
+    # Mirrors ThreadStressLog::Activate, AdvanceRead and CompletedDump: walk from the most recent message
+    # towards the oldest one.
+    def messages(self):
+        max_msg_size = MSG_HEADER.size + MAX_ARGS * self.log.cb_pointer
+        cur_read_chunk = self.cur_write_chunk
+        read_ptr = self.cur_ptr
+        if cur_read_chunk is None or read_ptr is None:
+            return
+        read_has_wrapped = False
+        stop_ptr = max(read_ptr - max_msg_size, self.chunk_start(cur_read_chunk))
+
+        # A chunk can't be visited more often than there are chunks in the file, bound the walk in case the
+        # log is modified while it's being read.
+        chunk_steps = self.log.header['cMaxChunks'] + 1
+
+        def advance_past_boundary(chunk, ptr):
+            if chunk == self.chunk_list_tail:
+                if not self.write_has_wrapped:
+                    return chunk, ptr, True
+                wrapped = True
+            else:
+                wrapped = False
+            chunk = self.log.pointer(self.log.to_offset(chunk + self.log.header['offsetOfChunkNext']))
+            if chunk is None:
+                return None, None, wrapped
+            start = self.chunk_start(chunk)
+            ptr = start
+            while ptr - start < max_msg_size and self.log.pointer(self.log.to_offset(ptr)) == 0:
+                ptr += self.log.cb_pointer
+            if ptr - start >= max_msg_size:
+                ptr = start
+            return chunk, ptr, wrapped
+
+        if read_ptr == self.chunk_end(cur_read_chunk):
+            cur_read_chunk, read_ptr, read_has_wrapped = advance_past_boundary(cur_read_chunk, read_ptr)
+
+        while cur_read_chunk is not None and chunk_steps > 0:
+            msg = self.message(read_ptr)
+            if msg is None or msg[2] == 0:
+                return
+            if read_has_wrapped and (not self.write_has_wrapped or
+                                     (cur_read_chunk == self.cur_write_chunk and read_ptr >= stop_ptr)):
+                return
+            if msg[0] != 0:
+                yield msg
+
+            read_ptr += MSG_HEADER.size + len(msg[3]) * self.log.cb_pointer
+            if read_ptr >= self.chunk_end(cur_read_chunk):
+                chunk_steps -= 1
+                cur_read_chunk, read_ptr, wrapped = advance_past_boundary(cur_read_chunk, read_ptr)
+                read_has_wrapped = read_has_wrapped or wrapped
+
+
+class ElfModule(object):
+    """Maps offsets from the module base to the bytes of the module file."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF':
+            raise ValueError('%s: not an ELF file' % path)
+        is64 = self.data[4] == 2 or self.data[4] == b'\x02'
+        endian = '<' if self.data[5] in (1, b'\x01') else '>'
+        if is64:
+            e_type, = struct.unpack_from(endian + 'H', self.data, 16)
+            e_phoff, = struct.unpack_from(endian + 'Q', self.data, 32)
+            e_phentsize, e_phnum = struct.unpack_from(endian + 'HH', self.data, 54)
+            phdr = endian + 'IIQQQQQQ'
+        else:
+            e_type, = struct.unpack_from(endian + 'H', self.data, 16)
+            e_phoff, = struct.unpack_from(endian + 'I', self.data, 28)
+            e_phentsize, e_phnum = struct.unpack_from(endian + 'HH', self.data, 42)
+            phdr = endian + 'IIIIIIII'
+
+        self.segments = []
+        for i in range(e_phnum):
+            fields = struct.unpack_from(phdr, self.data, e_phoff + i * e_phentsize)
+            if is64:
+                p_type, _, p_offset, p_vaddr, _, p_filesz = fields[:6]
+            else:
+                p_type, p_offset, p_vaddr, _, p_filesz = fields[:5]
+            if p_type == 1:     # PT_LOAD
+                self.segments.append((p_vaddr, p_filesz, p_offset))
+
+        # The module base the runtime records is the address the lowest segment's page is loaded at. For
+        # position independent modules that corresponds to address 0 of the image.
+        self.base = 0
+        if e_type == 2 and self.segments:   # ET_EXEC
+            self.base = min(s[0] for s in self.segments) & ~0xFFF
+
+    def read_string(self, module_offset, limit=256):
+        vaddr = self.base + module_offset
+        for seg_vaddr, filesz, file_offset in self.segments:
+            if seg_vaddr <= vaddr < seg_vaddr + filesz:
+                start = file_offset + vaddr - seg_vaddr
+                end = self.data.find(b'\0', start, min(start + limit, file_offset + filesz))
+                if end < 0:
+                    end = min(start + limit, file_offset + filesz)
+                return self.data[start:end].decode('utf-8', 'replace')
+        return None
+
+
+def format_message(fmt, args, module, module_base):
+    out = []
+    args = list(args)
+    i = 0
+    while i < len(fmt):
+        c = fmt[i]
+        if c != '%':
+            out.append(c)
+            i += 1
+            continue
+        j = i + 1
+        if j < len(fmt) and fmt[j] == '%':
+            out.append('%')
+            i = j + 1
+            continue
+        while j < len(fmt) and fmt[j] in '-+ #0123456789.':
+            j += 1
+        while j < len(fmt) and fmt[j] in 'lhIzL':
+            j += 1
+            # %I64x
+            while j < len(fmt) and fmt[j] in '0123456789':
+                j += 1
+        if j >= len(fmt):
+            out.append(fmt[i:])
+            break
+        conv = fmt[j]
+        flags = fmt[i + 1:j]
+        value = args.pop(0) if args else 0
+        if conv == 'p':
+            # %pK (code), %pT (type) and %pV (vtable) are annotated pointers.
+            if j + 1 < len(fmt) and fmt[j + 1] in 'KTVM':
+                j += 1
+            out.append('%016x' % value if module.cb_pointer == 8 else '%08x' % value)
+        elif conv in 'di':
+            bits = 64 if ('ll' in flags or 'I64' in flags or ('I' in flags and module.cb_pointer == 8)) else 32
+            value &= (1 << bits) - 1
+            if value >= 1 << (bits - 1):
+                value -= 1 << bits
+            out.append(str(value))
+        elif conv in 'uxXo':
+            bits = 64 if ('ll' in flags or 'I' in flags or 'z' in flags) else 32
+            value &= (1 << bits) - 1
+            spec = '%' + ''.join(ch for ch in flags if ch in '-+ #0123456789.') + conv
+            out.append(spec % value)
+        elif conv == 's':
+            s = None
+            if module is not None and module_base <= value:
+                s = module.elf.read_string(value - module_base) if module.elf else None
+            out.append(s if s is not None else '<string at 0x%x>' % value)
+        elif conv == 'c':
+            out.append(chr(value & 0xFF))
+        else:
+            out.append(fmt[i:j + 1])
+        i = j + 1
+    return ''.join(out)
+
+
+class Formatter(object):
+    def __init__(self, log, elf):
+        self.cb_pointer = log.cb_pointer
+        self.elf = elf
+        self.module_base = log.header['moduleOffset']
+        self.cache = {}
+
+    def format(self, format_offset, args):
+        fmt = self.cache.get(format_offset)
+        if fmt is None:
+            fmt = self.elf.read_string(format_offset) if self.elf else None
+            if fmt is None:
+                fmt = '<format string at module offset 0x%x>' % format_offset
+            self.cache[format_offset] = fmt
+        return format_message(fmt, args, self, self.module_base)
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write(__doc__)
+        return 1
+
+    module_path = None
+    thread_filter = None
+    i = 2
+    while i < len(argv):
+        if argv[i] == '--module' and i + 1 < len(argv):
+            module_path = argv[i + 1]
+            i += 2
+        elif argv[i] == '--thread' and i + 1 < len(argv):
+            thread_filter = int(argv[i + 1], 0)
+            i += 2
+        else:
+            sys.stderr.write(__doc__)
+            return 1
+
+    with open(argv[1], 'rb') as f:
+        log = StressLogFile(f.read())
+
+    module_path = module_path or log.module_path
+    elf = None
+    try:
+        elf = ElfModule(module_path)
+    except (IOError, OSError, ValueError, struct.error) as e:
+        sys.stderr.write('warning: cannot read format strings from %s: %s\n' % (module_path, e))
+
+    formatter = Formatter(log, elf)
+    messages = []
+    threads = 0
+    for thread_log in log.thread_logs():
+        if thread_filter is not None and thread_log.thread_id != thread_filter:
+            continue
+        threads += 1
+        for format_offset, facility, timestamp, args in thread_log.messages():
+            messages.append((timestamp, thread_log.thread_id, facility, format_offset, args))
+
+    messages.sort(key=lambda m: m[0])
+
+    print('%d threads, %d messages, module %s' % (threads, len(messages), module_path))
+    frequency = log.header['tickFrequency'] or 1
+    for timestamp, thread_id, facility, format_offset, args in messages:
+        seconds = (timestamp - log.header['startTimeStamp']) / float(frequency)
+        text = formatter.format(format_offset, args)
+        print('%8x %12.6f %08x %s' % (thread_id, seconds, facility, text.rstrip('\n')))
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
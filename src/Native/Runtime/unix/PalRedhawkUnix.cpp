@@ -38,6 +38,11 @@
 #include <pthread_np.h>
 #endif
 
+#ifdef __linux__
+#include <linux/futex.h>
+#include <limits.h>
+#endif
+
 #if HAVE_LWP_SELF
 #include <lwp.h>
 #endif
@@ -130,7 +135,11 @@ typedef Int32 (__stdcall *PVECTORED_EXCEPTION_HANDLER)(
     );
 
 #define PAGE_NOACCESS           0x01
+#define PAGE_READONLY           0x02
 #define PAGE_READWRITE          0x04
+#define PAGE_EXECUTE            0x10
+#define PAGE_EXECUTE_READ       0x20
+#define PAGE_EXECUTE_READWRITE  0x40
 #define MEM_COMMIT              0x1000
 #define MEM_RESERVE             0x2000
 #define MEM_DECOMMIT            0x4000
@@ -184,6 +193,111 @@ void TimeSpecAdd(timespec* time, uint32_t milliseconds)
     time->tv_nsec = nsec;
 }
 
+#ifdef __linux__
+
+//
+// Critical sections and events are implemented directly on top of futexes on Linux. Compared to the pthread
+// mutex and condition variable based implementations this avoids a syscall whenever nobody is waiting, lets
+// contended critical sections spin adaptively before blocking, and allows waiting on multiple events.
+//
+
+extern "C" void _mm_pause();
+
+// Upper bound on the number of iterations a thread spins on a held critical section before blocking.
+#define FUTEX_LOCK_MAX_SPIN_COUNT 100
+
+static int FutexWait(volatile int32_t* pAddress, int32_t expectedValue, const timespec* pTimeout)
+{
+    return syscall(SYS_futex, pAddress, FUTEX_WAIT_PRIVATE, expectedValue, pTimeout, NULL, 0);
+}
+
+static void FutexWake(volatile int32_t* pAddress, int32_t count)
+{
+    syscall(SYS_futex, pAddress, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+// Compute the time left until the CLOCK_MONOTONIC based endTime. Returns false if it has already passed.
+static bool GetRemainingTime(const timespec* pEndTime, timespec* pRemaining)
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    int64_t nsec = (int64_t)(pEndTime->tv_sec - now.tv_sec) * tccSecondsToNanoSeconds + (pEndTime->tv_nsec - now.tv_nsec);
+    if (nsec <= 0)
+    {
+        return false;
+    }
+
+    pRemaining->tv_sec = nsec / tccSecondsToNanoSeconds;
+    pRemaining->tv_nsec = nsec % tccSecondsToNanoSeconds;
+    return true;
+}
+
+// The futex word of a critical section is 0 when it's free, 1 when it's held and 2 when it's held and other
+// threads may be blocked on it.
+static bool FutexLockTryEnter(CRITICAL_SECTION* lpCriticalSection)
+{
+    volatile int32_t* pState = &lpCriticalSection->futexLock.state;
+    return (*pState == 0) && (__sync_val_compare_and_swap(pState, 0, 1) == 0);
+}
+
+static void FutexLockEnter(CRITICAL_SECTION* lpCriticalSection)
+{
+    if (FutexLockTryEnter(lpCriticalSection))
+    {
+        return;
+    }
+
+    volatile int32_t* pState = &lpCriticalSection->futexLock.state;
+
+    if (g_cLogicalCpus > 1)
+    {
+        // Spin for up to twice as long as it has recently taken for the lock to become free, keeping a running
+        // average of the spin count that was actually needed.
+        int32_t spinCount = lpCriticalSection->futexLock.spinCount;
+        int32_t maxSpinCount = min(FUTEX_LOCK_MAX_SPIN_COUNT, spinCount * 2 + 10);
+
+        int32_t spin = 0;
+        bool acquired = false;
+        while (spin < maxSpinCount)
+        {
+            spin++;
+            _mm_pause();
+            if (FutexLockTryEnter(lpCriticalSection))
+            {
+                acquired = true;
+                break;
+            }
+        }
+
+        lpCriticalSection->futexLock.spinCount = spinCount + (spin - spinCount) / 8;
+
+        if (acquired)
+        {
+            return;
+        }
+    }
+
+    // Mark the lock as contended so that the owner wakes us up when it leaves.
+    while (__sync_swap(pState, 2) != 0)
+    {
+        FutexWait(pState, 2, NULL);
+    }
+}
+
+static void FutexLockLeave(CRITICAL_SECTION* lpCriticalSection)
+{
+    volatile int32_t* pState = &lpCriticalSection->futexLock.state;
+    if (__sync_fetch_and_sub(pState, 1) != 1)
+    {
+        // There may be waiters, wake one of them up.
+        __sync_lock_release(pState);
+        FutexWake(pState, 1);
+    }
+}
+
+#endif // __linux__
+
 #ifdef __APPLE__
 // Convert nanoseconds to the timespec structure
 // Parameters:
@@ -211,6 +325,124 @@ public:
     }
 };
 
+#ifdef __linux__
+
+// Number of threads blocked waiting on more than one event at a time, and a sequence number which every Set
+// increments (and wakes) while there are any. Such waiters block on the sequence number rather than on the
+// individual events.
+static volatile int32_t g_cMultipleEventWaiters = 0;
+static volatile int32_t g_eventSetSequence = 0;
+
+class UnixEvent
+{
+    volatile int32_t m_state;       // 1 when the event is signaled, this is the futex word waiters block on
+    volatile int32_t m_cWaiters;    // number of threads blocked on m_state
+    bool m_manualReset;
+
+public:
+
+    UnixEvent(bool manualReset, bool initialState)
+    : m_state(initialState ? 1 : 0),
+      m_cWaiters(0),
+      m_manualReset(manualReset)
+    {
+    }
+
+    bool Initialize()
+    {
+        return true;
+    }
+
+    bool Destroy()
+    {
+        return true;
+    }
+
+    // Returns true if the event is signaled, clearing the state of auto-reset events.
+    bool TryWait()
+    {
+        if (m_manualReset)
+        {
+            return m_state != 0;
+        }
+
+        return (m_state != 0) && (__sync_val_compare_and_swap(&m_state, 1, 0) == 1);
+    }
+
+    uint32_t Wait(uint32_t milliseconds)
+    {
+        if (TryWait())
+        {
+            return WAIT_OBJECT_0;
+        }
+
+        if (milliseconds == 0)
+        {
+            return WAIT_TIMEOUT;
+        }
+
+        timespec endTime;
+        if (milliseconds != INFINITE)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &endTime);
+            TimeSpecAdd(&endTime, milliseconds);
+        }
+
+        // The increment is a full barrier, so either Set sees that there is a waiter or we see the new state.
+        __sync_add_and_fetch(&m_cWaiters, 1);
+
+        uint32_t waitStatus = WAIT_OBJECT_0;
+        while (!TryWait())
+        {
+            timespec remaining;
+            timespec* pTimeout = NULL;
+            if (milliseconds != INFINITE)
+            {
+                if (!GetRemainingTime(&endTime, &remaining))
+                {
+                    waitStatus = WAIT_TIMEOUT;
+                    break;
+                }
+                pTimeout = &remaining;
+            }
+
+            if ((FutexWait(&m_state, 0, pTimeout) != 0) && (errno != EAGAIN) && (errno != EINTR) && (errno != ETIMEDOUT))
+            {
+                waitStatus = WAIT_FAILED;
+                break;
+            }
+        }
+
+        __sync_sub_and_fetch(&m_cWaiters, 1);
+
+        return waitStatus;
+    }
+
+    void Set()
+    {
+        __sync_val_compare_and_swap(&m_state, 0, 1);
+
+        if (m_cWaiters != 0)
+        {
+            // Only one waiter can consume the signal of an auto-reset event
+            FutexWake(&m_state, m_manualReset ? INT_MAX : 1);
+        }
+
+        if (g_cMultipleEventWaiters != 0)
+        {
+            __sync_add_and_fetch(&g_eventSetSequence, 1);
+            FutexWake(&g_eventSetSequence, INT_MAX);
+        }
+    }
+
+    void Reset()
+    {
+        m_state = 0;
+    }
+};
+
+#else // __linux__
+
 class UnixEvent
 {
     pthread_cond_t m_condition;
@@ -404,6 +636,8 @@ public:
     }
 };
 
+#endif // __linux__
+
 class EventUnixHandle : public UnixHandle<UnixHandleType::Event, UnixEvent>
 {
 public:
@@ -420,11 +654,33 @@ public:
 
 typedef UnixHandle<UnixHandleType::Thread, pthread_t> ThreadUnixHandle;
 
+class FileUnixHandle : public UnixHandle<UnixHandleType::File, int>
+{
+public:
+    FileUnixHandle(int fd)
+    : UnixHandle<UnixHandleType::File, int>(fd)
+    {
+    }
+
+    virtual bool Destroy()
+    {
+        return close(m_object) == 0;
+    }
+};
+
 // Destructor of the thread local object represented by the g_threadKey,
 // called when a thread is shut down
 void TlsObjectDestructor(void* data)
 {
-    ASSERT(data == pthread_getspecific(g_threadKey));
+    // The key's value is cleared before its destructor is called. Put it back, PalDetachThread only detaches
+    // the thread that is attached, so exiting threads were never detached from the thread store.
+    ASSERT(pthread_getspecific(g_threadKey) == NULL);
+    int status = pthread_setspecific(g_threadKey, data);
+    if (status != 0)
+    {
+        ASSERT_UNCONDITIONALLY("TlsObjectDestructor failed to restore the thread pointer in thread local storage");
+        return;
+    }
 
     RuntimeThreadShutdown(data);
 }
@@ -526,11 +782,6 @@ REDHAWK_PALEXPORT unsigned int REDHAWK_PALAPI PalGetCurrentProcessorNumber()
 #endif //HAVE_SCHED_GETCPU    
 }
 
-REDHAWK_PALEXPORT UInt32_BOOL REDHAWK_PALAPI PalAllocateThunksFromTemplate(HANDLE hTemplateModule, uint32_t templateRva, size_t templateSize, void** newThunksOut)
-{
-    PORTABILITY_ASSERT("UNIXTODO: Implement this function");
-}
-
 REDHAWK_PALEXPORT void REDHAWK_PALAPI PalSleep(uint32_t milliseconds)
 {
 #if HAVE_CLOCK_MONOTONIC
@@ -576,6 +827,82 @@ extern "C" UInt32_BOOL CloseHandle(HANDLE handle)
     return success ? UInt32_TRUE : UInt32_FALSE;
 }
 
+REDHAWK_PALEXPORT bool REDHAWK_PALAPI PalGetOutputFileName(_In_z_ const char* pPrefix, _In_z_ const char* pExtension, _Out_writes_z_(cchFileName) char* pFileName, UInt32 cchFileName)
+{
+    // Not $TMPDIR, perf only ever looks for its map files in /tmp.
+    int cch = snprintf(pFileName, cchFileName, "/tmp/%s-%u%s", pPrefix, (unsigned int)getpid(), pExtension);
+    return (cch > 0) && ((UInt32)cch < cchFileName);
+}
+
+REDHAWK_PALEXPORT HANDLE REDHAWK_PALAPI PalCreateOutputFile(_In_z_ const char* pFileName)
+{
+    int fd = open(pFileName, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1)
+    {
+        return INVALID_HANDLE_VALUE;
+    }
+
+    FileUnixHandle* handle = new (nothrow) FileUnixHandle(fd);
+
+    if (handle == NULL)
+    {
+        close(fd);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    return handle;
+}
+
+REDHAWK_PALEXPORT UInt32_BOOL REDHAWK_PALAPI PalWriteOutputFile(HANDLE hFile, _In_reads_bytes_(cbBuffer) const void* pBuffer, UInt32 cbBuffer)
+{
+    ASSERT(((UnixHandleBase*)hFile)->GetType() == UnixHandleType::File);
+    FileUnixHandle* unixHandle = (FileUnixHandle*)hFile;
+
+    int fd = *unixHandle->GetObject();
+    const uint8_t* pb = (const uint8_t*)pBuffer;
+    while (cbBuffer != 0)
+    {
+        ssize_t cbWritten = write(fd, pb, cbBuffer);
+        if (cbWritten == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return UInt32_FALSE;
+        }
+
+        pb += cbWritten;
+        cbBuffer -= (UInt32)cbWritten;
+    }
+
+    return UInt32_TRUE;
+}
+
+REDHAWK_PALEXPORT void* REDHAWK_PALAPI PalMapOutputFile(_In_z_ const char* pFileName, UIntNative cbSize)
+{
+    int fd = open(pFileName, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1)
+    {
+        return NULL;
+    }
+
+    void* pMapping = NULL;
+    if (ftruncate(fd, (off_t)cbSize) == 0)
+    {
+        pMapping = mmap(NULL, cbSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (pMapping == MAP_FAILED)
+        {
+            pMapping = NULL;
+        }
+    }
+
+    // The mapping keeps the file open
+    close(fd);
+
+    return pMapping;
+}
+
 REDHAWK_PALEXPORT HANDLE REDHAWK_PALAPI PalCreateEventW(_In_opt_ LPSECURITY_ATTRIBUTES pEventAttributes, UInt32_BOOL manualReset, UInt32_BOOL initialState, _In_opt_z_ const wchar_t* pName)
 {
     UnixEvent event = UnixEvent(manualReset, initialState);
@@ -641,6 +968,11 @@ REDHAWK_PALEXPORT bool REDHAWK_PALAPI PalStartFinalizerThread(_In_ BackgroundCal
     return PalStartBackgroundWork(callback, pCallbackContext, UInt32_TRUE);
 }
 
+REDHAWK_PALEXPORT bool REDHAWK_PALAPI PalStartDiagnosticsThread(_In_ BackgroundCallback callback, _In_opt_ void* pCallbackContext)
+{
+    return PalStartBackgroundWork(callback, pCallbackContext, UInt32_FALSE);
+}
+
 // Returns a 64-bit tick count with a millisecond resolution. It tries its best
 // to return monotonically increasing counts and avoid being affected by changes
 // to the system clock (either due to drift or due to explicit changes to system
@@ -726,6 +1058,17 @@ REDHAWK_PALEXPORT HANDLE REDHAWK_PALAPI PalGetModuleHandleFromPointer(_In_ void*
     return moduleHandle;
 }
 
+REDHAWK_PALEXPORT const char* REDHAWK_PALAPI PalGetSymbolName(_In_ void* pointer)
+{
+    Dl_info info;
+    if ((dladdr(pointer, &info) == 0) || (info.dli_saddr == NULL))
+    {
+        return NULL;
+    }
+
+    return info.dli_sname;
+}
+
 REDHAWK_PALEXPORT void* REDHAWK_PALAPI PalAddVectoredExceptionHandler(uint32_t firstHandler, _In_ PVECTORED_EXCEPTION_HANDLER vectoredHandler)
 {
     // UNIXTODO: Implement this function
@@ -884,9 +1227,21 @@ static int W32toUnixAccessControl(uint32_t flProtect)
     case PAGE_NOACCESS:
         prot = PROT_NONE;
         break;
+    case PAGE_READONLY:
+        prot = PROT_READ;
+        break;
     case PAGE_READWRITE:
         prot = PROT_READ | PROT_WRITE;
         break;
+    case PAGE_EXECUTE:
+        prot = PROT_EXEC;
+        break;
+    case PAGE_EXECUTE_READ:
+        prot = PROT_READ | PROT_EXEC;
+        break;
+    case PAGE_EXECUTE_READWRITE:
+        prot = PROT_READ | PROT_WRITE | PROT_EXEC;
+        break;
     default:
         ASSERT(false);
         break;
@@ -961,6 +1316,89 @@ REDHAWK_PALEXPORT UInt32_BOOL REDHAWK_PALAPI PalVirtualFree(_In_ void* pAddress,
     return UInt32_TRUE;
 }
 
+// mprotect doesn't report the previous protection, find the mapping containing the page in /proc/self/maps.
+static bool GetPageProtection(size_t pageAddress, uint32_t* pProtect)
+{
+    FILE* maps = fopen("/proc/self/maps", "r");
+    if (maps == NULL)
+    {
+        return false;
+    }
+
+    bool found = false;
+    size_t start, end;
+    char perms[5];
+    while (fscanf(maps, "%zx-%zx %4s%*[^\n]", &start, &end, perms) == 3)
+    {
+        if ((pageAddress >= start) && (pageAddress < end))
+        {
+            bool read = (perms[0] == 'r');
+            bool write = (perms[1] == 'w');
+            if (perms[2] == 'x')
+            {
+                *pProtect = write ? PAGE_EXECUTE_READWRITE : (read ? PAGE_EXECUTE_READ : PAGE_EXECUTE);
+            }
+            else
+            {
+                *pProtect = write ? PAGE_READWRITE : (read ? PAGE_READONLY : PAGE_NOACCESS);
+            }
+
+            found = true;
+            break;
+        }
+    }
+
+    fclose(maps);
+    return found;
+}
+
+REDHAWK_PALEXPORT UInt32_BOOL REDHAWK_PALAPI PalVirtualProtect(_In_ void* pAddress, size_t size, uint32_t protect, _Out_opt_ uint32_t* pOldProtect)
+{
+    // mprotect operates on whole pages
+    size_t pageStart = (size_t)pAddress & ~(OS_PAGE_SIZE - 1);
+    size_t pageEnd = ((size_t)pAddress + size + (OS_PAGE_SIZE - 1)) & ~(OS_PAGE_SIZE - 1);
+
+    // Like VirtualProtect, report the protection of the first page. Looking it up means parsing /proc/self/maps,
+    // so it's skipped when the caller doesn't ask for it.
+    if ((pOldProtect != NULL) && !GetPageProtection(pageStart, pOldProtect))
+    {
+        return UInt32_FALSE;
+    }
+
+    int unixProtect = W32toUnixAccessControl(protect);
+
+    return mprotect((void *)pageStart, pageEnd - pageStart, unixProtect) == 0;
+}
+
+REDHAWK_PALEXPORT UInt32_BOOL REDHAWK_PALAPI PalAllocateThunksFromTemplate(HANDLE hTemplateModule, uint32_t templateRva, size_t templateSize, void** newThunksOut)
+{
+    // The template section can't be mapped from the image a second time like on Windows, so make an anonymous
+    // copy of it instead. The template alternates pages of thunk code with pages of thunk data, the copy keeps
+    // the code pages executable and the data pages writable like a fresh mapping of the section would.
+    ASSERT((templateSize % (2 * OS_PAGE_SIZE)) == 0);
+
+    void* pThunks = PalVirtualAlloc(NULL, templateSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (pThunks == NULL)
+    {
+        return UInt32_FALSE;
+    }
+
+    memcpy(pThunks, (uint8_t*)hTemplateModule + templateRva, templateSize);
+
+    for (size_t offset = 0; offset < templateSize; offset += 2 * OS_PAGE_SIZE)
+    {
+        uint32_t oldProtect;
+        if (!PalVirtualProtect((uint8_t*)pThunks + offset, OS_PAGE_SIZE, PAGE_EXECUTE_READ, &oldProtect))
+        {
+            PalVirtualFree(pThunks, 0, MEM_RELEASE);
+            return UInt32_FALSE;
+        }
+    }
+
+    *newThunksOut = pThunks;
+    return UInt32_TRUE;
+}
+
 REDHAWK_PALEXPORT _Ret_maybenull_ void* REDHAWK_PALAPI PalSetWerDataBuffer(_In_ void* pNewBuffer)
 {
     static void* pBuffer;
@@ -1002,7 +1440,13 @@ extern "C" UInt32_BOOL DuplicateHandle(
 
 extern "C" UInt32_BOOL InitializeCriticalSection(CRITICAL_SECTION * lpCriticalSection)
 {
+#ifdef __linux__
+    lpCriticalSection->futexLock.state = 0;
+    lpCriticalSection->futexLock.spinCount = 0;
+    return UInt32_TRUE;
+#else
     return pthread_mutex_init(&lpCriticalSection->mutex, NULL) == 0;
+#endif
 }
 
 extern "C" UInt32_BOOL InitializeCriticalSectionEx(CRITICAL_SECTION * lpCriticalSection, UInt32 arg2, UInt32 arg3)
@@ -1013,17 +1457,38 @@ extern "C" UInt32_BOOL InitializeCriticalSectionEx(CRITICAL_SECTION * lpCritical
 
 extern "C" void DeleteCriticalSection(CRITICAL_SECTION * lpCriticalSection)
 {
+#ifdef __linux__
+    ASSERT(lpCriticalSection->futexLock.state == 0);
+#else
     pthread_mutex_destroy(&lpCriticalSection->mutex);
+#endif
 }
 
 extern "C" void EnterCriticalSection(CRITICAL_SECTION * lpCriticalSection)
 {
-    pthread_mutex_lock(&lpCriticalSection->mutex);;
+#ifdef __linux__
+    FutexLockEnter(lpCriticalSection);
+#else
+    pthread_mutex_lock(&lpCriticalSection->mutex);
+#endif
+}
+
+extern "C" UInt32_BOOL TryEnterCriticalSection(CRITICAL_SECTION * lpCriticalSection)
+{
+#ifdef __linux__
+    return FutexLockTryEnter(lpCriticalSection) ? UInt32_TRUE : UInt32_FALSE;
+#else
+    return pthread_mutex_trylock(&lpCriticalSection->mutex) == 0;
+#endif
 }
 
 extern "C" void LeaveCriticalSection(CRITICAL_SECTION * lpCriticalSection)
 {
+#ifdef __linux__
+    FutexLockLeave(lpCriticalSection);
+#else
     pthread_mutex_unlock(&lpCriticalSection->mutex);
+#endif
 }
 
 extern "C" unsigned __int64  __readgsqword(unsigned long Offset)
@@ -1116,7 +1581,9 @@ typedef UInt32 (__stdcall *HijackCallback)(HANDLE hThread, _In_ PAL_LIMITED_CONT
 
 REDHAWK_PALEXPORT uint32_t REDHAWK_PALAPI PalHijack(HANDLE hThread, _In_ HijackCallback callback, _In_opt_ void* pCallbackContext)
 {
-    PORTABILITY_ASSERT("UNIXTODO: Implement this function");
+    // UNIXTODO: Implement this function. Until then threads aren't hijacked, the suspension waits for them to
+    // reach a safe point on their own (a p/invoke or reverse p/invoke transition) and tries again on its next pass.
+    return E_FAIL;
 }
 
 extern "C" UInt32 WaitForSingleObjectEx(HANDLE handle, UInt32 milliseconds, UInt32_BOOL alertable)
@@ -1130,10 +1597,78 @@ extern "C" UInt32 WaitForSingleObjectEx(HANDLE handle, UInt32 milliseconds, UInt
     return unixHandle->GetObject()->Wait(milliseconds);
 }
 
+#ifdef __linux__
+static uint32_t WaitForMultipleEvents(uint32_t timeout, uint32_t handleCount, HANDLE* pHandles)
+{
+    timespec endTime;
+    if (timeout != INFINITE)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &endTime);
+        TimeSpecAdd(&endTime, timeout);
+    }
+
+    // The increment is a full barrier, so either Set sees that there is a multiple event waiter or we see
+    // the new event state.
+    __sync_add_and_fetch(&g_cMultipleEventWaiters, 1);
+
+    uint32_t waitStatus = WAIT_TIMEOUT;
+    for (;;)
+    {
+        // Read the sequence number before looking at the events so that a Set racing with the checks below
+        // makes the futex wait return immediately.
+        int32_t sequence = g_eventSetSequence;
+
+        for (uint32_t i = 0; i < handleCount; i++)
+        {
+            UnixHandleBase* handleBase = (UnixHandleBase*)pHandles[i];
+            ASSERT(handleBase->GetType() == UnixHandleType::Event);
+            if (((EventUnixHandle*)handleBase)->GetObject()->TryWait())
+            {
+                waitStatus = WAIT_OBJECT_0 + i;
+                break;
+            }
+        }
+
+        if (waitStatus != WAIT_TIMEOUT)
+        {
+            break;
+        }
+
+        timespec remaining;
+        timespec* pTimeout = NULL;
+        if (timeout != INFINITE)
+        {
+            if (!GetRemainingTime(&endTime, &remaining))
+            {
+                break;
+            }
+            pTimeout = &remaining;
+        }
+
+        if ((FutexWait(&g_eventSetSequence, sequence, pTimeout) != 0) && (errno != EAGAIN) && (errno != EINTR) && (errno != ETIMEDOUT))
+        {
+            waitStatus = WAIT_FAILED;
+            break;
+        }
+    }
+
+    __sync_sub_and_fetch(&g_cMultipleEventWaiters, 1);
+
+    return waitStatus;
+}
+#endif // __linux__
+
 REDHAWK_PALEXPORT uint32_t REDHAWK_PALAPI PalCompatibleWaitAny(UInt32_BOOL alertable, uint32_t timeout, uint32_t handleCount, HANDLE* pHandles, UInt32_BOOL allowReentrantWait)
 {
+#ifdef __linux__
+    if (handleCount > 1)
+    {
+        return WaitForMultipleEvents(timeout, handleCount, pHandles);
+    }
+#else
     // Only a single handle wait for event is supported
     ASSERT(handleCount == 1);
+#endif
 
     return WaitForSingleObjectEx(pHandles[0], timeout, alertable);
 }
@@ -1369,6 +1904,31 @@ extern "C" UInt32_BOOL QueryPerformanceFrequency(LARGE_INTEGER *lpFrequency)
     return UInt32_TRUE;
 }
 
+// Same layout as FILETIME in PalRedhawk.h: 100 nanosecond intervals since January 1, 1601 (UTC).
+struct FILETIME
+{
+    UInt32 dwLowDateTime;
+    UInt32 dwHighDateTime;
+};
+
+// FILETIME of the Unix epoch, January 1, 1970 (UTC)
+static const UInt64 tccUnixEpochFileTime = 116444736000000000ULL;
+
+extern "C" void GetSystemTimeAsFileTime(FILETIME *lpSystemTimeAsFileTime)
+{
+    struct timeval tv;
+    if (gettimeofday(&tv, NULL) == -1)
+    {
+        ASSERT_UNCONDITIONALLY("gettimeofday() failed");
+        tv.tv_sec = 0;
+        tv.tv_usec = 0;
+    }
+
+    UInt64 fileTime = tccUnixEpochFileTime + (UInt64)tv.tv_sec * 10000000 + (UInt64)tv.tv_usec * 10;
+    lpSystemTimeAsFileTime->dwLowDateTime = (UInt32)fileTime;
+    lpSystemTimeAsFileTime->dwHighDateTime = (UInt32)(fileTime >> 32);
+}
+
 extern "C" UInt64 PalGetCurrentThreadIdForLogging()
 {
 #if defined(__linux__)
@@ -1852,25 +2412,24 @@ bool GCToOSInterface::CreateThread(GCThreadFunction function, void* param, GCThr
 // Initialize the critical section
 void CLRCriticalSection::Initialize()
 {
-    int st = pthread_mutex_init(&m_cs.mutex, NULL);
-    ASSERT(st == 0);
+    UInt32_BOOL st = InitializeCriticalSection(&m_cs);
+    ASSERT(st);
 }
 
 // Destroy the critical section
 void CLRCriticalSection::Destroy()
 {
-    int st = pthread_mutex_destroy(&m_cs.mutex);
-    ASSERT(st == 0);
+    DeleteCriticalSection(&m_cs);
 }
 
 // Enter the critical section. Blocks until the section can be entered.
 void CLRCriticalSection::Enter()
 {
-    pthread_mutex_lock(&m_cs.mutex);
+    EnterCriticalSection(&m_cs);
 }
 
 // Leave the critical section
 void CLRCriticalSection::Leave()
 {
-    pthread_mutex_unlock(&m_cs.mutex);
+    LeaveCriticalSection(&m_cs);
 }
@@ -380,6 +380,11 @@ REDHAWK_PALEXPORT bool REDHAWK_PALAPI PalStartFinalizerThread(_In_ BackgroundCal
     return PalStartBackgroundWork(callback, pCallbackContext, TRUE) != NULL;
 }
 
+REDHAWK_PALEXPORT bool REDHAWK_PALAPI PalStartDiagnosticsThread(_In_ BackgroundCallback callback, _In_opt_ void* pCallbackContext)
+{
+    return PalStartBackgroundWork(callback, pCallbackContext, FALSE) != NULL;
+}
+
 REDHAWK_PALEXPORT UInt32 REDHAWK_PALAPI PalGetTickCount()
 {
 #pragma warning(push)
@@ -406,6 +411,49 @@ REDHAWK_PALEXPORT HANDLE REDHAWK_PALAPI PalCreateFileW(
                        creationDisposition, flagsAndAttributes, hTemplateFile);
 }
 
+REDHAWK_PALEXPORT bool REDHAWK_PALAPI PalGetOutputFileName(_In_z_ const char* pPrefix, _In_z_ const char* pExtension, _Out_writes_z_(cchFileName) char* pFileName, UInt32 cchFileName)
+{
+    // The temporary directory comes with a trailing backslash.
+    char szTempPath[MAX_PATH + 1];
+    DWORD cchTempPath = GetTempPathA(ARRAYSIZE(szTempPath), szTempPath);
+    if ((cchTempPath == 0) || (cchTempPath >= ARRAYSIZE(szTempPath)))
+        return false;
+
+    int cch = _snprintf_s(pFileName, cchFileName, _TRUNCATE, "%s%s-%u%s", szTempPath, pPrefix, (unsigned int)GetCurrentProcessId(), pExtension);
+    return cch > 0;
+}
+
+REDHAWK_PALEXPORT HANDLE REDHAWK_PALAPI PalCreateOutputFile(_In_z_ const char* pFileName)
+{
+    return CreateFileA(pFileName, GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+}
+
+REDHAWK_PALEXPORT UInt32_BOOL REDHAWK_PALAPI PalWriteOutputFile(HANDLE hFile, _In_reads_bytes_(cbBuffer) const void* pBuffer, UInt32 cbBuffer)
+{
+    DWORD cbWritten;
+    return WriteFile(hFile, pBuffer, cbBuffer, &cbWritten, NULL) && (cbWritten == cbBuffer);
+}
+
+REDHAWK_PALEXPORT void* REDHAWK_PALAPI PalMapOutputFile(_In_z_ const char* pFileName, UIntNative cbSize)
+{
+    HANDLE hFile = CreateFileA(pFileName, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    void* pMapping = NULL;
+    HANDLE hMapping = CreateFileMappingW(hFile, NULL, PAGE_READWRITE, (DWORD)((UInt64)cbSize >> 32), (DWORD)cbSize, NULL);
+    if (hMapping != NULL)
+    {
+        pMapping = MapViewOfFile(hMapping, FILE_MAP_WRITE, 0, 0, cbSize);
+        CloseHandle(hMapping);
+    }
+
+    // The view keeps the file open
+    CloseHandle(hFile);
+
+    return pMapping;
+}
+
 REDHAWK_PALEXPORT HANDLE REDHAWK_PALAPI PalCreateLowMemoryNotification()
 {
     return CreateMemoryResourceNotification(LowMemoryResourceNotification);
@@ -425,6 +473,13 @@ REDHAWK_PALEXPORT HANDLE REDHAWK_PALAPI PalGetModuleHandleFromPointer(_In_ void*
     return (HANDLE)module;
 }
 
+REDHAWK_PALEXPORT const char* REDHAWK_PALAPI PalGetSymbolName(_In_ void* pointer)
+{
+    // Only used by the perf map, which doesn't exist on Windows.
+    UNREFERENCED_PARAMETER(pointer);
+    return NULL;
+}
+
 REDHAWK_PALEXPORT void* REDHAWK_PALAPI PalAddVectoredExceptionHandler(UInt32 firstHandler, _In_ PVECTORED_EXCEPTION_HANDLER vectoredHandler)
 {
     return AddVectoredExceptionHandler(firstHandler, vectoredHandler);
@@ -1319,6 +1374,19 @@ REDHAWK_PALEXPORT UInt32_BOOL REDHAWK_PALAPI PalVirtualFree(_In_ void* pAddress,
 }
 #pragma warning (pop)
 
+REDHAWK_PALEXPORT UInt32_BOOL REDHAWK_PALAPI PalVirtualProtect(_In_ void* pAddress, UIntNative size, UInt32 protect, _Out_opt_ UInt32* pOldProtect)
+{
+    // VirtualProtect requires somewhere to store the previous protection
+    DWORD oldProtect;
+    if (!VirtualProtect(pAddress, size, protect, &oldProtect))
+        return UInt32_FALSE;
+
+    if (pOldProtect != NULL)
+        *pOldProtect = oldProtect;
+
+    return UInt32_TRUE;
+}
+
 REDHAWK_PALEXPORT _Ret_maybenull_ void* REDHAWK_PALAPI PalSetWerDataBuffer(_In_ void* pNewBuffer)
 {
     static void* pBuffer;
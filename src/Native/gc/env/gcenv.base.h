@@ -455,6 +455,11 @@ public:
     static void SignalFinalizationDone(bool fFinalizer);
     static void SetFinalizerThread(Thread * pThread);
     static HANDLE GetFinalizerEvent();
+#ifdef FEATURE_REDHAWK
+    static bool IsCurrentThreadPrimaryFinalizer();
+    static void EnableFinalizerHelpers(bool fEnable);
+    static HANDLE GetFinalizerHelperEvent();
+#endif // FEATURE_REDHAWK
 };
 
 #ifdef FEATURE_REDHAWK
@@ -59,6 +59,10 @@ public:
     // post-gc callback.
     static void GcDone(int condemned);
 
+    // Called right after GcDone. Unless the collection was a background one the EE is still suspended and the
+    // heap is walkable.
+    static void DiagGCEnd(size_t index, int condemned, bool fConcurrent);
+
     // Promote refcounted handle callback
     static bool RefCountedHandleCallbacks(Object * pObject);
 
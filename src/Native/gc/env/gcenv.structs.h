@@ -105,7 +105,18 @@ public:
 #ifdef PLATFORM_UNIX
 
 typedef struct _RTL_CRITICAL_SECTION {
-    pthread_mutex_t mutex;
+    union
+    {
+        pthread_mutex_t mutex;
+
+        // The runtime's Linux PAL implements critical sections directly on top of futexes and uses this
+        // instead of the mutex.
+        struct
+        {
+            int32_t state;      // 0 = free, 1 = held, 2 = held and there may be waiters
+            int32_t spinCount;  // adaptive spin estimate
+        } futexLock;
+    };
 } CRITICAL_SECTION, RTL_CRITICAL_SECTION, *PRTL_CRITICAL_SECTION;
 
 #else
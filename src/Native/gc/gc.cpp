@@ -2282,6 +2282,42 @@ gc_mechanisms  gc_heap::settings;
 
 gc_history_global gc_heap::gc_data_global;
 
+gc_pause_stats gc_heap::pause_stats;
+
+int64_t     gc_heap::pause_start_ts = 0;
+
+BOOL        gc_heap::type_histogram_enabled_p = FALSE;
+
+gc_type_histogram_entry* gc_heap::type_histogram_merged = 0;
+
+size_t      gc_heap::type_histogram_gc_index = 0;
+
+#if defined (VERIFY_HEAP) && !defined (MULTIPLE_HEAPS)
+int         gc_heap::heap_verify_n_threads = 1;
+
+CLREvent    gc_heap::heap_verify_work_events[MAX_HEAP_VERIFY_THREADS];
+
+CLREvent    gc_heap::heap_verify_done_event;
+
+VOLATILE(int32_t) gc_heap::heap_verify_threads_pending = 0;
+
+heap_verify_item* gc_heap::heap_verify_items = 0;
+
+size_t      gc_heap::heap_verify_items_size = 0;
+
+int32_t     gc_heap::heap_verify_items_count = 0;
+
+VOLATILE(int32_t) gc_heap::heap_verify_next_item = 0;
+
+VOLATILE(int32_t) gc_heap::heap_verify_next_handle_table = 0;
+
+size_t      gc_heap::heap_verify_objects_verified[MAX_HEAP_VERIFY_THREADS];
+
+size_t      gc_heap::heap_verify_objects_verified_deep[MAX_HEAP_VERIFY_THREADS];
+
+uint32_t    gc_heap::heap_verify_sample_seed = 0;
+#endif //VERIFY_HEAP && !MULTIPLE_HEAPS
+
 size_t      gc_heap::gc_last_ephemeral_decommit_time = 0;
 
 size_t      gc_heap::gc_gen0_desired_high;
@@ -2561,6 +2597,12 @@ size_t      gc_heap::total_ephemeral_plugs = 0;
 
 seg_free_spaces* gc_heap::bestfit_seg = 0;
 
+gc_type_histogram_entry* gc_heap::type_histogram = 0;
+
+size_t      gc_heap::type_histogram_used = 0;
+
+BOOL        gc_heap::type_histogram_p = FALSE;
+
 size_t      gc_heap::total_ephemeral_size = 0;
 
 #ifdef HEAP_ANALYZE
@@ -2658,6 +2700,10 @@ SPTR_IMPL_NS_INIT(uint8_t, WKS, gc_heap, alloc_allocated, 0);
 
 size_t gc_heap::allocation_quantum = CLR_SIZE;
 
+#ifdef ADAPTIVE_ALLOC_QUANTUM
+size_t gc_heap::max_allocation_quantum = CLR_SIZE;
+#endif //ADAPTIVE_ALLOC_QUANTUM
+
 GCSpinLock gc_heap::more_space_lock;
 
 #ifdef SYNCHRONIZATION_STATS
@@ -2870,6 +2916,171 @@ void gc_heap::fire_pevents()
     fire_per_heap_hist_event (current_gc_data_per_heap, heap_number);
 #endif    
 #endif //!CORECLR
+
+    record_pause_gen_stats();
+}
+
+static void add_to_histogram (gc_histogram* hist, uint64_t value)
+{
+    size_t index;
+    if (value < GC_HISTOGRAM_SUB_BUCKETS)
+    {
+        index = (size_t)value;
+    }
+    else
+    {
+        int highest_bit = GC_HISTOGRAM_SUB_BUCKET_BITS;
+        while ((value >> highest_bit) > 1)
+        {
+            highest_bit++;
+        }
+
+        int shift = highest_bit - GC_HISTOGRAM_SUB_BUCKET_BITS;
+        index = ((size_t)(shift + 1) << GC_HISTOGRAM_SUB_BUCKET_BITS) +
+                (size_t)((value >> shift) & (GC_HISTOGRAM_SUB_BUCKETS - 1));
+    }
+
+    assert (index < GC_HISTOGRAM_BUCKETS);
+    hist->buckets[index]++;
+    hist->count++;
+    hist->sum += value;
+    if (value > hist->max)
+    {
+        hist->max = value;
+    }
+}
+
+static uint64_t elapsed_microseconds (int64_t start_ts)
+{
+    uint64_t elapsed = (uint64_t)(GCToOSInterface::QueryPerformanceCounter() - start_ts);
+    return ((elapsed / qpf) * 1000000) + (((elapsed % qpf) * 1000000) / qpf);
+}
+
+void gc_heap::timed_suspend_EE (GCToEEInterface::SUSPEND_REASON reason)
+{
+    int64_t start_ts = GCToOSInterface::QueryPerformanceCounter();
+    GCToEEInterface::SuspendEE (reason);
+
+    // Only one thread can have the EE suspended at a time so we own the pause stats until the EE is restarted.
+    pause_start_ts = start_ts;
+    add_to_histogram (&pause_stats.suspend_time, elapsed_microseconds (start_ts));
+}
+
+void gc_heap::timed_restart_EE (BOOL bFinishedGC)
+{
+    // Update the histogram while the EE is still suspended, once it's restarted another GC can start and
+    // reuse pause_start_ts and pause_stats. This leaves the restart itself out of the pause time.
+    add_to_histogram (&pause_stats.pause_time, elapsed_microseconds (pause_start_ts));
+    GCToEEInterface::RestartEE (bFinishedGC);
+}
+
+void gc_heap::record_pause_phase (gc_pause_phase phase, int64_t start_ts)
+{
+    // With server GC all heaps go through the phases in lock step.
+    if (heap_number == 0)
+    {
+        add_to_histogram (&pause_stats.phase_time[phase], elapsed_microseconds (start_ts));
+    }
+}
+
+void gc_heap::record_pause_gen_stats()
+{
+    static_assert (GC_PAUSE_STATS_GENERATIONS == (max_generation + 2), "gc_pause_stats covers each generation and the LOH");
+
+    // A background GC gets here on the background GC thread with the EE running, where it would race the
+    // foreground GCs updating the same histograms. Only blocking GCs are accounted for.
+    if (settings.concurrent)
+    {
+        return;
+    }
+
+    for (int gen_number = 0; gen_number < GC_PAUSE_STATS_GENERATIONS; gen_number++)
+    {
+        // The large object heap is only collected along with max_generation.
+        if (min (gen_number, (int)max_generation) > settings.condemned_generation)
+        {
+            break;
+        }
+
+        size_t promoted = 0;
+        size_t fragmented = 0;
+#ifdef MULTIPLE_HEAPS
+        for (int i = 0; i < gc_heap::n_heaps; i++)
+        {
+            gc_heap* hp = gc_heap::g_heaps[i];
+#else
+        {
+            gc_heap* hp = pGenGCHeap;
+#endif //MULTIPLE_HEAPS
+            gc_generation_data* gen_data = &(hp->get_gc_data_per_heap()->gen_data[gen_number]);
+            promoted += gen_data->pinned_surv + gen_data->npinned_surv;
+            fragmented += gen_data->free_list_space_after + gen_data->free_obj_space_after;
+        }
+
+        add_to_histogram (&pause_stats.promoted_bytes[gen_number], promoted);
+        add_to_histogram (&pause_stats.fragmented_bytes[gen_number], fragmented);
+    }
+
+    pause_stats.blocking_gc_count++;
+}
+
+// Returns the entry for type in a table of TYPE_HISTOGRAM_SIZE + 1 entries, claiming a free one if needed.
+// Types that don't fit share the entry at TYPE_HISTOGRAM_SIZE.
+static gc_type_histogram_entry* find_type_histogram_entry (gc_type_histogram_entry* table, size_t* used, void* type)
+{
+    if (type == 0)
+    {
+        return &table[TYPE_HISTOGRAM_SIZE];
+    }
+
+    size_t index = ((uint32_t)((size_t)type >> 3) * 2654435769u) >> (32 - TYPE_HISTOGRAM_BITS);
+    while (table[index].type != type)
+    {
+        if (table[index].type == 0)
+        {
+            // Keep the table at most 3/4 full so that the probe sequences stay short.
+            if (*used >= ((TYPE_HISTOGRAM_SIZE / 4) * 3))
+            {
+                return &table[TYPE_HISTOGRAM_SIZE];
+            }
+
+            (*used)++;
+            table[index].type = type;
+            break;
+        }
+
+        index = (index + 1) & (TYPE_HISTOGRAM_SIZE - 1);
+    }
+
+    return &table[index];
+}
+
+void gc_heap::merge_type_histograms()
+{
+    memset (type_histogram_merged, 0, (TYPE_HISTOGRAM_SIZE + 1) * sizeof (gc_type_histogram_entry));
+    size_t merged_used = 0;
+
+#ifdef MULTIPLE_HEAPS
+    for (int i = 0; i < gc_heap::n_heaps; i++)
+    {
+        gc_heap* hp = gc_heap::g_heaps[i];
+#else
+    {
+        gc_heap* hp = pGenGCHeap;
+#endif //MULTIPLE_HEAPS
+        for (size_t index = 0; index <= TYPE_HISTOGRAM_SIZE; index++)
+        {
+            gc_type_histogram_entry* from = &(hp->type_histogram[index]);
+            if (from->count != 0)
+            {
+                gc_type_histogram_entry* to = find_type_histogram_entry (type_histogram_merged, &merged_used, from->type);
+                to->count += from->count;
+                to->size += from->size;
+            }
+        }
+    }
+
+    type_histogram_gc_index = VolatileLoad (&settings.gc_index);
 }
 
 inline BOOL
@@ -5204,7 +5415,7 @@ void gc_heap::gc_thread_function ()
             gc_heap::ee_suspend_event.Wait(INFINITE, FALSE);
 
             BEGIN_TIMING(suspend_ee_during_log);
-            GCToEEInterface::SuspendEE(GCToEEInterface::SUSPEND_FOR_GC);
+            timed_suspend_EE(GCToEEInterface::SUSPEND_FOR_GC);
             END_TIMING(suspend_ee_during_log);
 
             proceed_with_gc_p = TRUE;
@@ -5252,7 +5463,7 @@ void gc_heap::gc_thread_function ()
             gc_heap::gc_started = FALSE;
 
             BEGIN_TIMING(restart_ee_during_log);
-            GCToEEInterface::RestartEE(TRUE);
+            timed_restart_EE(TRUE);
             END_TIMING(restart_ee_during_log);
             process_sync_log_stats();
 
@@ -5729,6 +5940,15 @@ void gc_heap::fix_allocation_context (alloc_context* acontext, BOOL for_gc_p,
                 alloc_contexts_used ++;
             }
         }
+
+#ifdef LAZY_ALLOC_CLEAR
+        //the uncleared part is already formatted as a free object
+        if (for_gc_p && (acontext->alloc_uncleared_bytes != 0))
+        {
+            generation_free_obj_space (generation_of (0)) += acontext->alloc_uncleared_bytes;
+            acontext->alloc_uncleared_bytes = 0;
+        }
+#endif //LAZY_ALLOC_CLEAR
     }
     else if (for_gc_p)
     {
@@ -5743,6 +5963,10 @@ void gc_heap::fix_allocation_context (alloc_context* acontext, BOOL for_gc_p,
     {
         acontext->alloc_ptr = 0;
         acontext->alloc_limit = acontext->alloc_ptr;
+
+#ifdef ADAPTIVE_ALLOC_QUANTUM
+        adapt_alloc_quantum (acontext);
+#endif //ADAPTIVE_ALLOC_QUANTUM
     }
 }
 
@@ -5771,6 +5995,10 @@ void void_allocation (alloc_context* acontext, void*)
                      (size_t)acontext->alloc_limit+Align(min_obj_size)));
         acontext->alloc_ptr = 0;
         acontext->alloc_limit = acontext->alloc_ptr;
+#ifdef LAZY_ALLOC_CLEAR
+        //the uncleared part stays behind as a free object
+        acontext->alloc_uncleared_bytes = 0;
+#endif //LAZY_ALLOC_CLEAR
     }
 }
 
@@ -9849,6 +10077,21 @@ gc_heap::init_semi_shared()
     short_plugs_pad_ratio = (double)DESIRED_PLUG_LENGTH / (double)(DESIRED_PLUG_LENGTH - Align (min_obj_size));
 #endif //SHORT_PLUGS
 
+    type_histogram_enabled_p = (g_pConfig->GetGCTypeHistogram() != 0);
+    if (type_histogram_enabled_p)
+    {
+        type_histogram_merged = new (nothrow) gc_type_histogram_entry [TYPE_HISTOGRAM_SIZE + 1];
+        if (!type_histogram_merged)
+        {
+            goto cleanup;
+        }
+        memset (type_histogram_merged, 0, (TYPE_HISTOGRAM_SIZE + 1) * sizeof (gc_type_histogram_entry));
+    }
+
+#if defined (VERIFY_HEAP) && !defined (MULTIPLE_HEAPS)
+    init_heap_verify_threads();
+#endif //VERIFY_HEAP && !MULTIPLE_HEAPS
+
     ret = 1;
 
 cleanup:
@@ -10110,6 +10353,10 @@ gc_heap::init_gc_heap (int  h_number)
 
     allocation_quantum = CLR_SIZE;
 
+#ifdef ADAPTIVE_ALLOC_QUANTUM
+    max_allocation_quantum = CLR_SIZE;
+#endif //ADAPTIVE_ALLOC_QUANTUM
+
     more_space_lock = gc_lock;
 
     ro_segments_in_range = FALSE;
@@ -10335,6 +10582,18 @@ gc_heap::init_gc_heap (int  h_number)
 
     max_free_space_items = MAX_NUM_FREE_SPACES;
 
+    type_histogram_p = FALSE;
+    type_histogram_used = 0;
+    type_histogram = 0;
+    if (type_histogram_enabled_p)
+    {
+        type_histogram = new (nothrow) gc_type_histogram_entry [TYPE_HISTOGRAM_SIZE + 1];
+        if (!type_histogram)
+        {
+            return 0;
+        }
+    }
+
     bestfit_seg = new (nothrow) seg_free_spaces (heap_number);
 
     if (!bestfit_seg)
@@ -11063,7 +11322,7 @@ void allocator::commit_alloc_list_changes()
 
 void gc_heap::adjust_limit_clr (uint8_t* start, size_t limit_size,
                                 alloc_context* acontext, heap_segment* seg,
-                                int align_const, int gen_number)
+                                int align_const, int gen_number, size_t size)
 {
     //probably should pass seg==0 for free lists.
     if (seg)
@@ -11088,11 +11347,29 @@ void gc_heap::adjust_limit_clr (uint8_t* start, size_t limit_size,
             make_unused_array (hole, free_obj_size);
             generation_free_obj_space (generation_of (gen_number)) += free_obj_size;
         }
+#ifdef LAZY_ALLOC_CLEAR
+        //the uncleared part of the old context is already formatted as a free object
+        if ((gen_number == 0) && (acontext->alloc_uncleared_bytes != 0))
+        {
+            generation_free_obj_space (generation_of (gen_number)) += acontext->alloc_uncleared_bytes;
+            acontext->alloc_uncleared_bytes = 0;
+        }
+#endif //LAZY_ALLOC_CLEAR
         acontext->alloc_ptr = start;
     }
+#ifdef LAZY_ALLOC_CLEAR
+    assert ((gen_number != 0) || (acontext->alloc_uncleared_bytes == 0));
+#endif //LAZY_ALLOC_CLEAR
     acontext->alloc_limit = (start + limit_size - Align (min_obj_size, align_const));
     acontext->alloc_bytes += limit_size;
 
+#ifdef ADAPTIVE_ALLOC_QUANTUM
+    if ((gen_number == 0) && (acontext->alloc_refills < 0xFF))
+    {
+        acontext->alloc_refills++;
+    }
+#endif //ADAPTIVE_ALLOC_QUANTUM
+
 #ifdef FEATURE_APPDOMAIN_RESOURCE_MONITORING
     if (g_fEnableARM)
     {
@@ -11139,8 +11416,32 @@ void gc_heap::adjust_limit_clr (uint8_t* start, size_t limit_size,
         dprintf (SPINLOCK_LOG, ("[%d]Lmsl to clear memory(1)", heap_number));
         add_saved_spinlock_info (me_release, mt_clr_mem);
         leave_spin_lock (&more_space_lock);
-        dprintf (3, ("clearing memory at %Ix for %d bytes", (start - plug_skew), limit_size));
-        memclr (start - plug_skew, limit_size);
+
+        size_t clear_size = limit_size;
+#ifdef LAZY_ALLOC_CLEAR
+        //only clear what the allocator is about to use, the rest is cleared
+        //by extend_alloc_context once the allocator gets to it
+        if (gen_number == 0)
+        {
+            clear_size = alloc_clear_size ((acontext->alloc_ptr + size + Align (min_obj_size, align_const) - start),
+                                           limit_size, align_const);
+        }
+#else
+        UNREFERENCED_PARAMETER(size);
+#endif //LAZY_ALLOC_CLEAR
+
+        dprintf (3, ("clearing memory at %Ix for %d bytes", (start - plug_skew), clear_size));
+        memclr (start - plug_skew, clear_size);
+
+#ifdef LAZY_ALLOC_CLEAR
+        if (clear_size < limit_size)
+        {
+            dprintf (3, ("leaving [%Ix, %Ix[ uncleared", (size_t)(start + clear_size), (size_t)(start + limit_size)));
+            make_unused_array (start + clear_size, limit_size - clear_size);
+            acontext->alloc_limit = start + clear_size - Align (min_obj_size, align_const);
+            acontext->alloc_uncleared_bytes = (uint16_t)(limit_size - clear_size);
+        }
+#endif //LAZY_ALLOC_CLEAR
     }
     else
     {
@@ -11192,18 +11493,105 @@ void gc_heap::adjust_limit_clr (uint8_t* start, size_t limit_size,
     //verify_mem_cleared (start - plug_skew, limit_size);
 }
 
+#ifdef LAZY_ALLOC_CLEAR
+// Returns how many of the available dirty bytes to clear right away so that at
+// least needed bytes (which include the Align (min_obj_size) the allocator can't
+// use) are usable. Anything left over has to be big enough to be formatted as a
+// free object and small enough to be recorded in the alloc context.
+size_t gc_heap::alloc_clear_size (size_t needed, size_t available, int align_const)
+{
+    size_t clear_size = max ((size_t)ALLOC_CLEAR_CHUNK, needed);
+    if (((clear_size + Align (min_obj_size, align_const)) > available) ||
+        ((available - clear_size) > ALLOC_UNCLEARED_MAX))
+    {
+        return available;
+    }
+    return clear_size;
+}
+
+// Called before taking more_space_lock when the gen0 alloc context runs out of
+// cleared memory. If the object fits in the uncleared part of the context that
+// follows alloc_limit, clear the next chunk of it and move alloc_limit up instead
+// of getting a new context.
+BOOL gc_heap::extend_alloc_context (alloc_context* acontext, size_t size)
+{
+    int align_const = get_alignment_constant (TRUE);
+    uint8_t* uncleared = acontext->alloc_limit + Align (min_obj_size, align_const);
+    size_t uncleared_size = acontext->alloc_uncleared_bytes;
+    size_t needed = acontext->alloc_ptr + size + Align (min_obj_size, align_const) - uncleared;
+
+    if (needed > uncleared_size)
+    {
+        //adjust_limit_clr will turn the rest of the context into free space
+        return FALSE;
+    }
+
+    size_t clear_size = alloc_clear_size (needed, uncleared_size, align_const);
+
+    dprintf (3, ("extending alloc context %Ix: clearing %Ix for %d bytes",
+                 (size_t)acontext, (size_t)(uncleared - plug_skew), clear_size));
+    memclr (uncleared - plug_skew, clear_size);
+    if (clear_size < uncleared_size)
+    {
+        make_unused_array (uncleared + clear_size, uncleared_size - clear_size);
+    }
+
+    acontext->alloc_limit = uncleared + clear_size - Align (min_obj_size, align_const);
+    acontext->alloc_uncleared_bytes = (uint16_t)(uncleared_size - clear_size);
+    return TRUE;
+}
+#endif //LAZY_ALLOC_CLEAR
+
 /* in order to make the allocator faster, allocate returns a
  * 0 filled object. Care must be taken to set the allocation limit to the
  * allocation pointer after gc
  */
 
+size_t gc_heap::alloc_quantum_of (alloc_context* acontext)
+{
+#ifdef ADAPTIVE_ALLOC_QUANTUM
+    if (acontext->alloc_quantum_units != 0)
+    {
+        return min ((size_t)acontext->alloc_quantum_units * ALLOC_QUANTUM_UNIT, max_allocation_quantum);
+    }
+#else
+    UNREFERENCED_PARAMETER(acontext);
+#endif //ADAPTIVE_ALLOC_QUANTUM
+    return allocation_quantum;
+}
+
+#ifdef ADAPTIVE_ALLOC_QUANTUM
+// Called for each alloc context at the start of a GC. Threads which had to come back for more space many
+// times since the last GC get a bigger quantum so they take the allocation slow path (and more_space_lock)
+// less often, threads which barely allocated get a smaller one so they don't hold on to gen0 space they
+// won't use.
+void gc_heap::adapt_alloc_quantum (alloc_context* acontext)
+{
+    size_t quantum = alloc_quantum_of (acontext);
+
+    if (acontext->alloc_refills >= ALLOC_QUANTUM_GROW_REFILLS)
+    {
+        quantum *= 2;
+    }
+    else if (acontext->alloc_refills <= ALLOC_QUANTUM_SHRINK_REFILLS)
+    {
+        quantum /= 2;
+    }
+
+    quantum = min ((size_t)ALLOC_QUANTUM_MAX, max ((size_t)ALLOC_QUANTUM_MIN, quantum));
+
+    acontext->alloc_quantum_units = (uint8_t)(quantum / ALLOC_QUANTUM_UNIT);
+    acontext->alloc_refills = 0;
+}
+#endif //ADAPTIVE_ALLOC_QUANTUM
+
 size_t gc_heap::limit_from_size (size_t size, size_t room, int gen_number,
-                                 int align_const)
+                                 alloc_context* acontext, int align_const)
 {
     size_t new_limit = new_allocation_limit ((size + Align (min_obj_size, align_const)),
                                              min (room,max (size + Align (min_obj_size, align_const),
                                                             ((gen_number < max_generation+1) ?
-                                                             allocation_quantum :
+                                                             alloc_quantum_of (acontext) :
                                                              0))),
                                              gen_number);
     assert (new_limit >= (size + Align (min_obj_size, align_const)));
@@ -11536,7 +11924,7 @@ BOOL gc_heap::a_fit_free_list_p (int gen_number,
                     // We ask for more Align (min_obj_size)
                     // to make sure that we can insert a free object
                     // in adjust_limit will set the limit lower
-                    size_t limit = limit_from_size (size, free_list_size, gen_number, align_const);
+                    size_t limit = limit_from_size (size, free_list_size, gen_number, acontext, align_const);
 
                     uint8_t*  remain = (free_list + limit);
                     size_t remain_size = (free_list_size - limit);
@@ -11553,7 +11941,7 @@ BOOL gc_heap::a_fit_free_list_p (int gen_number,
                     }
                     generation_free_list_space (gen) -= limit;
 
-                    adjust_limit_clr (free_list, limit, acontext, 0, align_const, gen_number);
+                    adjust_limit_clr (free_list, limit, acontext, 0, align_const, gen_number, size);
 
                     can_fit = TRUE;
                     goto end;
@@ -11710,7 +12098,7 @@ BOOL gc_heap::a_fit_free_list_large_p (size_t size,
 
                     // Substract min obj size because limit_from_size adds it. Not needed for LOH
                     size_t limit = limit_from_size (size - Align(min_obj_size, align_const), free_list_size, 
-                                                    gen_number, align_const);
+                                                    gen_number, acontext, align_const);
 
 #ifdef FEATURE_LOH_COMPACTION
                     make_unused_array (free_list, loh_pad);
@@ -11745,7 +12133,7 @@ BOOL gc_heap::a_fit_free_list_large_p (size_t size,
                     else
 #endif //BACKGROUND_GC
                     {
-                        adjust_limit_clr (free_list, limit, acontext, 0, align_const, gen_number);
+                        adjust_limit_clr (free_list, limit, acontext, 0, align_const, gen_number, size);
                     }
 
                     //fix the limit to compensate for adjust_limit_clr making it too short 
@@ -11799,7 +12187,7 @@ BOOL gc_heap::a_fit_segment_end_p (int gen_number,
     {
         limit = limit_from_size (size, 
                                  (end - allocated), 
-                                 gen_number, align_const);
+                                 gen_number, acontext, align_const);
         goto found_fit;
     }
 
@@ -11809,7 +12197,7 @@ BOOL gc_heap::a_fit_segment_end_p (int gen_number,
     {
         limit = limit_from_size (size, 
                                  (end - allocated), 
-                                 gen_number, align_const);
+                                 gen_number, acontext, align_const);
         if (grow_heap_segment (seg, allocated + limit))
         {
             goto found_fit;
@@ -11859,7 +12247,7 @@ found_fit:
     else
 #endif //BACKGROUND_GC
     {
-        adjust_limit_clr (old_alloc, limit, acontext, seg, align_const, gen_number);
+        adjust_limit_clr (old_alloc, limit, acontext, seg, align_const, gen_number, size);
     }
 
     return TRUE;
@@ -12817,6 +13205,14 @@ int gc_heap::try_allocate_more_space (alloc_context* acontext, size_t size,
         return -1;
     }
 
+#ifdef LAZY_ALLOC_CLEAR
+    if ((gen_number == 0) && (acontext->alloc_uncleared_bytes != 0) &&
+        extend_alloc_context (acontext, size))
+    {
+        return 1;
+    }
+#endif //LAZY_ALLOC_CLEAR
+
 #ifdef SYNCHRONIZATION_STATS
     unsigned int msl_acquire_start = GetCycleCount32();
 #endif //SYNCHRONIZATION_STATS
@@ -12905,6 +13301,11 @@ int gc_heap::try_allocate_more_space (alloc_context* acontext, size_t size,
     {
         //ETW trace for allocation tick
         size_t alloc_context_bytes = acontext->alloc_limit + Align (min_obj_size, align_const) - acontext->alloc_ptr;
+#ifdef LAZY_ALLOC_CLEAR
+        //the uncleared part of the context is handed out by extend_alloc_context
+        //without coming back here, account for it now
+        alloc_context_bytes += acontext->alloc_uncleared_bytes;
+#endif //LAZY_ALLOC_CLEAR
         int etw_allocation_index = ((gen_number == 0) ? 0 : 1);
 
         etw_allocation_running_amount[etw_allocation_index] += alloc_context_bytes;
@@ -15259,6 +15660,13 @@ void gc_heap::gc1()
                                             get_alignment_constant(FALSE));
             dprintf (3, ("New allocation quantum: %d(0x%Ix)", allocation_quantum, allocation_quantum));
         }
+
+#ifdef ADAPTIVE_ALLOC_QUANTUM
+        max_allocation_quantum = Align (min ((size_t)ALLOC_QUANTUM_MAX,
+                                             max (allocation_quantum, (size_t)get_new_allocation (0) / ALLOC_QUANTUM_BUDGET_FRACTION)),
+                                        get_alignment_constant(FALSE));
+        dprintf (3, ("New max allocation quantum: %d(0x%Ix)", max_allocation_quantum, max_allocation_quantum));
+#endif //ADAPTIVE_ALLOC_QUANTUM
     }
 #ifdef NO_WRITE_BARRIER
     reset_write_watch(FALSE);
@@ -17360,6 +17768,14 @@ BOOL ref_p (uint8_t* r)
     return (straight_ref_p (r) || partial_object_p (r));
 }
 
+inline
+void gc_heap::add_to_type_histogram (uint8_t* o, size_t s)
+{
+    gc_type_histogram_entry* entry = find_type_histogram_entry (type_histogram, &type_histogram_used, method_table (o));
+    entry->count++;
+    entry->size += s;
+}
+
 void gc_heap::mark_object_simple1 (uint8_t* oo, uint8_t* start THREAD_NUMBER_DCL)
 {
     SERVER_SC_MARK_VOLATILE(uint8_t*)* mark_stack_tos = (SERVER_SC_MARK_VOLATILE(uint8_t*)*)mark_stack_array;
@@ -17427,6 +17843,10 @@ void gc_heap::mark_object_simple1 (uint8_t* oo, uint8_t* start THREAD_NUMBER_DCL
                                                   }
                                                   size_t obj_size = size (o);
                                                   promoted_bytes (thread) += obj_size;
+                                                  if (type_histogram_p)
+                                                  {
+                                                      add_to_type_histogram (o, obj_size);
+                                                  }
                                                   if (contain_pointers_or_collectible (o))
                                                   {
                                                       *(mark_stack_tos++) = o;
@@ -17472,6 +17892,10 @@ void gc_heap::mark_object_simple1 (uint8_t* oo, uint8_t* start THREAD_NUMBER_DCL
 
                             size_t obj_size = size (class_obj);
                             promoted_bytes (thread) += obj_size;
+                            if (type_histogram_p)
+                            {
+                                add_to_type_histogram (class_obj, obj_size);
+                            }
                             *(mark_stack_tos++) = class_obj;
                         }
                     }
@@ -17517,6 +17941,10 @@ void gc_heap::mark_object_simple1 (uint8_t* oo, uint8_t* start THREAD_NUMBER_DCL
                                                 }
                                                 size_t obj_size = size (o);
                                                 promoted_bytes (thread) += obj_size;
+                                                if (type_histogram_p)
+                                                {
+                                                    add_to_type_histogram (o, obj_size);
+                                                }
                                                 if (contain_pointers_or_collectible (o))
                                                 {
                                                     *(mark_stack_tos++) = o;
@@ -17943,6 +18371,10 @@ gc_heap::mark_object_simple (uint8_t** po THREAD_NUMBER_DCL)
             m_boundary (o);
             size_t s = size (o);
             promoted_bytes (thread) += s;
+            if (type_histogram_p)
+            {
+                add_to_type_histogram (o, s);
+            }
             {
                 go_through_object_cl (method_table(o), o, s, poo,
                                         {
@@ -17952,6 +18384,10 @@ gc_heap::mark_object_simple (uint8_t** po THREAD_NUMBER_DCL)
                                                 m_boundary (oo);
                                                 size_t obj_size = size (oo);
                                                 promoted_bytes (thread) += obj_size;
+                                                if (type_histogram_p)
+                                                {
+                                                    add_to_type_histogram (oo, obj_size);
+                                                }
 
                                                 if (contain_pointers_or_collectible (oo))
                                                     mark_object_simple1 (oo, oo THREAD_NUMBER_ARG);
@@ -19168,11 +19604,19 @@ void gc_heap::mark_phase (int condemned_gen_number, BOOL mark_only_p)
     dprintf(2,("---- Mark Phase condemning %d ----", condemned_gen_number));
     BOOL  full_p = (condemned_gen_number == max_generation);
 
+    type_histogram_p = (full_p && (type_histogram != 0));
+    if (type_histogram_p)
+    {
+        memset (type_histogram, 0, (TYPE_HISTOGRAM_SIZE + 1) * sizeof (gc_type_histogram_entry));
+        type_histogram_used = 0;
+    }
+
 #ifdef TIME_GC
     unsigned start;
     unsigned finish;
     start = GetCycleCount32();
 #endif //TIME_GC
+    int64_t phase_start_ts = GCToOSInterface::QueryPerformanceCounter();
 
     int gen_to_init = condemned_gen_number;
     if (condemned_gen_number == max_generation)
@@ -19658,6 +20102,10 @@ void gc_heap::mark_phase (int condemned_gen_number, BOOL mark_only_p)
         mark_time = finish - start;
 #endif //TIME_GC
 
+    type_histogram_p = FALSE;
+
+    record_pause_phase (gc_pause_phase_mark, phase_start_ts);
+
     dprintf(2,("---- End of mark phase ----"));
 }
 
@@ -21108,6 +21556,7 @@ void gc_heap::plan_phase (int condemned_gen_number)
     unsigned finish;
     start = GetCycleCount32();
 #endif //TIME_GC
+    int64_t phase_start_ts = GCToOSInterface::QueryPerformanceCounter();
 
     dprintf (2,("---- Plan Phase ---- Condemned generation %d, promotion: %d",
                 condemned_gen_number, settings.promotion ? 1 : 0));
@@ -22060,6 +22509,8 @@ void gc_heap::plan_phase (int condemned_gen_number)
     plan_time = finish - start;
 #endif //TIME_GC
 
+    record_pause_phase (gc_pause_phase_plan, phase_start_ts);
+
     // We may update write barrier code.  We assume here EE has been suspended if we are on a GC thread.
     assert(GCHeap::IsGCInProgress());
 
@@ -22741,6 +23192,7 @@ void gc_heap::make_free_lists (int condemned_gen_number)
     unsigned finish;
     start = GetCycleCount32();
 #endif //TIME_GC
+    int64_t phase_start_ts = GCToOSInterface::QueryPerformanceCounter();
 
     //Promotion has to happen in sweep case.
     assert (settings.promotion);
@@ -22861,6 +23313,8 @@ void gc_heap::make_free_lists (int condemned_gen_number)
     finish = GetCycleCount32();
     sweep_time = finish - start;
 #endif //TIME_GC
+
+    record_pause_phase (gc_pause_phase_sweep, phase_start_ts);
 }
 
 void gc_heap::make_free_list_in_brick (uint8_t* tree, make_free_args* args)
@@ -24039,6 +24493,7 @@ void gc_heap::relocate_phase (int condemned_gen_number,
         unsigned finish;
         start = GetCycleCount32();
 #endif //TIME_GC
+    int64_t phase_start_ts = GCToOSInterface::QueryPerformanceCounter();
 
 //  %type%  category = quote (relocate);
     dprintf (2,("---- Relocate phase -----"));
@@ -24129,6 +24584,8 @@ void gc_heap::relocate_phase (int condemned_gen_number,
         reloc_time = finish - start;
 #endif //TIME_GC
 
+    record_pause_phase (gc_pause_phase_relocate, phase_start_ts);
+
     dprintf(2,( "---- End of Relocate phase ----"));
 }
 
@@ -24481,6 +24938,7 @@ void gc_heap::compact_phase (int condemned_gen_number,
         unsigned finish;
         start = GetCycleCount32();
 #endif //TIME_GC
+    int64_t phase_start_ts = GCToOSInterface::QueryPerformanceCounter();
     generation*   condemned_gen = generation_of (condemned_gen_number);
     uint8_t*  start_address = first_condemned_address;
     size_t   current_brick = brick_of (start_address);
@@ -24604,6 +25062,8 @@ void gc_heap::compact_phase (int condemned_gen_number,
     compact_time = finish - start;
 #endif //TIME_GC
 
+    record_pause_phase (gc_pause_phase_compact, phase_start_ts);
+
     concurrent_print_time_delta ("compact end");
 
     dprintf(2,("---- End of Compact phase ----"));
@@ -25906,9 +26366,9 @@ gc_heap::suspend_EE ()
     dprintf (2, ("suspend_EE"));
 #ifdef MULTIPLE_HEAPS
     gc_heap* hp = gc_heap::g_heaps[0];
-    GCToEEInterface::SuspendEE(GCToEEInterface::SUSPEND_FOR_GC_PREP);
+    timed_suspend_EE(GCToEEInterface::SUSPEND_FOR_GC_PREP);
 #else
-    GCToEEInterface::SuspendEE(GCToEEInterface::SUSPEND_FOR_GC_PREP);
+    timed_suspend_EE(GCToEEInterface::SUSPEND_FOR_GC_PREP);
 #endif //MULTIPLE_HEAPS
 }
 
@@ -25922,7 +26382,7 @@ gc_heap::bgc_suspend_EE ()
     }
     gc_started = TRUE;
     dprintf (2, ("bgc_suspend_EE"));
-    GCToEEInterface::SuspendEE(GCToEEInterface::SUSPEND_FOR_GC_PREP);
+    timed_suspend_EE(GCToEEInterface::SUSPEND_FOR_GC_PREP);
 
     gc_started = FALSE;
     for (int i = 0; i < n_heaps; i++)
@@ -25937,7 +26397,7 @@ gc_heap::bgc_suspend_EE ()
     reset_gc_done();
     gc_started = TRUE;
     dprintf (2, ("bgc_suspend_EE"));
-    GCToEEInterface::SuspendEE(GCToEEInterface::SUSPEND_FOR_GC_PREP);
+    timed_suspend_EE(GCToEEInterface::SUSPEND_FOR_GC_PREP);
     gc_started = FALSE;
     set_gc_done();
 }
@@ -25948,9 +26408,9 @@ gc_heap::restart_EE ()
 {
     dprintf (2, ("restart_EE"));
 #ifdef MULTIPLE_HEAPS
-    GCToEEInterface::RestartEE(FALSE);
+    timed_restart_EE(FALSE);
 #else
-    GCToEEInterface::RestartEE(FALSE);
+    timed_restart_EE(FALSE);
 #endif //MULTIPLE_HEAPS
 }
 
@@ -32770,26 +33230,23 @@ gc_heap::verify_free_lists ()
     }
 }
 
-void
-gc_heap::verify_heap (BOOL begin_gc_p)
+// Verifies the objects on one segment along with the bricks and cards covering them. All the state of the walk
+// is local so that several threads can verify different segments at the same time.
+void gc_heap::verify_heap_segment (heap_segment* seg, BOOL large_p,
+                                   size_t* objects_verified, size_t* objects_verified_deep)
 {
     int             heap_verify_level = g_pConfig->GetHeapVerifyLevel();
     size_t          last_valid_brick = 0;
     BOOL            bCurrentBrickInvalid = FALSE;
-    BOOL            large_brick_p = TRUE;
     size_t          curr_brick = 0;
     size_t          prev_brick = (size_t)-1;
-    int             curr_gen_num = max_generation+1;    
-    heap_segment*   seg = heap_segment_in_range (generation_start_segment (generation_of (curr_gen_num ) ));
-
-    PREFIX_ASSUME(seg != NULL);
-
+    int             curr_gen_num = (large_p ? (max_generation+1) : max_generation);
     uint8_t*        curr_object = heap_segment_mem (seg);
     uint8_t*        prev_object = 0;
     uint8_t*        begin_youngest = generation_allocation_start(generation_of(0));
     uint8_t*        end_youngest = heap_segment_allocated (ephemeral_heap_segment);
     uint8_t*        next_boundary = generation_allocation_start (generation_of (max_generation - 1));
-    int             align_const = get_alignment_constant (FALSE);
+    int             align_const = get_alignment_constant (!large_p);
     size_t          total_objects_verified = 0;
     size_t          total_objects_verified_deep = 0;
 
@@ -32800,131 +33257,8 @@ gc_heap::verify_heap (BOOL begin_gc_p)
     should_check_bgc_mark (seg, &consider_bgc_mark_p, &check_current_sweep_p, &check_saved_sweep_p);
 #endif //BACKGROUND_GC
 
-#ifdef MULTIPLE_HEAPS
-    t_join* current_join = &gc_t_join;
-#ifdef BACKGROUND_GC
-    if (settings.concurrent && (bgc_thread_id.IsCurrentThread()))
-    {
-        // We always call verify_heap on entry of GC on the SVR GC threads.
-        current_join = &bgc_t_join;
-    }
-#endif //BACKGROUND_GC
-#endif //MULTIPLE_HEAPS
-
-    UNREFERENCED_PARAMETER(begin_gc_p);
-#ifdef BACKGROUND_GC 
-    dprintf (2,("[%s]GC#%d(%s): Verifying heap - begin", 
-        (begin_gc_p ? "BEG" : "END"),
-        VolatileLoad(&settings.gc_index), 
-        (settings.concurrent ? "BGC" : (recursive_gc_sync::background_running_p() ? "FGC" : "NGC"))));
-#else
-    dprintf (2,("[%s]GC#%d: Verifying heap - begin", 
-                (begin_gc_p ? "BEG" : "END"), VolatileLoad(&settings.gc_index)));
-#endif //BACKGROUND_GC 
-
-#ifndef MULTIPLE_HEAPS
-    if ((g_ephemeral_low != generation_allocation_start (generation_of (max_generation - 1))) ||
-        (g_ephemeral_high != heap_segment_reserved (ephemeral_heap_segment)))
-    {
-        FATAL_GC_ERROR();
-    }
-#endif //MULTIPLE_HEAPS
-
-#ifdef BACKGROUND_GC
-    //don't touch the memory because the program is allocating from it.
-    if (!settings.concurrent)
-#endif //BACKGROUND_GC
-    {
-        if (!(heap_verify_level & EEConfig::HEAPVERIFY_NO_MEM_FILL))
-        {
-            //uninit the unused portions of segments.
-            generation* gen1 = large_object_generation;
-            heap_segment* seg1 = heap_segment_rw (generation_start_segment (gen1));
-            PREFIX_ASSUME(seg1 != NULL);
-
-            while (1)
-            {
-                if (seg1)
-                {
-                    uint8_t* clear_start = heap_segment_allocated (seg1) - plug_skew;
-                    if (heap_segment_used (seg1) > clear_start)
-                    {
-                        dprintf (3, ("setting end of seg %Ix: [%Ix-[%Ix to 0xaa", 
-                                    heap_segment_mem (seg1),
-                                    clear_start ,
-                                    heap_segment_used (seg1)));
-                        memset (heap_segment_allocated (seg1) - plug_skew, 0xaa,
-                            (heap_segment_used (seg1) - clear_start));
-                    }
-                    seg1 = heap_segment_next_rw (seg1);
-                }
-                else
-                {
-                    if (gen1 == large_object_generation)
-                    {
-                        gen1 = generation_of (max_generation);
-                        seg1 = heap_segment_rw (generation_start_segment (gen1));
-                        PREFIX_ASSUME(seg1 != NULL);
-                    }
-                    else
-                    {
-                        break;
-                    }
-                }
-            }
-        }
-    }
-
-#ifdef MULTIPLE_HEAPS
-    current_join->join(this, gc_join_verify_copy_table);
-    if (current_join->joined())
-    {
-        // in concurrent GC, new segment could be allocated when GC is working so the card brick table might not be updated at this point
-        for (int i = 0; i < n_heaps; i++)
-        {
-            //copy the card and brick tables
-            if (g_card_table != g_heaps[i]->card_table)
-            {
-                g_heaps[i]->copy_brick_card_table();
-            }
-        }
-
-        current_join->restart();
-    }
-#else
-        if (g_card_table != card_table)
-            copy_brick_card_table();
-#endif //MULTIPLE_HEAPS
-
-    //verify that the generation structures makes sense
-    {
-        generation* gen = generation_of (max_generation);
-
-        assert (generation_allocation_start (gen) ==
-                heap_segment_mem (heap_segment_rw (generation_start_segment (gen))));
-        int gen_num = max_generation-1;
-        generation* prev_gen = gen;
-        while (gen_num >= 0)
-        {
-            gen = generation_of (gen_num);
-            assert (generation_allocation_segment (gen) == ephemeral_heap_segment);
-            assert (generation_allocation_start (gen) >= heap_segment_mem (ephemeral_heap_segment));
-            assert (generation_allocation_start (gen) < heap_segment_allocated (ephemeral_heap_segment));
-
-            if (generation_start_segment (prev_gen ) ==
-                generation_start_segment (gen))
-            {
-                assert (generation_allocation_start (prev_gen) <
-                        generation_allocation_start (gen));
-            }
-            prev_gen = gen;
-            gen_num--;
-        }
-    }
-
     while (1)
     {
-        // Handle segment transitions
         if (curr_object >= heap_segment_allocated (seg))
         {
             if (curr_object > heap_segment_allocated(seg))
@@ -32933,36 +33267,7 @@ gc_heap::verify_heap (BOOL begin_gc_p)
                         (size_t)curr_object, (size_t)seg));
                 FATAL_GC_ERROR();
             }
-            seg = heap_segment_next_in_range (seg);
-            if (seg)
-            {
-#ifdef BACKGROUND_GC
-                should_check_bgc_mark (seg, &consider_bgc_mark_p, &check_current_sweep_p, &check_saved_sweep_p);
-#endif //BACKGROUND_GC
-                curr_object = heap_segment_mem(seg);
-                prev_object = 0;
-                continue;
-            }
-            else
-            {
-                if (curr_gen_num == (max_generation+1))
-                {
-                    curr_gen_num--;
-                    seg = heap_segment_in_range (generation_start_segment (generation_of (curr_gen_num)));
-
-                    PREFIX_ASSUME(seg != NULL);
-
-#ifdef BACKGROUND_GC
-                    should_check_bgc_mark (seg, &consider_bgc_mark_p, &check_current_sweep_p, &check_saved_sweep_p);
-#endif //BACKGROUND_GC
-                    curr_object = heap_segment_mem (seg);
-                    prev_object = 0;
-                    large_brick_p = FALSE;
-                    align_const = get_alignment_constant (TRUE);
-                }
-                else
-                    break;  // Done Verifying Heap -- no more segments
-            }
+            break;
         }
 
         // Are we at the end of the youngest_generation?
@@ -33035,7 +33340,7 @@ gc_heap::verify_heap (BOOL begin_gc_p)
                     FATAL_GC_ERROR();
                 }
 
-                if (large_brick_p)
+                if (large_p)
                 {
                     //large objects verify the table only if they are in
                     //range.
@@ -33198,6 +33503,353 @@ gc_heap::verify_heap (BOOL begin_gc_p)
         }
     }
 
+    *objects_verified += total_objects_verified;
+    *objects_verified_deep += total_objects_verified_deep;
+}
+
+#ifndef MULTIPLE_HEAPS
+// Creates the threads that verify the heap along with the thread doing the GC when HeapVerifyThreads is more than
+// one. Failing to create them isn't fatal, the heap is then verified by fewer threads.
+void gc_heap::init_heap_verify_threads()
+{
+    heap_verify_n_threads = 1;
+    heap_verify_sample_seed = (uint32_t)GCToOSInterface::QueryPerformanceCounter();
+
+    if (!(g_pConfig->GetHeapVerifyLevel() & EEConfig::HEAPVERIFY_GC))
+        return;
+
+    int n_threads = min (g_pConfig->GetHeapVerifyThreads(), MAX_HEAP_VERIFY_THREADS);
+    if (n_threads <= 1)
+        return;
+
+    heap_verify_done_event.CreateOSAutoEvent (FALSE);
+    if (!heap_verify_done_event.IsValid())
+        return;
+
+    while (heap_verify_n_threads < n_threads)
+    {
+        int thread_index = heap_verify_n_threads;
+
+        heap_verify_work_events[thread_index].CreateOSAutoEvent (FALSE);
+        if (!heap_verify_work_events[thread_index].IsValid())
+            break;
+
+        if (!GCToOSInterface::CreateThread (heap_verify_thread_stub, (void*)(size_t)thread_index, NULL))
+        {
+            heap_verify_work_events[thread_index].CloseEvent();
+            break;
+        }
+
+        heap_verify_n_threads++;
+    }
+
+    dprintf (2, ("verifying the heap with %d threads", heap_verify_n_threads));
+}
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable:4702) // C4702: unreachable code: the thread never returns
+#endif //_MSC_VER
+void __stdcall gc_heap::heap_verify_thread_stub (void* arg)
+{
+    ClrFlsSetThreadType (ThreadType_GC);
+
+    int thread_index = (int)(size_t)arg;
+
+    while (1)
+    {
+        heap_verify_work_events[thread_index].Wait (INFINITE, FALSE);
+
+        heap_verify_work (thread_index);
+
+        if (Interlocked::Decrement (&heap_verify_threads_pending) == 0)
+        {
+            heap_verify_done_event.Set();
+        }
+    }
+}
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+// One thread's share of verify_heap_segments_in_parallel: the segments it claims, then the handle tables it
+// claims.
+void gc_heap::heap_verify_work (int thread_index)
+{
+    size_t objects_verified = 0;
+    size_t objects_verified_deep = 0;
+
+    while (1)
+    {
+        int32_t index = Interlocked::Increment (&heap_verify_next_item) - 1;
+        if (index >= heap_verify_items_count)
+            break;
+
+        heap_verify_item* item = &heap_verify_items[index];
+        verify_heap_segment (item->seg, item->large_p, &objects_verified, &objects_verified_deep);
+
+#ifdef BACKGROUND_GC
+        if (settings.concurrent && !heap_segment_read_only_p (item->seg))
+        {
+            bgc_verify_mark_array_cleared (item->seg);
+        }
+#endif //BACKGROUND_GC
+    }
+
+    ScanContext sc;
+    sc.thread_number = heap_number;
+    GCScan::VerifyHandleTable(max_generation, max_generation, &sc, &heap_verify_next_handle_table);
+
+    heap_verify_objects_verified[thread_index] = objects_verified;
+    heap_verify_objects_verified_deep[thread_index] = objects_verified_deep;
+}
+
+// Verifies the segments, and the handle tables and mark array that go with them, on the heap verification
+// threads when there are some. When HeapVerifySamplePercent is set, only that percentage of the segments, picked
+// at random at each GC, are verified. Returns FALSE if neither applies, or the list of segments couldn't be
+// allocated, in which case the caller walks all the segments itself.
+BOOL gc_heap::verify_heap_segments_in_parallel (size_t* objects_verified, size_t* objects_verified_deep)
+{
+    int sample_percent = g_pConfig->GetHeapVerifySamplePercent();
+    BOOL sample_p = ((sample_percent > 0) && (sample_percent < 100));
+
+    if ((heap_verify_n_threads <= 1) && !sample_p)
+        return FALSE;
+
+    size_t n_segments = 0;
+    for (int curr_gen_num = max_generation+1; curr_gen_num >= max_generation; curr_gen_num--)
+    {
+        heap_segment* seg = heap_segment_in_range (generation_start_segment (generation_of (curr_gen_num)));
+        while (seg)
+        {
+            n_segments++;
+            seg = heap_segment_next_in_range (seg);
+        }
+    }
+
+    if (n_segments > heap_verify_items_size)
+    {
+        size_t new_size = max (n_segments, 2 * heap_verify_items_size);
+        heap_verify_item* new_items = new (nothrow) heap_verify_item [new_size];
+        if (!new_items)
+            return FALSE;
+
+        delete [] heap_verify_items;
+        heap_verify_items = new_items;
+        heap_verify_items_size = new_size;
+    }
+
+    int32_t n_items = 0;
+    for (int curr_gen_num = max_generation+1; curr_gen_num >= max_generation; curr_gen_num--)
+    {
+        heap_segment* seg = heap_segment_in_range (generation_start_segment (generation_of (curr_gen_num)));
+        while (seg)
+        {
+            BOOL verify_p = TRUE;
+            if (sample_p)
+            {
+                heap_verify_sample_seed = heap_verify_sample_seed * 214013 + 2531011;
+                verify_p = ((int)((heap_verify_sample_seed >> 16) % 100) < sample_percent);
+            }
+
+            if (verify_p)
+            {
+                heap_verify_items[n_items].seg = seg;
+                heap_verify_items[n_items].large_p = (curr_gen_num == (max_generation+1));
+                n_items++;
+            }
+            seg = heap_segment_next_in_range (seg);
+        }
+    }
+
+    // The ephemeral segment is where most of the heap changes, look at it when the draw picked nothing.
+    if (n_items == 0)
+    {
+        heap_verify_items[0].seg = ephemeral_heap_segment;
+        heap_verify_items[0].large_p = FALSE;
+        n_items = 1;
+    }
+
+    dprintf (2, ("verifying %d out of %Id segments with %d threads", n_items, n_segments, heap_verify_n_threads));
+
+    heap_verify_items_count = n_items;
+    heap_verify_next_item = 0;
+    heap_verify_next_handle_table = 0;
+    heap_verify_threads_pending = heap_verify_n_threads - 1;
+
+    for (int i = 1; i < heap_verify_n_threads; i++)
+    {
+        heap_verify_work_events[i].Set();
+    }
+
+    heap_verify_work (0);
+
+    if (heap_verify_n_threads > 1)
+    {
+        heap_verify_done_event.Wait (INFINITE, FALSE);
+    }
+
+    for (int i = 0; i < heap_verify_n_threads; i++)
+    {
+        *objects_verified += heap_verify_objects_verified[i];
+        *objects_verified_deep += heap_verify_objects_verified_deep[i];
+    }
+
+    return TRUE;
+}
+#endif //!MULTIPLE_HEAPS
+
+void
+gc_heap::verify_heap (BOOL begin_gc_p)
+{
+    int             heap_verify_level = g_pConfig->GetHeapVerifyLevel();
+    size_t          total_objects_verified = 0;
+    size_t          total_objects_verified_deep = 0;
+    BOOL            verified_in_parallel_p = FALSE;
+
+#ifdef MULTIPLE_HEAPS
+    t_join* current_join = &gc_t_join;
+#ifdef BACKGROUND_GC
+    if (settings.concurrent && (bgc_thread_id.IsCurrentThread()))
+    {
+        // We always call verify_heap on entry of GC on the SVR GC threads.
+        current_join = &bgc_t_join;
+    }
+#endif //BACKGROUND_GC
+#endif //MULTIPLE_HEAPS
+
+    UNREFERENCED_PARAMETER(begin_gc_p);
+#ifdef BACKGROUND_GC 
+    dprintf (2,("[%s]GC#%d(%s): Verifying heap - begin", 
+        (begin_gc_p ? "BEG" : "END"),
+        VolatileLoad(&settings.gc_index), 
+        (settings.concurrent ? "BGC" : (recursive_gc_sync::background_running_p() ? "FGC" : "NGC"))));
+#else
+    dprintf (2,("[%s]GC#%d: Verifying heap - begin", 
+                (begin_gc_p ? "BEG" : "END"), VolatileLoad(&settings.gc_index)));
+#endif //BACKGROUND_GC 
+
+#ifndef MULTIPLE_HEAPS
+    if ((g_ephemeral_low != generation_allocation_start (generation_of (max_generation - 1))) ||
+        (g_ephemeral_high != heap_segment_reserved (ephemeral_heap_segment)))
+    {
+        FATAL_GC_ERROR();
+    }
+#endif //MULTIPLE_HEAPS
+
+#ifdef BACKGROUND_GC
+    //don't touch the memory because the program is allocating from it.
+    if (!settings.concurrent)
+#endif //BACKGROUND_GC
+    {
+        if (!(heap_verify_level & EEConfig::HEAPVERIFY_NO_MEM_FILL))
+        {
+            //uninit the unused portions of segments.
+            generation* gen1 = large_object_generation;
+            heap_segment* seg1 = heap_segment_rw (generation_start_segment (gen1));
+            PREFIX_ASSUME(seg1 != NULL);
+
+            while (1)
+            {
+                if (seg1)
+                {
+                    uint8_t* clear_start = heap_segment_allocated (seg1) - plug_skew;
+                    if (heap_segment_used (seg1) > clear_start)
+                    {
+                        dprintf (3, ("setting end of seg %Ix: [%Ix-[%Ix to 0xaa", 
+                                    heap_segment_mem (seg1),
+                                    clear_start ,
+                                    heap_segment_used (seg1)));
+                        memset (heap_segment_allocated (seg1) - plug_skew, 0xaa,
+                            (heap_segment_used (seg1) - clear_start));
+                    }
+                    seg1 = heap_segment_next_rw (seg1);
+                }
+                else
+                {
+                    if (gen1 == large_object_generation)
+                    {
+                        gen1 = generation_of (max_generation);
+                        seg1 = heap_segment_rw (generation_start_segment (gen1));
+                        PREFIX_ASSUME(seg1 != NULL);
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+#ifdef MULTIPLE_HEAPS
+    current_join->join(this, gc_join_verify_copy_table);
+    if (current_join->joined())
+    {
+        // in concurrent GC, new segment could be allocated when GC is working so the card brick table might not be updated at this point
+        for (int i = 0; i < n_heaps; i++)
+        {
+            //copy the card and brick tables
+            if (g_card_table != g_heaps[i]->card_table)
+            {
+                g_heaps[i]->copy_brick_card_table();
+            }
+        }
+
+        current_join->restart();
+    }
+#else
+        if (g_card_table != card_table)
+            copy_brick_card_table();
+#endif //MULTIPLE_HEAPS
+
+    //verify that the generation structures makes sense
+    {
+        generation* gen = generation_of (max_generation);
+
+        assert (generation_allocation_start (gen) ==
+                heap_segment_mem (heap_segment_rw (generation_start_segment (gen))));
+        int gen_num = max_generation-1;
+        generation* prev_gen = gen;
+        while (gen_num >= 0)
+        {
+            gen = generation_of (gen_num);
+            assert (generation_allocation_segment (gen) == ephemeral_heap_segment);
+            assert (generation_allocation_start (gen) >= heap_segment_mem (ephemeral_heap_segment));
+            assert (generation_allocation_start (gen) < heap_segment_allocated (ephemeral_heap_segment));
+
+            if (generation_start_segment (prev_gen ) ==
+                generation_start_segment (gen))
+            {
+                assert (generation_allocation_start (prev_gen) <
+                        generation_allocation_start (gen));
+            }
+            prev_gen = gen;
+            gen_num--;
+        }
+    }
+
+#ifndef MULTIPLE_HEAPS
+    verified_in_parallel_p = verify_heap_segments_in_parallel (&total_objects_verified, &total_objects_verified_deep);
+#endif //!MULTIPLE_HEAPS
+
+    if (!verified_in_parallel_p)
+    {
+        for (int curr_gen_num = max_generation+1; curr_gen_num >= max_generation; curr_gen_num--)
+        {
+            heap_segment* seg = heap_segment_in_range (generation_start_segment (generation_of (curr_gen_num)));
+
+            PREFIX_ASSUME(seg != NULL);
+
+            while (seg)
+            {
+                verify_heap_segment (seg, (curr_gen_num == (max_generation+1)),
+                                     &total_objects_verified, &total_objects_verified_deep);
+                seg = heap_segment_next_in_range (seg);
+            }
+        }
+    }
+
 #ifdef BACKGROUND_GC
     dprintf (2, ("(%s)(%s)(%s) total_objects_verified is %Id, total_objects_verified_deep is %Id", 
                  (settings.concurrent ? "BGC" : (recursive_gc_sync::background_running_p () ? "FGC" : "NGC")),
@@ -33216,13 +33868,15 @@ gc_heap::verify_heap (BOOL begin_gc_p)
     finalize_queue->CheckFinalizerObjects();
 #endif // FEATURE_PREMORTEM_FINALIZATION
 
+    // The verification threads have done the handle tables as well.
+    if (!verified_in_parallel_p)
     {
         // to be consistent with handle table APIs pass a ScanContext*
         // to provide the heap number.  the SC isn't complete though so
         // limit its scope to handle table verification.
         ScanContext sc;
         sc.thread_number = heap_number;
-        GCScan::VerifyHandleTable(max_generation, max_generation, &sc);
+        GCScan::VerifyHandleTable(max_generation, max_generation, &sc, NULL);
     }
 
 #ifdef MULTIPLE_HEAPS
@@ -33247,7 +33901,7 @@ gc_heap::verify_heap (BOOL begin_gc_p)
         }
     }
 
-    if (settings.concurrent)
+    if (settings.concurrent && !verified_in_parallel_p)
     {
         verify_mark_array_cleared();
     }
@@ -34972,7 +35626,13 @@ void gc_heap::do_post_gc()
     gc_heap* hp = 0;
 #endif //MULTIPLE_HEAPS
     
+    if (type_histogram_enabled_p && !settings.concurrent && (settings.condemned_generation == max_generation))
+    {
+        merge_type_histograms();
+    }
+
     GCToEEInterface::GcDone(settings.condemned_generation);
+    GCToEEInterface::DiagGCEnd(VolatileLoad(&settings.gc_index), settings.condemned_generation, !!settings.concurrent);
 
 #ifdef GC_PROFILING
     if (!settings.concurrent)
@@ -35109,7 +35769,7 @@ GCHeap::GarbageCollectGeneration (unsigned int gen, gc_reason reason)
 
             dprintf (2, ("Suspending EE"));
             BEGIN_TIMING(suspend_ee_during_log);
-            GCToEEInterface::SuspendEE(GCToEEInterface::SUSPEND_FOR_GC);
+            gc_heap::timed_suspend_EE(GCToEEInterface::SUSPEND_FOR_GC);
             END_TIMING(suspend_ee_during_log);
             gc_heap::proceed_with_gc_p = gc_heap::should_proceed_with_gc();
             gc_heap::disable_preemptive (current_thread, cooperative_mode);
@@ -35199,7 +35859,7 @@ GCHeap::GarbageCollectGeneration (unsigned int gen, gc_reason reason)
         {
 #endif //BACKGROUND_GC
             BEGIN_TIMING(restart_ee_during_log);
-            GCToEEInterface::RestartEE(TRUE);
+            gc_heap::timed_restart_EE(TRUE);
             END_TIMING(restart_ee_during_log);
 #ifdef BACKGROUND_GC
         }
@@ -35670,6 +36330,33 @@ Object* GCHeap::GetNextFinalizableObject()
 
 }
 
+// Batched version of GetNextFinalizableObject: fetches up to count objects, taking each finalize lock only
+// once, and returns how many were stored in objects.
+size_t GCHeap::GetNextFinalizableObjects(Object** objects, size_t count)
+{
+#ifdef MULTIPLE_HEAPS
+
+    size_t fetched = 0;
+
+    //non critical objects from all queues first
+    for (int hn = 0; (hn < gc_heap::n_heaps) && (fetched < count); hn++)
+    {
+        gc_heap* hp = gc_heap::g_heaps [hn];
+        fetched += hp->finalize_queue->GetNextFinalizableObjects(&objects[fetched], count - fetched, TRUE);
+    }
+    //then non critical/critical ones
+    for (int hn = 0; (hn < gc_heap::n_heaps) && (fetched < count); hn++)
+    {
+        gc_heap* hp = gc_heap::g_heaps [hn];
+        fetched += hp->finalize_queue->GetNextFinalizableObjects(&objects[fetched], count - fetched, FALSE);
+    }
+    return fetched;
+
+#else //MULTIPLE_HEAPS
+    return pGenGCHeap->finalize_queue->GetNextFinalizableObjects(objects, count);
+#endif //MULTIPLE_HEAPS
+}
+
 size_t GCHeap::GetNumberFinalizableObjects()
 {
 #ifdef MULTIPLE_HEAPS
@@ -35762,6 +36449,49 @@ bool GCHeap::RegisterForFinalization (int gen, Object* obj)
     }
 }
 
+// Reservations are made on the first heap's queue, objects registered against
+// them are queued there whichever heap they live on.
+bool GCHeap::ReserveForFinalization (size_t count)
+{
+#ifdef MULTIPLE_HEAPS
+    gc_heap* hp = gc_heap::g_heaps [0];
+#else
+    gc_heap* hp = pGenGCHeap;
+#endif //MULTIPLE_HEAPS
+    return hp->finalize_queue->ReserveForFinalization (count);
+}
+
+void GCHeap::RegisterReservedForFinalization (Object* obj)
+{
+#ifdef MULTIPLE_HEAPS
+    gc_heap* hp = gc_heap::g_heaps [0];
+#else
+    gc_heap* hp = pGenGCHeap;
+#endif //MULTIPLE_HEAPS
+    if (((((CObjectHeader*)obj)->GetHeader()->GetBits()) & BIT_SBLK_FINALIZER_RUN))
+    {
+        //finalization was suppressed before the object was registered
+        ((CObjectHeader*)obj)->GetHeader()->ClrBit(BIT_SBLK_FINALIZER_RUN);
+        hp->finalize_queue->ReleaseFinalizationReservation (1);
+    }
+    else
+    {
+        bool registered_p = hp->finalize_queue->RegisterForFinalization (0, obj, 0, TRUE);
+        assert (registered_p);
+        UNREFERENCED_PARAMETER(registered_p);
+    }
+}
+
+void GCHeap::ReleaseFinalizationReservation (size_t count)
+{
+#ifdef MULTIPLE_HEAPS
+    gc_heap* hp = gc_heap::g_heaps [0];
+#else
+    gc_heap* hp = pGenGCHeap;
+#endif //MULTIPLE_HEAPS
+    hp->finalize_queue->ReleaseFinalizationReservation (count);
+}
+
 void GCHeap::SetFinalizationRun (Object* obj)
 {
     ((CObjectHeader*)obj)->GetHeader()->SetBit(BIT_SBLK_FINALIZER_RUN);
@@ -35882,6 +36612,7 @@ bool CFinalize::Initialize()
         SegQueueLimit (i) = m_Array;
     }
     m_PromotedCount = 0;
+    m_ReservedCount = 0;
     lock = -1;
 #ifdef _DEBUG
     lockowner_threadid.Clear();
@@ -35941,7 +36672,7 @@ void CFinalize::LeaveFinalizeLock()
 }
 
 bool
-CFinalize::RegisterForFinalization (int gen, Object* obj, size_t size)
+CFinalize::RegisterForFinalization (int gen, Object* obj, size_t size, BOOL reserved_p)
 {
     CONTRACTL {
 #ifdef FEATURE_REDHAWK
@@ -35970,7 +36701,14 @@ CFinalize::RegisterForFinalization (int gen, Object* obj, size_t size)
 
     // Adjust boundary for segments so that GC will keep objects alive.
     Object*** s_i = &SegQueue (FreeList);
-    if ((*s_i) == m_EndArray)
+    if (reserved_p)
+    {
+        //the room was set aside by ReserveForFinalization
+        assert ((m_ReservedCount != 0) && ((*s_i) < m_EndArray));
+        m_ReservedCount--;
+    }
+    //leave the reserved free slots alone
+    while ((size_t)(m_EndArray - (*s_i)) <= m_ReservedCount)
     {
         if (!GrowArray())
         {
@@ -36020,12 +36758,67 @@ CFinalize::RegisterForFinalization (int gen, Object* obj, size_t size)
     return true;
 }
 
+// Make sure count more objects can be registered for finalization without growing
+// the queue, registering them with reserved_p can't fail.
+bool
+CFinalize::ReserveForFinalization (size_t count)
+{
+    EnterFinalizeLock();
+    while ((size_t)(m_EndArray - SegQueue (FreeList)) < (m_ReservedCount + count))
+    {
+        if (!GrowArray())
+        {
+            LeaveFinalizeLock();
+            STRESS_LOG_OOM_STACK(0);
+            return false;
+        }
+    }
+    m_ReservedCount += count;
+    LeaveFinalizeLock();
+    return true;
+}
+
+void
+CFinalize::ReleaseFinalizationReservation (size_t count)
+{
+    EnterFinalizeLock();
+    assert (m_ReservedCount >= count);
+    m_ReservedCount -= count;
+    LeaveFinalizeLock();
+}
+
 Object*
 CFinalize::GetNextFinalizableObject (BOOL only_non_critical)
 {
-    Object* obj = 0;
     //serialize
     EnterFinalizeLock();
+    Object* obj = GetNextFinalizableObjectNoLock (only_non_critical);
+    LeaveFinalizeLock();
+    return obj;
+}
+
+size_t
+CFinalize::GetNextFinalizableObjects (Object** objects, size_t count, BOOL only_non_critical)
+{
+    size_t fetched = 0;
+    //serialize
+    EnterFinalizeLock();
+    while (fetched < count)
+    {
+        Object* obj = GetNextFinalizableObjectNoLock (only_non_critical);
+        if (!obj)
+            break;
+        objects[fetched++] = obj;
+    }
+    LeaveFinalizeLock();
+    return fetched;
+}
+
+// Must be called with the finalize lock held.
+Object*
+CFinalize::GetNextFinalizableObjectNoLock (BOOL only_non_critical)
+{
+    Object* obj = 0;
 
 retry:
     if (!IsSegEmpty(FinalizerListSeg))
@@ -36057,7 +36850,6 @@ retry:
     {
         dprintf (3, ("running finalizer for %Ix (mt: %Ix)", obj, method_table (obj)));
     }
-    LeaveFinalizeLock();
     return obj;
 }
 
@@ -36584,7 +37376,6 @@ void gc_heap::walk_heap (walk_fn fn, void* context, int gen_number, BOOL walk_la
     }
 }
 
-#if defined(GC_PROFILING) || defined(FEATURE_EVENT_TRACE)
 void GCHeap::WalkObject (Object* obj, walk_fn fn, void* context)
 {
     uint8_t* o = (uint8_t*)obj;
@@ -36602,7 +37393,19 @@ void GCHeap::WalkObject (Object* obj, walk_fn fn, void* context)
             );
     }
 }
-#endif //defined(GC_PROFILING) || defined(FEATURE_EVENT_TRACE)
+
+void GCHeap::DiagWalkHeap (walk_fn fn, void* context, int gen_number, BOOL walk_large_object_heap_p)
+{
+#ifdef MULTIPLE_HEAPS
+    for (int hn = 0; hn < gc_heap::n_heaps; hn++)
+    {
+        gc_heap* hp = gc_heap::g_heaps [hn];
+        hp->walk_heap (fn, context, gen_number, walk_large_object_heap_p);
+    }
+#else
+    gc_heap::walk_heap (fn, context, gen_number, walk_large_object_heap_p);
+#endif //MULTIPLE_HEAPS
+}
 
 // Go through and touch (read) each page straddled by a memory block.
 void TouchPages(void * pStart, size_t cb)
@@ -181,6 +181,9 @@ struct alloc_context
     SVR::GCHeap*   home_heap;
 #endif // defined(FEATURE_SVR_GC)
     int            alloc_count;
+    uint8_t        alloc_quantum_units; // Quantum for this context in units of ALLOC_QUANTUM_UNIT, 0 for the default
+    uint8_t        alloc_refills;       // Number of times this context was refilled since the last GC
+    uint16_t       alloc_uncleared_bytes; // Size of the not yet cleared free object following alloc_limit
 public:
 
     void init()
@@ -196,9 +199,65 @@ public:
         home_heap = 0;
 #endif // defined(FEATURE_SVR_GC)
         alloc_count = 0;
+        alloc_quantum_units = 0;
+        alloc_refills = 0;
+        alloc_uncleared_bytes = 0;
     }
 };
 
+// A log-linear ("HDR style") histogram. Values below GC_HISTOGRAM_SUB_BUCKETS get a bucket each, larger
+// values are bucketed by their highest set bit with GC_HISTOGRAM_SUB_BUCKETS linear buckets per power of 2, so
+// the relative error of a bucket is at most 1/GC_HISTOGRAM_SUB_BUCKETS while the whole uint64_t range is covered.
+#define GC_HISTOGRAM_SUB_BUCKET_BITS    3
+#define GC_HISTOGRAM_SUB_BUCKETS        (1 << GC_HISTOGRAM_SUB_BUCKET_BITS)
+#define GC_HISTOGRAM_BUCKETS            ((64 - GC_HISTOGRAM_SUB_BUCKET_BITS + 1) * GC_HISTOGRAM_SUB_BUCKETS)
+
+struct gc_histogram
+{
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint32_t buckets[GC_HISTOGRAM_BUCKETS];
+};
+
+enum gc_pause_phase
+{
+    gc_pause_phase_mark = 0,
+    gc_pause_phase_plan = 1,
+    gc_pause_phase_relocate = 2,
+    gc_pause_phase_compact = 3,
+    gc_pause_phase_sweep = 4,
+    gc_pause_phase_count = 5
+};
+
+#define GC_PAUSE_STATS_VERSION          1
+#define GC_PAUSE_STATS_GENERATIONS      4       // gen0, gen1, gen2 and the large object heap
+
+// Pause and phase accounting kept by the GC since startup, see GCHeap::GetPauseStats. Times are in
+// microseconds, sizes in bytes. Phase times cover blocking GCs only (background GCs run their mark and sweep
+// concurrently with the EE) and are measured on the first heap with server GC. Promoted and fragmented bytes
+// are recorded for each generation condemned by a blocking GC, summed over all heaps.
+struct gc_pause_stats
+{
+    uint32_t     version;               // GC_PAUSE_STATS_VERSION
+    uint32_t     size;                  // sizeof(gc_pause_stats)
+    uint64_t     blocking_gc_count;     // blocking GCs accounted for in the byte histograms below
+    gc_histogram suspend_time;          // time taken to suspend the EE
+    gc_histogram pause_time;            // time from the start of the suspension to the start of the restart
+    gc_histogram phase_time[gc_pause_phase_count];
+    gc_histogram promoted_bytes[GC_PAUSE_STATS_GENERATIONS];
+    gc_histogram fragmented_bytes[GC_PAUSE_STATS_GENERATIONS];
+};
+
+// One type in the live object histogram kept by blocking gen2 GCs when it's enabled, see
+// GCHeap::GetTypeHistogram. An entry with a null type accounts for the types that didn't fit in the table.
+struct gc_type_histogram_entry
+{
+    void*        type;                  // MethodTable of the objects
+    size_t       count;                 // number of live objects
+    size_t       size;                  // bytes they occupy
+};
+
 struct ScanContext
 {
     Thread* thread_under_crawl;
@@ -528,6 +587,7 @@ public:
 
     virtual void    SetFinalizationRun (Object* obj) = 0;
     virtual Object* GetNextFinalizable() = 0;
+    virtual size_t GetNextFinalizables(Object** objects, size_t count) = 0;
     virtual size_t GetNumberOfFinalizable() = 0;
 
     virtual void SetFinalizeQueueForShutdown(BOOL fHasLock) = 0;
@@ -567,9 +627,9 @@ public:
     virtual Object*  AllocLHeap (size_t size, uint32_t flags) = 0;
     virtual void     SetReservedVMLimit (size_t vmlimit) = 0;
     virtual void SetCardsAfterBulkCopy( Object**, size_t ) = 0;
-#if defined(GC_PROFILING) || defined(FEATURE_EVENT_TRACE)
     virtual void WalkObject (Object* obj, walk_fn fn, void* context) = 0;
-#endif //defined(GC_PROFILING) || defined(FEATURE_EVENT_TRACE)
+    // Calls fn for every object in the heap, only valid while the EE is suspended and the heap is walkable.
+    virtual void DiagWalkHeap (walk_fn fn, void* context, int gen_number, BOOL walk_large_object_heap_p) = 0;
 
     virtual bool IsThreadUsingAllocationContextHeap(alloc_context* acontext, int thread_number) = 0;
     virtual int GetNumberOfHeaps () = 0; 
@@ -580,6 +640,13 @@ public:
         // Finalizer queue stuff (should stay)
     virtual bool    RegisterForFinalization (int gen, Object* obj) = 0;
 
+        // Room reserved on the finalization queue with ReserveForFinalization guarantees that as many gen0
+        // objects can later be registered with RegisterReservedForFinalization, which can't fail. Each
+        // registration uses up one slot, ReleaseFinalizationReservation gives back the ones left unused.
+    virtual bool    ReserveForFinalization (size_t count) = 0;
+    virtual void    RegisterReservedForFinalization (Object* obj) = 0;
+    virtual void    ReleaseFinalizationReservation (size_t count) = 0;
+
         // General queries to the GC
     virtual BOOL    IsPromoted (Object *object) = 0;
     virtual unsigned WhichGeneration (Object* object) = 0;
@@ -607,6 +674,12 @@ public:
     virtual size_t  GetCurrentObjSize() = 0;
     virtual size_t  GetLastGCStartTime(int generation) = 0;
     virtual size_t  GetLastGCDuration(int generation) = 0;
+    virtual void    GetPauseStats(gc_pause_stats* pStats) = 0;
+
+    // Copies the max_entries types owning the most bytes at the end of the last blocking gen2 GC into entries,
+    // sorted by size, and returns how many were copied. *gc_index is set to the index of that GC. Returns 0 if
+    // the histogram is disabled or no such GC happened yet. GCs must not happen while this runs.
+    virtual size_t  GetTypeHistogram(gc_type_histogram_entry* entries, size_t max_entries, size_t* gc_index) = 0;
     virtual size_t  GetNow() = 0;
     virtual unsigned GetGcCount() = 0;
     virtual void TraceGCSegments() = 0;
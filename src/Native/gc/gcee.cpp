@@ -378,6 +378,44 @@ size_t GCHeap::GetLastGCDuration(int generation)
     return dd_gc_elapsed_time (hp->dynamic_data_of (generation));
 }
 
+void GCHeap::GetPauseStats(gc_pause_stats* pStats)
+{
+    *pStats = gc_heap::pause_stats;
+    pStats->version = GC_PAUSE_STATS_VERSION;
+    pStats->size = sizeof (gc_pause_stats);
+}
+
+size_t GCHeap::GetTypeHistogram(gc_type_histogram_entry* entries, size_t max_entries, size_t* gc_index)
+{
+    *gc_index = gc_heap::type_histogram_gc_index;
+    if (gc_heap::type_histogram_gc_index == 0)
+    {
+        return 0;
+    }
+
+    // Insertion into the sorted output, the caller only asks for the top few types.
+    size_t count = 0;
+    for (size_t index = 0; index <= TYPE_HISTOGRAM_SIZE; index++)
+    {
+        gc_type_histogram_entry* entry = &gc_heap::type_histogram_merged[index];
+        if ((entry->count == 0) ||
+            ((count == max_entries) && ((count == 0) || (entry->size <= entries[count - 1].size))))
+        {
+            continue;
+        }
+
+        size_t position = (count < max_entries) ? count++ : (count - 1);
+        while ((position > 0) && (entries[position - 1].size < entry->size))
+        {
+            entries[position] = entries[position - 1];
+            position--;
+        }
+        entries[position] = *entry;
+    }
+
+    return count;
+}
+
 size_t GetHighPrecisionTimeStamp();
 
 size_t GCHeap::GetNow()
@@ -94,6 +94,8 @@ public:
 
     size_t  GetLastGCStartTime(int generation);
     size_t  GetLastGCDuration(int generation);
+    void    GetPauseStats(gc_pause_stats* pStats);
+    size_t  GetTypeHistogram(gc_type_histogram_entry* entries, size_t max_entries, size_t* gc_index);
     size_t  GetNow();
 
     void  TraceGCSegments ();    
@@ -166,6 +168,11 @@ public:
 
     //Register an object for finalization
     bool    RegisterForFinalization (int gen, Object* obj); 
+
+    //Set aside room on the finalization queue, register objects against it or give it back
+    bool    ReserveForFinalization (size_t count);
+    void    RegisterReservedForFinalization (Object* obj);
+    void    ReleaseFinalizationReservation (size_t count);
     
     //Unregister an object for finalization
     void    SetFinalizationRun (Object* obj); 
@@ -205,6 +212,7 @@ public:
     unsigned GetGcCount();
 
     Object* GetNextFinalizable() { return GetNextFinalizableObject(); };
+    size_t GetNextFinalizables(Object** objects, size_t count) { return GetNextFinalizableObjects(objects, count); };
     size_t GetNumberOfFinalizable() { return GetNumberFinalizableObjects(); }
 
     PER_HEAP_ISOLATED HRESULT GetGcCounters(int gen, gc_counters* counters);
@@ -216,6 +224,7 @@ public:
     void SetReservedVMLimit (size_t vmlimit);
 
     PER_HEAP_ISOLATED Object* GetNextFinalizableObject();
+    PER_HEAP_ISOLATED size_t GetNextFinalizableObjects(Object** objects, size_t count);
     PER_HEAP_ISOLATED size_t GetNumberFinalizableObjects();
     PER_HEAP_ISOLATED size_t GetFinalizablePromotedCount();
 
@@ -224,9 +233,8 @@ public:
     BOOL ShouldRestartFinalizerWatchDog();
 
     void SetCardsAfterBulkCopy( Object**, size_t);
-#if defined(GC_PROFILING) || defined(FEATURE_EVENT_TRACE)
     void WalkObject (Object* obj, walk_fn fn, void* context);
-#endif // defined(GC_PROFILING) || defined(FEATURE_EVENT_TRACE)
+    void DiagWalkHeap (walk_fn fn, void* context, int gen_number, BOOL walk_large_object_heap_p);
 
 public:	// FIX 
 
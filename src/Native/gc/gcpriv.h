@@ -57,6 +57,24 @@ inline void FATAL_GC_ERROR()
 #define FEATURE_PREMORTEM_FINALIZATION
 #define GC_HISTORY
 
+#define ADAPTIVE_ALLOC_QUANTUM //size the allocation quantum of each alloc context by how often it gets refilled
+
+#ifdef ADAPTIVE_ALLOC_QUANTUM
+#define ALLOC_QUANTUM_UNIT              (1024)
+#define ALLOC_QUANTUM_MIN               (1024)
+#define ALLOC_QUANTUM_MAX               (64*1024)
+#define ALLOC_QUANTUM_GROW_REFILLS      (16)    //double the quantum of contexts refilled at least this often between GCs
+#define ALLOC_QUANTUM_SHRINK_REFILLS    (1)     //halve the quantum of contexts refilled at most this often between GCs
+#define ALLOC_QUANTUM_BUDGET_FRACTION   (16)    //no quantum may exceed this fraction of the gen0 budget
+#endif //ADAPTIVE_ALLOC_QUANTUM
+
+#define LAZY_ALLOC_CLEAR //clear dirty memory handed to gen0 alloc contexts in chunks as the allocator reaches it
+
+#ifdef LAZY_ALLOC_CLEAR
+#define ALLOC_CLEAR_CHUNK               (4*1024)    //bytes cleared up front and every time the context is extended
+#define ALLOC_UNCLEARED_MAX             (0xFFFF)    //has to fit in alloc_context::alloc_uncleared_bytes
+#endif //LAZY_ALLOC_CLEAR
+
 #ifndef FEATURE_REDHAWK
 #define HEAP_ANALYZE
 #define COLLECTIBLE_CLASS
@@ -199,6 +217,14 @@ void GCLogConfig (const char *fmt, ... );
 #define MAX_NUM_FREE_SPACES 200 
 #define MIN_NUM_FREE_SPACES 5 
 
+// Number of types the type histogram tables can hold.
+#define TYPE_HISTOGRAM_BITS 13
+#define TYPE_HISTOGRAM_SIZE (1 << TYPE_HISTOGRAM_BITS)
+
+// Upper bound on the number of threads verifying the heap in parallel (HeapVerifyThreads), including the thread
+// doing the GC.
+#define MAX_HEAP_VERIFY_THREADS 64
+
 //Please leave these definitions intact.
 
 #define CLREvent CLREventStatic
@@ -404,6 +430,15 @@ class exclusive_sync;
 class recursive_gc_sync;
 #endif //BACKGROUND_GC
 
+#ifdef VERIFY_HEAP
+// A segment to be verified by one of the heap verification threads.
+struct heap_verify_item
+{
+    heap_segment* seg;
+    BOOL large_p;
+};
+#endif //VERIFY_HEAP
+
 // The following 2 modes are of the same format as in clr\src\bcl\system\runtime\gcsettings.cs
 // make sure you change that one if you change this one!
 enum gc_pause_mode
@@ -1177,6 +1212,19 @@ public:
 #ifdef VERIFY_HEAP
     PER_HEAP
     void verify_free_lists(); 
+    PER_HEAP
+    void verify_heap_segment (heap_segment* seg, BOOL large_p,
+                              size_t* objects_verified, size_t* objects_verified_deep);
+#ifndef MULTIPLE_HEAPS
+    PER_HEAP_ISOLATED
+    void init_heap_verify_threads();
+    PER_HEAP_ISOLATED
+    BOOL verify_heap_segments_in_parallel (size_t* objects_verified, size_t* objects_verified_deep);
+    PER_HEAP_ISOLATED
+    void heap_verify_work (int thread_index);
+    static
+    void __stdcall heap_verify_thread_stub (void* arg);
+#endif //!MULTIPLE_HEAPS
     PER_HEAP
     void verify_heap (BOOL begin_gc_p);
 #endif //VERIFY_HEAP
@@ -1187,6 +1235,24 @@ public:
     PER_HEAP_ISOLATED
     void fire_pevents();
 
+    PER_HEAP_ISOLATED
+    void timed_suspend_EE (GCToEEInterface::SUSPEND_REASON reason);
+
+    PER_HEAP_ISOLATED
+    void timed_restart_EE (BOOL bFinishedGC);
+
+    PER_HEAP
+    void record_pause_phase (gc_pause_phase phase, int64_t start_ts);
+
+    PER_HEAP_ISOLATED
+    void record_pause_gen_stats();
+
+    PER_HEAP
+    void add_to_type_histogram (uint8_t* o, size_t s);
+
+    PER_HEAP_ISOLATED
+    void merge_type_histograms();
+
 #ifdef FEATURE_BASICFREEZE
     static void walk_read_only_segment(heap_segment *seg, void *pvContext, object_callback_func pfnMethodTable, object_callback_func pfnObjRef);
 #endif
@@ -1414,9 +1480,15 @@ protected:
     PER_HEAP
     void fire_etw_pin_object_event (uint8_t* object, uint8_t** ppObject);
 
+    PER_HEAP
+    size_t alloc_quantum_of (alloc_context* acontext);
+#ifdef ADAPTIVE_ALLOC_QUANTUM
+    PER_HEAP
+    void adapt_alloc_quantum (alloc_context* acontext);
+#endif //ADAPTIVE_ALLOC_QUANTUM
     PER_HEAP
     size_t limit_from_size (size_t size, size_t room, int gen_number,
-                            int align_const);
+                            alloc_context* acontext, int align_const);
     PER_HEAP
     int try_allocate_more_space (alloc_context* acontext, size_t jsize,
                                  int alloc_generation_number);
@@ -1799,7 +1871,13 @@ protected:
     PER_HEAP
     void adjust_limit_clr (uint8_t* start, size_t limit_size,
                            alloc_context* acontext, heap_segment* seg,
-                           int align_const, int gen_number);
+                           int align_const, int gen_number, size_t size);
+#ifdef LAZY_ALLOC_CLEAR
+    PER_HEAP_ISOLATED
+    size_t alloc_clear_size (size_t needed, size_t available, int align_const);
+    PER_HEAP
+    BOOL extend_alloc_context (alloc_context* acontext, size_t size);
+#endif //LAZY_ALLOC_CLEAR
     PER_HEAP
     void  leave_allocation_segment (generation* gen);
 
@@ -2911,6 +2989,68 @@ public:
     PER_HEAP_ISOLATED
     gc_history_global gc_data_global;
 
+    PER_HEAP_ISOLATED
+    gc_pause_stats pause_stats;
+
+    // Performance counter value at the start of the current EE suspension.
+    PER_HEAP_ISOLATED
+    int64_t pause_start_ts;
+
+    // Whether blocking gen2 GCs build the type histogram, see GCHeap::GetTypeHistogram.
+    PER_HEAP_ISOLATED
+    BOOL type_histogram_enabled_p;
+
+    // The per heap tables of the last blocking gen2 GC merged, laid out the same way.
+    PER_HEAP_ISOLATED
+    gc_type_histogram_entry* type_histogram_merged;
+
+    PER_HEAP_ISOLATED
+    size_t type_histogram_gc_index;
+
+#if defined (VERIFY_HEAP) && !defined (MULTIPLE_HEAPS)
+    // Number of threads verifying the heap, including the thread doing the GC. The other ones are created at
+    // init and wait on heap_verify_work_events.
+    PER_HEAP_ISOLATED
+    int heap_verify_n_threads;
+
+    PER_HEAP_ISOLATED
+    CLREvent heap_verify_work_events[MAX_HEAP_VERIFY_THREADS];
+
+    // Set by the last thread to finish its share of the work.
+    PER_HEAP_ISOLATED
+    CLREvent heap_verify_done_event;
+
+    PER_HEAP_ISOLATED
+    VOLATILE(int32_t) heap_verify_threads_pending;
+
+    // The segments to verify during the current GC, claimed by the threads through heap_verify_next_item.
+    PER_HEAP_ISOLATED
+    heap_verify_item* heap_verify_items;
+
+    PER_HEAP_ISOLATED
+    size_t heap_verify_items_size;
+
+    PER_HEAP_ISOLATED
+    int32_t heap_verify_items_count;
+
+    PER_HEAP_ISOLATED
+    VOLATILE(int32_t) heap_verify_next_item;
+
+    PER_HEAP_ISOLATED
+    VOLATILE(int32_t) heap_verify_next_handle_table;
+
+    // What each thread verified, summed up once they are all done.
+    PER_HEAP_ISOLATED
+    size_t heap_verify_objects_verified[MAX_HEAP_VERIFY_THREADS];
+
+    PER_HEAP_ISOLATED
+    size_t heap_verify_objects_verified_deep[MAX_HEAP_VERIFY_THREADS];
+
+    // State of the generator picking the segments verified when HeapVerifySamplePercent is set.
+    PER_HEAP_ISOLATED
+    uint32_t heap_verify_sample_seed;
+#endif //VERIFY_HEAP && !MULTIPLE_HEAPS
+
     PER_HEAP_ISOLATED
     size_t gc_last_ephemeral_decommit_time;
 
@@ -3301,6 +3441,11 @@ protected:
     PER_HEAP
     size_t allocation_quantum;
 
+#ifdef ADAPTIVE_ALLOC_QUANTUM
+    PER_HEAP
+    size_t max_allocation_quantum;
+#endif //ADAPTIVE_ALLOC_QUANTUM
+
     PER_HEAP
     size_t alloc_contexts_used;
 
@@ -3604,6 +3749,18 @@ protected:
     PER_HEAP
     seg_free_spaces* bestfit_seg;
 
+    // Open addressed table of the objects marked on this heap by type, filled in by the mark phase of blocking
+    // gen2 GCs when type_histogram_p is set. The entry at index TYPE_HISTOGRAM_SIZE accumulates the types that
+    // didn't fit.
+    PER_HEAP
+    gc_type_histogram_entry* type_histogram;
+
+    PER_HEAP
+    size_t type_histogram_used;
+
+    PER_HEAP
+    BOOL type_histogram_p;
+
     // Note: we know this from the plan phase.
     // total_ephemeral_plugs actually has the same value
     // but while we are calculating its value we also store
@@ -3713,6 +3870,7 @@ private:
     PTR_PTR_Object m_FillPointers[NUMBERGENERATIONS+ExtraSegCount];
     PTR_PTR_Object m_EndArray;
     size_t   m_PromotedCount;
+    size_t   m_ReservedCount;   //free slots set aside by ReserveForFinalization
     
     VOLATILE(int32_t) lock;
 #ifdef _DEBUG
@@ -3744,13 +3902,18 @@ private:
                                   BOOL fRunFinalizers, 
                                   unsigned int Seg);
 
+    Object* GetNextFinalizableObjectNoLock (BOOL only_non_critical);
+
 public:
     ~CFinalize();
     bool Initialize();
     void EnterFinalizeLock();
     void LeaveFinalizeLock();
-    bool RegisterForFinalization (int gen, Object* obj, size_t size=0);
+    bool RegisterForFinalization (int gen, Object* obj, size_t size=0, BOOL reserved_p=FALSE);
+    bool ReserveForFinalization (size_t count);
+    void ReleaseFinalizationReservation (size_t count);
     Object* GetNextFinalizableObject (BOOL only_non_critical=FALSE);
+    size_t GetNextFinalizableObjects (Object** objects, size_t count, BOOL only_non_critical=FALSE);
     BOOL ScanForFinalization (promote_func* fn, int gen,BOOL mark_only_p, gc_heap* hp);
     void RelocateFinalizationData (int gen, gc_heap* hp);
 #ifdef GC_PROFILING
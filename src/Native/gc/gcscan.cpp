@@ -316,10 +316,10 @@ size_t GCScan::AskForMoreReservedMemory (size_t old_size, size_t need_size)
     return old_size + need_size;
 }
 
-void GCScan::VerifyHandleTable(int condemned, int max_gen, ScanContext* sc)
+void GCScan::VerifyHandleTable(int condemned, int max_gen, ScanContext* sc, VOLATILE(int32_t)* pNextTable)
 {
     LIMITED_METHOD_CONTRACT;
-    Ref_VerifyHandleTable(condemned, max_gen, sc);
+    Ref_VerifyHandleTable(condemned, max_gen, sc, pNextTable);
 }
 
 #endif // !DACCESS_COMPILE
@@ -89,7 +89,8 @@ class GCScan
     
     static size_t AskForMoreReservedMemory (size_t old_size, size_t need_size);
 
-    static void VerifyHandleTable(int condemned, int max_gen, ScanContext* sc);
+    // pNextTable shares the tables out between several threads, see Ref_VerifyHandleTable.
+    static void VerifyHandleTable(int condemned, int max_gen, ScanContext* sc, VOLATILE(int32_t)* pNextTable);
     
 private:
 #ifdef DACCESS_COMPILE    
@@ -1746,6 +1746,48 @@ void Ref_ScanPointers(uint32_t condemned, uint32_t maxgen, ScanContext* sc, Ref_
     TraceVariableHandlesBySingleThread(&ScanPointer, uintptr_t(sc), uintptr_t(fn), VHT_WEAK_SHORT | VHT_WEAK_LONG | VHT_STRONG, condemned, maxgen, flags);
 }
 
+// Enumerate the object references held by handles of a single type, including variable handles whose dynamic
+// type corresponds to it. Used by heap snapshots to tell the kinds of handle roots apart.
+void Ref_ScanHandlesOfType(uint32_t type, ScanContext* sc, Ref_promote_func* fn)
+{
+    WRAPPER_NO_CONTRACT;
+
+    uint32_t types[1] = { type };
+    uint32_t flags = HNDGCF_NORMAL;
+    uint32_t maxgen = GCHeap::GetMaxGeneration();
+
+    for (HandleTableMap * walk = &g_HandleTableMap; 
+         walk != nullptr; 
+         walk = walk->pNext)
+    {
+        for (uint32_t i = 0; i < INITIAL_HANDLE_TABLE_ARRAY_SIZE; i++)
+        {
+            if (walk->pBuckets[i] != NULL)
+            {
+                for (int uCPUindex = 0; uCPUindex < getNumberOfSlots(); uCPUindex++)
+                {
+                    HHANDLETABLE hTable = walk->pBuckets[i]->pTable[uCPUindex];
+                    if (hTable)
+                        HndScanHandlesForGC(hTable, &ScanPointer, uintptr_t(sc), uintptr_t(fn), types, _countof(types), maxgen, maxgen, flags);
+                }
+            }
+        }
+    }
+
+    uint32_t variableTypes;
+    switch (type)
+    {
+    case HNDTYPE_WEAK_SHORT:    variableTypes = VHT_WEAK_SHORT; break;
+    case HNDTYPE_WEAK_LONG:     variableTypes = VHT_WEAK_LONG;  break;
+    case HNDTYPE_STRONG:        variableTypes = VHT_STRONG;     break;
+    case HNDTYPE_PINNED:        variableTypes = VHT_PINNED;     break;
+    default:                    variableTypes = 0;              break;
+    }
+
+    if (variableTypes != 0)
+        TraceVariableHandlesBySingleThread(&ScanPointer, uintptr_t(sc), uintptr_t(fn), variableTypes, maxgen, maxgen, flags);
+}
+
 void Ref_UpdatePinnedPointers(uint32_t condemned, uint32_t maxgen, ScanContext* sc, Ref_promote_func* fn)
 {
     WRAPPER_NO_CONTRACT;
@@ -1857,7 +1899,9 @@ void Ref_RejuvenateHandles(uint32_t condemned, uint32_t maxgen, uintptr_t lp1)
     }
 }
 
-void Ref_VerifyHandleTable(uint32_t condemned, uint32_t maxgen, ScanContext* sc)
+// When pNextTable is not NULL the tables are shared out between the threads calling this with the same counter,
+// each table is verified by the thread that claims its index.
+void Ref_VerifyHandleTable(uint32_t condemned, uint32_t maxgen, ScanContext* sc, VOLATILE(int32_t)* pNextTable)
 {
     WRAPPER_NO_CONTRACT;
 
@@ -1886,6 +1930,8 @@ void Ref_VerifyHandleTable(uint32_t condemned, uint32_t maxgen, ScanContext* sc)
     };
 
     // verify these handles
+    int32_t index = 0;
+    int32_t claimed = pNextTable ? (Interlocked::Increment(pNextTable) - 1) : 0;
     HandleTableMap *walk = &g_HandleTableMap;
     while (walk)
     {
@@ -1895,7 +1941,17 @@ void Ref_VerifyHandleTable(uint32_t condemned, uint32_t maxgen, ScanContext* sc)
             {
                 HHANDLETABLE hTable = walk->pBuckets[i]->pTable[getSlotNumber(sc)];
                 if (hTable)
-                    HndVerifyTable(hTable, types, _countof(types), condemned, maxgen, HNDGCF_NORMAL);
+                {
+                    if (pNextTable == NULL)
+                    {
+                        HndVerifyTable(hTable, types, _countof(types), condemned, maxgen, HNDGCF_NORMAL);
+                    }
+                    else if (index++ == claimed)
+                    {
+                        HndVerifyTable(hTable, types, _countof(types), condemned, maxgen, HNDGCF_NORMAL);
+                        claimed = Interlocked::Increment(pNextTable) - 1;
+                    }
+                }
             }
         }
         walk = walk->pNext;
@@ -670,6 +670,7 @@ void Ref_ScanDependentHandlesForRelocation(uint32_t condemned, uint32_t maxgen,
 void Ref_ScanSizedRefHandles(uint32_t condemned, uint32_t maxgen, ScanContext* sc, Ref_promote_func* fn);
 #ifdef FEATURE_REDHAWK
 void Ref_ScanPointers(uint32_t condemned, uint32_t maxgen, ScanContext* sc, Ref_promote_func* fn);
+void Ref_ScanHandlesOfType(uint32_t type, ScanContext* sc, Ref_promote_func* fn);
 #endif
 
 void Ref_CheckReachable       (uint32_t uCondemnedGeneration, uint32_t uMaxGeneration, uintptr_t lp1);
@@ -679,7 +680,7 @@ void Ref_ScanDependentHandlesForProfilerAndETW(uint32_t uMaxGeneration, Profilin
 void Ref_AgeHandles           (uint32_t uCondemnedGeneration, uint32_t uMaxGeneration, uintptr_t lp1);
 void Ref_RejuvenateHandles(uint32_t uCondemnedGeneration, uint32_t uMaxGeneration, uintptr_t lp1);
 
-void Ref_VerifyHandleTable(uint32_t condemned, uint32_t maxgen, ScanContext* sc);
+void Ref_VerifyHandleTable(uint32_t condemned, uint32_t maxgen, ScanContext* sc, VOLATILE(int32_t)* pNextTable);
 
 #endif // DACCESS_COMPILE
 
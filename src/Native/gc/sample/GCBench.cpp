@@ -0,0 +1,828 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// GCBench.cpp
+//
+
+//
+//  Native GC benchmarks built on the sample GC environment, so that GC changes can be measured without the rest
+//  of the runtime or any managed code.
+//
+//  usage: gcbench <scenario> [-threads <n>] [-count <n>] [-live <n>] [-survival <percent>] [-seed <n>] [-csv]
+//
+//  Each of -threads threads (4 by default) runs -count iterations of the scenario and keeps up to -live objects
+//  alive in roots reported to the GC. The scenarios are:
+//
+//  churn       Allocates small objects and byte arrays of up to 256 bytes, keeping 1% of them alive.
+//  survival    Allocates small objects, keeping -survival percent of them alive. Without -survival the scenario
+//              is run for each of 0, 5, 10, 25, 50 and 75 percent.
+//  loh         Allocates byte arrays of 1 to 8 times the large object threshold, each replacing one of the live
+//              arrays at random, which fragments the large object heap.
+//  pinning     churn, also creating a pinned handle for every 16th object and keeping -live / 16 of them.
+//  handles     Allocates small objects, creating a weak handle for each and a dependent handle making every
+//              other one reachable from a random live object. Each thread keeps -live handles of each kind.
+//  cards       The live objects are promoted to gen2 before the run, which then stores newly allocated objects
+//              into random fields of them, so that ephemeral GCs spend their time scanning cards.
+//  all         Every scenario with its default settings.
+//
+//  Each run reports its elapsed time, allocation throughput, the number of GCs of each generation, pause
+//  percentiles and the peak working set of the process during the run. The percentiles come from the GC's own
+//  pause histograms (see gc_pause_stats), so they are upper bounds accurate to 1/8th. The working set is sampled
+//  every 10ms, so it can miss short spikes, and includes what the heap still has committed from earlier runs.
+//  -csv prints comma separated values. The work done by a run only depends on the seed and the options, not on the timing of GCs.
+//
+
+#include "common.h"
+
+#include <stdlib.h>
+
+#include "gcenv.h"
+
+#include "gc.h"
+#include "objecthandle.h"
+
+#include "gcdesc.h"
+
+#ifdef _WIN32
+#include "windows.h"
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(BIT64)
+#define card_byte_shift     11
+#else
+#define card_byte_shift     10
+#endif
+
+#define card_byte(addr) (((size_t)(addr)) >> card_byte_shift)
+
+class Node : public Object
+{
+public:
+    Object * m_pLeft;
+    Object * m_pRight;
+};
+
+static struct NodeMethodTable
+{
+    // GCDesc
+    CGCDescSeries m_series[1];
+    size_t m_numSeries;
+
+    // The actual methodtable
+    MethodTable m_MT;
+}
+s_NodeMethodTable;
+
+static MethodTable s_ByteArrayMethodTable;
+
+static void InitializeMethodTables()
+{
+    // GC expects the size of ObjHeader (extra void*) to be included in the size.
+    uint32_t baseSize = sizeof(Node) + sizeof(ObjHeader);
+    s_NodeMethodTable.m_MT.m_baseSize = max(baseSize, MIN_OBJECT_SIZE);
+    s_NodeMethodTable.m_MT.m_componentSize = 0;
+    s_NodeMethodTable.m_MT.m_flags = MTFlag_ContainsPointers;
+
+    // A single series covers both references.
+    s_NodeMethodTable.m_numSeries = 1;
+    s_NodeMethodTable.m_series[0].SetSeriesOffset(offsetof(Node, m_pLeft));
+    s_NodeMethodTable.m_series[0].SetSeriesCount(2);
+    s_NodeMethodTable.m_series[0].seriessize -= s_NodeMethodTable.m_MT.m_baseSize;
+
+    s_ByteArrayMethodTable.m_baseSize = max((uint32_t)(sizeof(ArrayBase) + sizeof(ObjHeader)), MIN_OBJECT_SIZE);
+    s_ByteArrayMethodTable.m_componentSize = 1;
+    s_ByteArrayMethodTable.m_flags = MTFlag_IsArray;
+}
+
+//
+// Per thread state of a run
+//
+
+struct Scenario;
+
+struct BenchThread
+{
+    const Scenario * m_pScenario;
+    uint64_t m_seed;
+    uint64_t m_count;
+    uint32_t m_cLive;
+    uint32_t m_survival;
+
+    // m_pRoots[0] holds objects that must survive an allocation, the m_cLive live objects follow
+    Object ** m_pRoots;
+    Object ** m_pLive;
+
+    uint64_t m_bytesAllocated;
+    bool m_fFailed;
+};
+
+// xorshift64*, so that runs are reproducible on every platform
+class Random
+{
+    uint64_t m_state;
+
+public:
+    Random(uint64_t seed)
+        : m_state((seed * 0x9E3779B97F4A7C15ull) | 1)
+    {
+    }
+
+    uint64_t Next()
+    {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+        return m_state * 0x2545F4914F6CDD1Dull;
+    }
+
+    // A number in [0, limit)
+    uint32_t Next(uint32_t limit)
+    {
+        return (uint32_t)(((Next() >> 32) * limit) >> 32);
+    }
+};
+
+//
+// The allocation fast path and the write barrier, see GCSample.cpp
+//
+
+static Object * Allocate(BenchThread * pThread, MethodTable * pMT, size_t size)
+{
+    alloc_context * acontext = GetThread()->GetAllocContext();
+    Object * pObject;
+
+    uint8_t* result = acontext->alloc_ptr;
+    uint8_t* advance = result + size;
+    if ((size < LARGE_OBJECT_SIZE) && (advance <= acontext->alloc_limit))
+    {
+        acontext->alloc_ptr = advance;
+        pObject = (Object *)result;
+    }
+    else
+    {
+        pObject = GCHeap::GetGCHeap()->Alloc(acontext, size, 0);
+        if (pObject == NULL)
+        {
+            pThread->m_fFailed = true;
+            return NULL;
+        }
+    }
+
+    pObject->RawSetMethodTable(pMT);
+    pThread->m_bytesAllocated += size;
+
+    return pObject;
+}
+
+static Node * AllocateNode(BenchThread * pThread)
+{
+    return (Node *)Allocate(pThread, &s_NodeMethodTable.m_MT, s_NodeMethodTable.m_MT.GetBaseSize());
+}
+
+static Object * AllocateByteArray(BenchThread * pThread, uint32_t length)
+{
+    size_t size = (s_ByteArrayMethodTable.GetBaseSize() + length + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1);
+
+    Object * pObject = Allocate(pThread, &s_ByteArrayMethodTable, size);
+    if (pObject != NULL)
+        *(uint32_t *)((uint8_t *)pObject + ArrayBase::GetOffsetOfNumComponents()) = length;
+
+    return pObject;
+}
+
+static void WriteBarrier(Object ** dst, Object * ref)
+{
+    *dst = ref;
+
+    if (((uint8_t*)dst < g_lowest_address) || ((uint8_t*)dst >= g_highest_address))
+        return;
+
+    if ((uint8_t*)ref >= g_ephemeral_low && (uint8_t*)ref < g_ephemeral_high)
+    {
+        uint8_t* pCardByte = (uint8_t *)*(volatile uint8_t **)(&g_card_table) + card_byte((uint8_t *)dst);
+        if (*pCardByte != 0xFF)
+            *pCardByte = 0xFF;
+    }
+}
+
+//
+// Scenarios. The work functions run in cooperative mode and must not keep object references in locals across
+// an allocation, which may move objects.
+//
+
+static HHANDLETABLE GetHandleTable()
+{
+    return g_HandleTableMap.pBuckets[0]->pTable[GetCurrentThreadHomeHeapNumber()];
+}
+
+static void RunAllocate(BenchThread * pThread, bool fMixed)
+{
+    Thread * pCurrentThread = GetThread();
+    Random random(pThread->m_seed);
+
+    for (uint64_t i = 0; i < pThread->m_count; i++)
+    {
+        Object * pObject;
+        if (fMixed && (random.Next(4) == 0))
+            pObject = AllocateByteArray(pThread, random.Next(256));
+        else
+            pObject = AllocateNode(pThread);
+        if (pObject == NULL)
+            return;
+
+        if (random.Next(100) < pThread->m_survival)
+            pThread->m_pLive[random.Next(pThread->m_cLive)] = pObject;
+
+        pCurrentThread->PollGC();
+    }
+}
+
+static void RunChurn(BenchThread * pThread)
+{
+    RunAllocate(pThread, true);
+}
+
+static void RunSurvival(BenchThread * pThread)
+{
+    RunAllocate(pThread, false);
+}
+
+static void RunLargeObjects(BenchThread * pThread)
+{
+    Thread * pCurrentThread = GetThread();
+    Random random(pThread->m_seed);
+
+    for (uint64_t i = 0; i < pThread->m_count; i++)
+    {
+        uint32_t length = (uint32_t)LARGE_OBJECT_SIZE + random.Next(7 * (uint32_t)LARGE_OBJECT_SIZE);
+        Object * pObject = AllocateByteArray(pThread, length);
+        if (pObject == NULL)
+            return;
+
+        pThread->m_pLive[random.Next(pThread->m_cLive)] = pObject;
+
+        pCurrentThread->PollGC();
+    }
+}
+
+#define PINNING_INTERVAL 16
+
+static void RunPinning(BenchThread * pThread)
+{
+    Thread * pCurrentThread = GetThread();
+    Random random(pThread->m_seed);
+
+    uint32_t cPins = max(pThread->m_cLive / PINNING_INTERVAL, 1u);
+    OBJECTHANDLE * pPins = new (nothrow) OBJECTHANDLE[cPins];
+    if (pPins == NULL)
+    {
+        pThread->m_fFailed = true;
+        return;
+    }
+    memset(pPins, 0, cPins * sizeof(OBJECTHANDLE));
+
+    for (uint64_t i = 0; i < pThread->m_count; i++)
+    {
+        Object * pObject;
+        if (random.Next(4) == 0)
+            pObject = AllocateByteArray(pThread, random.Next(256));
+        else
+            pObject = AllocateNode(pThread);
+        if (pObject == NULL)
+            break;
+
+        if (random.Next(100) < pThread->m_survival)
+            pThread->m_pLive[random.Next(pThread->m_cLive)] = pObject;
+
+        if ((i % PINNING_INTERVAL) == 0)
+        {
+            uint32_t slot = random.Next(cPins);
+            if (pPins[slot] != NULL)
+                DestroyGlobalTypedHandle(pPins[slot]);
+            pPins[slot] = CreateGlobalTypedHandle(pObject, HNDTYPE_PINNED);
+            if (pPins[slot] == NULL)
+            {
+                pThread->m_fFailed = true;
+                break;
+            }
+        }
+
+        pCurrentThread->PollGC();
+    }
+
+    for (uint32_t slot = 0; slot < cPins; slot++)
+    {
+        if (pPins[slot] != NULL)
+            DestroyGlobalTypedHandle(pPins[slot]);
+    }
+    delete[] pPins;
+}
+
+static void RunHandles(BenchThread * pThread)
+{
+    Thread * pCurrentThread = GetThread();
+    Random random(pThread->m_seed);
+    HHANDLETABLE hTable = GetHandleTable();
+
+    uint32_t cHandles = pThread->m_cLive;
+    OBJECTHANDLE * pWeak = new (nothrow) OBJECTHANDLE[cHandles];
+    OBJECTHANDLE * pDependent = new (nothrow) OBJECTHANDLE[cHandles];
+    if ((pWeak == NULL) || (pDependent == NULL))
+    {
+        pThread->m_fFailed = true;
+        delete[] pWeak;
+        delete[] pDependent;
+        return;
+    }
+    memset(pWeak, 0, cHandles * sizeof(OBJECTHANDLE));
+    memset(pDependent, 0, cHandles * sizeof(OBJECTHANDLE));
+
+    for (uint64_t i = 0; i < pThread->m_count; i++)
+    {
+        Object * pObject = AllocateNode(pThread);
+        if (pObject == NULL)
+            break;
+
+        if (random.Next(100) < pThread->m_survival)
+            pThread->m_pLive[random.Next(pThread->m_cLive)] = pObject;
+
+        uint32_t slot = random.Next(cHandles);
+        if (pWeak[slot] != NULL)
+            DestroyGlobalWeakHandle(pWeak[slot]);
+        pWeak[slot] = CreateGlobalWeakHandle(pObject);
+        if (pWeak[slot] == NULL)
+        {
+            pThread->m_fFailed = true;
+            break;
+        }
+
+        if ((i % 2) == 0)
+        {
+            // The secondary is allocated first, the primary can only be read once no more allocations happen.
+            pThread->m_pRoots[0] = AllocateNode(pThread);
+            if (pThread->m_pRoots[0] == NULL)
+                break;
+
+            Object * pPrimary = pThread->m_pLive[random.Next(pThread->m_cLive)];
+            if (pPrimary != NULL)
+            {
+                slot = random.Next(cHandles);
+                if (pDependent[slot] != NULL)
+                    DestroyDependentHandle(pDependent[slot]);
+                pDependent[slot] = CreateDependentHandle(hTable, pPrimary, pThread->m_pRoots[0]);
+                if (pDependent[slot] == NULL)
+                {
+                    pThread->m_fFailed = true;
+                    break;
+                }
+            }
+            pThread->m_pRoots[0] = NULL;
+        }
+
+        pCurrentThread->PollGC();
+    }
+
+    for (uint32_t slot = 0; slot < cHandles; slot++)
+    {
+        if (pWeak[slot] != NULL)
+            DestroyGlobalWeakHandle(pWeak[slot]);
+        if (pDependent[slot] != NULL)
+            DestroyDependentHandle(pDependent[slot]);
+    }
+    delete[] pWeak;
+    delete[] pDependent;
+}
+
+// Runs on the main thread before the GC that precedes the run
+static void SetupCards(BenchThread * pThread)
+{
+    for (uint32_t i = 0; i < pThread->m_cLive; i++)
+    {
+        pThread->m_pLive[i] = AllocateNode(pThread);
+        if (pThread->m_pLive[i] == NULL)
+            return;
+    }
+}
+
+static void RunCards(BenchThread * pThread)
+{
+    Thread * pCurrentThread = GetThread();
+    Random random(pThread->m_seed);
+
+    for (uint64_t i = 0; i < pThread->m_count; i++)
+    {
+        Object * pObject = AllocateNode(pThread);
+        if (pObject == NULL)
+            return;
+
+        Node * pOld = (Node *)pThread->m_pLive[random.Next(pThread->m_cLive)];
+        WriteBarrier(random.Next(2) ? &pOld->m_pLeft : &pOld->m_pRight, pObject);
+
+        pCurrentThread->PollGC();
+    }
+}
+
+typedef void (*BenchFunction)(BenchThread * pThread);
+
+struct Scenario
+{
+    const char * m_name;
+    BenchFunction m_pfnSetup;
+    BenchFunction m_pfnRun;
+    uint64_t m_count;           // default iterations per thread
+    uint32_t m_cLive;           // default live objects per thread
+    uint32_t m_survival;        // default percentage of objects kept alive
+    int m_setupGCs;             // full GCs after the setup, enough to promote what it allocated to gen2
+};
+
+static const Scenario s_scenarios[] =
+{
+    { "churn",      NULL,       RunChurn,           5000000,    10000,  1,  1 },
+    { "survival",   NULL,       RunSurvival,        5000000,    100000, 10, 1 },
+    { "loh",        NULL,       RunLargeObjects,    20000,      64,     0,  1 },
+    { "pinning",    NULL,       RunPinning,         5000000,    10000,  1,  1 },
+    { "handles",    NULL,       RunHandles,         2000000,    10000,  10, 1 },
+    { "cards",      SetupCards, RunCards,           5000000,    100000, 0,  2 },
+};
+
+static const uint32_t s_survivalSweep[] = { 0, 5, 10, 25, 50, 75 };
+
+struct BenchOptions
+{
+    uint32_t m_cThreads;
+    uint64_t m_count;           // 0 for the scenario's default
+    uint32_t m_cLive;           // 0 for the scenario's default
+    int m_survival;             // -1 for the scenario's default
+    uint64_t m_seed;
+    bool m_fCsv;
+};
+
+//
+// Running and reporting
+//
+
+static int32_t s_cRunningThreads;
+static CLREventStatic s_doneEvent;
+
+static void BenchThreadStart(void * pParam)
+{
+    BenchThread * pThread = (BenchThread *)pParam;
+
+    ThreadStore::AttachCurrentThread();
+    Thread * pCurrentThread = GetThread();
+
+    pCurrentThread->DisablePreemptiveGC();
+    pThread->m_pScenario->m_pfnRun(pThread);
+    pCurrentThread->EnablePreemptiveGC();
+
+    if (Interlocked::Decrement(&s_cRunningThreads) == 0)
+        s_doneEvent.Set();
+}
+
+// The largest value that falls in the given bucket, see add_to_histogram in gc.cpp
+static uint64_t HistogramBucketLimit(size_t index)
+{
+    if (index < GC_HISTOGRAM_SUB_BUCKETS)
+        return index;
+
+    int shift = (int)(index >> GC_HISTOGRAM_SUB_BUCKET_BITS) - 1;
+    uint64_t subBucket = index & (GC_HISTOGRAM_SUB_BUCKETS - 1);
+    return ((GC_HISTOGRAM_SUB_BUCKETS + subBucket + 1) << shift) - 1;
+}
+
+// Percentile of the values added to a histogram between two snapshots of it
+static uint64_t HistogramPercentile(const gc_histogram * pBefore, const gc_histogram * pAfter, uint32_t percentile)
+{
+    uint64_t count = pAfter->count - pBefore->count;
+    if (count == 0)
+        return 0;
+
+    uint64_t rank = max((count * percentile + 99) / 100, (uint64_t)1);
+    uint64_t seen = 0;
+    for (size_t index = 0; index < GC_HISTOGRAM_BUCKETS; index++)
+    {
+        seen += pAfter->buckets[index] - pBefore->buckets[index];
+        if (seen >= rank)
+            return min(HistogramBucketLimit(index), pAfter->max);
+    }
+
+    return pAfter->max;
+}
+
+// Current working set of the process
+static uint64_t GetWorkingSet()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.WorkingSetSize;
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS)
+        return 0;
+    return info.resident_size;
+#else
+    FILE * pFile = fopen("/proc/self/statm", "r");
+    if (pFile == NULL)
+        return 0;
+
+    unsigned long long cPagesTotal = 0;
+    unsigned long long cPagesResident = 0;
+    int cFields = fscanf(pFile, "%llu %llu", &cPagesTotal, &cPagesResident);
+    fclose(pFile);
+    if (cFields != 2)
+        return 0;
+
+    return cPagesResident * (uint64_t)sysconf(_SC_PAGE_SIZE);
+#endif
+}
+
+static void PrintHeader(const BenchOptions * pOptions)
+{
+    if (pOptions->m_fCsv)
+    {
+        printf("scenario,threads,survival,elapsed_ms,mops_per_s,mb_per_s,gen0,gen1,gen2,pauses,"
+               "pause_p50_us,pause_p90_us,pause_p99_us,pause_max_us,pause_total_ms,peak_rss_mb\n");
+    }
+    else
+    {
+        printf("%-9s %7s %8s %10s %8s %8s %6s %5s %5s %6s %8s %8s %8s %8s %9s %8s\n",
+               "scenario", "threads", "survival", "elapsed_ms", "Mops/s", "MB/s", "gen0", "gen1", "gen2", "pauses",
+               "p50_us", "p90_us", "p99_us", "max_us", "pause_ms", "rss_mb");
+    }
+}
+
+#define RSS_SAMPLE_INTERVAL_MS 10
+
+static gc_pause_stats s_pauseStatsBefore;
+static gc_pause_stats s_pauseStatsAfter;
+
+static bool RunScenario(const Scenario * pScenario, const BenchOptions * pOptions, uint32_t survival)
+{
+    GCHeap * pGCHeap = GCHeap::GetGCHeap();
+    Thread * pMainThread = GetThread();
+    int maxGeneration = (int)GCHeap::GetMaxGeneration();
+
+    uint32_t cThreads = pOptions->m_cThreads;
+    uint32_t cLive = (pOptions->m_cLive != 0) ? pOptions->m_cLive : pScenario->m_cLive;
+    size_t cRoots = (size_t)cThreads * (1 + cLive);
+
+    // Every thread's roots live in one array reported by the main thread, so that the setup can run before
+    // the threads exist.
+    Object ** pRoots = new (nothrow) Object *[cRoots];
+    BenchThread * pThreads = new (nothrow) BenchThread[cThreads];
+    if ((pRoots == NULL) || (pThreads == NULL))
+    {
+        delete[] pRoots;
+        delete[] pThreads;
+        return false;
+    }
+    memset(pRoots, 0, cRoots * sizeof(Object *));
+    pMainThread->SetRoots(pRoots, cRoots);
+
+    for (uint32_t i = 0; i < cThreads; i++)
+    {
+        BenchThread * pThread = &pThreads[i];
+        pThread->m_pScenario = pScenario;
+        pThread->m_seed = pOptions->m_seed + i;
+        pThread->m_count = (pOptions->m_count != 0) ? pOptions->m_count : pScenario->m_count;
+        pThread->m_cLive = cLive;
+        pThread->m_survival = survival;
+        pThread->m_pRoots = &pRoots[i * (1 + cLive)];
+        pThread->m_pLive = pThread->m_pRoots + 1;
+        pThread->m_bytesAllocated = 0;
+        pThread->m_fFailed = false;
+    }
+
+    pMainThread->DisablePreemptiveGC();
+
+    bool fSucceeded = true;
+    if (pScenario->m_pfnSetup != NULL)
+    {
+        for (uint32_t i = 0; i < cThreads; i++)
+        {
+            pScenario->m_pfnSetup(&pThreads[i]);
+            fSucceeded = fSucceeded && !pThreads[i].m_fFailed;
+            pThreads[i].m_bytesAllocated = 0;
+        }
+    }
+
+    // Start from a heap that only contains what the setup allocated.
+    for (int i = 0; i < pScenario->m_setupGCs; i++)
+        pGCHeap->GarbageCollect(maxGeneration);
+
+    pMainThread->EnablePreemptiveGC();
+
+    // GC_PAUSE_STATS_GENERATIONS also counts the large object heap.
+    unsigned gcCountsBefore[GC_PAUSE_STATS_GENERATIONS];
+    for (int gen = 0; gen <= maxGeneration; gen++)
+        gcCountsBefore[gen] = pGCHeap->CollectionCount(gen);
+    pGCHeap->GetPauseStats(&s_pauseStatsBefore);
+
+    int64_t startTimestamp = GCToOSInterface::QueryPerformanceCounter();
+    uint64_t peakWorkingSet = GetWorkingSet();
+
+    uint32_t cStarted = 0;
+    if (fSucceeded)
+    {
+        if (!s_doneEvent.IsValid())
+            s_doneEvent.CreateManualEvent(false);
+        s_doneEvent.Reset();
+
+        s_cRunningThreads = (int32_t)cThreads;
+        for (; cStarted < cThreads; cStarted++)
+        {
+            if (!GCToOSInterface::CreateThread(BenchThreadStart, &pThreads[cStarted], NULL))
+                break;
+        }
+
+        // Account for the threads that couldn't be started.
+        if ((cStarted < cThreads) &&
+            (Interlocked::ExchangeAdd(&s_cRunningThreads, -(int32_t)(cThreads - cStarted)) == (int32_t)(cThreads - cStarted)))
+        {
+            s_doneEvent.Set();
+        }
+        while (s_doneEvent.Wait(RSS_SAMPLE_INTERVAL_MS, false) == WAIT_TIMEOUT)
+            peakWorkingSet = max(peakWorkingSet, GetWorkingSet());
+    }
+    peakWorkingSet = max(peakWorkingSet, GetWorkingSet());
+
+    int64_t endTimestamp = GCToOSInterface::QueryPerformanceCounter();
+
+    pGCHeap->GetPauseStats(&s_pauseStatsAfter);
+    unsigned gcCounts[GC_PAUSE_STATS_GENERATIONS];
+    for (int gen = 0; gen <= maxGeneration; gen++)
+        gcCounts[gen] = pGCHeap->CollectionCount(gen) - gcCountsBefore[gen];
+
+    uint64_t operations = 0;
+    uint64_t bytesAllocated = 0;
+    for (uint32_t i = 0; i < cThreads; i++)
+    {
+        fSucceeded = fSucceeded && !pThreads[i].m_fFailed;
+        operations += pThreads[i].m_count;
+        bytesAllocated += pThreads[i].m_bytesAllocated;
+    }
+    fSucceeded = fSucceeded && (cStarted == cThreads);
+
+    pMainThread->SetRoots(NULL, 0);
+    delete[] pRoots;
+    delete[] pThreads;
+
+    if (!fSucceeded)
+    {
+        fprintf(stderr, "%s: the run failed, out of memory or threads\n", pScenario->m_name);
+        return false;
+    }
+
+    double seconds = (double)(endTimestamp - startTimestamp) / (double)GCToOSInterface::QueryPerformanceFrequency();
+    const gc_histogram * pBefore = &s_pauseStatsBefore.pause_time;
+    const gc_histogram * pAfter = &s_pauseStatsAfter.pause_time;
+
+    printf(pOptions->m_fCsv ?
+               "%s,%u,%u,%.1f,%.3f,%.1f,%u,%u,%u,%llu,%llu,%llu,%llu,%llu,%.1f,%.1f\n" :
+               "%-9s %7u %8u %10.1f %8.3f %8.1f %6u %5u %5u %6llu %8llu %8llu %8llu %8llu %9.1f %8.1f\n",
+           pScenario->m_name,
+           cThreads,
+           survival,
+           seconds * 1000.0,
+           (double)operations / seconds / 1000000.0,
+           (double)bytesAllocated / seconds / (1024.0 * 1024.0),
+           gcCounts[0], gcCounts[1], gcCounts[2],
+           (unsigned long long)(pAfter->count - pBefore->count),
+           (unsigned long long)HistogramPercentile(pBefore, pAfter, 50),
+           (unsigned long long)HistogramPercentile(pBefore, pAfter, 90),
+           (unsigned long long)HistogramPercentile(pBefore, pAfter, 99),
+           (unsigned long long)HistogramPercentile(pBefore, pAfter, 100),
+           (double)(pAfter->sum - pBefore->sum) / 1000.0,
+           (double)peakWorkingSet / (1024.0 * 1024.0));
+    fflush(stdout);
+
+    return true;
+}
+
+static bool RunScenarioWithOptions(const Scenario * pScenario, const BenchOptions * pOptions)
+{
+    if (pOptions->m_survival >= 0)
+        return RunScenario(pScenario, pOptions, (uint32_t)pOptions->m_survival);
+
+    if (pScenario->m_pfnRun != RunSurvival)
+        return RunScenario(pScenario, pOptions, pScenario->m_survival);
+
+    for (size_t i = 0; i < sizeof(s_survivalSweep) / sizeof(s_survivalSweep[0]); i++)
+    {
+        if (!RunScenario(pScenario, pOptions, s_survivalSweep[i]))
+            return false;
+    }
+
+    return true;
+}
+
+static int Usage()
+{
+    fprintf(stderr, "usage: gcbench <scenario> [-threads <n>] [-count <n>] [-live <n>] [-survival <percent>] [-seed <n>] [-csv]\n");
+    fprintf(stderr, "scenarios:");
+    for (size_t i = 0; i < sizeof(s_scenarios) / sizeof(s_scenarios[0]); i++)
+        fprintf(stderr, " %s", s_scenarios[i].m_name);
+    fprintf(stderr, " all\n");
+    return 1;
+}
+
+int __cdecl main(int argc, char* argv[])
+{
+    if (argc < 2)
+        return Usage();
+
+    BenchOptions options;
+    options.m_cThreads = 4;
+    options.m_count = 0;
+    options.m_cLive = 0;
+    options.m_survival = -1;
+    options.m_seed = 1;
+    options.m_fCsv = false;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-csv") == 0)
+        {
+            options.m_fCsv = true;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+            return Usage();
+
+        unsigned long long value = strtoull(argv[i + 1], NULL, 0);
+        if (strcmp(argv[i], "-threads") == 0 && value > 0)
+            options.m_cThreads = (uint32_t)value;
+        else if (strcmp(argv[i], "-count") == 0 && value > 0)
+            options.m_count = value;
+        else if (strcmp(argv[i], "-live") == 0 && value > 0)
+            options.m_cLive = (uint32_t)value;
+        else if (strcmp(argv[i], "-survival") == 0 && value <= 100)
+            options.m_survival = (int)value;
+        else if (strcmp(argv[i], "-seed") == 0)
+            options.m_seed = value;
+        else
+            return Usage();
+        i++;
+    }
+
+    const Scenario * pScenario = NULL;
+    bool fAll = (strcmp(argv[1], "all") == 0);
+    if (!fAll)
+    {
+        for (size_t i = 0; i < sizeof(s_scenarios) / sizeof(s_scenarios[0]); i++)
+        {
+            if (strcmp(argv[1], s_scenarios[i].m_name) == 0)
+                pScenario = &s_scenarios[i];
+        }
+        if (pScenario == NULL)
+            return Usage();
+    }
+
+    //
+    // Initialize the GC the same way GCSample.cpp does
+    //
+    if (!GCToOSInterface::Initialize())
+        return -1;
+
+    static MethodTable freeObjectMT;
+    freeObjectMT.InitializeFreeObject();
+    g_pFreeObjectMethodTable = &freeObjectMT;
+
+    if (!Ref_Initialize())
+        return -1;
+
+    GCHeap *pGCHeap = GCHeap::CreateGCHeap();
+    if (!pGCHeap)
+        return -1;
+
+    if (FAILED(pGCHeap->Initialize()))
+        return -1;
+
+    ThreadStore::AttachCurrentThread();
+
+    InitializeMethodTables();
+
+    PrintHeader(&options);
+
+    if (!fAll)
+        return RunScenarioWithOptions(pScenario, &options) ? 0 : -1;
+
+    for (size_t i = 0; i < sizeof(s_scenarios) / sizeof(s_scenarios[0]); i++)
+    {
+        if (!RunScenarioWithOptions(&s_scenarios[i], &options))
+            return -1;
+    }
+
+    return 0;
+}
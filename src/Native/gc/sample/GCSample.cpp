@@ -31,9 +31,10 @@
 // * Scanning of stack roots:
 //      static void GcScanRoots(promote_func* fn,  int condemned, int max_gen, ScanContext* sc);
 //
-//  The sample has trivial implementation for these methods. It is single threaded, and there are no stack roots to 
-//  be reported. There are number of other callbacks that GC calls to optionally allow the execution engine to do its 
-//  own bookkeeping.
+//  The sample has simple implementations of these methods: threads poll for a pending suspension at safe points, and
+//  each thread can register an array of object references that stands in for its stack roots. This sample is single
+//  threaded and reports no roots, see GCBench.cpp for a multi-threaded user of the environment. There are number of
+//  other callbacks that GC calls to optionally allow the execution engine to do its own bookkeeping.
 //
 //  For now, the sample GC environment has some cruft in it to decouple the GC from Windows and rest of CoreCLR. 
 //  It is something we would like to clean up.
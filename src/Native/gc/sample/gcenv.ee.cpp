@@ -4,95 +4,17 @@
 
 #include "common.h"
 
-#include "windows.h"
-
 #include "gcenv.h"
 #include "gc.h"
 
 EEConfig * g_pConfig;
 
-void CLREventStatic::CreateManualEvent(bool bInitialState)
-{
-    m_hEvent = CreateEventW(NULL, TRUE, bInitialState, NULL);
-    m_fInitialized = true;
-}
-
-void CLREventStatic::CreateAutoEvent(bool bInitialState)
-{
-    m_hEvent = CreateEventW(NULL, FALSE, bInitialState, NULL);
-    m_fInitialized = true;
-}
-
-void CLREventStatic::CreateOSManualEvent(bool bInitialState)
-{
-    m_hEvent = CreateEventW(NULL, TRUE, bInitialState, NULL);
-    m_fInitialized = true;
-}
-
-void CLREventStatic::CreateOSAutoEvent(bool bInitialState)
-{
-    m_hEvent = CreateEventW(NULL, FALSE, bInitialState, NULL);
-    m_fInitialized = true;
-}
-
-void CLREventStatic::CloseEvent()
-{
-    if (m_fInitialized && m_hEvent != INVALID_HANDLE_VALUE)
-    {
-        CloseHandle(m_hEvent);
-        m_hEvent = INVALID_HANDLE_VALUE;
-    }
-}
-
-bool CLREventStatic::IsValid() const
-{
-    return m_fInitialized && m_hEvent != INVALID_HANDLE_VALUE;
-}
-
-bool CLREventStatic::Set()
-{
-    if (!m_fInitialized)
-        return false;
-    return !!SetEvent(m_hEvent);
-}
-
-bool CLREventStatic::Reset()
-{
-    if (!m_fInitialized)
-        return false;
-    return !!ResetEvent(m_hEvent);
-}
-
-uint32_t CLREventStatic::Wait(uint32_t dwMilliseconds, bool bAlertable)
-{
-    DWORD result = WAIT_FAILED;
-
-    if (m_fInitialized)
-    {
-        bool        disablePreemptive = false;
-        Thread *    pCurThread = GetThread();
-
-        if (NULL != pCurThread)
-        {
-            if (GCToEEInterface::IsPreemptiveGCDisabled(pCurThread))
-            {
-                GCToEEInterface::EnablePreemptiveGC(pCurThread);
-                disablePreemptive = true;
-            }
-        }
-
-        result = WaitForSingleObjectEx(m_hEvent, dwMilliseconds, bAlertable);
-
-        if (disablePreemptive)
-        {
-            GCToEEInterface::DisablePreemptiveGC(pCurThread);
-        }
-    }
-
-    return result;
-}
-
-__declspec(thread) Thread * pCurrentThread;
+#ifdef _MSC_VER
+__declspec(thread)
+#else
+__thread
+#endif
+Thread * pCurrentThread;
 
 Thread * GetThread()
 {
@@ -111,33 +33,91 @@ Thread * ThreadStore::GetThreadList(Thread * pThread)
 
 void ThreadStore::AttachCurrentThread()
 {
-    // TODO: Locks
-
     Thread * pThread = new Thread();
     pThread->GetAllocContext()->init();
     pCurrentThread = pThread;
 
-    pThread->m_pNext = g_pThreadList;
-    g_pThreadList = pThread;
+    // Threads are never removed from the list, so it can be walked without a lock while others are added.
+    Thread * pHead;
+    do
+    {
+        pHead = VolatileLoad(&g_pThreadList);
+        pThread->m_pNext = pHead;
+    }
+    while (Interlocked::CompareExchangePointer(&g_pThreadList, pThread, pHead) != pHead);
+}
+
+//
+// Threads run managed code, here the benchmark or sample code allocating objects, in cooperative mode and
+// check for a pending suspension at GC safe points (Thread::PollGC, or when they switch back to cooperative
+// mode). The thread suspending the EE sets g_TrapReturningThreads and waits for every other thread to be in
+// preemptive mode. Threads trying to switch back to cooperative mode until the EE is restarted block on
+// s_restartEvent.
+//
+
+static Thread * volatile s_pSuspendingThread;
+static CLREventStatic s_restartEvent;
+
+void Thread::DisablePreemptiveGC()
+{
+    Interlocked::Exchange(&m_fPreemptiveGCDisabled, (uint32_t)1);
+
+    while (VolatileLoad(&g_TrapReturningThreads) && (this != s_pSuspendingThread))
+    {
+        m_fPreemptiveGCDisabled = 0;
+        s_restartEvent.Wait(INFINITE, false);
+        Interlocked::Exchange(&m_fPreemptiveGCDisabled, (uint32_t)1);
+    }
 }
 
 void GCToEEInterface::SuspendEE(GCToEEInterface::SUSPEND_REASON reason)
 {
     GCHeap::GetGCHeap()->SetGCInProgress(TRUE);
 
-    // TODO: Implement
+    // Only one thread suspends the EE at a time, the first one creates the event.
+    if (!s_restartEvent.IsValid())
+        s_restartEvent.CreateManualEvent(false);
+    s_restartEvent.Reset();
+
+    Thread * pCurrentThread = GetThread();
+    s_pSuspendingThread = pCurrentThread;
+    Interlocked::Exchange(&g_TrapReturningThreads, 1);
+
+    Thread * pThread = NULL;
+    while ((pThread = ThreadStore::GetThreadList(pThread)) != NULL)
+    {
+        if (pThread == pCurrentThread)
+            continue;
+
+        for (uint32_t switchCount = 0; pThread->PreemptiveGCDisabled(); switchCount++)
+            GCToOSInterface::YieldThread(switchCount);
+    }
 }
 
 void GCToEEInterface::RestartEE(bool bFinishedGC)
 {
-    // TODO: Implement
+    Interlocked::Exchange(&g_TrapReturningThreads, 0);
+    s_pSuspendingThread = NULL;
+    s_restartEvent.Set();
 
     GCHeap::GetGCHeap()->SetGCInProgress(FALSE);
 }
 
 void GCToEEInterface::GcScanRoots(promote_func* fn,  int condemned, int max_gen, ScanContext* sc)
 {
-    // TODO: Implement - Scan stack roots on given thread
+    Thread * pThread = NULL;
+    while ((pThread = ThreadStore::GetThreadList(pThread)) != NULL)
+    {
+        size_t cRoots;
+        Object ** pRoots = pThread->GetRoots(&cRoots);
+
+        sc->thread_under_crawl = pThread;
+        for (size_t i = 0; i < cRoots; i++)
+        {
+            if (pRoots[i] != NULL)
+                fn(&pRoots[i], sc, 0);
+        }
+    }
 }
 
 void GCToEEInterface::GcStartWork(int condemned, int max_gen)
@@ -156,6 +136,10 @@ void GCToEEInterface::GcDone(int condemned)
 {
 }
 
+void GCToEEInterface::DiagGCEnd(size_t index, int condemned, bool fConcurrent)
+{
+}
+
 bool GCToEEInterface::RefCountedHandleCallbacks(Object * pObject)
 {
     return false;
@@ -15,6 +15,7 @@
 #define _ASSERTE(_expr) ASSERT(_expr)
 #endif
 
+#include "sal.h"
 #include "gcenv.structs.h"
 #include "gcenv.base.h"
 #include "gcenv.ee.h"
@@ -26,6 +27,16 @@
 
 #define MAX_LONGPATH 1024
 
+#ifndef _MSC_VER
+// gcenv.base.h only provides these for Visual C++, the runtime gets them from its PAL
+#if defined(_X86_) || defined(_AMD64_)
+#define YieldProcessor() __asm__ __volatile__("rep; nop")
+#else
+#define YieldProcessor() do { } while (0)
+#endif
+#define MemoryBarrier() __sync_synchronize()
+#endif // !_MSC_VER
+
 //
 // Thread
 //
@@ -34,14 +45,19 @@ struct alloc_context;
 
 class Thread
 {
-    uint32_t m_fPreemptiveGCDisabled;
+    volatile uint32_t m_fPreemptiveGCDisabled;
     uintptr_t m_alloc_context[16]; // Reserve enough space to fix allocation context
 
+    // Object references the thread reports to the GC, standing in for its stack
+    Object ** m_pRoots;
+    size_t m_cRoots;
+
     friend class ThreadStore;
     Thread * m_pNext;
 
 public:
     Thread()
+        : m_fPreemptiveGCDisabled(0), m_pRoots(NULL), m_cRoots(0), m_pNext(NULL)
     {
     }
 
@@ -55,9 +71,29 @@ public:
         m_fPreemptiveGCDisabled = false;
     }
 
-    void DisablePreemptiveGC()
+    // Switches to cooperative mode, waiting for the GC in progress if there is one
+    void DisablePreemptiveGC();
+
+    // A GC safe point for threads running in cooperative mode
+    void PollGC()
+    {
+        if (VolatileLoad(&g_TrapReturningThreads))
+        {
+            EnablePreemptiveGC();
+            DisablePreemptiveGC();
+        }
+    }
+
+    void SetRoots(Object ** pRoots, size_t cRoots)
+    {
+        m_pRoots = pRoots;
+        m_cRoots = cRoots;
+    }
+
+    Object ** GetRoots(size_t * pcRoots)
     {
-        m_fPreemptiveGCDisabled = true;
+        *pcRoots = m_cRoots;
+        return m_pRoots;
     }
 
     alloc_context* GetAllocContext()
@@ -120,6 +156,8 @@ public:
     };
 
     int     GetHeapVerifyLevel() { return 0; }
+    int     GetHeapVerifyThreads() { return 0; }
+    int     GetHeapVerifySamplePercent() { return 0; }
     bool    IsHeapVerifyEnabled() { return GetHeapVerifyLevel() != 0; }
 
     GCStressFlags GetGCStressLevel()        const { return GCSTRESS_NONE; }
@@ -138,6 +176,7 @@ public:
     int     GetGCRetainVM()                const { return 0; }
     int     GetGCTrimCommit()               const { return 0; }
     int     GetGCLOHCompactionMode()        const { return 0; }
+    int     GetGCTypeHistogram()            const { return 0; }
 
     bool    GetGCAllowVeryLargeObjects()   const { return false; }
 
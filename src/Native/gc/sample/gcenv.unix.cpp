@@ -11,452 +11,601 @@
 #include "gcenv.h"
 #include "gc.h"
 
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdlib.h>
 #include <sys/mman.h>
-#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
 
-int32_t FastInterlockIncrement(int32_t volatile *lpAddend)
-{
-    return __sync_add_and_fetch(lpAddend, 1);
-}
+#define tccSecondsToNanoSeconds 1000000000
+#define tccMilliSecondsToNanoSeconds 1000000
 
-int32_t FastInterlockDecrement(int32_t volatile *lpAddend)
-{
-    return __sync_sub_and_fetch(lpAddend, 1);
-}
+MethodTable * g_pFreeObjectMethodTable;
 
-int32_t FastInterlockExchange(int32_t volatile *Target, int32_t Value)
-{
-    return __sync_swap(Target, Value);
-}
+int32_t g_TrapReturningThreads;
 
-int32_t FastInterlockCompareExchange(int32_t volatile *Destination, int32_t Exchange, int32_t Comperand)
-{
-    return __sync_val_compare_and_swap(Destination, Comperand, Exchange);
-}
+bool g_fFinalizerRunOnShutDown;
 
-int32_t FastInterlockExchangeAdd(int32_t volatile *Addend, int32_t Value)
-{
-    return __sync_fetch_and_add(Addend, Value);
-}
+GCSystemInfo g_SystemInfo;
 
-void * _FastInterlockExchangePointer(void * volatile *Target, void * Value)
+// Initialize the interface implementation
+// Return:
+//  true if it has succeeded, false if it has failed
+bool GCToOSInterface::Initialize()
 {
-    return __sync_swap(Target, Value);
-}
+    long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+    long pageSize = sysconf(_SC_PAGE_SIZE);
+    if ((cpuCount <= 0) || (pageSize <= 0))
+    {
+        return false;
+    }
 
-void * _FastInterlockCompareExchangePointer(void * volatile *Destination, void * Exchange, void * Comperand)
-{
-    return __sync_val_compare_and_swap(Destination, Comperand, Exchange);
-}
+    g_SystemInfo.dwNumberOfProcessors = (uint32_t)cpuCount;
+    g_SystemInfo.dwPageSize = (uint32_t)pageSize;
+    g_SystemInfo.dwAllocationGranularity = (uint32_t)pageSize;
 
-void FastInterlockOr(uint32_t volatile *p, uint32_t msk)
-{
-    __sync_fetch_and_or(p, msk);
+    return true;
 }
 
-void FastInterlockAnd(uint32_t volatile *p, uint32_t msk)
+// Shutdown the interface implementation
+void GCToOSInterface::Shutdown()
 {
-    __sync_fetch_and_and(p, msk);
 }
 
-
-void UnsafeInitializeCriticalSection(CRITICAL_SECTION * lpCriticalSection)
+// Get numeric id of the current thread if possible on the
+// current platform. It is indended for logging purposes only.
+// Return:
+//  Numeric id of the current thread or 0 if the
+uint64_t GCToOSInterface::GetCurrentThreadIdForLogging()
 {
-    pthread_mutex_init(&lpCriticalSection->mutex, NULL);
+    return (uint64_t)pthread_self();
 }
 
-void UnsafeEEEnterCriticalSection(CRITICAL_SECTION *lpCriticalSection)
+// Get id of the process
+// Return:
+//  Id of the current process
+uint32_t GCToOSInterface::GetCurrentProcessId()
 {
-    pthread_mutex_lock(&lpCriticalSection->mutex);
+    return (uint32_t)getpid();
 }
 
-void UnsafeEELeaveCriticalSection(CRITICAL_SECTION * lpCriticalSection)
+// Set ideal affinity for the current thread
+// Parameters:
+//  affinity - ideal processor affinity for the thread
+// Return:
+//  true if it has succeeded, false if it has failed
+bool GCToOSInterface::SetCurrentThreadIdealAffinity(GCThreadAffinity* affinity)
 {
-    pthread_mutex_unlock(&lpCriticalSection->mutex);
+    return false;
 }
 
-void UnsafeDeleteCriticalSection(CRITICAL_SECTION *lpCriticalSection)
+// Get the number of the current processor
+uint32_t GCToOSInterface::GetCurrentProcessorNumber()
 {
-    pthread_mutex_destroy(&lpCriticalSection->mutex);
+    _ASSERTE(GCToOSInterface::CanGetCurrentProcessorNumber());
+    return 0;
 }
 
-#if 0
-void CLREventStatic::CreateManualEvent(bool bInitialState)
+// Check if the OS supports getting current processor number
+bool GCToOSInterface::CanGetCurrentProcessorNumber()
 {
-    // TODO: Implement
-    m_fInitialized = true;
+    return false;
 }
 
-void CLREventStatic::CreateAutoEvent(bool bInitialState)
+// Flush write buffers of processors that are executing threads of the current process
+void GCToOSInterface::FlushProcessWriteBuffers()
 {
-    // TODO: Implement
-    m_fInitialized = true;
+    // The sample only needs this for the server GC and background GC, neither of which it runs.
+    __sync_synchronize();
 }
 
-void CLREventStatic::CreateOSManualEvent(bool bInitialState)
+// Break into a debugger
+void GCToOSInterface::DebugBreak()
 {
-    CreateManualEvent(bInitialState);
+    raise(SIGTRAP);
 }
 
-void CLREventStatic::CreateOSAutoEvent (bool bInitialState)
+// Get number of logical processors
+uint32_t GCToOSInterface::GetLogicalCpuCount()
 {
-    CreateAutoEvent(bInitialState);
+    return g_SystemInfo.dwNumberOfProcessors;
 }
 
-void CLREventStatic::CloseEvent()
+// Causes the calling thread to sleep for the specified number of milliseconds
+// Parameters:
+//  sleepMSec   - time to sleep before switching to another thread
+void GCToOSInterface::Sleep(uint32_t sleepMSec)
 {
-    if (m_fInitialized)
+    timespec requested;
+    requested.tv_sec = sleepMSec / 1000;
+    requested.tv_nsec = (sleepMSec % 1000) * tccMilliSecondsToNanoSeconds;
+
+    timespec remaining;
+    while (nanosleep(&requested, &remaining) == -1 && errno == EINTR)
     {
-        // TODO: Implement
-        m_fInitialized = false;
+        requested = remaining;
     }
 }
 
-bool CLREventStatic::IsValid() const
+// Causes the calling thread to yield execution to another thread that is ready to run on the current processor.
+// Parameters:
+//  switchCount - number of times the YieldThread was called in a loop
+void GCToOSInterface::YieldThread(uint32_t switchCount)
 {
-    return m_fInitialized; 
+    sched_yield();
 }
 
-bool CLREventStatic::Set()
+// Reserve virtual memory range.
+// Parameters:
+//  address   - starting virtual address, it can be NULL to let the function choose the starting address
+//  size      - size of the virtual memory range
+//  alignment - requested memory alignment, 0 means no specific alignment requested
+//  flags     - flags to control special settings like write watching
+// Return:
+//  Starting virtual address of the reserved range
+void* GCToOSInterface::VirtualReserve(void* address, size_t size, size_t alignment, uint32_t flags)
 {
-    if (!m_fInitialized)
-        return false;
-    // TODO: Implement
-    return true; 
-}
+    _ASSERTE(!(flags & VirtualReserveFlags::WriteWatch));
 
-bool CLREventStatic::Reset()
-{
-    if (!m_fInitialized)
-        return false;
-    // TODO: Implement
-    return true;
-}
+    if (alignment == 0)
+    {
+        alignment = OS_PAGE_SIZE;
+    }
 
-uint32_t CLREventStatic::Wait(uint32_t dwMilliseconds, bool bAlertable)
-{
-    DWORD result = WAIT_FAILED;
+    size_t alignedSize = size + (alignment - OS_PAGE_SIZE);
 
-    if (m_fInitialized)
+    void * pRetVal = mmap(address, alignedSize, PROT_NONE, MAP_ANON | MAP_PRIVATE, -1, 0);
+    if (pRetVal == MAP_FAILED)
     {
-        bool        disablePreemptive = false;
-        Thread *    pCurThread  = GetThread();
-
-        if (NULL != pCurThread)
-        {
-            if (pCurThread->PreemptiveGCDisabled())
-            {
-                pCurThread->EnablePreemptiveGC();
-                disablePreemptive = true;
-            }
-        }
+        return NULL;
+    }
 
-        // TODO: Implement
-        result = WAIT_OBJECT_0;
+    // Trim the reservation down to the aligned range
+    void * pAlignedRetVal = (void *)(((size_t)pRetVal + (alignment - 1)) & ~(alignment - 1));
+    size_t startPadding = (size_t)pAlignedRetVal - (size_t)pRetVal;
+    if (startPadding != 0)
+    {
+        munmap(pRetVal, startPadding);
+    }
 
-        if (disablePreemptive)
-        {
-            pCurThread->DisablePreemptiveGC();
-        }
+    size_t endPadding = alignedSize - (startPadding + size);
+    if (endPadding != 0)
+    {
+        munmap((void *)((size_t)pAlignedRetVal + size), endPadding);
     }
 
-    return result;
+    return pAlignedRetVal;
 }
-#endif // 0
 
-void DestroyThread(Thread * pThread)
+// Release virtual memory range previously reserved using VirtualReserve
+// Parameters:
+//  address - starting virtual address
+//  size    - size of the virtual memory range
+// Return:
+//  true if it has succeeded, false if it has failed
+bool GCToOSInterface::VirtualRelease(void* address, size_t size)
 {
-    // TODO: implement
+    return munmap(address, size) == 0;
 }
 
-bool __SwitchToThread(uint32_t dwSleepMSec, uint32_t dwSwitchCount)
+// Commit virtual memory range. It must be part of a range reserved using VirtualReserve.
+// Parameters:
+//  address - starting virtual address
+//  size    - size of the virtual memory range
+// Return:
+//  true if it has succeeded, false if it has failed
+bool GCToOSInterface::VirtualCommit(void* address, size_t size)
 {
-    return sched_yield() == 0;
+    return mprotect(address, size, PROT_WRITE | PROT_READ) == 0;
 }
 
-static int W32toUnixAccessControl(uint32_t flProtect)
+// Decomit virtual memory range.
+// Parameters:
+//  address - starting virtual address
+//  size    - size of the virtual memory range
+// Return:
+//  true if it has succeeded, false if it has failed
+bool GCToOSInterface::VirtualDecommit(void* address, size_t size)
 {
-    int prot = 0;
-
-    switch (flProtect & 0xff)
-    {
-    case PAGE_NOACCESS:
-        prot = PROT_NONE;
-        break;
-    case PAGE_READWRITE:
-        prot = PROT_READ | PROT_WRITE;
-        break;
-    default:
-        _ASSERTE(false);
-        break;
-    }
-    return prot;
+    // Give the pages back to the OS as well, the GC expects decommitted memory to read as zeros once it is
+    // committed again.
+    return (madvise(address, size, MADV_DONTNEED) == 0) && (mprotect(address, size, PROT_NONE) == 0);
 }
 
-MethodTable * g_pFreeObjectMethodTable;
-
-GCSystemInfo g_SystemInfo;
-
-void InitializeSystemInfo()
+// Reset virtual memory range. Indicates that data in the memory range specified by address and size is no
+// longer of interest, but it should not be decommitted.
+// Parameters:
+//  address - starting virtual address
+//  size    - size of the virtual memory range
+//  unlock  - true if the memory range should also be unlocked
+// Return:
+//  true if it has succeeded, false if it has failed
+bool GCToOSInterface::VirtualReset(void * address, size_t size, bool unlock)
 {
-    // TODO: Implement
-    g_SystemInfo.dwNumberOfProcessors = 4;
-
-    g_SystemInfo.dwPageSize = OS_PAGE_SIZE;
-    g_SystemInfo.dwAllocationGranularity = OS_PAGE_SIZE;
-}
-
-int32_t g_TrapReturningThreads;
-
-bool g_fFinalizerRunOnShutDown;
-
-#if 0
-#ifdef _MSC_VER
-__declspec(thread)
+#ifdef MADV_FREE
+    return madvise(address, size, MADV_FREE) == 0;
 #else
-__thread
+    return madvise(address, size, MADV_DONTNEED) == 0;
 #endif
-Thread * pCurrentThread;
+}
 
-Thread * GetThread()
+// Check if the OS supports write watching
+bool GCToOSInterface::SupportsWriteWatch()
 {
-    return pCurrentThread;
+    return false;
 }
 
-Thread * g_pThreadList = NULL;
-
-Thread * ThreadStore::GetThreadList(Thread * pThread)
+// Reset the write tracking state for the specified virtual memory range.
+// Parameters:
+//  address - starting virtual address
+//  size    - size of the virtual memory range
+void GCToOSInterface::ResetWriteWatch(void* address, size_t size)
 {
-    if (pThread == NULL)
-        return g_pThreadList;
+}
 
-    return pThread->m_pNext;
+// Retrieve addresses of the pages that are written to in a region of virtual memory
+// Parameters:
+//  resetState         - true indicates to reset the write tracking state
+//  address            - starting virtual address
+//  size               - size of the virtual memory range
+//  pageAddresses      - buffer that receives an array of page addresses in the memory region
+//  pageAddressesCount - on input, size of the lpAddresses array, in array elements
+//                       on output, the number of page addresses that are returned in the array.
+// Return:
+//  true if it has succeeded, false if it has failed
+bool GCToOSInterface::GetWriteWatch(bool resetState, void* address, size_t size, void** pageAddresses, uintptr_t* pageAddressesCount)
+{
+    return false;
 }
 
-void ThreadStore::AttachCurrentThread(bool fAcquireThreadStoreLock)
+// Get size of the largest cache on the processor die
+// Parameters:
+//  trueSize - true to return true cache size, false to return scaled up size based on
+//             the processor architecture
+// Return:
+//  Size of the cache
+size_t GCToOSInterface::GetLargestOnDieCacheSize(bool trueSize)
 {
-    // TODO: Locks
+    // The GC sizes the gen0 budget from this. Without it gen0 stays at its 256KB floor, which makes every scenario
+    // with many roots spend its time reporting them.
+    long cacheSize = 0;
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    cacheSize = max(cacheSize, sysconf(_SC_LEVEL1_DCACHE_SIZE));
+#endif
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    cacheSize = max(cacheSize, sysconf(_SC_LEVEL2_CACHE_SIZE));
+#endif
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    cacheSize = max(cacheSize, sysconf(_SC_LEVEL3_CACHE_SIZE));
+#endif
+#ifdef _SC_LEVEL4_CACHE_SIZE
+    cacheSize = max(cacheSize, sysconf(_SC_LEVEL4_CACHE_SIZE));
+#endif
 
-    Thread * pThread = new Thread();
-    pThread->GetAllocContext()->init();
-    pCurrentThread = pThread;
+    return (size_t)cacheSize;
+}
 
-    pThread->m_pNext = g_pThreadList;
-    g_pThreadList = pThread;
+// Get affinity mask of the current process
+// Parameters:
+//  processMask - affinity mask for the specified process
+//  systemMask  - affinity mask for the system
+// Return:
+//  true if it has succeeded, false if it has failed
+// Remarks:
+//  A process affinity mask is a bit vector in which each bit represents the processors that
+//  a process is allowed to run on. A system affinity mask is a bit vector in which each bit
+//  represents the processors that are configured into a system.
+//  A process affinity mask is a subset of the system affinity mask. A process is only allowed
+//  to run on the processors configured into a system. Therefore, the process affinity mask cannot
+//  specify a 1 bit for a processor when the system affinity mask specifies a 0 bit for that processor.
+bool GCToOSInterface::GetCurrentProcessAffinityMask(uintptr_t* processMask, uintptr_t* systemMask)
+{
+    return false;
 }
-#endif // 0
-void DestroyThread(Thread * pThread)
+
+// Get number of processors assigned to the current process
+// Return:
+//  The number of processors
+uint32_t GCToOSInterface::GetCurrentProcessCpuCount()
 {
-    // TODO: Implement
+    return g_SystemInfo.dwNumberOfProcessors;
 }
 
-#if 0 
-void GCToEEInterface::SuspendEE(GCToEEInterface::SUSPEND_REASON reason)
+// Get global memory status
+// Parameters:
+//  ms - pointer to the structure that will be filled in with the memory status
+void GCToOSInterface::GetMemoryStatus(GCMemoryStatus* ms)
 {
-    GCHeap::GetGCHeap()->SetGCInProgress(TRUE);
+    uint64_t pageSize = (uint64_t)sysconf(_SC_PAGE_SIZE);
+
+    ms->ullTotalPhys = (uint64_t)sysconf(_SC_PHYS_PAGES) * pageSize;
+    ms->ullAvailPhys = (uint64_t)sysconf(_SC_AVPHYS_PAGES) * pageSize;
+    ms->dwMemoryLoad = (ms->ullTotalPhys != 0) ?
+        (uint32_t)(((ms->ullTotalPhys - ms->ullAvailPhys) * 100) / ms->ullTotalPhys) : 0;
+    ms->ullTotalPageFile = 0;
+    ms->ullAvailPageFile = 0;
 
-    // TODO: Implement
+    // There is no API to get the total virtual address space size, use the 128TB of user address space of the
+    // supported 64-bit systems.
+    ms->ullTotalVirtual = (1ull << 47);
+    ms->ullAvailVirtual = ms->ullAvailPhys;
 }
 
-void GCToEEInterface::RestartEE(bool bFinishedGC)
+// Get a high precision performance counter
+// Return:
+//  The counter value
+int64_t GCToOSInterface::QueryPerformanceCounter()
 {
-    // TODO: Implement
+    timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+    {
+        _ASSERTE(!"Fatal Error - cannot query performance counter.");
+        abort();
+    }
 
-    GCHeap::GetGCHeap()->SetGCInProgress(FALSE);
+    return (int64_t)ts.tv_sec * tccSecondsToNanoSeconds + ts.tv_nsec;
 }
 
-void GCToEEInterface::GcScanRoots(promote_func* fn, int condemned, int max_gen, ScanContext* sc)
+// Get a frequency of the high precision performance counter
+// Return:
+//  The counter frequency
+int64_t GCToOSInterface::QueryPerformanceFrequency()
 {
-    // TODO: Implement - Scan stack roots
+    return tccSecondsToNanoSeconds;
 }
 
-void GCToEEInterface::GcStartWork(int condemned, int max_gen)
+// Get a time stamp with a low precision
+// Return:
+//  Time stamp in milliseconds
+uint32_t GCToOSInterface::GetLowPrecisionTimeStamp()
 {
+    return (uint32_t)(QueryPerformanceCounter() / tccMilliSecondsToNanoSeconds);
 }
 
-void GCToEEInterface::AfterGcScanRoots(int condemned, int max_gen, ScanContext* sc)
+// Parameters of the GC thread stub
+struct GCThreadStubParam
 {
-}
+    GCThreadFunction GCThreadFunction;
+    void* GCThreadParam;
+};
 
-void GCToEEInterface::GcBeforeBGCSweepWork()
+// GC thread stub to convert GC thread function to an OS specific thread function
+static void* GCThreadStub(void* param)
 {
+    GCThreadStubParam *stubParam = (GCThreadStubParam*)param;
+    GCThreadFunction function = stubParam->GCThreadFunction;
+    void* threadParam = stubParam->GCThreadParam;
+
+    delete stubParam;
+
+    function(threadParam);
+
+    return NULL;
 }
 
-void GCToEEInterface::GcDone(int condemned)
+// Create a new thread
+// Parameters:
+//  function - the function to be executed by the thread
+//  param    - parameters of the thread
+//  affinity - processor affinity of the thread
+// Return:
+//  true if it has succeeded, false if it has failed
+bool GCToOSInterface::CreateThread(GCThreadFunction function, void* param, GCThreadAffinity* affinity)
 {
+    GCThreadStubParam* stubParam = new (nothrow) GCThreadStubParam();
+    if (stubParam == NULL)
+    {
+        return false;
+    }
+
+    stubParam->GCThreadFunction = function;
+    stubParam->GCThreadParam = param;
+
+    pthread_attr_t attrs;
+    pthread_attr_init(&attrs);
+
+    // Create the thread as detached, that means not joinable
+    pthread_attr_setdetachstate(&attrs, PTHREAD_CREATE_DETACHED);
+
+    pthread_t threadId;
+    int st = pthread_create(&threadId, &attrs, GCThreadStub, stubParam);
+
+    pthread_attr_destroy(&attrs);
+
+    if (st != 0)
+    {
+        delete stubParam;
+        return false;
+    }
+
+    return true;
 }
 
-void FinalizerThread::EnableFinalization()
+// Initialize the critical section
+void CLRCriticalSection::Initialize()
 {
-    // Signal to finalizer thread that there are objects to finalize
-    // TODO: Implement for finalization
+    pthread_mutex_init(&m_cs.mutex, NULL);
 }
 
-bool PalStartBackgroundGCThread(BackgroundCallback callback, void* pCallbackContext)
+// Destroy the critical section
+void CLRCriticalSection::Destroy()
 {
-    // TODO: Implement for background GC
-    return false;
+    pthread_mutex_destroy(&m_cs.mutex);
 }
 
-bool IsGCSpecialThread()
+// Enter the critical section. Blocks until the section can be entered.
+void CLRCriticalSection::Enter()
 {
-    // TODO: Implement for background GC
-    return false;
+    pthread_mutex_lock(&m_cs.mutex);
 }
 
-#endif // 0
-
-WINBASEAPI
-UINT
-WINAPI
-GetWriteWatch(
-    DWORD dwFlags,
-    PVOID lpBaseAddress,
-    SIZE_T dwRegionSize,
-    PVOID *lpAddresses,
-    uintptr_t * lpdwCount,
-    uint32_t * lpdwGranularity
-    )
-{
-    // TODO: Implement for background GC
-    *lpAddresses = NULL;
-    *lpdwCount = 0;
-    // Until it is implemented, return non-zero value as an indicator of failure
-    return 1;
-}
-
-WINBASEAPI
-UINT
-WINAPI
-ResetWriteWatch(
-    LPVOID lpBaseAddress,
-    SIZE_T dwRegionSize
-    )
-{
-    // TODO: Implement for background GC
-    // Until it is implemented, return non-zero value as an indicator of failure
-    return 1;
-}
-
-const int tccSecondsToMillieSeconds = 1000;
-const int tccSecondsToMicroSeconds = 1000000;
-const int tccMillieSecondsToMicroSeconds = 1000;       // 10^3
-
-WINBASEAPI
-DWORD
-WINAPI
-GetTickCount()
-{
-    // TODO: More efficient, platform-specific implementation
-    struct timeval tv;
-    if (gettimeofday(&tv, NULL) == -1)
-    {
-        _ASSERTE(!"gettimeofday() failed");
-        return 0;
-    }
-    return (tv.tv_sec * tccSecondsToMillieSeconds) + (tv.tv_usec / tccMillieSecondsToMicroSeconds);
+// Leave the critical section
+void CLRCriticalSection::Leave()
+{
+    pthread_mutex_unlock(&m_cs.mutex);
 }
 
-WINBASEAPI
-BOOL
-WINAPI
-QueryPerformanceCounter(LARGE_INTEGER *lpPerformanceCount)
+//
+// Events, the handle of a CLREventStatic points to one of these
+//
+
+struct UnixEvent
+{
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_condition;
+    bool m_fManualReset;
+    bool m_fSignaled;
+};
+
+static HANDLE CreateUnixEvent(bool bManualReset, bool bInitialState)
 {
-    // TODO: More efficient, platform-specific implementation
-    struct timeval tv;
-    if (gettimeofday(&tv, NULL) == -1)
+    UnixEvent * pEvent = new (nothrow) UnixEvent();
+    if (pEvent == NULL)
     {
-        _ASSERTE(!"gettimeofday() failed");
-        return FALSE;
+        return NULL;
     }
-    lpPerformanceCount->QuadPart =
-        (int64_t) tv.tv_sec * (int64_t) tccSecondsToMicroSeconds + (int64_t) tv.tv_usec;
-    return TRUE;
+
+    pthread_mutex_init(&pEvent->m_mutex, NULL);
+    pthread_cond_init(&pEvent->m_condition, NULL);
+    pEvent->m_fManualReset = bManualReset;
+    pEvent->m_fSignaled = bInitialState;
+
+    return (HANDLE)pEvent;
 }
 
-WINBASEAPI
-BOOL
-WINAPI
-QueryPerformanceFrequency(LARGE_INTEGER *lpFrequency)
+void CLREventStatic::CreateManualEvent(bool bInitialState)
 {
-    lpFrequency->QuadPart = (int64_t) tccSecondsToMicroSeconds;
-    return TRUE;
+    m_hEvent = CreateUnixEvent(true, bInitialState);
+    m_fInitialized = true;
 }
 
-WINBASEAPI
-DWORD
-WINAPI
-GetCurrentThreadId(
-    void)
+void CLREventStatic::CreateAutoEvent(bool bInitialState)
 {
-    // TODO: Implement
-    return 1;
+    m_hEvent = CreateUnixEvent(false, bInitialState);
+    m_fInitialized = true;
 }
 
-WINBASEAPI
-void
-WINAPI
-YieldProcessor()
+void CLREventStatic::CreateOSManualEvent(bool bInitialState)
 {
-    // TODO: Implement
+    CreateManualEvent(bInitialState);
 }
 
-WINBASEAPI
-void
-WINAPI
-DebugBreak()
+void CLREventStatic::CreateOSAutoEvent(bool bInitialState)
 {
-    // TODO: Implement
+    CreateAutoEvent(bInitialState);
 }
 
-WINBASEAPI
-void
-WINAPI
-MemoryBarrier()
+void CLREventStatic::CloseEvent()
 {
-    // TODO: Implement
+    if (m_fInitialized && m_hEvent != NULL)
+    {
+        UnixEvent * pEvent = (UnixEvent *)m_hEvent;
+        pthread_cond_destroy(&pEvent->m_condition);
+        pthread_mutex_destroy(&pEvent->m_mutex);
+        delete pEvent;
+        m_hEvent = NULL;
+    }
 }
 
-// File I/O - Used for tracking only
+bool CLREventStatic::IsValid() const
+{
+    return m_fInitialized && m_hEvent != NULL;
+}
 
-WINBASEAPI
-BOOL
-WINAPI
-FlushFileBuffers(
-    HANDLE hFile)
+bool CLREventStatic::Set()
 {
-    // TODO: Reimplement callers using CRT
-    return FALSE;
+    if (!IsValid())
+        return false;
+
+    UnixEvent * pEvent = (UnixEvent *)m_hEvent;
+    pthread_mutex_lock(&pEvent->m_mutex);
+    pEvent->m_fSignaled = true;
+    if (pEvent->m_fManualReset)
+        pthread_cond_broadcast(&pEvent->m_condition);
+    else
+        pthread_cond_signal(&pEvent->m_condition);
+    pthread_mutex_unlock(&pEvent->m_mutex);
+
+    return true;
 }
 
-WINBASEAPI
-BOOL
-WINAPI
-WriteFile(
-    HANDLE hFile,
-    LPCVOID lpBuffer,
-    DWORD nNumberOfBytesToWrite,
-    DWORD * lpNumberOfBytesWritten,
-    PVOID lpOverlapped)
+bool CLREventStatic::Reset()
 {
-    // TODO: Reimplement callers using CRT
-    return FALSE;
+    if (!IsValid())
+        return false;
+
+    UnixEvent * pEvent = (UnixEvent *)m_hEvent;
+    pthread_mutex_lock(&pEvent->m_mutex);
+    pEvent->m_fSignaled = false;
+    pthread_mutex_unlock(&pEvent->m_mutex);
+
+    return true;
 }
 
-WINBASEAPI
-BOOL
-WINAPI
-CloseHandle(
-    HANDLE hObject)
+uint32_t CLREventStatic::Wait(uint32_t dwMilliseconds, bool bAlertable)
 {
-    // TODO: Reimplement callers using CRT
-    return FALSE;
+    uint32_t result = WAIT_FAILED;
+
+    if (IsValid())
+    {
+        bool        disablePreemptive = false;
+        Thread *    pCurThread = GetThread();
+
+        if (NULL != pCurThread)
+        {
+            if (GCToEEInterface::IsPreemptiveGCDisabled(pCurThread))
+            {
+                GCToEEInterface::EnablePreemptiveGC(pCurThread);
+                disablePreemptive = true;
+            }
+        }
+
+        timespec deadline;
+        if (dwMilliseconds != INFINITE)
+        {
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            uint64_t nanoseconds = (uint64_t)deadline.tv_nsec + (uint64_t)dwMilliseconds * tccMilliSecondsToNanoSeconds;
+            deadline.tv_sec += nanoseconds / tccSecondsToNanoSeconds;
+            deadline.tv_nsec = nanoseconds % tccSecondsToNanoSeconds;
+        }
+
+        UnixEvent * pEvent = (UnixEvent *)m_hEvent;
+        pthread_mutex_lock(&pEvent->m_mutex);
+
+        int st = 0;
+        while (!pEvent->m_fSignaled && (st == 0))
+        {
+            if (dwMilliseconds == INFINITE)
+                st = pthread_cond_wait(&pEvent->m_condition, &pEvent->m_mutex);
+            else
+                st = pthread_cond_timedwait(&pEvent->m_condition, &pEvent->m_mutex, &deadline);
+        }
+
+        if (pEvent->m_fSignaled)
+        {
+            if (!pEvent->m_fManualReset)
+                pEvent->m_fSignaled = false;
+            result = WAIT_OBJECT_0;
+        }
+        else if (st == ETIMEDOUT)
+        {
+            result = WAIT_TIMEOUT;
+        }
+
+        pthread_mutex_unlock(&pEvent->m_mutex);
+
+        if (disablePreemptive)
+        {
+            GCToEEInterface::DisablePreemptiveGC(pCurThread);
+        }
+    }
+
+    return result;
 }
 
-WINBASEAPI
-DWORD
-WINAPI
-GetLastError()
+void DestroyThread(Thread * pThread)
 {
-    return 1;
+    // TODO: implement
 }
@@ -252,8 +252,32 @@ bool GCToOSInterface::GetWriteWatch(bool resetState, void* address, size_t size,
 //  Size of the cache
 size_t GCToOSInterface::GetLargestOnDieCacheSize(bool trueSize)
 {
-    // TODO: implement
-    return 0;
+    // The GC sizes the gen0 budget from this. Without it gen0 stays at its 256KB floor, which makes every scenario
+    // with many roots spend its time reporting them.
+    DWORD cbInfo = 0;
+    if (::GetLogicalProcessorInformation(NULL, &cbInfo) || (GetLastError() != ERROR_INSUFFICIENT_BUFFER))
+    {
+        return 0;
+    }
+
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION * pInfo = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION *)new (nothrow) uint8_t[cbInfo];
+    if (pInfo == NULL)
+    {
+        return 0;
+    }
+
+    size_t cacheSize = 0;
+    if (::GetLogicalProcessorInformation(pInfo, &cbInfo))
+    {
+        for (DWORD i = 0; i < cbInfo / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION); i++)
+        {
+            if (pInfo[i].Relationship == RelationCache)
+                cacheSize = max(cacheSize, (size_t)pInfo[i].Cache.Size);
+        }
+    }
+
+    delete[] (uint8_t *)pInfo;
+    return cacheSize;
 }
 
 // Get affinity mask of the current process
@@ -437,6 +461,87 @@ void CLRCriticalSection::Leave()
     ::LeaveCriticalSection(&m_cs);
 }
 
+void CLREventStatic::CreateManualEvent(bool bInitialState)
+{
+    m_hEvent = CreateEventW(NULL, TRUE, bInitialState, NULL);
+    m_fInitialized = true;
+}
+
+void CLREventStatic::CreateAutoEvent(bool bInitialState)
+{
+    m_hEvent = CreateEventW(NULL, FALSE, bInitialState, NULL);
+    m_fInitialized = true;
+}
+
+void CLREventStatic::CreateOSManualEvent(bool bInitialState)
+{
+    m_hEvent = CreateEventW(NULL, TRUE, bInitialState, NULL);
+    m_fInitialized = true;
+}
+
+void CLREventStatic::CreateOSAutoEvent(bool bInitialState)
+{
+    m_hEvent = CreateEventW(NULL, FALSE, bInitialState, NULL);
+    m_fInitialized = true;
+}
+
+void CLREventStatic::CloseEvent()
+{
+    if (m_fInitialized && m_hEvent != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_hEvent);
+        m_hEvent = INVALID_HANDLE_VALUE;
+    }
+}
+
+bool CLREventStatic::IsValid() const
+{
+    return m_fInitialized && m_hEvent != INVALID_HANDLE_VALUE;
+}
+
+bool CLREventStatic::Set()
+{
+    if (!m_fInitialized)
+        return false;
+    return !!SetEvent(m_hEvent);
+}
+
+bool CLREventStatic::Reset()
+{
+    if (!m_fInitialized)
+        return false;
+    return !!ResetEvent(m_hEvent);
+}
+
+uint32_t CLREventStatic::Wait(uint32_t dwMilliseconds, bool bAlertable)
+{
+    DWORD result = WAIT_FAILED;
+
+    if (m_fInitialized)
+    {
+        bool        disablePreemptive = false;
+        Thread *    pCurThread = GetThread();
+
+        if (NULL != pCurThread)
+        {
+            if (GCToEEInterface::IsPreemptiveGCDisabled(pCurThread))
+            {
+                GCToEEInterface::EnablePreemptiveGC(pCurThread);
+                disablePreemptive = true;
+            }
+        }
+
+        result = WaitForSingleObjectEx(m_hEvent, dwMilliseconds, bAlertable);
+
+        if (disablePreemptive)
+        {
+            GCToEEInterface::DisablePreemptiveGC(pCurThread);
+        }
+    }
+
+    return result;
+}
+
 void DestroyThread(Thread * pThread)
 {
     // TODO: implement
@@ -36,6 +36,28 @@ namespace System.Runtime
         [DllImport(Redhawk.BaseName, CallingConvention = CallingConvention.Cdecl)]
         private static extern long RhpGetGcTotalMemory();
 
+        // Drain up to cMaxSamples allocation samples (native AllocationSample structures) into pBuffer and
+        // return how many were copied.
+        [RuntimeExport("RhGetAllocationSamples")]
+        internal static uint RhGetAllocationSamples(IntPtr pBuffer, uint cMaxSamples)
+        {
+            return RhpGetAllocationSamples(pBuffer, cMaxSamples);
+        }
+
+        [DllImport(Redhawk.BaseName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern uint RhpGetAllocationSamples(IntPtr pBuffer, uint cMaxSamples);
+
+        // Write a snapshot of the heap (see src/Native/Runtime/HeapSnapshot.h) to the file named by the null
+        // terminated UTF-8 string pszFileName. Returns false if the snapshot couldn't be written in full.
+        [RuntimeExport("RhWriteHeapSnapshot")]
+        internal static bool RhWriteHeapSnapshot(IntPtr pszFileName)
+        {
+            return RhpWriteHeapSnapshot(pszFileName) != 0;
+        }
+
+        [DllImport(Redhawk.BaseName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int RhpWriteHeapSnapshot(IntPtr pszFileName);
+
         //
         // internalcalls for System.Runtime.__Finalizer.
         //
@@ -46,6 +68,13 @@ namespace System.Runtime
         [ManuallyManaged(GcPollPolicy.Never)]
         internal static extern Object RhpGetNextFinalizableObject();
 
+        // Fetch up to buffer.Length objects which need finalization into the start of buffer and return how
+        // many were fetched, zero if we've reached the end of the list.
+        [RuntimeImport(Redhawk.BaseName, "RhpGetNextFinalizableObjects")]
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [ManuallyManaged(GcPollPolicy.Never)]
+        internal static extern uint RhpGetNextFinalizableObjects(Object[] buffer);
+
         //
         // internalcalls for System.Runtime.InteropServices.GCHandle.
         //
@@ -81,6 +110,13 @@ namespace System.Runtime
         [ManuallyManaged(GcPollPolicy.Sometimes)]
         internal unsafe extern static object RhpNewFinalizable(EEType* pEEType);
 
+        // Allocate up to count objects from the thread's alloc context into consecutive elements of an object
+        // array starting at pOut, returning how many were allocated. Never triggers a GC.
+        [RuntimeImport(Redhawk.BaseName, "RhpNewFastBatch")]
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [ManuallyManaged(GcPollPolicy.Never)]
+        internal unsafe extern static uint RhpNewFastBatch(EEType* pEEType, uint count, ref object pOut);  // BEWARE: not for finalizable objects!
+
         [RuntimeImport(Redhawk.BaseName, "RhpNewArray")]
         [MethodImpl(MethodImplOptions.InternalCall)]
         [ManuallyManaged(GcPollPolicy.Sometimes)]
@@ -194,6 +230,20 @@ namespace System.Runtime
                                                                          EETypeRef** ppInstantiation,
                                                                          GenericVariance** ppVarianceInfo);
 
+        // Look up the cached result of casting an object of type pSourceType to pTargetType. Returns
+        // CastCacheResult.Miss if the result hasn't been recorded yet.
+        [RuntimeImport(Redhawk.BaseName, "RhpCheckCastCache")]
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [ManuallyManaged(GcPollPolicy.Never)]
+        internal extern static unsafe CastCacheResult RhpCheckCastCache(EEType* pSourceType, EEType* pTargetType);
+
+        // Record the result of casting an object of type pSourceType to pTargetType. Only results which depend
+        // solely on the two types (and not on the object instance, e.g. via ICastable) may be recorded.
+        [RuntimeImport(Redhawk.BaseName, "RhpAddToCastCache")]
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [ManuallyManaged(GcPollPolicy.Never)]
+        internal extern static unsafe void RhpAddToCastCache(EEType* pSourceType, EEType* pTargetType, bool fCastable);
+
         //
         // StackFrameIterator
         //
@@ -254,6 +304,11 @@ namespace System.Runtime
         [ManuallyManaged(GcPollPolicy.Never)]
         internal extern static unsafe IntPtr RhpGetICastableGetImplTypeMethod(EEType* pEEType);
 
+        [RuntimeImport(Redhawk.BaseName, "RhpIsCurrentThreadPrimaryFinalizer")]
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [ManuallyManaged(GcPollPolicy.Never)]
+        internal extern static uint RhpIsCurrentThreadPrimaryFinalizer();
+
         [RuntimeImport(Redhawk.BaseName, "RhpGetNextFinalizerInitCallback")]
         [MethodImpl(MethodImplOptions.InternalCall)]
         [ManuallyManaged(GcPollPolicy.Never)]
@@ -316,6 +371,14 @@ namespace System.Runtime
         internal static extern void RhpSignalFinalizationComplete();
     }
 
+    // Keep this synchronized with CastCacheResult in TypeCastCache.h.
+    internal enum CastCacheResult : uint
+    {
+        NotCastable = 0,
+        Castable = 1,
+        Miss = 2,
+    }
+
     // Keep this synchronized with GenericVarianceType in rhbinder.h.
     public enum GenericVariance : byte
     {
@@ -107,6 +107,51 @@ namespace System.Runtime
             }
         }
 
+        // Fill objects[index .. index + count) with newly allocated objects of the given type.
+        [RuntimeExport("RhNewObjectBatch")]
+        public unsafe static void RhNewObjectBatch(EETypePtr pEEType, object[] objects, int index, int count)
+        {
+            EEType* ptrEEType = (EEType*)pEEType.ToPointer();
+
+            // The fast path writes to the array without bounds checks, so validate the whole range up front.
+            if ((uint)index > (uint)objects.Length || (uint)count > (uint)(objects.Length - index))
+            {
+                IntPtr returnAddr = BinderIntrinsics.GetReturnAddress();
+                Exception e = EH.GetClasslibException(ExceptionIDs.IndexOutOfRange, returnAddr);
+                throw e;
+            }
+
+            int end = index + count;
+
+#if FEATURE_64BIT_ALIGNMENT
+            if (ptrEEType->RequiresAlign8)
+            {
+                for (int i = index; i < end; i++)
+                    objects[i] = RhNewObject(pEEType);
+                return;
+            }
+#endif // FEATURE_64BIT_ALIGNMENT
+
+            if (ptrEEType->IsFinalizable)
+            {
+                for (int i = index; i < end; i++)
+                    objects[i] = InternalCalls.RhpNewFinalizable(ptrEEType);
+                return;
+            }
+
+            int next = index;
+            while (next < end)
+            {
+                next += (int)InternalCalls.RhpNewFastBatch(ptrEEType, (uint)(end - next), ref objects[next]);
+                if (next < end)
+                {
+                    // The alloc context is exhausted. Going through the regular allocator refills it (and may
+                    // trigger a GC, which is fine since everything allocated so far is held by the array).
+                    objects[next++] = InternalCalls.RhpNewFast(ptrEEType);
+                }
+            }
+        }
+
         [RuntimeExport("RhNewArray")]
         public unsafe static object RhNewArray(EETypePtr pEEType, int length)
         {
@@ -62,6 +62,24 @@ namespace System.Runtime
                 while (pObjType->SimpleCasting());
             }
 
+            // The remaining checks are comparatively expensive, so consult the cast cache first. The cache is
+            // keyed on the exact type of the object rather than the parent we may have walked up to above.
+            CastCacheResult cachedResult = InternalCalls.RhpCheckCastCache(obj.EEType, pTargetType);
+            if (cachedResult != CastCacheResult.Miss)
+            {
+                return (cachedResult == CastCacheResult.Castable) ? obj : null;
+            }
+
+            bool fCastable = IsInstanceOfClassSlow(pObjType, pTargetType);
+            InternalCalls.RhpAddToCastCache(obj.EEType, pTargetType, fCastable);
+
+            return fCastable ? obj : null;
+        }
+
+        // Slow path of IsInstanceOfClass. Determines whether an object of type pObjType (or a type derived from
+        // it) can be cast to pTargetType without consulting the cast cache.
+        static private unsafe bool IsInstanceOfClassSlow(EEType* pObjType, EEType* pTargetType)
+        {
             if (pTargetType->IsCloned)
             {
                 pTargetType = pTargetType->CanonicalEEType;
@@ -75,7 +93,7 @@ namespace System.Runtime
             // if the EETypes pointers match, we're done
             if (pObjType == pTargetType)
             {
-                return obj;
+                return true;
             }
 
             if (pTargetType->HasGenericVariance && pObjType->HasGenericVariance)
@@ -87,7 +105,7 @@ namespace System.Runtime
                 // we don't support deriving from user delegate classes any further all we have to check here
                 // is that the uninstantiated generic delegate definitions are the same and the type
                 // parameters are compatible.
-                return TypesAreCompatibleViaGenericVariance(pObjType, pTargetType) ? obj : null;
+                return TypesAreCompatibleViaGenericVariance(pObjType, pTargetType);
             }
 
             if (pObjType->IsArray)
@@ -95,16 +113,16 @@ namespace System.Runtime
                 // arrays can be cast to System.Object
                 if (WellKnownEETypes.IsSystemObject(pTargetType))
                 {
-                    return obj;
+                    return true;
                 }
 
                 // arrays can be cast to System.Array
                 if (WellKnownEETypes.IsSystemArray(pTargetType))
                 {
-                    return obj;
+                    return true;
                 }
 
-                return null;
+                return false;
             }
 
 
@@ -114,7 +132,7 @@ namespace System.Runtime
                 pObjType = pObjType->NonClonedNonArrayBaseType;
                 if (pObjType == null)
                 {
-                    return null;
+                    return false;
                 }
 
                 if (pObjType->IsCloned)
@@ -122,7 +140,7 @@ namespace System.Runtime
 
                 if (pObjType == pTargetType)
                 {
-                    return obj;
+                    return true;
                 }
             }
         }
@@ -202,12 +220,18 @@ namespace System.Runtime
 
             Debug.Assert(!pObjType->IsCloned, "cloned array types are disallowed");
 
+            CastCacheResult cachedResult = InternalCalls.RhpCheckCastCache(pObjType, pTargetType);
+            if (cachedResult != CastCacheResult.Miss)
+            {
+                return (cachedResult == CastCacheResult.Castable) ? obj : null;
+            }
+
             // compare the array types structurally
 
-            if (AreTypesAssignableInternal(pObjType->RelatedParameterType, pTargetType->RelatedParameterType, false, true))
-                return obj;
+            bool fCastable = AreTypesAssignableInternal(pObjType->RelatedParameterType, pTargetType->RelatedParameterType, false, true);
+            InternalCalls.RhpAddToCastCache(pObjType, pTargetType, fCastable);
 
-            return null;
+            return fCastable ? obj : null;
         }
 
         [RuntimeExport("RhTypeCast_CheckCastArray")]
@@ -300,59 +324,77 @@ namespace System.Runtime
             //
             // Interfaces which are only variant for arrays have the HasGenericVariance flag set even if they
             // are not variant.
+            if (!pTargetType->HasGenericVariance)
+                return false;
+
+            // Matching up instantiations is expensive, so consult the cast cache first.
+            CastCacheResult cachedResult = InternalCalls.RhpCheckCastCache(pObjType, pTargetType);
+            if (cachedResult != CastCacheResult.Miss)
+                return cachedResult == CastCacheResult.Castable;
+
+            bool fImplements = ImplementsInterfaceViaGenericVariance(pObjType, pTargetType);
+            InternalCalls.RhpAddToCastCache(pObjType, pTargetType, fImplements);
+
+            return fImplements;
+        }
+
+        // Determine whether pObjType implements an instantiation of the generic interface pTargetType which is
+        // compatible with pTargetType due to generic variance (or array covariance).
+        static private unsafe bool ImplementsInterfaceViaGenericVariance(EEType* pObjType, EEType* pTargetType)
+        {
+            int numInterfaces = pObjType->NumInterfaces;
+            EEInterfaceInfo* interfaceMap = pObjType->InterfaceMap;
             bool fArrayCovariance = pObjType->IsArray;
-            if (pTargetType->HasGenericVariance)
-            {
-                // Grab details about the instantiation of the target generic interface.
-                EETypeRef* pTargetInstantiation;
-                int targetArity;
-                GenericVariance* pTargetVarianceInfo;
-                EEType* pTargetGenericType = InternalCalls.RhGetGenericInstantiation(pTargetType,
-                                                                                      &targetArity,
-                                                                                      &pTargetInstantiation,
-                                                                                      &pTargetVarianceInfo);
 
-                Debug.Assert(pTargetVarianceInfo != null, "did not expect empty variance info");
+            // Grab details about the instantiation of the target generic interface.
+            EETypeRef* pTargetInstantiation;
+            int targetArity;
+            GenericVariance* pTargetVarianceInfo;
+            EEType* pTargetGenericType = InternalCalls.RhGetGenericInstantiation(pTargetType,
+                                                                                  &targetArity,
+                                                                                  &pTargetInstantiation,
+                                                                                  &pTargetVarianceInfo);
+
+            Debug.Assert(pTargetVarianceInfo != null, "did not expect empty variance info");
 
 
-                for (int i = 0; i < numInterfaces; i++)
+            for (int i = 0; i < numInterfaces; i++)
+            {
+                EEType* pInterfaceType = interfaceMap[i].InterfaceType;
+
+                // We can ignore interfaces which are not also marked as having generic variance
+                // unless we're dealing with array covariance. 
+                //
+                // Interfaces which are only variant for arrays have the HasGenericVariance flag set even if they
+                // are not variant.
+                if (pInterfaceType->HasGenericVariance)
                 {
-                    EEType* pInterfaceType = interfaceMap[i].InterfaceType;
-
-                    // We can ignore interfaces which are not also marked as having generic variance
-                    // unless we're dealing with array covariance. 
-                    //
-                    // Interfaces which are only variant for arrays have the HasGenericVariance flag set even if they
-                    // are not variant.
-                    if (pInterfaceType->HasGenericVariance)
-                    {
-                        // Grab instantiation details for the candidate interface.
-                        EETypeRef* pInterfaceInstantiation;
-                        int interfaceArity;
-                        GenericVariance* pInterfaceVarianceInfo;
-                        EEType* pInterfaceGenericType = InternalCalls.RhGetGenericInstantiation(pInterfaceType,
-                                                                                                 &interfaceArity,
-                                                                                                 &pInterfaceInstantiation,
-                                                                                                 &pInterfaceVarianceInfo);
-
-                        Debug.Assert(pInterfaceVarianceInfo != null, "did not expect empty variance info");
-
-                        // If the generic types aren't the same then the types aren't compatible.
-                        if (pInterfaceGenericType != pTargetGenericType)
-                            continue;
-
-                        // The types represent different instantiations of the same generic type. The
-                        // arity of both had better be the same.
-                        Debug.Assert(targetArity == interfaceArity, "arity mismatch betweeen generic instantiations");
-
-                        // Compare the instantiations to see if they're compatible taking variance into account.
-                        if (TypeParametersAreCompatible(targetArity,
-                                                        pInterfaceInstantiation,
-                                                        pTargetInstantiation,
-                                                        pTargetVarianceInfo,
-                                                        fArrayCovariance))
-                            return true;
-                    }
+                    // Grab instantiation details for the candidate interface.
+                    EETypeRef* pInterfaceInstantiation;
+                    int interfaceArity;
+                    GenericVariance* pInterfaceVarianceInfo;
+                    EEType* pInterfaceGenericType = InternalCalls.RhGetGenericInstantiation(pInterfaceType,
+                                                                                             &interfaceArity,
+                                                                                             &pInterfaceInstantiation,
+                                                                                             &pInterfaceVarianceInfo);
+
+                    Debug.Assert(pInterfaceVarianceInfo != null, "did not expect empty variance info");
+
+                    // If the generic types aren't the same then the types aren't compatible.
+                    if (pInterfaceGenericType != pTargetGenericType)
+                        continue;
+
+                    // The types represent different instantiations of the same generic type. The
+                    // arity of both had better be the same.
+                    Debug.Assert(targetArity == interfaceArity, "arity mismatch betweeen generic instantiations");
+
+                    // Compare the instantiations to see if they're compatible taking variance into account.
+                    if (TypeParametersAreCompatible(targetArity,
+                                                    pInterfaceInstantiation,
+                                                    pTargetInstantiation,
+                                                    pTargetVarianceInfo,
+                                                    fArrayCovariance))
+                        return true;
                 }
             }
 
@@ -7,9 +7,10 @@ using System.Runtime.InteropServices;
 using System.Runtime.CompilerServices;
 
 //
-// Implements the single finalizer thread for a Redhawk instance. Essentially waits for an event to fire
+// Implements the finalizer thread(s) for a Redhawk instance. Essentially waits for an event to fire
 // indicating finalization is necessary then drains the queue of pending finalizable objects, calling the
-// finalize method for each one.
+// finalize method for each one. The runtime may run this on more than one thread, in which case the threads
+// drain the queue together.
 // 
 
 namespace System.Runtime
@@ -22,7 +23,12 @@ namespace System.Runtime
     public static class __Finalizer
 #endif
     {
-        private static bool s_fHaveNewClasslibs /* = false */;
+        // Number of finalizable objects fetched from the runtime at a time.
+        private const int FinalizationBatchSize = 32;
+
+        // Set when a class library is registered. Only the primary finalizer thread resets it and makes the
+        // finalizer init callbacks, the additional ones would race with it over both.
+        private static volatile bool s_fHaveNewClasslibs /* = false */;
 
         [NativeCallable(EntryPoint = "ProcessFinalizers", CallingConvention = CallingConvention.Cdecl)]
         public static void ProcessFinalizers()
@@ -33,7 +39,7 @@ namespace System.Runtime
                 // otherwise memory is low and we should initiate a collection. 
                 if (InternalCalls.RhpWaitForFinalizerRequest() != 0)
                 {
-                    if (s_fHaveNewClasslibs)
+                    if (s_fHaveNewClasslibs && (InternalCalls.RhpIsCurrentThreadPrimaryFinalizer() != 0))
                     {
                         s_fHaveNewClasslibs = false;
                         MakeFinalizerInitCallbacks();
@@ -60,17 +66,25 @@ namespace System.Runtime
         [MethodImpl(MethodImplOptions.NoInlining)]
         private unsafe static void DrainQueue()
         {
+            Object[] batch = new Object[FinalizationBatchSize];
+
             // Drain the queue of finalizable objects.
             while (true)
             { 
-                Object target = InternalCalls.RhpGetNextFinalizableObject();
-                if (target == null)
+                uint count = InternalCalls.RhpGetNextFinalizableObjects(batch);
+                if (count == 0)
                     return;
 
-                // Call the finalizer on the current target object. If the finalizer throws we'll fail
-                // fast via normal Redhawk exception semantics (since we don't attempt to catch
-                // anything).
-                CalliIntrinsics.CallVoid(target.EEType->FinalizerCode, target);
+                for (uint i = 0; i < count; i++)
+                {
+                    Object target = batch[i];
+                    batch[i] = null;
+
+                    // Call the finalizer on the current target object. If the finalizer throws we'll fail
+                    // fast via normal Redhawk exception semantics (since we don't attempt to catch
+                    // anything).
+                    CalliIntrinsics.CallVoid(target.EEType->FinalizerCode, target);
+                }
             }
         }
 
@@ -17,6 +17,9 @@ namespace Internal.Runtime.CompilerHelpers
     [McgIntrinsics]
     internal static class StartupCodeHelpers
     {
+        // STARTUP_TIMELINE_EVENT_ID in src/Native/Runtime/CommonMacros.h
+        private const uint StartupTimelineEagerClassConstructorsBegin = 7;
+
         public static IntPtr[] Modules
         {
             get; private set;
@@ -36,6 +39,8 @@ namespace Internal.Runtime.CompilerHelpers
             // so that the eager constructors can access it.
             Modules = modules;
 
+            RecordStartupTimelineEvent(StartupTimelineEagerClassConstructorsBegin);
+
             // These two loops look funny but it's important to initialize the global tables before running
             // the first class constructor to prevent them calling into another uninitialized module
             foreach (var moduleManager in modules)
@@ -202,5 +207,9 @@ namespace Internal.Runtime.CompilerHelpers
         [RuntimeImport(".", "RhpCreateModuleManager")]
         [MethodImplAttribute(MethodImplOptions.InternalCall)]
         private static unsafe extern IntPtr CreateModuleManager(IntPtr moduleHeader);
+
+        [RuntimeImport(".", "RhpRecordStartupTimelineEvent")]
+        [MethodImplAttribute(MethodImplOptions.InternalCall)]
+        private static extern void RecordStartupTimelineEvent(uint eventId);
     }
 }
@@ -90,6 +90,14 @@ namespace System.Runtime
         [RuntimeImport(RuntimeLibrary, "RhGetGcTotalMemory")]
         internal static extern long RhGetGcTotalMemory();
 
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhGetAllocationSamples")]
+        internal static extern uint RhGetAllocationSamples(IntPtr pBuffer, uint cMaxSamples);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhWriteHeapSnapshot")]
+        internal static extern bool RhWriteHeapSnapshot(IntPtr pszFileName);
+
         [MethodImpl(MethodImplOptions.InternalCall)]
         [RuntimeImport(RuntimeLibrary, "RhGetLohCompactionMode")]
         internal static extern int RhGetLohCompactionMode();
@@ -114,6 +122,30 @@ namespace System.Runtime
         [RuntimeImport(RuntimeLibrary, "RhGetLastGCDuration")]
         internal static extern long RhGetLastGCDuration(int generation);
 
+        // Copies the GC's pause and phase histograms (the native gc_pause_stats structure) to pBuffer if cbBuffer
+        // is large enough and returns their size.
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhGetGcPauseStats")]
+        internal static unsafe extern uint RhGetGcPauseStats(void* pBuffer, uint cbBuffer);
+
+        // Copies up to cMaxEntries (type, count, bytes) entries, the native gc_type_histogram_entry structure, of the
+        // types owning the most bytes after the last blocking gen2 GC to pBuffer and returns how many were copied.
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhGetTypeHistogram")]
+        internal static unsafe extern uint RhGetTypeHistogram(void* pBuffer, uint cMaxEntries, ulong* pGcIndex);
+
+        // Copies the runtime lock contention counters (an array of the native CrstContentionStats structure indexed
+        // by CrstType) to pBuffer if cbBuffer is large enough and returns their size.
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhGetCrstContentionStats")]
+        internal static unsafe extern uint RhGetCrstContentionStats(void* pBuffer, uint cbBuffer);
+
+        // Copies the runtime suspension time histogram (the native SuspendStats structure) to pBuffer if cbBuffer
+        // is large enough and returns its size.
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhGetSuspendStats")]
+        internal static unsafe extern uint RhGetSuspendStats(void* pBuffer, uint cbBuffer);
+
         //
         // calls for GCHandle.
         // These methods are needed to implement GCHandle class like functionality (optional)
@@ -241,6 +273,11 @@ namespace System.Runtime
         [RuntimeImport(RuntimeLibrary, "RhNewObject")]
         internal static extern object RhNewObject(EETypePtr pEEType);
 
+        // Fill objects[index .. index + count) with new objects of the given type.
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhNewObjectBatch")]
+        internal static extern void RhNewObjectBatch(EETypePtr pEEType, object[] objects, int index, int count);
+
         [MethodImpl(MethodImplOptions.InternalCall)]
         [RuntimeImport(RuntimeLibrary, "RhNewArray")]
         internal static extern Array RhNewArray(EETypePtr pEEType, int length);